@@ -34,18 +34,30 @@
 #include <byteswap.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <limits.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <sched.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <linux/spi/spi.h>
 #include <linux/spi/spidev.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "libads1256.h"
 #include "libads1256reg.h"
+#include "libads1256replay.h"
+#include "libads1256writer.h"
+#include "libads1256pyramid.h"
+#include "libads1256net.h"
+#include "libads1256arena.h"
+#include "libads1256duty.h"
+#include "libads1256export.h"
+#include "libads1256detect.h"
 #include "ads1256.h"
 
 #define DEV_SPI_SPEED 1920000 // 1MHz
@@ -54,25 +66,148 @@
 extern int ADS125xDriverDebug;
 char *usage = "Usage: [options...]\n"
               " -h, --help                 Show this manual\n"
-              " -s, --single               Single read\n"
-              " -c, --continuous <times>   Read data 'times' times in continuous mode.\n"
+              " -s, --single [n] [median]  Single read, or the mean (median) of a burst of n\n"
+              "                            conversions at 30 kSPS with its noise and latency\n"
+              " -c, --continuous <times> [recover]\n"
+              "                            Read data 'times' times in continuous mode, recover\n"
+              "                            in place from a DRDY or SPI glitch if given\n"
               "     -o, --output <file>    Write continuous mode data to a file\n"
-              " -p, --pdwn [off/on/0/1]    Set PDWN low (off/0) or high (on/1)\n\n"
+              " -b, --binary <times> <file> [recover]\n"
+              "                            Stream 'times' reads to a binary capture file,\n"
+              "                            with a min/max/mean pyramid in <file>.pyr\n"
+              " -v, --view <file> <first> <count> <pixels>\n"
+              "                            Print min/max/mean of a capture range from its pyramid\n"
+              " -e, --export <capture> <csv> [threads]\n"
+              "                            Convert a binary capture to the CSV of the continuous\n"
+              "                            mode, formatted on 'threads' threads (default all CPUs)\n"
+              " -n, --net <tcp|udp> <addr> <times> [capture]\n"
+              "                            Stream 'times' reads over TCP (listen on [host:]port,\n"
+              "                            start with the first client) or UDP (send to host:port),\n"
+              "                            from a replayed capture instead of the ADC if given\n"
+              " -d, --duty <rate> <times> [capture]\n"
+              "                            Take 'times' readings at 'rate' Hz, the ADC in STANDBY\n"
+              "                            or PDWN in between, from a replayed capture if given\n"
+              " -a, --alarm <spec> <times> [capture]\n"
+              "                            Print only the events of 'times' reads, as set by\n"
+              "                            spec: high=,low=,hyst=,spike=,step=<codes>[/<window>],\n"
+              "                            flat=<codes>/<samples>,context=<samples>\n"
+              " -k, --control <times> <deadline_us> [capture]\n"
+              "                            Run a control callback on each of 'times' reads and\n"
+              "                            print the DRDY to callback latencies and deadline misses\n"
+              " -p, --pdwn [off/on/0/1]    Set PDWN low (off/0) or high (on/1)\n"
+              " -r, --replay <file> [fast] Replay a capture (.csv or binary) through RDATAC,\n"
+              "                            paced at the DRATE or as fast as possible\n\n"
               "ads1256 homepage at: https://github.com/rokkiea/ADS125x-driver\n"
               "Copyright (c) 2025 Guo Ruijing (rokkiea)";
 
-void one_shot_read();
-void continu_read(FILE *output, int times);
+void check_ret(int ret, const char *what);
+void replay_setup(ads125x_dev *dev, const char *path, int flags);
+ads125x_arena *session_arena(size_t size);
+int export_threads(void);
+void one_shot_read(int burst, int filter);
+void continu_setup(ads125x_dev *dev);
+void print_recovery(ads125x_dev *dev);
+void continu_release(ads125x_dev *dev);
+void continu_read(FILE *output, int times, int recover);
+void binary_read(const char *path, int times, int recover);
+void write_continu_result(FILE *output, uint8_t *rdatac_result, int times);
 void doContinuRead(int argc, char* argv []);
+void doBinaryRead(int argc, char* argv []);
 void doPdwn(int argc, char* argv []);
+void doNet(int argc, char* argv []);
+void doDuty(int argc, char* argv []);
+int set_replay_fault(ads125x_dev *dev, const char *spec);
+void doReplay(int argc, char* argv []);
+void doView(int argc, char* argv []);
+void doExport(int argc, char* argv []);
+int set_detect_spec(ads125x_detect_config *cfg, const char *spec);
+void write_events(FILE *output, const ads125x_event *events, int n);
+void doAlarm(int argc, char* argv []);
+void doControl(int argc, char* argv []);
 
-void one_shot_read()
+/**
+ * check_ret - Exit when a libads1256 call failed
+ * @ret: Return value of the call.
+ * @what: Name of the step, for the error message.
+ */
+void check_ret(int ret, const char *what)
+{
+    if (ret >= 0)
+        return;
+    fprintf(stderr, "%s failed: %d\n", what, ret);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * replay_setup - Open a capture as the device and set it up as continu_setup() does the ADC
+ * @dev: The device, overwritten.
+ * @path: The capture, CSV or binary.
+ * @flags: ADS125x_REPLAY_* flags.
+ */
+void replay_setup(ads125x_dev *dev, const char *path, int flags)
+{
+    memset(dev, 0x00, sizeof(*dev));
+    dev->name = "ADS1256";
+    if (ads125xReplayOpen(dev, path, ADS125x_REPLAY_FMT_AUTO, flags))
+        exit(EXIT_FAILURE);
+    check_ret(ads125xRESET(dev), "RESET");
+    check_ret(ads125xSetDRATE(dev, (uint8_t)ADS125x_DR_1000), "Set DRATE");
+    check_ret(ads125xSetMUX(dev, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1), "Set MUX");
+    check_ret(ads125xSELFCAL(dev), "SELFCAL");
+    return;
+}
+
+/**
+ * session_arena - Buffers of a session, mapped and faulted in up front
+ * @size: Bytes of all the buffers of the session.
+ *
+ * ADS1256_ARENA=huge,memfd,lock picks the backing, see libads1256arena.h.
+ */
+ads125x_arena *session_arena(size_t size)
+{
+    ads125x_arena *arena;
+    char *env = NULL;
+    int flags = 0;
+
+    if ((env = getenv("ADS1256_ARENA")) != NULL)
+    {
+        if (strstr(env, "huge"))
+            flags |= ADS125x_ARENA_HUGEPAGE;
+        if (strstr(env, "memfd"))
+            flags |= ADS125x_ARENA_MEMFD;
+        if (strstr(env, "lock"))
+            flags |= ADS125x_ARENA_LOCK;
+    }
+    if ((arena = ads125xArenaOpen(size, flags)) == NULL)
+    {
+        fprintf(stderr, "Allocated memory for the session failed.\n");
+        exit(1);
+    }
+    return arena;
+}
+
+/**
+ * export_threads - Threads formatting the CSV output
+ *
+ * ADS1256_EXPORT_THREADS=n, default one per online CPU.
+ */
+int export_threads(void)
+{
+    char *env = NULL;
+
+    if ((env = getenv("ADS1256_EXPORT_THREADS")) != NULL)
+        return atoi(env);
+    return 0;
+}
+
+void one_shot_read(int burst, int filter)
 {
     uint8_t result[4] = {0};
     int i = 0;
     int ret = 0;
-    uint64_t calcResult = 0;
+    int64_t calcResult = 0;
     double result_volt = 0;
+    ads125x_burst br;
     ads125x_dev ads1256;
 
     // Init ads1256 struct memory space
@@ -83,7 +218,7 @@ void one_shot_read()
     ads1256.spi_speed = ADS125x_SPI_SPEED;
 
     // Setup SPI bus
-    if (0 == (ads1256.fd = ads125xSetup(&ads1256, 0, 0)))
+    if ((ads1256.fd = ads125xSetup(&ads1256, 0, 0)) < 0)
     {
         printf("SPI setup failed.\n");
         exit(EXIT_FAILURE);
@@ -99,29 +234,45 @@ void one_shot_read()
     ads125xSetPDWN(&ads1256, 1);
 
     // RESET ADS1256 to clean previous settings and status
-    ads125xRESET(&ads1256);
+    check_ret(ads125xRESET(&ads1256), "RESET");
     // Set data rate to 15000 sps
-    ads125xSetDRATE(&ads1256, (uint8_t)ADS125x_DR_15000);
+    check_ret(ads125xSetDRATE(&ads1256, (uint8_t)ADS125x_DR_15000), "Set DRATE");
     // Set Multiplexer, the result will be V_CH0 - V_CH1
-    ads125xSetMUX(&ads1256, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1);
+    check_ret(ads125xSetMUX(&ads1256, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1), "Set MUX");
     // Requite Self Offset and Gain Calibration
-    ads125xSendCMD(&ads1256, ADS125x_CMD_SELFCAL);
+    check_ret(ads125xSELFCAL(&ads1256), "SELFCAL");
 
     // Read Register STATUS, MUX, ADCON, DRATE
-    ads125xRREG(&ads1256, ADS125x_REG_ADDR_STATUS, result, 0x04);
+    check_ret(ads125xRREG(&ads1256, ADS125x_REG_ADDR_STATUS, result, 0x04), "RREG");
     fprintf(stdout, "STATUS MUX ADCON DRATE REG: ");
     for (i = 0; i < 4; ++i)
         fprintf(stdout, "%02hx ", result[i]);
     fprintf(stdout, "\n");
 
+    if (burst > 1)
+    {
+        // Oversampled at the fastest DRATE, noise falls with sqrt(burst)
+        check_ret(ads125xBurstRead(&ads1256, (uint8_t)ADS125x_DR_30000, burst, filter, &br), "Burst read");
+        fprintf(stdout, "Burst:      %d conversions, %s %.3lf   Volt=%.12lf\n", br.count,
+                filter == ADS125x_BURST_MEDIAN ? "median" : "mean", br.value, br.value * 5 / (1 << 23));
+        fprintf(stdout, "            noise %.3lf codes per conversion, %.3lf codes (%.3lf uV) filtered, latency %.3lf ms (expected %.3lf ms)\n",
+                br.noise_rms, br.noise, br.noise * 5e6 / (1 << 23), br.latency_ns * 1e-6,
+                ads125xBurstLatencyUs((uint8_t)ADS125x_DR_30000, burst) * 1e-3);
+        ads125xSetPDWN(&ads1256, 0);
+        ads125xCloseDRDY(&ads1256);
+        ads125xClosePDWN(&ads1256);
+        SPIRelease(ads1256.fd);
+        return;
+    }
+
     // one-shot read data
-    ads125xRDATA(&ads1256, result);
+    check_ret(ads125xRDATA(&ads1256, result), "RDATA");
     fprintf(stdout, "One-shot:   raw 0x");
     for (i = 0; i < 3; ++i)
         fprintf(stdout, "%02hx", result[i]);
 
     // convert raw data to real voltage
-    calcResult = (uint64_t)convert_to_signed_24bit(result);
+    calcResult = convert_to_signed_24bit(result);
     calcResult *= 5;
     result_volt = (double)calcResult / (1ULL << 23);
     fprintf(stdout, "   Volt=%.12lf\n", result_volt);
@@ -129,98 +280,244 @@ void one_shot_read()
     // Release all resource
     ads125xSetPDWN(&ads1256, 0);
     ads125xCloseDRDY(&ads1256);
+    ads125xClosePDWN(&ads1256);
     SPIRelease(ads1256.fd);
     return;
 }
 
-void continu_read(FILE *output, int times)
+void continu_setup(ads125x_dev *dev)
 {
     uint8_t result[4] = {0};
-    uint8_t *rdatac_result = NULL;
-    int i = 0, j = 0;
+    int i = 0;
     int ret = 0;
-    uint64_t calcResult = 0;
-    double result_volt = 0;
-    ads125x_dev ads1256;
 
     // Init ads1256 struct memory space
-    memset(&ads1256, 0x00, sizeof(ads1256));
-    if ((rdatac_result = (uint8_t *)malloc(times * ADS125x_DATA_LEN_BYTE)) == NULL)
-    {
-        fprintf(stderr, "Allocated memory for rdatac_result failed.\n");
-        exit(1);
-    }
-    memset(rdatac_result, 0x00, sizeof(times * ADS125x_DATA_LEN_BYTE));
-    ads1256.name = "ADS1256";
-    ads1256.spi_mode = ADS125x_SPI_MODE;
-    ads1256.spi_bit_p_word = ADS125x_SPI_BIT_P_WORD;
-    ads1256.spi_speed = ADS125x_SPI_SPEED;
+    memset(dev, 0x00, sizeof(*dev));
+    dev->name = "ADS1256";
+    dev->spi_mode = ADS125x_SPI_MODE;
+    dev->spi_bit_p_word = ADS125x_SPI_BIT_P_WORD;
+    dev->spi_speed = ADS125x_SPI_SPEED;
 
     // Setup SPI bus
-    if (0 == (ads1256.fd = ads125xSetup(&ads1256, 0, 0)))
+    if ((dev->fd = ads125xSetup(dev, 0, 0)) < 0)
     {
         printf("SPI setup failed.\n");
         exit(EXIT_FAILURE);
     }
 
     // Open DRDY & PDWN
-    if ((ret = ads125xOpenDRDY(&ads1256, ADS125x_DRDY_CHIP, ADS125x_DRDY_LINE)))
+    if ((ret = ads125xOpenDRDY(dev, ADS125x_DRDY_CHIP, ADS125x_DRDY_LINE)))
         fprintf(stderr, "Open DRDY err: %d\n", ret);
-    if ((ret = ads125xOpenPDWN(&ads1256, ADS125x_PDWN_CHIP, ADS125x_PDWN_LINE, 0)))
+    if ((ret = ads125xOpenPDWN(dev, ADS125x_PDWN_CHIP, ADS125x_PDWN_LINE, 0)))
         fprintf(stderr, "Open PDWN err: %d\n", ret);
 
     // Set PDWN to high to POWER-UP ADS1256
-    ads125xSetPDWN(&ads1256, 1);
+    ads125xSetPDWN(dev, 1);
 
     // RESET ADS1256 to clean previous settings and status
-    ads125xSendCMD(&ads1256, ADS125x_CMD_RESET);
+    check_ret(ads125xSendCMD(dev, ADS125x_CMD_RESET), "RESET");
     // Set data rate to 1000 sps
-    ads125xSetDRATE(&ads1256, (uint8_t)ADS125x_DR_1000);
+    check_ret(ads125xSetDRATE(dev, (uint8_t)ADS125x_DR_1000), "Set DRATE");
     // Set Multiplexer, the result will be V_CH0 - V_CH1
-    ads125xSetMUX(&ads1256, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1);
-    // Requite Self Offset and Gain Calibration
-    ads125xSendCMD(&ads1256, ADS125x_CMD_SELFCAL);
+    check_ret(ads125xSetMUX(dev, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1), "Set MUX");
+    // Requite Self Offset and Gain Calibration, the result is kept for recovery
+    check_ret(ads125xSELFCAL(dev), "SELFCAL");
 
     // Read Register STATUS, MUX, ADCON, DRATE
-    ads125xRREG(&ads1256, ADS125x_REG_ADDR_STATUS, result, 0x04);
+    check_ret(ads125xRREG(dev, ADS125x_REG_ADDR_STATUS, result, 0x04), "RREG");
     fprintf(stdout, "STATUS MUX ADCON DRATE REG: ");
     for (i = 0; i < 4; ++i)
         fprintf(stdout, "%02hx ", result[i]);
     fprintf(stdout, "\n");
+    return;
+}
+
+void print_recovery(ads125x_dev *dev)
+{
+    if (dev->recovery.count == 0 && dev->recovery.failures == 0)
+        return;
+    fprintf(stderr, "Recovered %llu times, %llu conversions lost, last gap %.3lf ms at sample %llu, %llu failures.\n",
+            (unsigned long long)dev->recovery.count, (unsigned long long)dev->recovery.lost_samples,
+            dev->recovery.last_gap_ns * 1e-6, (unsigned long long)dev->recovery.last_index,
+            (unsigned long long)dev->recovery.failures);
+    return;
+}
+
+void continu_release(ads125x_dev *dev)
+{
+    print_recovery(dev);
+    ads125xSetPDWN(dev, 0);
+    ads125xCloseDRDY(dev);
+    ads125xClosePDWN(dev);
+    SPIRelease(dev->fd);
+    return;
+}
+
+void continu_read(FILE *output, int times, int recover)
+{
+    uint8_t *rdatac_result = NULL;
+    ads125x_arena *arena = NULL;
+    ads125x_dev ads1256;
+
+    // Zeroed and faulted in, the RDATAC loop takes no page fault
+    arena = session_arena((size_t)times * ADS125x_DATA_LEN_BYTE + ADS125x_ARENA_ALIGN);
+    if ((rdatac_result = (uint8_t *)ads125xArenaAlloc(arena, (size_t)times * ADS125x_DATA_LEN_BYTE)) == NULL)
+    {
+        fprintf(stderr, "Allocated memory for rdatac_result failed.\n");
+        exit(1);
+    }
+    continu_setup(&ads1256);
+    // The capture survives a glitch, the lost conversions are reported
+    if (recover)
+        ads1256.flags |= ADS125x_FLAG_RECOVER;
 
     // continues read data
-    ads125xRDATAC(&ads1256, rdatac_result, times);
+    if (ads125xRDATAC(&ads1256, rdatac_result, times) < 0)
+        fprintf(stderr, "Continuous read stopped by a error.\n");
     fprintf(stdout, "====== Continues read ======\n");
-    for (j = 0; j < times; ++j)
+    write_continu_result(output, rdatac_result, times);
+
+    // Release all resource
+    continu_release(&ads1256);
+    ads125xArenaClose(arena);
+    return;
+}
+
+void binary_read(const char *path, int times, int recover)
+{
+    uint8_t *buf = NULL, *scratch = NULL;
+    uint64_t *ts = NULL;
+    ads125x_arena *arena = NULL;
+    int done = 0, n = 0, k = 0;
+    ads125x_writer *writer = NULL;
+    ads125x_writer_stats stats;
+    ads125x_pyr *pyr = NULL;
+    ads125x_detect_config cfg;
+    ads125x_detect *det = NULL;
+    ads125x_event events[ADS125x_ALARM_EVENTS];
+    FILE *events_fp = NULL;
+    char events_path[PATH_MAX];
+    char *env = NULL;
+    ads125x_dev ads1256;
+
+    // ADS1256_DETECT=<spec> writes the events of the capture to <file>.events, see -a
+    if ((env = getenv("ADS1256_DETECT")) != NULL)
     {
-        fprintf(output, "%5d,", j + 1);
-        for (i = 0; i < 3; ++i)
+        ads125xDetectConfigInit(&cfg);
+        if (set_detect_spec(&cfg, env) || (det = ads125xDetectOpen(&cfg)) == NULL)
+        {
+            fprintf(stderr, "Invalid ADS1256_DETECT %s .\n", env);
+            exit(EXIT_FAILURE);
+        }
+        snprintf(events_path, sizeof(events_path), "%s.events", path);
+        if ((events_fp = fopen(events_path, "w")) == NULL)
         {
-            fprintf(output, "%02hx", rdatac_result[j * 3 + i]);
+            fprintf(stderr, "Open file %s error.\n", events_path);
+            exit(EXIT_FAILURE);
         }
-        calcResult = (uint64_t)convert_to_signed_24bit(rdatac_result + (j * 3));
-        calcResult *= 5;
-        result_volt = (double)calcResult / (1ULL << 23);
-        fprintf(output, ",%.12lf\n", result_volt);
     }
+    if ((writer = ads125xWriterOpen(path, ADS125x_CAPTURE_BLOCK * ADS125x_DATA_LEN_BYTE,
+                                    ADS125x_CAPTURE_BUFS, ADS125x_CAPTURE_DEPTH, 0)) == NULL)
+        exit(EXIT_FAILURE);
+    arena = session_arena(ADS125x_CAPTURE_BLOCK * (ADS125x_DATA_LEN_BYTE + sizeof(uint64_t)) + 2 * ADS125x_ARENA_ALIGN);
+    if ((scratch = (uint8_t *)ads125xArenaAlloc(arena, ADS125x_CAPTURE_BLOCK * ADS125x_DATA_LEN_BYTE)) == NULL ||
+        (det && (ts = (uint64_t *)ads125xArenaAlloc(arena, ADS125x_CAPTURE_BLOCK * sizeof(uint64_t))) == NULL))
+    {
+        fprintf(stderr, "Allocated memory for scratch buffer failed.\n");
+        exit(1);
+    }
+    if ((pyr = ads125xPyrCreate(path)) == NULL)
+        fprintf(stderr, "Create the pyramid of %s failed, recording without.\n", path);
+    continu_setup(&ads1256);
+    if (recover)
+        ads1256.flags |= ADS125x_FLAG_RECOVER;
 
-    // Release all resource
-    ads125xSetPDWN(&ads1256, 0);
-    ads125xCloseDRDY(&ads1256);
-    SPIRelease(ads1256.fd);
+    // The DRDY loop never waits for the storage, a block without free buffer is lost
+    check_ret(ads125xRDATACStart(&ads1256), "RDATAC");
+    for (done = 0; done < times; done += n)
+    {
+        n = times - done < ADS125x_CAPTURE_BLOCK ? times - done : ADS125x_CAPTURE_BLOCK;
+        buf = ads125xWriterGetBuffer(writer);
+        if (ads125xRDATACReadTs(&ads1256, buf ? buf : scratch, ts, n) < 0)
+        {
+            fprintf(stderr, "Continuous read stopped by a error after %d samples.\n", done);
+            break;
+        }
+        // Events are detected on lost blocks too, their indexes count every conversion
+        if (det && (k = ads125xDetectPushRaw(det, buf ? buf : scratch, ts, n, events, ADS125x_ALARM_EVENTS)) > 0)
+            write_events(events_fp, events, k);
+        if (!buf)
+            continue;
+        // The pyramid skips lost blocks too, so it stays aligned with the file
+        if (pyr)
+            ads125xPyrPushRaw(pyr, buf, n);
+        ads125xWriterSubmit(writer, buf, n * ADS125x_DATA_LEN_BYTE);
+    }
+    ads125xRDATACStop(&ads1256);
+    continu_release(&ads1256);
+
+    if (det)
+    {
+        while ((k = ads125xDetectFlush(det, events, ADS125x_ALARM_EVENTS)) > 0)
+            write_events(events_fp, events, k);
+        ads125xDetectClose(det);
+        if (fclose(events_fp))
+            fprintf(stderr, "Write %s failed.\n", events_path);
+    }
+    if (ads125xWriterClose(writer, &stats))
+        fprintf(stderr, "Write %s failed.\n", path);
+    if (pyr && ads125xPyrClose(pyr))
+        fprintf(stderr, "Write the pyramid of %s failed.\n", path);
+    fprintf(stderr, "Wrote %llu bytes with %s, %llu blocks lost, write latency min/avg/max %.3lf/%.3lf/%.3lf ms.\n",
+            (unsigned long long)stats.bytes, stats.engine, (unsigned long long)stats.overruns,
+            stats.lat_min_ns * 1e-6, stats.lat_avg_ns * 1e-6, stats.lat_max_ns * 1e-6);
+    ads125xArenaClose(arena);
+    return;
+}
+
+void doBinaryRead(int argc, char* argv [])
+{
+    int recover = 0;
+
+    if (argc == 5 && strcasecmp(argv[4], "recover") == 0)
+    {
+        recover = 1;
+        --argc;
+    }
+    if (argc != 4) {
+        fprintf (stderr, "Usage: %s -b/--binary <times> <file> [recover]\n", argv [0]) ;
+        exit (1) ;
+    }
+    binary_read(argv[3], atoi(argv[2]), recover);
+    return;
+}
+
+void write_continu_result(FILE *output, uint8_t *rdatac_result, int times)
+{
+    // The lines of "%5d,%02x%02x%02x,%.12lf", formatted on all CPUs
+    fflush(output);
+    if (ads125xExportWrite(fileno(output), rdatac_result, times, 1, export_threads(), NULL))
+        fprintf(stderr, "Write continuous mode data failed.\n");
     return;
 }
 
 void doContinuRead(int argc, char* argv [])
 {
     FILE *fp = NULL;
+    int recover = 0;
+
+    if (argc > 3 && strcasecmp(argv[argc - 1], "recover") == 0)
+    {
+        recover = 1;
+        --argc;
+    }
     if (argc < 3) {
-        fprintf (stderr, "Usage: %s -c/--continuous <times>\n", argv [0]) ;
+        fprintf (stderr, "Usage: %s -c/--continuous <times> [recover]\n", argv [0]) ;
         exit (1);
     }
     else if (argc == 4 || argc > 5)
     {
-        fprintf (stderr, "Usage: %s -c/--continuous <times> -o <files>\n", argv[0]);
+        fprintf (stderr, "Usage: %s -c/--continuous <times> -o <files> [recover]\n", argv[0]);
         exit (1);
     }
 
@@ -232,9 +529,9 @@ void doContinuRead(int argc, char* argv [])
                 fprintf(stderr, "Open file %s error.\n", argv[4]);
                 exit(EXIT_FAILURE);
             }
-            continu_read(fp, atoi(argv[2])); break;
+            continu_read(fp, atoi(argv[2]), recover); break;
         case 3:
-        default: continu_read(stdout, atoi(argv[2])); break;
+        default: continu_read(stdout, atoi(argv[2]), recover); break;
     }
     return;
 }
@@ -244,6 +541,7 @@ void doPdwn(int argc, char* argv [])
     int ret = 0;
     ads125x_dev ads1256;
 
+    memset(&ads1256, 0x00, sizeof(ads1256));
     if (argc == 2 || argc > 3) {
         fprintf (stderr, "Usage: %s -p/--pdwn [off/on/0/1]\n", argv [0]) ;
         exit (1) ;
@@ -264,6 +562,536 @@ void doPdwn(int argc, char* argv [])
     return;
 }
 
+/**
+ * doNet - Stream RDATAC samples to network clients
+ *
+ * ADS1256_NET_BATCH, ADS1256_NET_LATENCY_US and ADS1256_NET_ZEROCOPY=1
+ * tune the server, see libads1256net.h.
+ */
+void doNet(int argc, char* argv [])
+{
+    ads125x_net_cfg cfg;
+    ads125x_net_stats stats;
+    ads125x_net *net = NULL;
+    ads125x_pub *pub = NULL;
+    ads125x_dev ads1256;
+    struct timespec start, end;
+    double elapsed = 0;
+    char *env = NULL;
+    int times = 0, done = 0, n = 0;
+
+    if (argc < 5 || argc > 6) {
+        fprintf (stderr, "Usage: %s -n/--net <tcp|udp> <addr> <times> [capture]\n", argv [0]) ;
+        exit (1) ;
+    }
+    memset(&cfg, 0x00, sizeof(cfg));
+    /**/ if (strcasecmp(argv[2], "tcp") == 0) cfg.proto = ADS125x_NET_TCP;
+    else if (strcasecmp(argv[2], "udp") == 0) cfg.proto = ADS125x_NET_UDP;
+    else {
+        fprintf(stderr, "Invalid protocol %s .\n", argv[2]);
+        exit(EXIT_FAILURE);
+    }
+    cfg.addr = argv[3];
+    cfg.policy = ADS125x_SUB_DROP_OLDEST;
+    if ((env = getenv("ADS1256_NET_BATCH")) != NULL)
+        cfg.batch = strtoul(env, NULL, 0);
+    if ((env = getenv("ADS1256_NET_LATENCY_US")) != NULL)
+        cfg.latency_us = atoi(env);
+    if ((env = getenv("ADS1256_NET_ZEROCOPY")) != NULL && atoi(env))
+        cfg.flags |= ADS125x_NET_ZEROCOPY;
+    times = atoi(argv[4]);
+
+    if (argc == 6)
+    {
+        // A looped replay of the capture, testable over loopback without the ADC
+        replay_setup(&ads1256, argv[5], ADS125x_REPLAY_PACED | ADS125x_REPLAY_LOOP);
+    }
+    else if (geteuid() != 0)
+    {
+        fprintf(stderr, "%s: Must be root to stream from the ADC.\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    else
+        continu_setup(&ads1256);
+
+    if ((pub = ads125xPubOpen(ADS125x_NET_RING)) == NULL || (net = ads125xNetServe(pub, &cfg)) == NULL)
+    {
+        fprintf(stderr, "Start the %s server on %s failed.\n", argv[2], argv[3]);
+        exit(EXIT_FAILURE);
+    }
+    if (cfg.proto == ADS125x_NET_TCP)
+        fprintf(stderr, "Waiting for a client on %s.\n", argv[3]);
+    ads125xNetWaitClients(net, 1, -1);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    check_ret(ads125xRDATACStart(&ads1256), "RDATAC");
+    // Published a chunk at a time, the ring is what the server sees
+    for (done = 0; done < times; done += n)
+    {
+        n = times - done < ADS125x_NET_CHUNK ? times - done : ADS125x_NET_CHUNK;
+        if (ads125xPubRDATAC(&ads1256, pub, n) < 0)
+        {
+            fprintf(stderr, "Continuous read stopped by a error after %d samples.\n", done);
+            break;
+        }
+    }
+    ads125xRDATACStop(&ads1256);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+
+    // The clients get the rest of the ring, then the end of the stream
+    ads125xPubClose(pub);
+    ads125xNetClose(net, &stats);
+    fprintf(stderr, "Acquired %d samples in %.4lf s, sent %llu samples in %llu frames with %llu sends, %llu bytes, %llu dropped, %d clients.\n",
+            times, elapsed, (unsigned long long)stats.samples, (unsigned long long)stats.frames,
+            (unsigned long long)stats.sends, (unsigned long long)stats.bytes,
+            (unsigned long long)stats.dropped, stats.clients);
+    if (stats.zc_sends)
+        fprintf(stderr, "%llu zerocopy sends, %llu copied by the kernel.\n",
+                (unsigned long long)stats.zc_sends, (unsigned long long)stats.zc_copied);
+    if (argc == 6)
+    {
+        if (ads125xReplayDropped(&ads1256))
+            fprintf(stderr, "%llu conversions missed by the acquisition.\n", (unsigned long long)ads125xReplayDropped(&ads1256));
+        ads125xReplayClose(&ads1256);
+    }
+    else
+        continu_release(&ads1256);
+    return;
+}
+
+/**
+ * doDuty - Duty-cycled readings at a low rate
+ *
+ * ADS1256_DUTY_STATE=awake, standby or pdwn forces the state between the
+ * readings, see libads1256duty.h.
+ */
+void doDuty(int argc, char* argv [])
+{
+    ads125x_duty duty;
+    ads125x_duty_stats stats;
+    ads125x_duty_sample *samples = NULL;
+    ads125x_dev ads1256;
+    char *env = NULL;
+    int times = 0, state = ADS125x_DUTY_AUTO, i = 0;
+
+    if (argc < 4 || argc > 5) {
+        fprintf (stderr, "Usage: %s -d/--duty <rate> <times> [capture]\n", argv [0]) ;
+        exit (1) ;
+    }
+    if ((env = getenv("ADS1256_DUTY_STATE")) != NULL)
+    {
+        /**/ if (strcasecmp(env, "awake") == 0) state = ADS125x_DUTY_AWAKE;
+        else if (strcasecmp(env, "standby") == 0) state = ADS125x_DUTY_STANDBY;
+        else if (strcasecmp(env, "pdwn") == 0) state = ADS125x_DUTY_PDWN;
+        else {
+            fprintf(stderr, "Invalid duty cycle state %s .\n", env);
+            exit(EXIT_FAILURE);
+        }
+    }
+    times = atoi(argv[3]);
+    if (times <= 0 || (samples = (ads125x_duty_sample *)malloc(times * sizeof(*samples))) == NULL)
+        exit(EXIT_FAILURE);
+
+    if (argc == 5)
+    {
+        replay_setup(&ads1256, argv[4], ADS125x_REPLAY_PACED | ADS125x_REPLAY_LOOP);
+    }
+    else if (geteuid() != 0)
+    {
+        fprintf(stderr, "%s: Must be root to read the ADC.\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    else
+        continu_setup(&ads1256);
+
+    if (ads125xDutyPlan(&ads1256, &duty, atof(argv[2]), state) < 0)
+    {
+        fprintf(stderr, "Cannot take readings at %s Hz in this state.\n", argv[2]);
+        exit(EXIT_FAILURE);
+    }
+    ads125xDutyPrint(&duty, stderr);
+    check_ret(ads125xDutyStart(&ads1256, &duty), "Start duty cycle");
+    // Printed as they come, a reading every period
+    for (i = 0; i < times; ++i)
+    {
+        if (ads125xDutyRead(&ads1256, &duty, &samples[i], 1) < 0)
+        {
+            fprintf(stderr, "Duty cycle stopped by a error after %d readings.\n", i);
+            break;
+        }
+        fprintf(stdout, "%5d,%06x,%.12lf,%.3lf,%.3lf\n", i + 1, samples[i].code & 0xFFFFFF,
+                samples[i].code * 5.0 / (1 << 23), samples[i].late_ns * 1e-3, samples[i].awake_ns * 1e-3);
+        fflush(stdout);
+    }
+    ads125xDutyStop(&ads1256);
+
+    ads125xDutyGetStats(&duty, &stats);
+    fprintf(stderr, "%llu readings, %llu late (max %.3lf ms), up to %.3lf ms early, %llu periods skipped.\n",
+            (unsigned long long)stats.readings, (unsigned long long)stats.late, stats.late_max_ns * 1e-6,
+            stats.early_max_ns * 1e-6, (unsigned long long)stats.skipped);
+    if (stats.readings)
+        fprintf(stderr, "Awake %.3lf ms per reading (max %.3lf ms), about %.3lf uJ per reading.\n",
+                stats.awake_ns * 1e-6 / stats.readings, stats.awake_max_ns * 1e-6, stats.energy_uj / stats.readings);
+    free(samples);
+    if (argc == 5)
+        ads125xReplayClose(&ads1256);
+    else
+        continu_release(&ads1256);
+    return;
+}
+
+int set_replay_fault(ads125x_dev *dev, const char *spec)
+{
+    unsigned long long after = 0;
+    int count = 1, fault = ADS125x_FAULT_NONE;
+
+    if (sscanf(spec, "drdy:%llu", &after) == 1)
+        fault = ADS125x_FAULT_DRDY_STUCK;
+    else if (sscanf(spec, "xfer:%llu:%d", &after, &count) >= 1)
+        fault = ADS125x_FAULT_XFER;
+    if (fault == ADS125x_FAULT_NONE || ads125xReplayInjectFault(dev, fault, after, count))
+    {
+        fprintf(stderr, "Invalid replay fault %s .\n", spec);
+        return 1;
+    }
+    return 0;
+}
+
+void doReplay(int argc, char* argv [])
+{
+    int flags = ADS125x_REPLAY_PACED;
+    int times = 0;
+    uint8_t *rdatac_result = NULL;
+    ads125x_arena *arena = NULL;
+    struct timespec start, end;
+    double elapsed = 0;
+    char *env = NULL;
+    ads125x_dev ads1256;
+
+    if (argc < 3 || argc > 4) {
+        fprintf (stderr, "Usage: %s -r/--replay <file> [fast]\n", argv [0]) ;
+        exit (1) ;
+    }
+    if (argc == 4)
+    {
+        if (strcasecmp(argv[3], "fast") != 0)
+        {
+            fprintf(stderr, "Invalid replay mode %s .\n", argv[3]);
+            exit(EXIT_FAILURE);
+        }
+        flags = ADS125x_REPLAY_FAST;
+    }
+
+    // Same sequence as continu_read(), a capture is replayed at the rate it was recorded
+    replay_setup(&ads1256, argv[2], flags);
+    times = (int)ads125xReplayCount(&ads1256);
+    arena = session_arena((size_t)times * ADS125x_DATA_LEN_BYTE + ADS125x_ARENA_ALIGN);
+    if ((rdatac_result = (uint8_t *)ads125xArenaAlloc(arena, (size_t)times * ADS125x_DATA_LEN_BYTE)) == NULL)
+    {
+        fprintf(stderr, "Allocated memory for rdatac_result failed.\n");
+        exit(1);
+    }
+
+    ads1256.flags |= ADS125x_FLAG_RECOVER;
+
+    // ADS1256_REPLAY_FAULT=drdy:<after> or xfer:<after>[:<count>] tests the recovery
+    if ((env = getenv("ADS1256_REPLAY_FAULT")) != NULL && set_replay_fault(&ads1256, env))
+        exit(EXIT_FAILURE);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (ads125xRDATAC(&ads1256, rdatac_result, times) < 0)
+        fprintf(stderr, "Replay stopped by a error.\n");
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+
+    write_continu_result(stdout, rdatac_result, times);
+    fprintf(stderr, "Replayed %d samples in %.4lf s, %.2lf SPS, %llu dropped.\n",
+            times, elapsed, times / elapsed, (unsigned long long)ads125xReplayDropped(&ads1256));
+    print_recovery(&ads1256);
+
+    ads125xArenaClose(arena);
+    ads125xReplayClose(&ads1256);
+    return;
+}
+
+void doView(int argc, char* argv [])
+{
+    ads125x_pyr_view *view;
+    ads125x_pyr_point *points;
+    uint64_t first, count;
+    int i, pixels;
+
+    if (argc != 6) {
+        fprintf (stderr, "Usage: %s -v/--view <file> <first> <count> <pixels>\n", argv [0]) ;
+        exit (1) ;
+    }
+    first = strtoull(argv[3], NULL, 0);
+    count = strtoull(argv[4], NULL, 0);
+    pixels = atoi(argv[5]);
+    if ((view = ads125xPyrOpen(argv[2])) == NULL)
+    {
+        fprintf(stderr, "%s has no pyramid.\n", argv[2]);
+        exit(EXIT_FAILURE);
+    }
+    if (pixels <= 0 || (points = (ads125x_pyr_point *)malloc(pixels * sizeof(*points))) == NULL)
+        exit(EXIT_FAILURE);
+    if (ads125xPyrQuery(view, first, count, points, pixels) < 0)
+    {
+        fprintf(stderr, "Invalid range or more pixels than samples, the capture has %llu samples.\n", (unsigned long long)ads125xPyrSamples(view));
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < pixels; ++i)
+        fprintf(stdout, "%llu,%d,%d,%.3lf\n", (unsigned long long)(first + i * count / pixels),
+                points[i].min, points[i].max, points[i].mean);
+    free(points);
+    ads125xPyrViewClose(view);
+    return;
+}
+
+void doExport(int argc, char* argv [])
+{
+    ads125x_export_stats stats;
+
+    if (argc < 4 || argc > 5) {
+        fprintf (stderr, "Usage: %s -e/--export <capture> <csv> [threads]\n", argv [0]) ;
+        exit (1) ;
+    }
+    if (ads125xExportFile(argv[2], argv[3], argc == 5 ? atoi(argv[4]) : export_threads(), &stats))
+        exit(EXIT_FAILURE);
+    fprintf(stderr, "Exported %llu samples, %llu bytes in %.4lf s with %d threads, %.0lf samples/s.\n",
+            (unsigned long long)stats.samples, (unsigned long long)stats.bytes, stats.elapsed, stats.threads,
+            stats.elapsed > 0 ? stats.samples / stats.elapsed : 0);
+    return;
+}
+
+/**
+ * set_detect_spec - Configure event detection from -a or ADS1256_DETECT
+ * @cfg: Initialized by ads125xDetectConfigInit().
+ * @spec: Comma separated high=<code>, low=<code>, hyst=<code>, spike=<code>,
+ *        step=<code>[/<window>], flat=<code>/<samples>, context=<samples>.
+ */
+int set_detect_spec(ads125x_detect_config *cfg, const char *spec)
+{
+    char buf[256], *item, *save = NULL;
+    long long a = 0, b = 0;
+    int n;
+
+    snprintf(buf, sizeof(buf), "%s", spec);
+    for (item = strtok_r(buf, ",", &save); item; item = strtok_r(NULL, ",", &save))
+    {
+        n = 0;
+        /**/ if (sscanf(item, "high=%lli", &a) == 1) { cfg->high = a; cfg->mask |= ADS125x_DETECT_LEVEL; }
+        else if (sscanf(item, "low=%lli", &a) == 1) { cfg->low = a; cfg->mask |= ADS125x_DETECT_LEVEL; }
+        else if (sscanf(item, "hyst=%lli", &a) == 1) cfg->hysteresis = a;
+        else if (sscanf(item, "spike=%lli", &a) == 1) { cfg->spike = a; cfg->mask |= ADS125x_DETECT_SPIKE; }
+        else if ((n = sscanf(item, "step=%lli/%lli", &a, &b)) >= 1)
+        {
+            cfg->step = a;
+            if (n == 2)
+                cfg->step_window = b;
+            cfg->mask |= ADS125x_DETECT_STEP;
+        }
+        else if (sscanf(item, "flat=%lli/%lli", &a, &b) == 2)
+        {
+            cfg->flat_delta = a;
+            cfg->flat_samples = b;
+            cfg->mask |= ADS125x_DETECT_FLATLINE;
+        }
+        else if (sscanf(item, "context=%lli", &a) == 1) cfg->context = a;
+        else {
+            fprintf(stderr, "Invalid detection %s .\n", item);
+            return 1;
+        }
+    }
+    if (cfg->mask == 0)
+    {
+        fprintf(stderr, "Nothing to detect in %s .\n", spec);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * write_events - Print events as type,index,DRDY ns,code,ref,first context index,context;...
+ */
+void write_events(FILE *output, const ads125x_event *events, int n)
+{
+    uint32_t k;
+
+    for (; n > 0; --n, ++events)
+    {
+        fprintf(output, "%s,%llu,%llu,%d,%d,%llu,", ads125xEventName(events->type), (unsigned long long)events->index,
+                (unsigned long long)events->ts, events->code, events->ref, (unsigned long long)events->context_index);
+        for (k = 0; k < events->context_n; ++k)
+            fprintf(output, k ? ";%d" : "%d", events->context[k]);
+        fprintf(output, "\n");
+    }
+    return;
+}
+
+void doAlarm(int argc, char* argv [])
+{
+    ads125x_detect_config cfg;
+    ads125x_detect_stats stats;
+    ads125x_detect *det = NULL;
+    ads125x_event events[ADS125x_ALARM_EVENTS];
+    uint8_t raw[ADS125x_ALARM_CHUNK * ADS125x_DATA_LEN_BYTE];
+    uint64_t ts[ADS125x_ALARM_CHUNK], now, lat_max = 0, lat_sum = 0, emitted = 0;
+    struct timespec t;
+    ads125x_dev ads1256;
+    int times = 0, done = 0, n = 0, k = 0, i = 0;
+
+    if (argc < 4 || argc > 5) {
+        fprintf (stderr, "Usage: %s -a/--alarm <spec> <times> [capture]\n", argv [0]) ;
+        exit (1) ;
+    }
+    ads125xDetectConfigInit(&cfg);
+    if (set_detect_spec(&cfg, argv[2]))
+        exit(EXIT_FAILURE);
+    if ((det = ads125xDetectOpen(&cfg)) == NULL)
+    {
+        fprintf(stderr, "Invalid detection settings %s .\n", argv[2]);
+        exit(EXIT_FAILURE);
+    }
+    times = atoi(argv[3]);
+
+    if (argc == 5)
+    {
+        replay_setup(&ads1256, argv[4], ADS125x_REPLAY_PACED | ADS125x_REPLAY_LOOP);
+    }
+    else if (geteuid() != 0)
+    {
+        fprintf(stderr, "%s: Must be root to read the ADC.\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    else
+        continu_setup(&ads1256);
+
+    // Small chunks, an event is printed a few samples after its DRDY
+    check_ret(ads125xRDATACStart(&ads1256), "RDATAC");
+    for (done = 0; done < times; done += n)
+    {
+        n = times - done < ADS125x_ALARM_CHUNK ? times - done : ADS125x_ALARM_CHUNK;
+        if (ads125xRDATACReadTs(&ads1256, raw, ts, n) < 0)
+        {
+            fprintf(stderr, "Continuous read stopped by a error after %d samples.\n", done);
+            break;
+        }
+        if ((k = ads125xDetectPushRaw(det, raw, ts, n, events, ADS125x_ALARM_EVENTS)) == 0)
+            continue;
+        write_events(stdout, events, k);
+        fflush(stdout);
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        now = (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+        for (i = 0; i < k; ++i)
+        {
+            lat_sum += now - events[i].ts;
+            lat_max = now - events[i].ts > lat_max ? now - events[i].ts : lat_max;
+        }
+        emitted += k;
+    }
+    ads125xRDATACStop(&ads1256);
+    while ((k = ads125xDetectFlush(det, events, ADS125x_ALARM_EVENTS)) > 0)
+        write_events(stdout, events, k);
+
+    ads125xDetectGetStats(det, &stats);
+    fprintf(stderr, "%llu samples, %llu high, %llu low, %llu normal, %llu spike, %llu step, %llu flatline, %llu dropped.\n",
+            (unsigned long long)stats.samples, (unsigned long long)stats.events[ADS125x_EVENT_HIGH],
+            (unsigned long long)stats.events[ADS125x_EVENT_LOW], (unsigned long long)stats.events[ADS125x_EVENT_NORMAL],
+            (unsigned long long)stats.events[ADS125x_EVENT_SPIKE], (unsigned long long)stats.events[ADS125x_EVENT_STEP],
+            (unsigned long long)stats.events[ADS125x_EVENT_FLATLINE], (unsigned long long)stats.dropped);
+    fprintf(stderr, "%llu of %llu blocks checked sample by sample.\n",
+            (unsigned long long)stats.scanned, (unsigned long long)stats.blocks);
+    if (emitted)
+        fprintf(stderr, "DRDY to event printed: avg %.3lf ms, max %.3lf ms.\n", lat_sum * 1e-6 / emitted, lat_max * 1e-6);
+    ads125xDetectClose(det);
+    if (argc == 5)
+        ads125xReplayClose(&ads1256);
+    else
+        continu_release(&ads1256);
+    return;
+}
+
+/**
+ * control_hold - Control callback of doControl(), holds the last conversion as the output
+ */
+static int control_hold(void *arg, int32_t code, uint64_t ts)
+{
+    volatile int32_t *output = (volatile int32_t *)arg;
+
+    (void)ts;
+    *output = code;
+    return 0;
+}
+
+/**
+ * doControl - Closed-loop control mode
+ *
+ * Spins on DRDY. ADS1256_CONTROL_PRIO=<1-99> runs the loop SCHED_FIFO
+ * with its memory locked, pin it to an isolated core with taskset.
+ */
+void doControl(int argc, char* argv [])
+{
+    static ads125x_control control;
+    ads125x_control_stats stats;
+    ads125x_dev ads1256;
+    struct sched_param param;
+    volatile int32_t output = 0;
+    char *env = NULL;
+    int times = 0, ret = 0, i = 0;
+
+    if (argc < 4 || argc > 5) {
+        fprintf (stderr, "Usage: %s -k/--control <times> <deadline_us> [capture]\n", argv [0]) ;
+        exit (1) ;
+    }
+    if ((times = atoi(argv[2])) <= 0)
+    {
+        fprintf(stderr, "Invalid read times %s .\n", argv[2]);
+        exit(EXIT_FAILURE);
+    }
+    if ((env = getenv("ADS1256_CONTROL_PRIO")) != NULL)
+    {
+        memset(&param, 0x00, sizeof(param));
+        param.sched_priority = atoi(env);
+        if (sched_setscheduler(0, SCHED_FIFO, &param) < 0 || mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+            fprintf(stderr, "Real-time setup failed: %s\n", strerror(errno));
+    }
+
+    if (argc == 5)
+    {
+        replay_setup(&ads1256, argv[4], ADS125x_REPLAY_PACED | ADS125x_REPLAY_LOOP);
+    }
+    else if (geteuid() != 0)
+    {
+        fprintf(stderr, "%s: Must be root to read the ADC.\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    else
+        continu_setup(&ads1256);
+
+    ads1256.wait_mode = ADS125x_WAIT_SPIN;
+    if ((ret = ads125xControlRun(&ads1256, &control, control_hold, (void *)&output, strtoull(argv[3], NULL, 0) * 1000, times)) < 0)
+        fprintf(stderr, "Control loop stopped by a error after %llu samples.\n", (unsigned long long)control.calls);
+
+    ads125xControlGetStats(&control, &stats);
+    fprintf(stdout, "Last output: %d\n", (int)output);
+    fprintf(stdout, "%llu calls, %llu deadline misses, %llu conversions lost.\n", (unsigned long long)stats.calls,
+            (unsigned long long)stats.misses, (unsigned long long)stats.overruns);
+    fprintf(stdout, "DRDY to callback: mean %.1lf us, p50 %.0lf us, p99 %.0lf us, max %.1lf us, return max %.1lf us.\n",
+            stats.lat_mean_us, stats.lat_p50_us, stats.lat_p99_us, stats.lat_max_us, stats.done_max_us);
+    for (i = 0; i < ADS125x_CONTROL_BUCKETS; ++i)
+        if (control.hist[i])
+            fprintf(stdout, "%s%4d us: %llu\n", i + 1 < ADS125x_CONTROL_BUCKETS ? " <" : ">=",
+                    i + 1 < ADS125x_CONTROL_BUCKETS ? (i + 1) * ADS125x_CONTROL_BUCKET_NS / 1000 : i * ADS125x_CONTROL_BUCKET_NS / 1000,
+                    (unsigned long long)control.hist[i]);
+    if (argc == 5)
+        ads125xReplayClose(&ads1256);
+    else
+        continu_release(&ads1256);
+    return;
+}
+
 int main(int argc, char *argv[])
 {
     char *env = NULL;
@@ -286,14 +1114,55 @@ int main(int argc, char *argv[])
         exit(EXIT_SUCCESS);
     }
 
+    // Replay, view and export need no hardware access
+    if (strcasecmp(argv[1], "-r") == 0 || strcasecmp(argv[1], "--replay") == 0)
+    {
+        doReplay(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+    if (strcasecmp(argv[1], "-v") == 0 || strcasecmp(argv[1], "--view") == 0)
+    {
+        doView(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+    if (strcasecmp(argv[1], "-e") == 0 || strcasecmp(argv[1], "--export") == 0)
+    {
+        doExport(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+    // Checks for root itself, a replayed capture needs no hardware
+    if (strcasecmp(argv[1], "-n") == 0 || strcasecmp(argv[1], "--net") == 0)
+    {
+        doNet(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+    if (strcasecmp(argv[1], "-d") == 0 || strcasecmp(argv[1], "--duty") == 0)
+    {
+        doDuty(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+    if (strcasecmp(argv[1], "-a") == 0 || strcasecmp(argv[1], "--alarm") == 0)
+    {
+        doAlarm(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+    if (strcasecmp(argv[1], "-k") == 0 || strcasecmp(argv[1], "--control") == 0)
+    {
+        doControl(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+
     if (geteuid() != 0)
     {
         fprintf(stderr, "%s: Must be root to run. Program should be suid root. This is an error.\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    /**/ if ( strcasecmp (argv[1], "-s") == 0 || strcasecmp (argv[1], "--single"    ) == 0 ) one_shot_read();
+    /**/ if ( strcasecmp (argv[1], "-s") == 0 || strcasecmp (argv[1], "--single"    ) == 0 )
+        one_shot_read(argc > 2 ? atoi(argv[2]) : 1,
+                      argc > 3 && strcasecmp(argv[3], "median") == 0 ? ADS125x_BURST_MEDIAN : ADS125x_BURST_MEAN);
     else if ( strcasecmp (argv[1], "-c") == 0 || strcasecmp (argv[1], "--continuous") == 0 ) doContinuRead(argc, argv);
+    else if ( strcasecmp (argv[1], "-b") == 0 || strcasecmp (argv[1], "--binary"    ) == 0 ) doBinaryRead(argc, argv);
     else if ( strcasecmp (argv[1], "-p") == 0 || strcasecmp (argv[1], "--pdwn") == 0)        doPdwn(argc, argv);
     else if ( strcasecmp (argv[1], "-o") == 0 || strcasecmp (argv[1], "--pdwn") == 0)
         {fprintf(stderr, "output parameter can only be used with continuous output.\n"); exit(1);}
@@ -38,3 +38,17 @@
 #define ADS125x_DRDY_LINE 3
 #define ADS125x_PDWN_CHIP "gpiochip4"
 #define ADS125x_PDWN_LINE 3
+
+// Binary capture: samples per block, buffers and writes in flight
+#define ADS125x_CAPTURE_BLOCK 4096
+#define ADS125x_CAPTURE_BUFS 16
+#define ADS125x_CAPTURE_DEPTH 4
+
+// Network streaming: samples in the ring between the ADC and the clients,
+// samples published at a time
+#define ADS125x_NET_RING 65536
+#define ADS125x_NET_CHUNK 32
+
+// Event detection: samples read and checked at a time, events returned at a time
+#define ADS125x_ALARM_CHUNK 16
+#define ADS125x_ALARM_EVENTS 64
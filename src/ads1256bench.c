@@ -0,0 +1,882 @@
+/**
+ * ads1256bench.c - Benchmark of the ADS125x acquisition paths
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <linux/spi/spidev.h>
+
+#include "libads1256.h"
+#include "libads1256reg.h"
+#include "libads1256replay.h"
+#include "libads1256export.h"
+#include "libads1256graph.h"
+#include "libads1256align.h"
+#include "ads1256.h"
+#include "ads1256bench.h"
+
+#define BENCH_DURATION 0.5
+
+extern int ADS125xDriverDebug;
+int bench_malloc = 0;
+char *usage = "Usage: [options...]\n"
+              " -h, --help                 Show this manual\n"
+              " -d, --duration <seconds>   Time per run, default 0.5\n"
+              " -s, --sps <rate>           Only run this data rate\n"
+              " -m, --mode <mode>          Only run rdatac, rdatac-cpp, rdata or control\n"
+              " -w, --wait <strategy>      Only run spin, yield, sleep or predict\n"
+              " -r, --replay <file>        Replay a capture instead of a synthetic signal\n"
+              "     --hw                   Use the ADS1256 hardware\n"
+              " -j, --json <file>          Write the results as JSON\n"
+              " -o, --output <file>        Write the Markdown table to a file\n"
+              "     --malloc               Allocate the run buffers with malloc() instead of\n"
+              "                            a prefaulted arena, to compare the page faults\n"
+              " -e, --export <samples>     Only measure the CSV export of 'samples' samples,\n"
+              "                            fprintf() against libads1256export on 1 ~ all CPUs\n"
+              " -g, --graph <devices>      Only measure a libads1256graph pipeline on 1 ~ 'devices'\n"
+              "                            emulated chips read as fast as possible\n"
+              " -a, --align <samples>      Only measure libads1256align merging 'samples' samples\n"
+              "                            of 1 ~ 8 simulated chips with drifting clocks\n\n"
+              "Without --hw the benchmark runs on a emulated chip paced at each DRATE.";
+
+// Fastest first, as in the README table
+static const uint8_t bench_rates[] = {
+    ADS125x_DR_30000, ADS125x_DR_15000, ADS125x_DR_7500, ADS125x_DR_3750,
+    ADS125x_DR_2000, ADS125x_DR_1000, ADS125x_DR_500, ADS125x_DR_100,
+    ADS125x_DR_60, ADS125x_DR_50, ADS125x_DR_30, ADS125x_DR_25,
+    ADS125x_DR_15, ADS125x_DR_10, ADS125x_DR_5, ADS125x_DR_2_5,
+};
+static const char *bench_modes[BENCH_MODE_NUM] = {"rdatac", "rdatac-cpp", "rdata", "control"};
+// Indexed by ADS125x_WAIT_*
+static const char *bench_waits[] = {"spin", "yield", "sleep", "predict"};
+
+static uint64_t bench_cpu_ns(const struct rusage *ru)
+{
+    return (ru->ru_utime.tv_sec + ru->ru_stime.tv_sec) * 1000000000ULL +
+           (ru->ru_utime.tv_usec + ru->ru_stime.tv_usec) * 1000ULL;
+}
+
+static int bench_cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * bench_begin - Start measuring a run of @n samples on @dev
+ *
+ * The latency buffer is faulted in here, so the page faults of the run
+ * are the ones of the acquisition path.
+ * @return: 0 success, 1 is allocate memory failed.
+ */
+int bench_begin(bench_acc *acc, ads125x_dev *dev, size_t n)
+{
+    double sps;
+
+    memset(acc, 0x00, sizeof(*acc));
+    if (!bench_malloc)
+    {
+        if ((acc->arena = ads125xArenaOpen(n * sizeof(uint64_t) + ADS125x_ARENA_ALIGN, 0)) != NULL)
+            acc->lat_ns = (uint64_t *)ads125xArenaAlloc(acc->arena, n * sizeof(uint64_t));
+    }
+    else
+        acc->lat_ns = (uint64_t *)malloc(n * sizeof(uint64_t));
+    if (acc->lat_ns == NULL)
+    {
+        fprintf(stderr, "Allocated memory for latencies failed.\n");
+        return 1;
+    }
+    acc->cap = n;
+    sps = ads125xDRATEToSPS(dev->regs[ADS125x_REG_ADDR_DRATE]);
+    acc->period_ns = 1e9 / (sps ? sps : 30000);
+    acc->replay_dropped = ads125xReplayDropped(dev);
+    acc->io = dev->io;
+    getrusage(RUSAGE_THREAD, &acc->ru);
+    acc->faults = ads125xPageFaults();
+    acc->start_ns = ads125xNowNs();
+    return 0;
+}
+
+/**
+ * bench_sample - Account a sample just read from @dev
+ *
+ * The latency runs from the DRDY falling edge to now. Conversions
+ * overwritten before they were read show up as DRDY gaps longer than a
+ * period, which is how drops are counted on hardware.
+ */
+void bench_sample(bench_acc *acc, ads125x_dev *dev)
+{
+    uint64_t now = ads125xNowNs(), gap;
+
+    if (acc->n < acc->cap)
+        acc->lat_ns[acc->n++] = now > dev->drdy_ns ? now - dev->drdy_ns : 0;
+    if (acc->last_drdy_ns && (gap = dev->drdy_ns - acc->last_drdy_ns) > 1.5 * acc->period_ns)
+        acc->gap_drops += (uint64_t)(gap / acc->period_ns + 0.5) - 1;
+    acc->last_drdy_ns = dev->drdy_ns;
+}
+
+/**
+ * bench_end - Finish a run and fill the measured part of @r
+ */
+void bench_end(bench_acc *acc, ads125x_dev *dev, bench_result *r)
+{
+    static const double pct[3] = {0.50, 0.90, 0.99};
+    struct rusage ru;
+    uint64_t ops;
+    int i;
+
+    r->elapsed = (ads125xNowNs() - acc->start_ns) * 1e-9;
+    r->page_faults = ads125xPageFaults() - acc->faults;
+    getrusage(RUSAGE_THREAD, &ru);
+    r->samples = acc->n;
+    r->actual_sps = acc->n / r->elapsed;
+    r->cpu = (bench_cpu_ns(&ru) - bench_cpu_ns(&acc->ru)) * 1e-9 / r->elapsed * 100;
+    // A emulated chip knows exactly which conversions were overwritten
+    r->dropped = dev->backend ? ads125xReplayDropped(dev) - acc->replay_dropped : acc->gap_drops;
+    ops = (dev->io.transfers - acc->io.transfers) + (dev->io.drdy_polls - acc->io.drdy_polls) +
+          (dev->io.sleeps - acc->io.sleeps);
+    r->syscalls = acc->n ? (double)ops / acc->n : 0;
+
+    memset(r->lat_us, 0x00, sizeof(r->lat_us));
+    if (acc->n)
+    {
+        qsort(acc->lat_ns, acc->n, sizeof(uint64_t), bench_cmp_u64);
+        for (i = 0; i < 3; ++i)
+            r->lat_us[i] = acc->lat_ns[(size_t)(pct[i] * (acc->n - 1))] * 1e-3;
+        r->lat_us[3] = acc->lat_ns[acc->n - 1] * 1e-3;
+    }
+    if (acc->arena)
+        ads125xArenaClose(acc->arena);
+    else
+        free(acc->lat_ns);
+    acc->arena = NULL;
+    acc->lat_ns = NULL;
+}
+
+/**
+ * bench_synth - A sine with some noise, as raw samples
+ */
+static uint8_t *bench_synth(size_t count)
+{
+    uint8_t *buf;
+    uint32_t seed = 1;
+    int32_t code;
+    size_t i;
+
+    if ((buf = (uint8_t *)malloc(count * ADS125x_DATA_LEN_BYTE)) == NULL)
+        return NULL;
+    for (i = 0; i < count; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        code = (int32_t)(2000000 * sin(2 * M_PI * i / 64)) + (int32_t)((seed >> 16) & 0xFF) - 128;
+        buf[i * 3 + 0] = (code >> 16) & 0xFF;
+        buf[i * 3 + 1] = (code >> 8) & 0xFF;
+        buf[i * 3 + 2] = code & 0xFF;
+    }
+    return buf;
+}
+
+static int bench_open(ads125x_dev *dev, const bench_source *src)
+{
+    int ret;
+
+    memset(dev, 0x00, sizeof(*dev));
+    dev->name = "ADS1256";
+    dev->spi_mode = ADS125x_SPI_MODE;
+    dev->spi_bit_p_word = ADS125x_SPI_BIT_P_WORD;
+    dev->spi_speed = ADS125x_SPI_SPEED;
+
+    if (src->path)
+        return ads125xReplayOpen(dev, src->path, ADS125x_REPLAY_FMT_AUTO, ADS125x_REPLAY_PACED | ADS125x_REPLAY_LOOP);
+    if (!src->hw)
+        return ads125xReplayOpenBuffer(dev, src->samples, src->count, ADS125x_REPLAY_PACED | ADS125x_REPLAY_LOOP);
+
+    if ((dev->fd = ads125xSetup(dev, 0, 0)) < 0)
+        return 1;
+    if ((ret = ads125xOpenDRDY(dev, ADS125x_DRDY_CHIP, ADS125x_DRDY_LINE)) ||
+        (ret = ads125xOpenPDWN(dev, ADS125x_PDWN_CHIP, ADS125x_PDWN_LINE, 0)))
+    {
+        ads125xCloseDRDY(dev);
+        SPIRelease(dev->fd);
+        return ret;
+    }
+    ads125xSetPDWN(dev, 1);
+    return 0;
+}
+
+static void bench_close(ads125x_dev *dev)
+{
+    if (dev->backend)
+    {
+        ads125xReplayClose(dev);
+        return;
+    }
+    ads125xSetPDWN(dev, 0);
+    ads125xCloseDRDY(dev);
+    ads125xClosePDWN(dev);
+    SPIRelease(dev->fd);
+    return;
+}
+
+/**
+ * bench_control_sample - ads125xControlRun() callback, accounts the sample on entry
+ */
+static int bench_control_sample(void *arg, int32_t code, uint64_t ts)
+{
+    bench_acc *acc = (bench_acc *)arg;
+
+    (void)code;
+    (void)ts;
+    bench_sample(acc, acc->dev);
+    return 0;
+}
+
+/**
+ * bench_run_c - Read @n samples at @dr through the C API
+ *
+ * @return: 0 success, 1 is the device failed.
+ */
+static int bench_run_c(const bench_source *src, uint8_t dr, int mode, int wait, size_t n, bench_result *r)
+{
+    uint8_t raw[ADS125x_DATA_LEN_BYTE];
+    static ads125x_control control;
+    ads125x_predict predict;
+    ads125x_dev dev;
+    bench_acc acc;
+    size_t i;
+    int ret = 0;
+
+    if (bench_open(&dev, src))
+        return 1;
+    if (ads125xRESET(&dev) < 0 || ads125xSetDRATE(&dev, dr) < 0 ||
+        ads125xSetMUX(&dev, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1) < 0 ||
+        ads125xSELFCAL(&dev) < 0 || bench_begin(&acc, &dev, n))
+    {
+        bench_close(&dev);
+        return 1;
+    }
+    dev.wait_mode = wait;
+    dev.predict = &predict;
+
+    if (mode == BENCH_MODE_RDATAC)
+    {
+        ret = ads125xRDATACStart(&dev);
+        for (i = 0; i < n && ret == ADS125x_OK; ++i)
+            if ((ret = ads125xRDATACRead(&dev, raw, 1)) == ADS125x_OK)
+                bench_sample(&acc, &dev);
+        ads125xRDATACStop(&dev);
+    }
+    else if (mode == BENCH_MODE_CONTROL)
+    {
+        acc.dev = &dev;
+        ret = ads125xControlRun(&dev, &control, bench_control_sample, &acc, 0, n);
+    }
+    else
+    {
+        for (i = 0; i < n && ret == ADS125x_OK; ++i)
+            if ((ret = ads125xRDATA(&dev, raw)) == ADS125x_OK)
+                bench_sample(&acc, &dev);
+    }
+    bench_end(&acc, &dev, r);
+    bench_close(&dev);
+    return ret < 0;
+}
+
+static void write_markdown(FILE *fp, const bench_result *r, int count)
+{
+    int i;
+
+    fprintf(fp, "| Mode       | Wait    | Target Rate / SPS | Number of Samples | Elapsed Time / s | Actual Rate / SPS "
+                "| Ratio to Target Rate / %% | Dropped | CPU / %% | Latency p50 / p90 / p99 / max / us | Syscalls / Sample | Page Faults |\n");
+    fprintf(fp, "| ---------- | ------- | -------- | ------ | ------ | -------- | --------- | ---- | ----- | ------------------------- | ---- | ---- |\n");
+    for (i = 0; i < count; ++i, ++r)
+        fprintf(fp, "| %-10s | %-7s | %g | %llu | %.4lf | %.3lf | %.4lf | %llu | %.1lf | %.1lf / %.1lf / %.1lf / %.1lf | %.2lf | %llu |\n",
+                r->mode, r->wait, r->target_sps, (unsigned long long)r->samples, r->elapsed, r->actual_sps,
+                r->actual_sps / r->target_sps * 100, (unsigned long long)r->dropped, r->cpu,
+                r->lat_us[0], r->lat_us[1], r->lat_us[2], r->lat_us[3], r->syscalls,
+                (unsigned long long)r->page_faults);
+    return;
+}
+
+static void write_json(FILE *fp, const char *backend, const bench_result *r, int count)
+{
+    int i;
+
+    fprintf(fp, "{\n  \"backend\": \"%s\",\n  \"runs\": [", backend);
+    for (i = 0; i < count; ++i, ++r)
+        fprintf(fp, "%s\n    {\"mode\": \"%s\", \"wait\": \"%s\", \"target_sps\": %g, \"samples\": %llu, "
+                    "\"elapsed_s\": %.6lf, \"actual_sps\": %.3lf, \"dropped\": %llu, \"cpu_percent\": %.2lf, "
+                    "\"latency_us\": {\"p50\": %.3lf, \"p90\": %.3lf, \"p99\": %.3lf, \"max\": %.3lf}, "
+                    "\"syscalls_per_sample\": %.3lf, \"page_faults\": %llu}",
+                i ? "," : "", r->mode, r->wait, r->target_sps, (unsigned long long)r->samples, r->elapsed,
+                r->actual_sps, (unsigned long long)r->dropped, r->cpu,
+                r->lat_us[0], r->lat_us[1], r->lat_us[2], r->lat_us[3], r->syscalls,
+                (unsigned long long)r->page_faults);
+    fprintf(fp, "\n  ]\n}\n");
+    return;
+}
+
+/**
+ * bench_export_fprintf - The CSV export as continu_read() did it, one fprintf() per sample
+ */
+static void bench_export_fprintf(FILE *fp, const uint8_t *raw, size_t count)
+{
+    size_t j;
+    int i;
+
+    for (j = 0; j < count; ++j)
+    {
+        fprintf(fp, "%5d,", (int)(j + 1));
+        for (i = 0; i < 3; ++i)
+            fprintf(fp, "%02hx", raw[j * 3 + i]);
+        fprintf(fp, ",%.12lf\n", (double)convert_to_signed_24bit((uint8_t *)raw + j * 3) * 5 / (1ULL << 23));
+    }
+    return;
+}
+
+/**
+ * bench_export - Measure the CSV export of @count synthetic samples to /dev/null
+ *
+ * @return: 0, or 1 if a run failed.
+ */
+static int bench_export(size_t count, FILE *md, const char *json)
+{
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN), threads[16], runs = 0, i, fd, failed = 0;
+    double elapsed[16];
+    uint64_t bytes[16];
+    ads125x_export_stats stats;
+    struct timespec start, end;
+    uint8_t *raw;
+    FILE *fp;
+
+    if ((raw = bench_synth(count)) == NULL || (fp = fopen("/dev/null", "w")) == NULL)
+    {
+        fprintf(stderr, "Prepare the export benchmark failed.\n");
+        free(raw);
+        return 1;
+    }
+    fd = fileno(fp);
+
+    // Run 0 is the fprintf() baseline, then 1, 2, 4 ... threads up to all CPUs
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    bench_export_fprintf(fp, raw, count);
+    fflush(fp);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    threads[0] = 1;
+    elapsed[0] = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    runs = 1;
+    if (cpus < 1)
+        cpus = 1;
+    for (i = 1; runs < 16; i = i * 2 < cpus ? i * 2 : cpus)
+    {
+        if (ads125xExportWrite(fd, raw, count, 1, i, &stats))
+            failed = 1;
+        threads[runs] = stats.threads;
+        elapsed[runs] = stats.elapsed;
+        bytes[runs] = stats.bytes;
+        ++runs;
+        if (i >= cpus)
+            break;
+    }
+    // Both write the same lines
+    bytes[0] = bytes[1];
+    for (i = 0; i < runs; ++i)
+        fprintf(stderr, "%-8s %2d threads: %12.0lf samples/s, %8.1lf MB/s\n", i ? "export" : "fprintf", threads[i],
+                count / elapsed[i], bytes[i] / elapsed[i] * 1e-6);
+
+    fprintf(md, "| Formatter | Threads | Number of Samples | Elapsed Time / s | Samples / s | MB / s | Speedup |\n");
+    fprintf(md, "| ---- | ---- | ------ | ------ | -------- | ------ | ---- |\n");
+    for (i = 0; i < runs; ++i)
+        fprintf(md, "| %s | %d | %llu | %.4lf | %.0lf | %.1lf | %.2lf |\n", i ? "libads1256export" : "fprintf", threads[i],
+                (unsigned long long)count, elapsed[i], count / elapsed[i], bytes[i] / elapsed[i] * 1e-6, elapsed[0] / elapsed[i]);
+    if (json)
+    {
+        FILE *jp;
+
+        if ((jp = fopen(json, "w")) == NULL)
+        {
+            fprintf(stderr, "Open file %s error.\n", json);
+            exit(EXIT_FAILURE);
+        }
+        fprintf(jp, "{\n  \"backend\": \"export\",\n  \"runs\": [");
+        for (i = 0; i < runs; ++i)
+            fprintf(jp, "%s\n    {\"formatter\": \"%s\", \"threads\": %d, \"samples\": %llu, \"elapsed_s\": %.6lf, "
+                        "\"samples_per_s\": %.1lf, \"bytes\": %llu}",
+                    i ? "," : "", i ? "libads1256export" : "fprintf", threads[i], (unsigned long long)count,
+                    elapsed[i], count / elapsed[i], (unsigned long long)bytes[i]);
+        fprintf(jp, "\n  ]\n}\n");
+        fclose(jp);
+    }
+    fclose(fp);
+    free(raw);
+    return failed;
+}
+
+/**
+ * bench_graph_sink - Sum the codes, so the pipeline really reads them
+ */
+static int bench_graph_sink(void *arg, const ads125x_gblock *in, ads125x_gblock *out)
+{
+    int64_t *sum = (int64_t *)arg;
+    size_t i;
+
+    (void)out;
+    for (i = 0; i < in->n; ++i)
+        *sum += in->codes[i];
+    return ADS125x_OK;
+}
+
+/**
+ * bench_graph - Measure the graph scaling over 1 ~ @max_devices emulated chips
+ *
+ * Every chip feeds a decimation by BENCH_GRAPH_DECIMATE and a boxcar of
+ * BENCH_GRAPH_BOXCAR samples, each to its own sink, for @duration seconds.
+ *
+ * @return: 0, or 1 if a run failed.
+ */
+static int bench_graph(int max_devices, double duration, FILE *md, const char *json)
+{
+    bench_graph_result res[BENCH_GRAPH_MAX_DEVICES];
+    ads125x_dev devs[BENCH_GRAPH_MAX_DEVICES];
+    int64_t sums[BENCH_GRAPH_MAX_DEVICES][2];
+    ads125x_graph_node_stats ns;
+    ads125x_graph_stats gs;
+    ads125x_graph *g;
+    int n, i, src, dec, box, sources[BENCH_GRAPH_MAX_DEVICES], boxes[BENCH_GRAPH_MAX_DEVICES], failed = 0;
+    uint8_t *synth;
+
+    if (max_devices > BENCH_GRAPH_MAX_DEVICES)
+        max_devices = BENCH_GRAPH_MAX_DEVICES;
+    if ((synth = bench_synth(BENCH_SYNTH_SAMPLES)) == NULL)
+    {
+        fprintf(stderr, "Prepare the graph benchmark failed.\n");
+        return 1;
+    }
+    memset(res, 0x00, sizeof(res));
+    for (n = 1; n <= max_devices; ++n)
+    {
+        bench_graph_result *r = &res[n - 1];
+
+        memset(sums, 0x00, sizeof(sums));
+        memset(devs, 0x00, sizeof(devs));
+        if ((g = ads125xGraphOpen(BENCH_GRAPH_BLOCK)) == NULL)
+        {
+            failed = 1;
+            break;
+        }
+        for (i = 0; i < n; ++i)
+        {
+            devs[i].name = "ADS1256";
+            if (ads125xReplayOpenBuffer(&devs[i], synth, BENCH_SYNTH_SAMPLES, ADS125x_REPLAY_FAST | ADS125x_REPLAY_LOOP) ||
+                (src = sources[i] = ads125xGraphAddSource(g, &devs[i], 0)) < 0 ||
+                (dec = ads125xGraphAddDecimate(g, BENCH_GRAPH_DECIMATE)) < 0 ||
+                (box = boxes[i] = ads125xGraphAddBoxcar(g, BENCH_GRAPH_BOXCAR)) < 0 ||
+                ads125xGraphConnect(g, src, dec) || ads125xGraphConnect(g, src, box) ||
+                ads125xGraphConnect(g, dec, ads125xGraphAddSink(g, bench_graph_sink, &sums[i][0])) ||
+                ads125xGraphConnect(g, box, ads125xGraphAddSink(g, bench_graph_sink, &sums[i][1])))
+            {
+                failed = 1;
+                break;
+            }
+        }
+        if (!failed && ads125xGraphStart(g, 0) == ADS125x_OK)
+        {
+            usleep((useconds_t)(duration * 1e6));
+            if (ads125xGraphStop(g))
+                failed = 1;
+        }
+        else
+            failed = 1;
+        ads125xGraphGetStats(g, &gs);
+        r->devices = n;
+        r->threads = gs.threads;
+        r->elapsed = gs.elapsed;
+        r->steals = gs.steals;
+        r->runs = gs.runs;
+        for (i = 0; i < n && !failed; ++i)
+        {
+            ads125xGraphGetNodeStats(g, sources[i], &ns);
+            r->read += ns.samples;
+            r->dropped += ns.dropped;
+            r->blocks += ns.blocks;
+            ads125xGraphGetNodeStats(g, boxes[i], &ns);
+            r->processed += ns.samples;
+        }
+        ads125xGraphClose(g);
+        for (i = 0; i < n; ++i)
+            if (devs[i].backend)
+                ads125xReplayClose(&devs[i]);
+        if (failed)
+        {
+            fprintf(stderr, "Graph run of %d devices failed.\n", n);
+            break;
+        }
+        fprintf(stderr, "graph %2d devices %2d threads: %12.0lf samples/s read, %12.0lf processed, %5.1lf%% blocks dropped\n",
+                n, r->threads, r->read / r->elapsed, r->processed / r->elapsed,
+                r->blocks ? 100.0 * r->dropped / r->blocks : 0);
+    }
+    max_devices = n - 1;
+
+    fprintf(md, "| Devices | Threads | Elapsed Time / s | Read / s | Processed / s | Dropped Blocks | Steals | Scaling |\n");
+    fprintf(md, "| ---- | ---- | ------ | -------- | -------- | ------ | ------ | ---- |\n");
+    for (i = 0; i < max_devices; ++i)
+        fprintf(md, "| %d | %d | %.3lf | %.0lf | %.0lf | %.1lf%% | %llu | %.2lf |\n", res[i].devices, res[i].threads,
+                res[i].elapsed, res[i].read / res[i].elapsed, res[i].processed / res[i].elapsed,
+                res[i].blocks ? 100.0 * res[i].dropped / res[i].blocks : 0, (unsigned long long)res[i].steals,
+                (res[i].processed / res[i].elapsed) / (res[0].processed / res[0].elapsed));
+    if (json)
+    {
+        FILE *jp;
+
+        if ((jp = fopen(json, "w")) == NULL)
+        {
+            fprintf(stderr, "Open file %s error.\n", json);
+            exit(EXIT_FAILURE);
+        }
+        fprintf(jp, "{\n  \"backend\": \"graph\",\n  \"runs\": [");
+        for (i = 0; i < max_devices; ++i)
+            fprintf(jp, "%s\n    {\"devices\": %d, \"threads\": %d, \"elapsed_s\": %.6lf, \"read\": %llu, "
+                        "\"processed\": %llu, \"blocks\": %llu, \"dropped_blocks\": %llu, \"runs\": %llu, \"steals\": %llu}",
+                    i ? "," : "", res[i].devices, res[i].threads, res[i].elapsed, (unsigned long long)res[i].read,
+                    (unsigned long long)res[i].processed, (unsigned long long)res[i].blocks,
+                    (unsigned long long)res[i].dropped, (unsigned long long)res[i].runs, (unsigned long long)res[i].steals);
+        fprintf(jp, "\n  ]\n}\n");
+        fclose(jp);
+    }
+    free(synth);
+    return failed;
+}
+
+/**
+ * bench_align - Measure ads125xMergePush() and ads125xMergePull() on simulated clocks
+ * @count: Samples per device.
+ *
+ * Device k converts at 1 kSPS off by bench_align_ppm[k], its timestamps
+ * are late by up to 20 us and it misses one conversion in 1000. The
+ * samples are made before the clock starts.
+ *
+ * @return: 0, or 1 if a run failed.
+ */
+static int bench_align(size_t count, FILE *md, const char *json)
+{
+    static const double bench_align_ppm[BENCH_ALIGN_MAX_DEVICES] = {40, -60, 25, -15, 80, -35, 5, -90};
+    bench_align_result res[4];
+    double sps[BENCH_ALIGN_MAX_DEVICES], *frames = NULL, period, e;
+    uint64_t *ts = NULL, *frame_ns = NULL;
+    int32_t *codes = NULL;
+    struct timespec start, end;
+    ads125x_merge *m;
+    int runs = 0, n, d, i, failed = 0;
+    size_t at, k, j, len;
+    uint32_t seed = 1;
+
+    if (count < BENCH_ALIGN_BLOCK)
+        count = BENCH_ALIGN_BLOCK;
+    count -= count % BENCH_ALIGN_BLOCK;
+    if ((codes = (int32_t *)malloc(BENCH_ALIGN_MAX_DEVICES * count * sizeof(*codes))) == NULL ||
+        (ts = (uint64_t *)malloc(BENCH_ALIGN_MAX_DEVICES * count * sizeof(*ts))) == NULL ||
+        (frames = (double *)malloc(BENCH_ALIGN_MAX_DEVICES * BENCH_ALIGN_BLOCK * 2 * sizeof(*frames))) == NULL ||
+        (frame_ns = (uint64_t *)malloc(BENCH_ALIGN_BLOCK * 2 * sizeof(*frame_ns))) == NULL)
+    {
+        fprintf(stderr, "Prepare the align benchmark failed.\n");
+        failed = 1;
+        goto out;
+    }
+    for (d = 0; d < BENCH_ALIGN_MAX_DEVICES; ++d)
+    {
+        sps[d] = 1000;
+        period = 1e6 / (1 + bench_align_ppm[d] * 1e-6);
+        for (k = j = 0; j < count; ++k)
+        {
+            if (k % 1000 == 999)
+                continue;
+            seed = seed * 1664525 + 1013904223;
+            codes[d * count + j] = (int32_t)lround(1e6 * sin(2 * M_PI * 50 * k * period * 1e-9));
+            ts[d * count + j] = 1000000000000ULL + d * 123457 + (uint64_t)llround(k * period) + (seed >> 8) % 20000;
+            ++j;
+        }
+    }
+
+    for (n = 1; n <= BENCH_ALIGN_MAX_DEVICES; n *= 2, ++runs)
+    {
+        bench_align_result *r = &res[runs];
+
+        memset(r, 0x00, sizeof(*r));
+        r->devices = n;
+        if ((m = ads125xMergeOpen(n, sps, 1000)) == NULL)
+        {
+            failed = 1;
+            break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (at = 0; at < count; at += BENCH_ALIGN_BLOCK)
+        {
+            for (d = 0; d < n; ++d)
+                ads125xMergePush(m, d, codes + d * count + at, ts + d * count + at, BENCH_ALIGN_BLOCK);
+            while ((len = ads125xMergePull(m, frame_ns, frames, BENCH_ALIGN_BLOCK * 2)) > 0)
+                r->frames += len;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        r->elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+        r->samples = (uint64_t)n * count;
+        for (d = 0; d < n; ++d)
+        {
+            e = fabs(ads125xClockPPM(ads125xMergeClock(m, d)) - bench_align_ppm[d]);
+            if (e > r->ppm_error)
+                r->ppm_error = e;
+        }
+        ads125xMergeClose(m);
+        fprintf(stderr, "align %d devices: %12.0lf samples/s, %10.0lf frames/s, %.2lf ppm worst error\n", n,
+                r->samples / r->elapsed, r->frames / r->elapsed, r->ppm_error);
+    }
+
+    fprintf(md, "| Devices | Samples / Device | Elapsed Time / s | Samples / s | Frames / s | ns / Sample | Worst PPM Error |\n");
+    fprintf(md, "| ---- | ------ | ------ | -------- | -------- | ---- | ---- |\n");
+    for (i = 0; i < runs; ++i)
+        fprintf(md, "| %d | %llu | %.4lf | %.0lf | %.0lf | %.1lf | %.2lf |\n", res[i].devices, (unsigned long long)count,
+                res[i].elapsed, res[i].samples / res[i].elapsed, res[i].frames / res[i].elapsed,
+                res[i].elapsed * 1e9 / res[i].samples, res[i].ppm_error);
+    if (json)
+    {
+        FILE *jp;
+
+        if ((jp = fopen(json, "w")) == NULL)
+        {
+            fprintf(stderr, "Open file %s error.\n", json);
+            exit(EXIT_FAILURE);
+        }
+        fprintf(jp, "{\n  \"backend\": \"align\",\n  \"runs\": [");
+        for (i = 0; i < runs; ++i)
+            fprintf(jp, "%s\n    {\"devices\": %d, \"elapsed_s\": %.6lf, \"samples\": %llu, \"frames\": %llu, "
+                        "\"samples_per_s\": %.1lf, \"ppm_error\": %.3lf}",
+                    i ? "," : "", res[i].devices, res[i].elapsed, (unsigned long long)res[i].samples,
+                    (unsigned long long)res[i].frames, res[i].samples / res[i].elapsed, res[i].ppm_error);
+        fprintf(jp, "\n  ]\n}\n");
+        fclose(jp);
+    }
+out:
+    free(codes);
+    free(ts);
+    free(frames);
+    free(frame_ns);
+    return failed;
+}
+
+static int find_name(const char **names, int count, const char *name)
+{
+    int i;
+
+    for (i = 0; i < count; ++i)
+        if (strcasecmp(names[i], name) == 0)
+            return i;
+    fprintf(stderr, "Unknown name %s .\n", name);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    int nrates = sizeof(bench_rates) / sizeof(bench_rates[0]);
+    int nwaits = sizeof(bench_waits) / sizeof(bench_waits[0]);
+    int i, m, w, count = 0, only_mode = -1, only_wait = -1, failed = 0;
+    size_t export_samples = 0;
+    int graph_devices = 0;
+    size_t align_samples = 0;
+    double duration = BENCH_DURATION, only_sps = 0, sps;
+    const char *json = NULL, *output = NULL;
+    bench_source src = {0, NULL, NULL, 0};
+    bench_result *results = NULL, *r;
+    uint8_t *synth = NULL;
+    size_t n;
+    FILE *fp;
+
+    for (i = 1; i < argc; ++i)
+    {
+        const char *arg = i + 1 < argc ? argv[i + 1] : NULL;
+
+        /**/ if ( strcasecmp(argv[i], "-h") == 0 || strcasecmp(argv[i], "--help") == 0 )
+        {
+            fprintf(stdout, "%s: %s\n", argv[0], usage);
+            exit(EXIT_SUCCESS);
+        }
+        else if ( strcasecmp(argv[i], "--hw") == 0 ) { src.hw = 1; continue; }
+        else if ( strcasecmp(argv[i], "--malloc") == 0 ) { bench_malloc = 1; continue; }
+        else if ( arg == NULL )
+        {
+            fprintf(stderr, "%s: Missing value of %s.\n", argv[0], argv[i]);
+            exit(EXIT_FAILURE);
+        }
+        else if ( strcasecmp(argv[i], "-d") == 0 || strcasecmp(argv[i], "--duration") == 0 ) duration = atof(arg);
+        else if ( strcasecmp(argv[i], "-s") == 0 || strcasecmp(argv[i], "--sps"     ) == 0 ) only_sps = atof(arg);
+        else if ( strcasecmp(argv[i], "-m") == 0 || strcasecmp(argv[i], "--mode"    ) == 0 ) only_mode = find_name(bench_modes, BENCH_MODE_NUM, arg);
+        else if ( strcasecmp(argv[i], "-w") == 0 || strcasecmp(argv[i], "--wait"    ) == 0 ) only_wait = find_name(bench_waits, nwaits, arg);
+        else if ( strcasecmp(argv[i], "-r") == 0 || strcasecmp(argv[i], "--replay"  ) == 0 ) src.path = arg;
+        else if ( strcasecmp(argv[i], "-j") == 0 || strcasecmp(argv[i], "--json"    ) == 0 ) json = arg;
+        else if ( strcasecmp(argv[i], "-o") == 0 || strcasecmp(argv[i], "--output"  ) == 0 ) output = arg;
+        else if ( strcasecmp(argv[i], "-e") == 0 || strcasecmp(argv[i], "--export"  ) == 0 ) export_samples = strtoull(arg, NULL, 0);
+        else if ( strcasecmp(argv[i], "-g") == 0 || strcasecmp(argv[i], "--graph"   ) == 0 ) graph_devices = atoi(arg);
+        else if ( strcasecmp(argv[i], "-a") == 0 || strcasecmp(argv[i], "--align"   ) == 0 ) align_samples = strtoull(arg, NULL, 0);
+        else {
+            fprintf (stderr, "%s: Unknown option: %s.\n", argv [0], argv [i]) ;
+            exit (EXIT_FAILURE) ;
+        }
+        ++i;
+    }
+    if (export_samples)
+    {
+        if (output && (fp = fopen(output, "w")) != NULL)
+        {
+            failed = bench_export(export_samples, fp, json);
+            fclose(fp);
+        }
+        else
+        {
+            if (output)
+                fprintf(stderr, "Open file %s error.\n", output);
+            failed = bench_export(export_samples, stdout, json);
+        }
+        return failed;
+    }
+    if (graph_devices > 0)
+    {
+        if (output && (fp = fopen(output, "w")) != NULL)
+        {
+            failed = bench_graph(graph_devices, duration, fp, json);
+            fclose(fp);
+        }
+        else
+        {
+            if (output)
+                fprintf(stderr, "Open file %s error.\n", output);
+            failed = bench_graph(graph_devices, duration, stdout, json);
+        }
+        return failed;
+    }
+    if (align_samples)
+    {
+        if (output && (fp = fopen(output, "w")) != NULL)
+        {
+            failed = bench_align(align_samples, fp, json);
+            fclose(fp);
+        }
+        else
+        {
+            if (output)
+                fprintf(stderr, "Open file %s error.\n", output);
+            failed = bench_align(align_samples, stdout, json);
+        }
+        return failed;
+    }
+    if (src.hw && geteuid() != 0)
+    {
+        fprintf(stderr, "%s: Must be root to use the hardware.\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (!src.hw && !src.path)
+    {
+        if ((synth = bench_synth(BENCH_SYNTH_SAMPLES)) == NULL)
+        {
+            fprintf(stderr, "Allocated memory for synthetic samples failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        src.samples = synth;
+        src.count = BENCH_SYNTH_SAMPLES;
+    }
+    if ((results = (bench_result *)calloc(nrates * BENCH_MODE_NUM * nwaits, sizeof(bench_result))) == NULL)
+    {
+        fprintf(stderr, "Allocated memory for results failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (m = 0; m < BENCH_MODE_NUM; ++m)
+    {
+        if (only_mode >= 0 && m != only_mode)
+            continue;
+        for (w = 0; w < nwaits; ++w)
+        {
+            if (only_wait >= 0 && w != only_wait)
+                continue;
+            for (i = 0; i < nrates; ++i)
+            {
+                sps = ads125xDRATEToSPS(bench_rates[i]);
+                if (only_sps > 0 && sps != only_sps)
+                    continue;
+                n = (size_t)(sps * duration) > BENCH_MIN_SAMPLES ? (size_t)(sps * duration) : BENCH_MIN_SAMPLES;
+                r = results + count;
+                r->mode = bench_modes[m];
+                r->wait = bench_waits[w];
+                r->target_sps = sps;
+                if ((m == BENCH_MODE_RDATAC_CPP ? bench_run_cpp(&src, bench_rates[i], w, n, r)
+                                                : bench_run_c(&src, bench_rates[i], m, w, n, r)))
+                {
+                    fprintf(stderr, "Run %s/%s at %g SPS failed.\n", r->mode, r->wait, sps);
+                    failed = 1;
+                }
+                fprintf(stderr, "%-10s %-7s %8g SPS: %10.3lf SPS, %llu dropped, %5.1lf%% CPU, %llu page faults\n", r->mode, r->wait, sps,
+                        r->actual_sps, (unsigned long long)r->dropped, r->cpu, (unsigned long long)r->page_faults);
+                ++count;
+            }
+        }
+    }
+
+    if (output && (fp = fopen(output, "w")) != NULL)
+    {
+        write_markdown(fp, results, count);
+        fclose(fp);
+    }
+    else
+    {
+        if (output)
+            fprintf(stderr, "Open file %s error.\n", output);
+        write_markdown(stdout, results, count);
+    }
+    if (json)
+    {
+        if ((fp = fopen(json, "w")) == NULL)
+        {
+            fprintf(stderr, "Open file %s error.\n", json);
+            exit(EXIT_FAILURE);
+        }
+        write_json(fp, src.hw ? "hardware" : src.path ? "replay" : "emulated", results, count);
+        fclose(fp);
+    }
+    free(results);
+    free(synth);
+    return failed;
+}
@@ -0,0 +1,146 @@
+/**
+ * ads1256bench.h - Benchmark of the ADS125x acquisition paths
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef ADS1256BENCH_H
+#define ADS1256BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/resource.h>
+
+#include "libads1256.h"
+#include "libads1256arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENCH_MODE_RDATAC       0   // ads125xRDATACRead()
+#define BENCH_MODE_RDATAC_CPP   1   // ads125x::Device::Stream
+#define BENCH_MODE_RDATA        2   // ads125xRDATA() one-shot
+#define BENCH_MODE_CONTROL      3   // ads125xControlRun() callback
+#define BENCH_MODE_NUM          4
+
+#define BENCH_MIN_SAMPLES       5
+#define BENCH_SYNTH_SAMPLES     4096
+
+#define BENCH_GRAPH_MAX_DEVICES 16
+#define BENCH_GRAPH_BLOCK       512     // Samples per graph block
+#define BENCH_GRAPH_DECIMATE    8
+#define BENCH_GRAPH_BOXCAR      16
+
+#define BENCH_ALIGN_MAX_DEVICES 8
+#define BENCH_ALIGN_BLOCK       64      // Samples per push, well under ADS125x_MERGE_HISTORY
+
+/**
+ * bench_source - Where the benchmark gets its device from
+ * @hw: Use the ADS1256 wired as in ads1256.h.
+ * @path: Replay this capture, if not @hw.
+ * @samples: Otherwise emulate a chip serving @count synthetic samples.
+ */
+typedef struct bench_source_struct
+{
+    int hw;
+    const char *path;
+    const uint8_t *samples;
+    size_t count;
+} bench_source;
+
+typedef struct bench_result_struct
+{
+    const char *mode;
+    const char *wait;
+    double target_sps;
+    uint64_t samples;
+    double elapsed;
+    double actual_sps;
+    uint64_t dropped;
+    double cpu;
+    double lat_us[4];   // p50, p90, p99, max
+    double syscalls;
+    uint64_t page_faults;
+} bench_result;
+
+typedef struct bench_graph_result_struct
+{
+    int devices;
+    int threads;
+    double elapsed;
+    uint64_t read;          // Samples read by the sources
+    uint64_t processed;     // Samples through the boxcar filters
+    uint64_t blocks;
+    uint64_t dropped;       // Blocks the sources dropped
+    uint64_t runs;
+    uint64_t steals;
+} bench_graph_result;
+
+typedef struct bench_align_result_struct
+{
+    int devices;
+    double elapsed;
+    uint64_t samples;       // Samples pushed, all devices
+    uint64_t frames;        // Frames pulled
+    double ppm_error;       // Worst error of ads125xClockPPM()
+} bench_align_result;
+
+// Measurement of one run, see bench_begin()
+typedef struct bench_acc_struct
+{
+    uint64_t *lat_ns;
+    size_t n;
+    size_t cap;
+    double period_ns;
+    uint64_t start_ns;
+    uint64_t last_drdy_ns;
+    uint64_t gap_drops;
+    uint64_t replay_dropped;
+    ads125x_io_stats io;
+    struct rusage ru;
+    ads125x_arena *arena;
+    uint64_t faults;
+    ads125x_dev *dev;   // Device of the control callback
+} bench_acc;
+
+// Buffers of a run come from malloc() instead of a prefaulted arena
+extern int bench_malloc;
+
+int bench_begin(bench_acc *acc, ads125x_dev *dev, size_t n);
+void bench_sample(bench_acc *acc, ads125x_dev *dev);
+void bench_end(bench_acc *acc, ads125x_dev *dev, bench_result *r);
+int bench_run_cpp(const bench_source *src, uint8_t dr, int wait, size_t n, bench_result *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
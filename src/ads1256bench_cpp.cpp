@@ -0,0 +1,105 @@
+/**
+ * ads1256bench_cpp.cpp - The C++ interface leg of the benchmark
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+#include <cstdio>
+#include <optional>
+#include <linux/spi/spidev.h>
+
+#include "libads1256.hpp"
+#include "ads1256.h"
+#include "ads1256bench.h"
+
+using BenchDevice = ads125x::Device<ads125x::Gain::x1, 2500000, int32_t>;
+
+static BenchDevice bench_open_cpp(const bench_source *src)
+{
+    if (src->path)
+        return BenchDevice::replay(src->path, ADS125x_REPLAY_PACED | ADS125x_REPLAY_LOOP);
+    if (!src->hw)
+        return BenchDevice::emulate(src->samples, src->count, ADS125x_REPLAY_PACED | ADS125x_REPLAY_LOOP);
+    return BenchDevice({ADS125x_DRDY_CHIP, ADS125x_DRDY_LINE, ADS125x_PDWN_CHIP, ADS125x_PDWN_LINE, 0, 0,
+                        ADS125x_SPI_SPEED, ADS125x_SPI_MODE});
+}
+
+/**
+ * bench_run_cpp - Read @n samples at @dr through ads125x::Device::Stream
+ *
+ * Same sequence and per-sample reads as the C RDATAC run, so the
+ * difference between both is the cost of the wrapper.
+ *
+ * @return: 0 success, 1 is the device failed.
+ */
+extern "C" int bench_run_cpp(const bench_source *src, uint8_t dr, int wait, std::size_t n, bench_result *r)
+{
+    std::optional<BenchDevice> dev;
+    ads125x_predict predict;
+    bench_acc acc;
+    int32_t sample;
+    std::size_t i;
+
+    try
+    {
+        dev.emplace(bench_open_cpp(src));
+        dev->reset();
+        dev->set_rate(static_cast<ads125x::DataRate>(dr));
+        dev->set_mux(ads125x::Input::AIN0, ads125x::Input::AIN1);
+        dev->self_calibrate();
+    }
+    catch (const ads125x::Error &e)
+    {
+        std::fprintf(stderr, "%s: %d\n", e.what(), e.code());
+        return 1;
+    }
+    if (bench_begin(&acc, dev->native(), n))
+        return 1;
+    dev->native()->wait_mode = wait;
+    dev->native()->predict = &predict;
+
+    try
+    {
+        auto stream = dev->stream();
+
+        for (i = 0; i < n; ++i)
+        {
+            stream.read(&sample, 1);
+            bench_sample(&acc, dev->native());
+        }
+    }
+    catch (const ads125x::Error &e)
+    {
+        std::fprintf(stderr, "%s: %d\n", e.what(), e.code());
+        bench_end(&acc, dev->native(), r);
+        return 1;
+    }
+    bench_end(&acc, dev->native(), r);
+    return 0;
+}
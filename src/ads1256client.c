@@ -0,0 +1,125 @@
+/**
+ * ads1256client.c - Reference receiver of the ads1256 sample stream
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "libads1256.h"
+#include "libads1256net.h"
+
+#define CLIENT_FIRST_US 10000000    // Wait for the first UDP frame
+#define CLIENT_IDLE_US  2000000     // UDP stream ended
+
+char *usage = "Usage: ads1256client <tcp|udp> <addr> [samples] [-q]\n"
+              " tcp <host:port>            Connect to `ads1256 -n tcp <port> ...`\n"
+              " udp <[host:]port>          Receive `ads1256 -n udp <host:port> ...`\n"
+              " samples                    Stop after this many samples, 0 for the whole stream\n"
+              " -q                         Only print the summary\n\n"
+              "Prints one \"seq,raw,volt,ts\" line per sample, the summary goes to stderr.";
+
+int main(int argc, char *argv[])
+{
+    static int32_t codes[ADS125x_NET_MAX_COUNT];
+    static uint64_t ts[ADS125x_NET_MAX_COUNT];
+    ads125x_net_client_stats stats;
+    ads125x_net_frame frame;
+    ads125x_net_client *cli;
+    uint64_t limit = 0, start = 0, last = 0, now, lat, lat_sum = 0, lat_max = 0;
+    double elapsed;
+    int proto, quiet = 0, n, i;
+
+    if (argc > 1 && strcmp(argv[argc - 1], "-q") == 0)
+    {
+        quiet = 1;
+        argc--;
+    }
+    if (argc < 3 || argc > 4)
+    {
+        fprintf(stderr, "%s\n", usage);
+        exit(EXIT_FAILURE);
+    }
+    /**/ if (strcasecmp(argv[1], "tcp") == 0) proto = ADS125x_NET_TCP;
+    else if (strcasecmp(argv[1], "udp") == 0) proto = ADS125x_NET_UDP;
+    else {
+        fprintf(stderr, "Invalid protocol %s .\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+    if (argc == 4)
+        limit = strtoull(argv[3], NULL, 0);
+    if ((cli = ads125xNetConnect(proto, argv[2])) == NULL)
+        exit(EXIT_FAILURE);
+
+    for (;;)
+    {
+        n = ads125xNetRecv(cli, &frame, codes, ts, start ? CLIENT_IDLE_US : (proto == ADS125x_NET_UDP ? CLIENT_FIRST_US : -1));
+        if (n == ADS125x_ERR_INVAL)
+        {
+            fprintf(stderr, "Skip a malformed frame.\n");
+            continue;
+        }
+        if (n <= 0)
+            break;
+        now = ads125xNowNs();
+        if (!start)
+            start = now;
+        last = now;
+        // Only meaningful on the host of the server, the clocks are the same
+        lat = now > ts[n - 1] ? now - ts[n - 1] : 0;
+        lat_sum += lat;
+        if (lat > lat_max)
+            lat_max = lat;
+        if (!quiet)
+            for (i = 0; i < n; ++i)
+                fprintf(stdout, "%llu,%06x,%.12lf,%llu\n", (unsigned long long)(frame.seq + i),
+                        (uint32_t)codes[i] & 0xffffff, codes[i] * 5.0 / (1 << 23), (unsigned long long)ts[i]);
+        ads125xNetClientGetStats(cli, &stats);
+        if (limit && stats.samples >= limit)
+            break;
+    }
+    if (n < 0 && n != ADS125x_ERR_TIMEOUT)
+        fprintf(stderr, "Receive failed: %d\n", n);
+
+    ads125xNetClientGetStats(cli, &stats);
+    elapsed = (last - start) * 1e-9;
+    fprintf(stderr, "Received %llu samples in %llu frames, %.2lf SPS, %.3lf MB/s, %llu missing, %llu dropped by the server.\n",
+            (unsigned long long)stats.samples, (unsigned long long)stats.frames,
+            elapsed > 0 ? stats.samples / elapsed : 0, elapsed > 0 ? stats.bytes / elapsed * 1e-6 : 0,
+            (unsigned long long)stats.gaps, (unsigned long long)stats.lost);
+    if (stats.frames)
+        fprintf(stderr, "Last sample of a frame to receive latency avg/max %.3lf/%.3lf ms (same host only).\n",
+                lat_sum * 1e-6 / stats.frames, lat_max * 1e-6);
+    ads125xNetDisconnect(cli);
+    return stats.gaps ? 2 : 0;
+}
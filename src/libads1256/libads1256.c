@@ -34,14 +34,17 @@
 #include <byteswap.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <math.h>
 #include <string.h>
 // #include <stdint.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <sched.h>
 #include <sys/ioctl.h>
 #include <linux/spi/spi.h>
 #include <linux/spi/spidev.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "libads1256reg.h"
@@ -49,6 +52,11 @@
 
 int ADS125xDriverDebug = false;
 
+/**
+ * FailurePrint - Print a error message
+ *
+ * @return: ADS125x_ERR_IO, so that callers can return it.
+ */
 int FailurePrint(const char *message, ...)
 {
     va_list argp;
@@ -59,9 +67,8 @@ int FailurePrint(const char *message, ...)
     va_end(argp);
 
     fprintf(stderr, "%s", buffer);
-    exit(EXIT_FAILURE);
 
-    return 0;
+    return ADS125x_ERR_IO;
 }
 
 /**
@@ -117,21 +124,20 @@ int ads125xGetGPIOLine(char *chip, int line, struct gpiod_chip **cp, struct gpio
  * @chip: Target GPIO chip string.
  * @line: Target GPIO line number.
  *
- * @return: 0 is open DRDY successful,
- *          1 is open DRDY GPIO error,
- *          2 is set DRDY direction error.
+ * @return: ADS125x_OK, ADS125x_ERR_IO is open the GPIO line or set its
+ *          direction failed.
  */
 int ads125xOpenDRDY(ads125x_dev *dev, char *chip, int line)
 {
     if (ads125xGetGPIOLine(chip, line, &(dev->pin_DRDY_chip), &(dev->pin_DRDY_line)))
     {
         fprintf(stderr, "Cannot open ADS1256 DRDY.\n");
-        return 1;
+        return ADS125x_ERR_IO;
     }
     if ((gpiod_line_request_input(dev->pin_DRDY_line, "ads125x-drdy")) < 0)
     {
         fprintf(stderr, "Cannot set DRDY to input mode.\n");
-        return 2;
+        return ADS125x_ERR_IO;
     }
     if (ADS125xDriverDebug)
         fprintf(stdout, "Open DRDY at %s line %d.\n", chip, line);
@@ -145,27 +151,26 @@ int ads125xOpenDRDY(ads125x_dev *dev, char *chip, int line)
  * @line: Target GPIO line number.
  * @init_status: Init PDWN status, 0 is low, 1 is high.
  *
- * @return: 0 is open DRDY successful,
- *          1 is open DRDY GPIO error,
- *          2 is set DRDY direction error.
- *          3 invalid init_status, only 0 or 1.
+ * @return: ADS125x_OK, ADS125x_ERR_INVAL is a init_status other than 0
+ *          or 1, ADS125x_ERR_IO is open the GPIO line or set its
+ *          direction failed.
  */
 int ads125xOpenPDWN(ads125x_dev *dev, char *chip, int line, uint8_t init_status)
 {
     if (init_status & 0xFE)
     {
         fprintf(stderr, "Invalid init_status %d.\n", init_status);
-        return 3;
+        return ADS125x_ERR_INVAL;
     }
     if (ads125xGetGPIOLine(chip, line, &(dev->pin_PDWN_chip), &(dev->pin_PDWN_line)))
     {
         fprintf(stderr, "Cannot open ADS1256 PDWN.\n");
-        return 1;
+        return ADS125x_ERR_IO;
     }
     if ((gpiod_line_request_output(dev->pin_PDWN_line, "ads125x-pdwn", init_status)) < 0)
     {
         fprintf(stderr, "Cannot set DRDY to output mode.\n");
-        return 2;
+        return ADS125x_ERR_IO;
     }
     if (ADS125xDriverDebug)
         fprintf(stdout, "Open PDWN at %s line %d status %d.\n", chip, line, init_status);
@@ -177,9 +182,12 @@ int ads125xOpenPDWN(ads125x_dev *dev, char *chip, int line, uint8_t init_status)
  */
 void ads125xCloseDRDY(ads125x_dev *dev)
 {
+    if (!dev->pin_DRDY_line)
+        return;
     // gpiod_line_release(dev->pin_DRDY_line);
     gpiod_line_close_chip(dev->pin_DRDY_line);
     dev->pin_DRDY_line = NULL;
+    dev->drdy_events = 0;
     dev->pin_DRDY_chip = NULL;
     if (ADS125xDriverDebug)
         fprintf(stdout, "Close DRDY.\n");
@@ -188,10 +196,12 @@ void ads125xCloseDRDY(ads125x_dev *dev)
 }
 
 /**
- * ads125xClosePDWN - Close ADS1256 DRDY GPIO chip and line
+ * ads125xClosePDWN - Close ADS1256 PDWN GPIO chip and line
  */
 void ads125xClosePDWN(ads125x_dev *dev)
 {
+    if (!dev->pin_PDWN_line)
+        return;
     // gpiod_line_release(dev->pin_DRDY_line);
     gpiod_line_close_chip(dev->pin_PDWN_line);
     dev->pin_PDWN_line = NULL;
@@ -201,14 +211,389 @@ void ads125xClosePDWN(ads125x_dev *dev)
     return;
 }
 
+/**
+ * ads125xNowNs - Monotonic time in nanoseconds
+ */
+uint64_t ads125xNowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * ads125xGetDRDY - Get ADS1256 DRDY level
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * @return: 0 is DRDY low (data ready), 1 is DRDY high, -1 is read error.
+ */
+int ads125xGetDRDY(ads125x_dev *dev)
+{
+    dev->io.drdy_polls++;
+    if (dev->backend)
+        return dev->backend->get_drdy(dev);
+    return gpiod_line_get_value(dev->pin_DRDY_line);
+}
+
+/**
+ * ads125xDRDYTimeout - Get the DRDY timeout of a device
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * The timeout is dev->drdy_timeout_us if set, otherwise
+ * ADS125x_DRDY_TIMEOUT_PERIODS conversion periods of the cached DRATE
+ * plus ADS125x_DRDY_TIMEOUT_MARGIN_US. An unknown DRATE counts as the
+ * slowest one.
+ *
+ * @return: The timeout in nanoseconds.
+ */
+uint64_t ads125xDRDYTimeout(ads125x_dev *dev)
+{
+    double sps = 0;
+
+    if (dev->drdy_timeout_us > 0)
+        return dev->drdy_timeout_us * 1000ULL;
+    if (dev->regs_valid & (1 << ADS125x_REG_ADDR_DRATE))
+        sps = ads125xDRATEToSPS(dev->regs[ADS125x_REG_ADDR_DRATE]);
+    if (sps == 0)
+        sps = 2.5;
+    return (uint64_t)(ADS125x_DRDY_TIMEOUT_PERIODS * 1e9 / sps) + ADS125x_DRDY_TIMEOUT_MARGIN_US * 1000ULL;
+}
+
+/**
+ * ads125x_predict_reset - Start predicting DRDY edges at the cached DRATE
+ */
+static void ads125x_predict_reset(ads125x_dev *dev)
+{
+    ads125x_predict *p = dev->predict;
+    double sps = 0;
+
+    if (!p)
+        return;
+    if (dev->regs_valid & (1 << ADS125x_REG_ADDR_DRATE))
+        sps = ads125xDRATEToSPS(dev->regs[ADS125x_REG_ADDR_DRATE]);
+    p->edge_ns = 0;
+    p->period_ns = sps ? (uint64_t)(1e9 / sps) : 0;
+    p->margin_ns = ADS125x_PREDICT_MARGIN_US * 1000ULL;
+    p->wake_lat_ns = 0;
+}
+
+/**
+ * ads125x_predict_sleep - Sleep until shortly before the predicted DRDY edge
+ *
+ * Sleeps in naps of ADS125x_WAIT_SLEEP_US, a idle CPU, above all a
+ * virtual one, wakes up from one long sleep much later more often. The
+ * margin doubles when a wakeup is later than it, and shrinks slowly
+ * towards twice the smoothed wakeup latency.
+ *
+ * @return: 1 if it slept, 0 if the edge is too close or not known yet.
+ */
+static int ads125x_predict_sleep(ads125x_dev *dev, uint64_t now)
+{
+    ads125x_predict *p = dev->predict;
+    uint64_t next, target, late, want;
+    struct timespec ts;
+
+    if (!p->edge_ns || !p->period_ns)
+        return 0;
+    next = p->edge_ns + p->period_ns;
+    if (next <= now)
+        next += ((now - next) / p->period_ns + 1) * p->period_ns;
+    if (next < now + p->margin_ns + ADS125x_PREDICT_MARGIN_MIN_US * 1000ULL)
+        return 0;
+    target = next - p->margin_ns;
+    while (now < target)
+    {
+        now = now + ADS125x_WAIT_SLEEP_US * 1000ULL < target ? now + ADS125x_WAIT_SLEEP_US * 1000ULL : target;
+        ts.tv_sec = now / 1000000000ULL;
+        ts.tv_nsec = now % 1000000000ULL;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        dev->io.sleeps++;
+        now = ads125xNowNs();
+    }
+    late = now > target ? now - target : 0;
+    // Preemption outliers must not inflate the average
+    p->wake_lat_ns = (p->wake_lat_ns * 7 + (late < 2 * p->margin_ns ? late : 2 * p->margin_ns)) / 8;
+    want = 2 * p->wake_lat_ns;
+    if (want < ADS125x_PREDICT_MARGIN_MIN_US * 1000ULL)
+        want = ADS125x_PREDICT_MARGIN_MIN_US * 1000ULL;
+    if (late > p->margin_ns)
+        p->margin_ns *= 2;
+    else if (p->margin_ns > want)
+        p->margin_ns -= (p->margin_ns - want) / 16;
+    if (p->margin_ns > p->period_ns / 2)
+        p->margin_ns = p->period_ns / 2;
+    return 1;
+}
+
+/**
+ * ads125x_predict_edge - Track the DRDY edge just seen
+ * @exact: dev->drdy_ns is the edge, the backend knows it or DRDY was
+ *         polled high after the last sleep. Otherwise DRDY fell while
+ *         sleeping, on the predicted grid.
+ *
+ * The period follows the measured edges, so it tracks the crystal of
+ * the chip instead of the nominal DRATE.
+ */
+static void ads125x_predict_edge(ads125x_dev *dev, int exact)
+{
+    ads125x_predict *p = dev->predict;
+    uint64_t edge = dev->drdy_ns, dt, k, measured;
+
+    if (!p->period_ns)
+        return;
+    // A late wait only knows the edge was before now, snap it to the predicted grid
+    if (!exact && p->edge_ns && edge > p->edge_ns)
+        edge = p->edge_ns + (edge - p->edge_ns) / p->period_ns * p->period_ns;
+    if (exact && p->edge_ns && edge > p->edge_ns)
+    {
+        dt = edge - p->edge_ns;
+        k = (dt + p->period_ns / 2) / p->period_ns;
+        measured = k ? dt / k : 0;
+        if (measured && measured > p->period_ns - p->period_ns / 8 && measured < p->period_ns + p->period_ns / 8)
+            p->period_ns = (p->period_ns * 15 + measured) / 16;
+    }
+    p->edge_ns = edge;
+}
+
 /**
  * ads125xwaitDRDY - Wating ADS1256 DRDY to low
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * Polls DRDY as set by dev->wait_mode, and sets dev->drdy_ns to the time
+ * DRDY went low if the backend knows it, otherwise to the time it was
+ * seen low.
+ *
+ * @return: ADS125x_OK, ADS125x_ERR_IO is read DRDY failed,
+ *          ADS125x_ERR_TIMEOUT is DRDY did not go low in time, see
+ *          ads125xDRDYTimeout().
  */
-void ads125xwaitDRDY(struct gpiod_line *line)
+int ads125xwaitDRDY(ads125x_dev *dev)
 {
-    while (gpiod_line_get_value(line))
-        ;
-    return;
+    static const struct timespec nap = {0, ADS125x_WAIT_SLEEP_US * 1000};
+    uint64_t now, deadline = 0;
+    int level, exact = 0, predict = dev->wait_mode == ADS125x_WAIT_PREDICT && dev->rdatac && dev->predict;
+
+    while ((level = ads125xGetDRDY(dev)))
+    {
+        if (level < 0)
+            return FailurePrint("Read DRDY error: %s\n", strerror(errno));
+        now = ads125xNowNs();
+        if (!deadline)
+        {
+            deadline = now + ads125xDRDYTimeout(dev);
+            // Sleep once per wait, then spin the last part of the period
+            if (predict && ads125x_predict_sleep(dev, now))
+                continue;
+        }
+        // Check DRDY once more, the thread may have been preempted after the last read
+        else if (now > deadline && ads125xGetDRDY(dev))
+        {
+            fprintf(stderr, "ADS125x err: DRDY timeout.\n");
+            return ADS125x_ERR_TIMEOUT;
+        }
+        // Polled high with no sleep since, the fall is seen when it happens
+        exact = 1;
+        if (dev->wait_mode == ADS125x_WAIT_YIELD)
+            sched_yield();
+        else if (dev->wait_mode == ADS125x_WAIT_SLEEP)
+            nanosleep(&nap, NULL);
+        else
+            continue;
+        dev->io.sleeps++;
+    }
+    if (!dev->backend || !dev->backend->drdy_time || !(dev->drdy_ns = dev->backend->drdy_time(dev)))
+        dev->drdy_ns = ads125xNowNs();
+    else
+        exact = 1;
+    if (predict)
+        ads125x_predict_edge(dev, exact);
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xDRDYEventFd - Get a fd which polls readable when DRDY goes low
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * On hardware the DRDY line is requested again for falling edge events,
+ * ads125xGetDRDY() keeps working. Before waiting on the fd, call
+ * ads125xDRDYEventArm() and check ads125xGetDRDY() once more, DRDY may
+ * have fallen before the fd was armed.
+ *
+ * @return: The fd, owned by the device, or ADS125x_ERR_IO.
+ */
+int ads125xDRDYEventFd(ads125x_dev *dev)
+{
+    if (dev->backend)
+        return dev->backend->event_fd ? dev->backend->event_fd(dev) : ADS125x_ERR_IO;
+    if (!dev->pin_DRDY_line)
+        return ADS125x_ERR_IO;
+    if (!dev->drdy_events)
+    {
+        gpiod_line_release(dev->pin_DRDY_line);
+        if (gpiod_line_request_falling_edge_events(dev->pin_DRDY_line, "ads125x-drdy") < 0)
+            return FailurePrint("Cannot request DRDY events: %s\n", strerror(errno));
+        dev->drdy_events = 1;
+    }
+    return gpiod_line_event_get_fd(dev->pin_DRDY_line);
+}
+
+/**
+ * ads125xDRDYEventArm - Arm the DRDY event fd for the next falling edge
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * @return: ADS125x_OK or ADS125x_ERR_IO.
+ */
+int ads125xDRDYEventArm(ads125x_dev *dev)
+{
+    static const struct timespec now = {0, 0};
+    struct gpiod_line_event ev;
+    int ret;
+
+    if (dev->backend)
+        return dev->backend->event_arm ? dev->backend->event_arm(dev) : ADS125x_ERR_IO;
+    if (!dev->drdy_events)
+        return ADS125x_ERR_IO;
+    // Drop the edges already seen
+    while ((ret = gpiod_line_event_wait(dev->pin_DRDY_line, &now)) == 1)
+        if (gpiod_line_event_read(dev->pin_DRDY_line, &ev) < 0)
+            return FailurePrint("Read DRDY event error: %s\n", strerror(errno));
+    return ret < 0 ? FailurePrint("Wait DRDY event error: %s\n", strerror(errno)) : ADS125x_OK;
+}
+
+/**
+ * ads125xTransfer - Send a SPI message to ADS1256
+ * @dev: The ads125x dev info struct pointer.
+ * @xfer: Array of @n transfers, sent as one message.
+ * @n: Number of transfers.
+ *
+ * Goes through the device backend if one is attached, otherwise
+ * through the spidev ioctl.
+ *
+ * @return: < 0 is transfer failed.
+ */
+int ads125xTransfer(ads125x_dev *dev, struct spi_ioc_transfer *xfer, int n)
+{
+    dev->io.transfers++;
+    if (dev->backend)
+        return dev->backend->transfer(dev, xfer, n);
+    return ioctl(dev->fd, SPI_IOC_MESSAGE(n), xfer);
+}
+
+/**
+ * ads125xDRATEToSPS - Convert a DRATE register value to samples per second
+ * @dr: Data rate, see ADS125x_DR_*.
+ *
+ * @return: The data rate in SPS, 0 is unknown DRATE value.
+ */
+double ads125xDRATEToSPS(const uint8_t dr)
+{
+    switch (dr)
+    {
+    case ADS125x_DR_2_5:    return 2.5;
+    case ADS125x_DR_5:      return 5;
+    case ADS125x_DR_10:     return 10;
+    case ADS125x_DR_15:     return 15;
+    case ADS125x_DR_25:     return 25;
+    case ADS125x_DR_30:     return 30;
+    case ADS125x_DR_50:     return 50;
+    case ADS125x_DR_60:     return 60;
+    case ADS125x_DR_100:    return 100;
+    case ADS125x_DR_500:    return 500;
+    case ADS125x_DR_1000:   return 1000;
+    case ADS125x_DR_2000:   return 2000;
+    case ADS125x_DR_3750:   return 3750;
+    case ADS125x_DR_7500:   return 7500;
+    case ADS125x_DR_15000:  return 15000;
+    case ADS125x_DR_30000:  return 30000;
+    default:                return 0;
+    }
+}
+
+/**
+ * ads125xDRATEToSettleUs - Get the settling time after SYNC or a MUX change
+ * @dr: A data rate, see ADS125x_DR_*.
+ *
+ * The time from SYNC/WAKEUP to the first settled DRDY, from the datasheet
+ * table "Settling time vs data rate" at a 7.68 MHz clock.
+ *
+ * @return: Settling time in us, 0 is an invalid data rate.
+ */
+double ads125xDRATEToSettleUs(const uint8_t dr)
+{
+    switch (dr)
+    {
+    case ADS125x_DR_2_5:    return 400180;
+    case ADS125x_DR_5:      return 200180;
+    case ADS125x_DR_10:     return 100180;
+    case ADS125x_DR_15:     return 66840;
+    case ADS125x_DR_25:     return 40180;
+    case ADS125x_DR_30:     return 33510;
+    case ADS125x_DR_50:     return 20180;
+    case ADS125x_DR_60:     return 16840;
+    case ADS125x_DR_100:    return 10180;
+    case ADS125x_DR_500:    return 2180;
+    case ADS125x_DR_1000:   return 1180;
+    case ADS125x_DR_2000:   return 680;
+    case ADS125x_DR_3750:   return 440;
+    case ADS125x_DR_7500:   return 310;
+    case ADS125x_DR_15000:  return 250;
+    case ADS125x_DR_30000:  return 210;
+    default:                return 0;
+    }
+}
+
+/**
+ * ads125x_cache_regs - Remember register values written to or read from the chip
+ */
+static void ads125x_cache_regs(ads125x_dev *dev, uint8_t regaddr, const uint8_t *data, uint8_t len)
+{
+    for (; len > 0 && regaddr < ADS125x_REG_NUM; --len, ++regaddr, ++data)
+    {
+        dev->regs[regaddr] = *data;
+        dev->regs_valid |= 1 << regaddr;
+    }
+}
+
+/**
+ * ads125x_track_cmd - Update the cached chip state after a command
+ */
+static void ads125x_track_cmd(ads125x_dev *dev, uint8_t cmd)
+{
+    static const uint8_t reset_regs[] = {0x01, 0x01, 0x20, 0xF0, 0xE0};
+
+    switch (cmd)
+    {
+    case ADS125x_CMD_RESET:
+        // The calibration registers keep unknown factory values until read
+        ads125x_cache_regs(dev, ADS125x_REG_ADDR_STATUS, reset_regs, sizeof(reset_regs));
+        dev->regs_valid &= ~ADS125x_REG_CAL_MASK;
+        dev->rdatac = 0;
+        dev->power = ADS125x_POWER_ON;
+        break;
+    case ADS125x_CMD_WAKEUP:
+        dev->power = ADS125x_POWER_ON;
+        break;
+    case ADS125x_CMD_STANDBY:
+        dev->power = ADS125x_POWER_STANDBY;
+        break;
+    case ADS125x_CMD_RDATAC:
+        dev->rdatac = 1;
+        ads125x_predict_reset(dev);
+        break;
+    case ADS125x_CMD_SDATAC:
+        dev->rdatac = 0;
+        break;
+    case ADS125x_CMD_SELFCAL:
+    case ADS125x_CMD_SELFOCAL:
+    case ADS125x_CMD_SELFGCAL:
+    case ADS125x_CMD_SYSOCAL:
+    case ADS125x_CMD_SYSGCAL:
+        dev->regs_valid &= ~ADS125x_REG_CAL_MASK;
+        break;
+    default:
+        break;
+    }
 }
 
 /**
@@ -218,7 +603,7 @@ void ads125xwaitDRDY(struct gpiod_line *line)
  * @speed: Speed of the SPI device.
  * @mode: Clock Phase and Polarity
  * 
- * @return: return a SPI dev descriptors
+ * @return: return a SPI dev descriptors, -1 is failed.
  */
 int SPISetup(const int channel, const int port, const int speed, const int spiBPW, const int mode)
 {
@@ -231,15 +616,17 @@ int SPISetup(const int channel, const int port, const int speed, const int spiBP
 
     // Get SPI dev descriptors
     if ((fd = open(spidev, O_RDWR)) < 0)
-        return FailurePrint("SPI Mode Change failure: %s\n", strerror(errno));
+        return FailurePrint("SPI open %s failure: %s\n", spidev, strerror(errno));
 
     // Set SPI parameters.
-    if (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0)
-        return FailurePrint("SPI Mode Change failure: %s\n", strerror(errno));
-    if (ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &spiBPW) < 0)
-        return FailurePrint("SPI Mode Change failure: %s\n", strerror(errno));
-    if (ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0)
-        return FailurePrint("SPI Mode Change failure: %s\n", strerror(errno));
+    if (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+        ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &spiBPW) < 0 ||
+        ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0)
+    {
+        FailurePrint("SPI Mode Change failure: %s\n", strerror(errno));
+        close(fd);
+        return -1;
+    }
 
     return fd;
 }
@@ -251,13 +638,13 @@ int SPISetup(const int channel, const int port, const int speed, const int spiBP
  * @spiChannel: the SPI bus number
  * @spiPort: the SPI port number
  * 
- * @return: return a SPI dev descriptors
+ * @return: return a SPI dev descriptors, -1 is failed.
  */
 int ads125xSetup(ads125x_dev *dev, int spiChannel, int spiPort)
 {
     int fd;
 
-    fd = SPISetup(0, 0, dev->spi_speed, dev->spi_bit_p_word, dev->spi_mode);
+    fd = SPISetup(spiChannel, spiPort, dev->spi_speed, dev->spi_bit_p_word, dev->spi_mode);
     return fd;
 }
 
@@ -285,8 +672,10 @@ int SPIRelease(const int fd)
  * @dev: The ads125x dev info struct pointer.
  * @psel: Postive Input Channel (AIN_P) select.
  * @nsel: Negative Input Channel (AIN_N) select.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
  */
-void ads125xSetMUX(ads125x_dev *dev, const uint8_t psel, const uint8_t nsel)
+int ads125xSetMUX(ads125x_dev *dev, const uint8_t psel, const uint8_t nsel)
 {
     uint8_t spiTxData[3] = {0};
     int ret;
@@ -306,21 +695,25 @@ void ads125xSetMUX(ads125x_dev *dev, const uint8_t psel, const uint8_t nsel)
     spi.bits_per_word = dev->spi_bit_p_word;
     spi.cs_change = 0;
 
-    while (gpiod_line_get_value(dev->pin_DRDY_line))
-        ;
-    if ((ret = ioctl(dev->fd, SPI_IOC_MESSAGE(1), &spi)) < 0)
-        FailurePrint("Set Data-Rate error: %s\n", strerror(errno));
-    return;
+    if ((ret = ads125xwaitDRDY(dev)) < 0)
+        return ret;
+    if (ads125xTransfer(dev, &spi, 1) < 0)
+        return FailurePrint("Set MUX error: %s\n", strerror(errno));
+    ads125x_cache_regs(dev, ADS125x_REG_ADDR_MUX, spiTxData + 2, 1);
+    return ADS125x_OK;
 }
 
 /**
  * ads125xSetDRATE - set ads125x_dev A/D data rate
  * @dev: The ads125x dev info struct pointer.
  * @dr: Target data rates, see ADS125x_DR_* and the datasheet.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
  */
-void ads125xSetDRATE(ads125x_dev *dev, const uint8_t dr)
+int ads125xSetDRATE(ads125x_dev *dev, const uint8_t dr)
 {
     uint8_t spiTxData[3] = {0};
+    int ret;
     struct spi_ioc_transfer spi;
 
     memset(&spi, 0, sizeof(spi));
@@ -338,33 +731,24 @@ void ads125xSetDRATE(ads125x_dev *dev, const uint8_t dr)
     spi.bits_per_word = dev->spi_bit_p_word;
     spi.cs_change = 0;
 
-    while (gpiod_line_get_value(dev->pin_DRDY_line))
-        ;
-    if (ioctl(dev->fd, SPI_IOC_MESSAGE(1), &spi) < 0)
-        FailurePrint("Set Data-Rate error: %s\n", strerror(errno));
-    return;
+    if ((ret = ads125xwaitDRDY(dev)) < 0)
+        return ret;
+    if (ads125xTransfer(dev, &spi, 1) < 0)
+        return FailurePrint("Set Data-Rate error: %s\n", strerror(errno));
+    ads125x_cache_regs(dev, ADS125x_REG_ADDR_DRATE, spiTxData + 2, 1);
+    return ADS125x_OK;
 }
 
 /**
- * ads125xSendCMD - Send a command to ADS1256
- * @dev: The ads125x dev info struct pointer.
- * @cmd: A command. see ads1256reg.h .
- *
- * This function is intended for sending single-byte commands only,
- * facilitating operations such as wake-up, calibration, and reset.
- * Commands are macro-defined with the `ADS125x_CMD_` prefix.
- *
- * **WARN**: DO NOT USE THIS FUNCTION SEND RDATA/RRED/WREG/RESET COMMAND.
+ * ads125x_send_byte - Send a single-byte command without waiting for DRDY
  */
-void ads125xSendCMD(ads125x_dev *dev, const uint8_t cmd)
+static int ads125x_send_byte(ads125x_dev *dev, const uint8_t cmd)
 {
     uint8_t spiTxData = cmd;
     struct spi_ioc_transfer spi;
 
     memset(&spi, 0, sizeof(spi));
 
-    spiTxData = cmd;
-
     spi.tx_buf = (unsigned long)&spiTxData;
     spi.rx_buf = 0;
     spi.len = 1;
@@ -373,11 +757,32 @@ void ads125xSendCMD(ads125x_dev *dev, const uint8_t cmd)
     spi.bits_per_word = dev->spi_bit_p_word;
     spi.cs_change = 0;
 
-    while (gpiod_line_get_value(dev->pin_DRDY_line))
-        ;
-    if (ioctl(dev->fd, SPI_IOC_MESSAGE(1), &spi) < 0)
-        FailurePrint("Send command error: %s\n", strerror(errno));
-    return;
+    if (ads125xTransfer(dev, &spi, 1) < 0)
+        return FailurePrint("Send command error: %s\n", strerror(errno));
+    ads125x_track_cmd(dev, cmd);
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xSendCMD - Send a command to ADS1256
+ * @dev: The ads125x dev info struct pointer.
+ * @cmd: A command. see ads1256reg.h .
+ *
+ * This function is intended for sending single-byte commands only,
+ * facilitating operations such as wake-up, calibration, and reset.
+ * Commands are macro-defined with the `ADS125x_CMD_` prefix.
+ *
+ * **WARN**: DO NOT USE THIS FUNCTION SEND RDATA/RRED/WREG/RESET COMMAND.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xSendCMD(ads125x_dev *dev, const uint8_t cmd)
+{
+    int ret;
+
+    if ((ret = ads125xwaitDRDY(dev)) < 0)
+        return ret;
+    return ads125x_send_byte(dev, cmd);
 }
 
 /**
@@ -386,16 +791,19 @@ void ads125xSendCMD(ads125x_dev *dev, const uint8_t cmd)
  * @regaddr: The target read register address.
  * @data: Used to store the read data.
  * @len: Read data length, not need to -1
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
  */
-void ads125xRREG(ads125x_dev *dev, const uint8_t regaddr, uint8_t *data, const uint8_t len)
+int ads125xRREG(ads125x_dev *dev, const uint8_t regaddr, uint8_t *data, const uint8_t len)
 {
-    uint8_t *spiTxData = (uint8_t *)malloc(len + 3);
+    uint8_t spiTxData[ADS125x_REG_NUM + 3];
+    int ret;
     struct spi_ioc_transfer spi[2];
 
-    if (len > 0x0A || len < 1)
+    if (len > ADS125x_REG_NUM || len < 1)
     {
-        fprintf(stderr, "ADS125x err: invalid RREG data length %d. (MAX 10 Bytes)\n", len);
-        return;
+        fprintf(stderr, "ADS125x err: invalid RREG data length %d. (MAX %d Bytes)\n", len, ADS125x_REG_NUM);
+        return ADS125x_ERR_INVAL;
     }
     memset(&spi, 0, sizeof(spi));
     memset(spiTxData, 0x0, len + 3);
@@ -420,15 +828,12 @@ void ads125xRREG(ads125x_dev *dev, const uint8_t regaddr, uint8_t *data, const u
     spi[1].bits_per_word = dev->spi_bit_p_word;
     spi[1].cs_change = 0;
 
-    while (gpiod_line_get_value(dev->pin_DRDY_line))
-        ;
-    if (ioctl(dev->fd, SPI_IOC_MESSAGE(2), &spi) < 0)
-    {
-        FailurePrint("WREG err: %s\n", strerror(errno));
-        free(spiTxData);
-    }
-    free(spiTxData);
-    return;
+    if ((ret = ads125xwaitDRDY(dev)) < 0)
+        return ret;
+    if (ads125xTransfer(dev, spi, 2) < 0)
+        return FailurePrint("RREG err: %s\n", strerror(errno));
+    ads125x_cache_regs(dev, regaddr, data, len);
+    return ADS125x_OK;
 }
 
 /**
@@ -437,22 +842,25 @@ void ads125xRREG(ads125x_dev *dev, const uint8_t regaddr, uint8_t *data, const u
  * @regaddr: The target write register address.
  * @data: Used to store the data to be written.
  * @len: Write data length, not need to -1
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
  */
-void ads125xWREG(ads125x_dev *dev, const uint8_t regaddr, uint8_t *data, const uint8_t len)
+int ads125xWREG(ads125x_dev *dev, const uint8_t regaddr, uint8_t *data, const uint8_t len)
 {
-    uint8_t *spiTxData = (uint8_t *)malloc(len + 2);
+    uint8_t spiTxData[ADS125x_REG_NUM + 2];
+    int ret;
     struct spi_ioc_transfer spi;
 
-    if (len > 0x0A)
+    if (len > ADS125x_REG_NUM || len < 1)
     {
-        fprintf(stderr, "%s", "ADS125x err: WREG data too long. (MAX 64 Bytes)\n");
-        return;
+        fprintf(stderr, "ADS125x err: invalid WREG data length %d. (MAX %d Bytes)\n", len, ADS125x_REG_NUM);
+        return ADS125x_ERR_INVAL;
     }
     memset(&spi, 0, sizeof(spi));
     memset(spiTxData, 0x0, len + 2);
 
     spiTxData[0] = ADS125x_CMD_WREG | (regaddr & 0x0F);
-    spiTxData[1] = len & 0x0F;
+    spiTxData[1] = (len - 1) & 0x0F;
     memcpy(spiTxData + 2, data, len);
 
     spi.tx_buf = (unsigned long)spiTxData;
@@ -463,25 +871,25 @@ void ads125xWREG(ads125x_dev *dev, const uint8_t regaddr, uint8_t *data, const u
     spi.bits_per_word = dev->spi_bit_p_word;
     spi.cs_change = 0;
 
-    while (gpiod_line_get_value(dev->pin_DRDY_line))
-        ;
-    if (ioctl(dev->fd, SPI_IOC_MESSAGE(1), &spi) < 0)
-    {
-        FailurePrint("WREG err: %s\n", strerror(errno));
-        free(spiTxData);
-    }
-    free(spiTxData);
-    return;
+    if ((ret = ads125xwaitDRDY(dev)) < 0)
+        return ret;
+    if (ads125xTransfer(dev, &spi, 1) < 0)
+        return FailurePrint("WREG err: %s\n", strerror(errno));
+    ads125x_cache_regs(dev, regaddr, data, len);
+    return ADS125x_OK;
 }
 
 /**
  * ads125xRDATA - ADS125x one-shot read data
  * @dev: The ads125x dev info struct pointer.
  * @data: Used to store the data to be written, please give a 3-Bytes space.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
  */
-void ads125xRDATA(ads125x_dev *dev, uint8_t *data)
+int ads125xRDATA(ads125x_dev *dev, uint8_t *data)
 {
     uint8_t spiTxData[4] = {0};
+    int ret;
     struct spi_ioc_transfer spi[4];
 
     memset(&spi, 0, sizeof(spi));
@@ -521,17 +929,18 @@ void ads125xRDATA(ads125x_dev *dev, uint8_t *data)
     spi[3].bits_per_word = dev->spi_bit_p_word;
     spi[3].cs_change = 0;
 
-    // ads125xwaitDRDY(dev->pin_DRDY_line);
-    if (ioctl(dev->fd, SPI_IOC_MESSAGE(4), &spi) < 0)
-        FailurePrint("RDATA error: %s\n", strerror(errno));
+    // ads125xwaitDRDY(dev);
+    if (ads125xTransfer(dev, spi, 4) < 0)
+        return FailurePrint("RDATA error: %s\n", strerror(errno));
 
-    ads125xwaitDRDY(dev->pin_DRDY_line);
+    if ((ret = ads125xwaitDRDY(dev)) < 0)
+        return ret;
     spiTxData[0] = ADS125x_CMD_STANDBY;
     spi[0].tx_buf = (unsigned long)&spiTxData;
     spi[0].delay_usecs = 0;
-    if (ioctl(dev->fd, SPI_IOC_MESSAGE(1), &spi) < 0)
-        FailurePrint("RDATA error: %s\n", strerror(errno));
-    return;
+    if (ads125xTransfer(dev, spi, 1) < 0)
+        return FailurePrint("RDATA error: %s\n", strerror(errno));
+    return ADS125x_OK;
 }
 
 /**
@@ -539,11 +948,73 @@ void ads125xRDATA(ads125x_dev *dev, uint8_t *data)
  * @dev: The ads125x dev info struct pointer.
  * @data: Used to store the data to be written, please give times*3 space.
  * @times: Read times
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
  */
-void ads125xRDATAC(ads125x_dev *dev, uint8_t *data, int times)
+int ads125xRDATAC(ads125x_dev *dev, uint8_t *data, int times)
 {
-    int i;
-    // int g;
+    int ret;
+
+    if ((ret = ads125xRDATACStart(dev)) < 0)
+        return ret;
+    if ((ret = ads125xRDATACRead(dev, data, times)) < 0)
+    {
+        ads125xRDATACStop(dev);
+        return ret;
+    }
+    return ads125xRDATACStop(dev);
+}
+
+/**
+ * ads125xRDATACStart - Enter ADS125x continuous read mode
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * Use ads125xRDATACRead() to fetch the conversions in blocks and
+ * ads125xRDATACStop() to leave continuous read mode.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xRDATACStart(ads125x_dev *dev)
+{
+    int ret;
+
+    if ((ret = ads125xSendCMD(dev, ADS125x_CMD_RDATAC)) < 0)
+        return ret;
+    dev->rdatac_count = 0;
+    dev->last_sample_ns = ads125xNowNs();
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xRDATACRead - Read conversions in continuous read mode
+ * @dev: The ads125x dev info struct pointer.
+ * @data: Used to store the data to be written, please give times*3 space.
+ * @times: Read times
+ *
+ * With ADS125x_FLAG_RECOVER set in dev->flags, a DRDY timeout or a
+ * failed transfer runs ads125xRecover() and the read goes on, the gap
+ * is recorded in dev->recovery.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xRDATACRead(ads125x_dev *dev, uint8_t *data, int times)
+{
+    return ads125xRDATACReadTs(dev, data, NULL, times);
+}
+
+/**
+ * ads125xRDATACReadTs - Read conversions with their DRDY timestamps
+ * @dev: The ads125x dev info struct pointer.
+ * @data: Used to store the data to be written, please give times*3 space.
+ * @ts: Used to store the DRDY falling edge time of each conversion,
+ *      CLOCK_MONOTONIC ns, see dev->drdy_ns. May be NULL.
+ * @times: Read times
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xRDATACReadTs(ads125x_dev *dev, uint8_t *data, uint64_t *ts, int times)
+{
+    int i, ret, tries = 0;
     struct spi_ioc_transfer spi;
 
     memset(&spi, 0, sizeof(spi));
@@ -555,22 +1026,532 @@ void ads125xRDATAC(ads125x_dev *dev, uint8_t *data, int times)
     spi.bits_per_word = dev->spi_bit_p_word;
     spi.cs_change = 0;
 
-    ads125xSendCMD(dev, ADS125x_CMD_RDATAC);
-    // ads125xwaitDRDY(dev->pin_DRDY_line);
-    // if (ioctl(dev->fd, SPI_IOC_MESSAGE(1), &spi) < 0)
-    //     FailurePrint("Send command error: %s\n", strerror(errno));
     for (i = 0; i < times; ++i)
     {
         spi.rx_buf = (unsigned long)(data + 3 * i);
-        ads125xwaitDRDY(dev->pin_DRDY_line);
-        // while ((g = gpiod_line_get_value(dev->pin_DRDY_line)))
-        //     if (g == -1)
-        //         exit(1);
-        if (ioctl(dev->fd, SPI_IOC_MESSAGE(1), &spi) < 0)
-            FailurePrint("RDATAC error: %s\n", strerror(errno));
-        // printf("time: %d\n", i);
-    }
-    ads125xSendCMD(dev, ADS125x_CMD_SDATAC);
+        if ((ret = ads125xwaitDRDY(dev)) == ADS125x_OK && ads125xTransfer(dev, &spi, 1) < 0)
+            ret = FailurePrint("RDATAC error: %s\n", strerror(errno));
+        if (ret < 0)
+        {
+            if (!(dev->flags & ADS125x_FLAG_RECOVER))
+                return ret;
+            do
+            {
+                if (tries++ >= ADS125x_RECOVER_TRIES)
+                {
+                    dev->recovery.failures++;
+                    return ret;
+                }
+            } while ((ret = ads125xRecover(dev)) < 0);
+            --i;
+            continue;
+        }
+        tries = 0;
+        if (ts)
+            ts[i] = dev->drdy_ns;
+        dev->rdatac_count++;
+        dev->last_sample_ns = ads125xNowNs();
+    }
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xRDATACStop - Leave ADS125x continuous read mode
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xRDATACStop(ads125x_dev *dev)
+{
+    return ads125xSendCMD(dev, ADS125x_CMD_SDATAC);
+}
+
+/**
+ * ads125x_chop_cycle - Start the next chop phase and read the last one
+ * @c: The chopping state.
+ * @data: Used to store the result of the conversion that just finished.
+ *
+ * One SPI message per DRDY: WREG MUX to the next phase, SYNC and WAKEUP
+ * to restart the conversion on it, then RDATA, which still returns the
+ * result of the previous phase. The datasheet cycles the multiplexer
+ * this way, each result is settled.
+ */
+static int ads125x_chop_cycle(ads125x_dev *dev, ads125x_chop *c, uint8_t *data)
+{
+    uint8_t spiTxData[6];
+    int ret;
+    struct spi_ioc_transfer spi[5];
+
+    memset(&spi, 0, sizeof(spi));
+    spiTxData[0] = ADS125x_CMD_WREG | ADS125x_REG_ADDR_MUX;
+    spiTxData[1] = 0x00;
+    spiTxData[2] = c->mux[c->phase ^ 1];
+    spiTxData[3] = ADS125x_CMD_SYNC;
+    spiTxData[4] = ADS125x_CMD_WAKEUP;
+    spiTxData[5] = ADS125x_CMD_RDATA;
+    // WREG
+    spi[0].tx_buf = (unsigned long)spiTxData;
+    spi[0].len = 3;
+    // SYNC, t11 before WAKEUP
+    spi[1].tx_buf = (unsigned long)&spiTxData[3];
+    spi[1].len = 1;
+    spi[1].delay_usecs = 4;
+    // WAKEUP
+    spi[2].tx_buf = (unsigned long)&spiTxData[4];
+    spi[2].len = 1;
+    // RDATA, t6 before the data
+    spi[3].tx_buf = (unsigned long)&spiTxData[5];
+    spi[3].len = 1;
+    spi[3].delay_usecs = ADS125x_T6_US;
+    // Received data
+    spi[4].rx_buf = (unsigned long)data;
+    spi[4].len = 3;
+    for (ret = 0; ret < 5; ++ret)
+    {
+        spi[ret].speed_hz = dev->spi_speed;
+        spi[ret].bits_per_word = dev->spi_bit_p_word;
+    }
+
+    if ((ret = ads125xwaitDRDY(dev)) < 0)
+        return ret;
+    if (ads125xTransfer(dev, spi, 5) < 0)
+        return FailurePrint("Chop error: %s\n", strerror(errno));
+    ads125x_cache_regs(dev, ADS125x_REG_ADDR_MUX, spiTxData + 2, 1);
+    c->phase ^= 1;
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xChopStart - Enter the input-swap chopping mode
+ * @dev: The ads125x dev info struct pointer.
+ * @chop: State of the chopping, owned by the caller until ads125xChopStop().
+ * @psel: Postive Input Channel (AIN_P) select.
+ * @nsel: Negative Input Channel (AIN_N) select.
+ *
+ * Conversions alternate between (P,N) and (N,P), ads125xChopRead()
+ * subtracts each pair, which cancels the offset of the chip and its
+ * drift slower than a pair. Each conversion is restarted by SYNC, so it
+ * takes the settling time, see ads125xDRATEToSettleUs(), and a chopped
+ * result takes two. The chopped rate is at most 1 / (2 * settling time),
+ * well below DRATE / 2: 2.38 kSPS at 30 kSPS, 1.61 kSPS at 7.5 kSPS and
+ * 424 SPS at 1 kSPS, less the time of the SPI message of each
+ * conversion, see ads125xChopGetStats(). Must not be in RDATAC mode.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xChopStart(ads125x_dev *dev, ads125x_chop *chop, const uint8_t psel, const uint8_t nsel)
+{
+    uint8_t spiTxData[5];
+    int ret;
+    struct spi_ioc_transfer spi[2];
+
+    if (dev->rdatac)
+        return ADS125x_ERR_INVAL;
+    memset(chop, 0x00, sizeof(*chop));
+    chop->mux[0] = psel | nsel;
+    chop->mux[1] = (psel >> 4) | (nsel << 4);
+
+    memset(&spi, 0, sizeof(spi));
+    spiTxData[0] = ADS125x_CMD_WREG | ADS125x_REG_ADDR_MUX;
+    spiTxData[1] = 0x00;
+    spiTxData[2] = chop->mux[0];
+    spiTxData[3] = ADS125x_CMD_SYNC;
+    spiTxData[4] = ADS125x_CMD_WAKEUP;
+    spi[0].tx_buf = (unsigned long)spiTxData;
+    spi[0].len = 4;
+    spi[0].delay_usecs = 4;
+    spi[0].speed_hz = dev->spi_speed;
+    spi[0].bits_per_word = dev->spi_bit_p_word;
+    spi[1].tx_buf = (unsigned long)&spiTxData[4];
+    spi[1].len = 1;
+    spi[1].speed_hz = dev->spi_speed;
+    spi[1].bits_per_word = dev->spi_bit_p_word;
+
+    if ((ret = ads125xwaitDRDY(dev)) < 0)
+        return ret;
+    if (ads125xTransfer(dev, spi, 2) < 0)
+        return FailurePrint("Chop start error: %s\n", strerror(errno));
+    ads125x_cache_regs(dev, ADS125x_REG_ADDR_MUX, spiTxData + 2, 1);
+    chop->start_ns = ads125xNowNs();
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xChopRead - Read chopped results
+ * @dev: The ads125x dev info struct pointer.
+ * @chop: Given to ads125xChopStart().
+ * @data: Used to store times results, (P,N) - (N,P) / 2 in codes,
+ *        rounded to the nearest code, halves away from zero.
+ * @ts: Used to store the time of each result, the DRDY edge between its
+ *      two conversions. May be NULL.
+ * @times: Read times
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xChopRead(ads125x_dev *dev, ads125x_chop *chop, int32_t *data, uint64_t *ts, int times)
+{
+    ads125x_chop *c = chop;
+    uint8_t raw[3];
+    int32_t code;
+    double v, d;
+    int i, ret;
+
+    for (i = 0; i < times;)
+    {
+        // The phase flips in ads125x_chop_cycle(), raw is the old phase
+        if ((ret = ads125x_chop_cycle(dev, c, raw)) < 0)
+            return ret;
+        code = convert_to_signed_24bit(raw);
+        if (c->phase == 1)
+        {
+            c->first = code;
+            c->first_ns = dev->drdy_ns;
+            c->pending = 1;
+            continue;
+        }
+        if (!c->pending)
+            continue;
+        c->pending = 0;
+        v = ((double)c->first - code) / 2;
+        // Not the integer division, it truncates odd differences toward zero
+        data[i] = (int32_t)lround(v);
+        if (ts)
+            ts[i] = c->first_ns;
+        ++i;
+        c->offset_sum += ((double)c->first + code) / 2;
+        c->pairs++;
+        d = v - c->mean;
+        c->mean += d / c->pairs;
+        c->m2 += d * (v - c->mean);
+    }
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xChopStop - Leave the chopping mode
+ * @dev: The ads125x dev info struct pointer.
+ * @chop: Given to ads125xChopStart().
+ *
+ * The MUX is set back to (P,N).
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xChopStop(ads125x_dev *dev, const ads125x_chop *chop)
+{
+    return ads125xSetMUX(dev, chop->mux[0] & 0xF0, chop->mux[0] & 0x0F);
+}
+
+/**
+ * ads125xChopGetStats - Get the rate, noise and offset of the chopping mode
+ * @chop: Given to ads125xChopStart().
+ * @stats: Returns the statistics since ads125xChopStart().
+ */
+void ads125xChopGetStats(const ads125x_chop *chop, ads125x_chop_stats *stats)
+{
+    const ads125x_chop *c = chop;
+    uint64_t elapsed = ads125xNowNs() - c->start_ns;
+
+    stats->pairs = c->pairs;
+    stats->rate_sps = elapsed ? c->pairs * 1e9 / elapsed : 0;
+    stats->noise_rms = c->pairs > 1 ? sqrt(c->m2 / (c->pairs - 1)) : 0;
+    stats->offset = c->pairs ? c->offset_sum / c->pairs : 0;
+    return;
+}
+
+/**
+ * ads125xBurstLatencyUs - Expected latency of ads125xBurstRead()
+ * @dr: The data rate of the burst, see ADS125x_DR_*.
+ * @count: Conversions of the burst.
+ *
+ * The settling time, the conversion consumed by RDATAC and @count
+ * conversions. With white noise the result improves by sqrt(@count), so
+ * a burst at a fast DRATE gets to the noise of a slow one sooner than a
+ * single conversion at the slow DRATE, which has to settle too.
+ *
+ * @return: The latency in us, 0 is an invalid data rate.
+ */
+double ads125xBurstLatencyUs(const uint8_t dr, int count)
+{
+    double sps = ads125xDRATEToSPS(dr);
+
+    if (sps == 0)
+        return 0;
+    return ads125xDRATEToSettleUs(dr) + (count + 1) * 1e6 / sps;
+}
+
+/**
+ * ads125x_burst_widen - Sign extend 3 byte conversions to int32
+ *
+ * No branch and no call, the loop vectorizes.
+ */
+static void ads125x_burst_widen(const uint8_t *raw, int32_t *codes, int n)
+{
+    int i;
+
+    for (i = 0; i < n; ++i)
+        codes[i] = (int32_t)((uint32_t)raw[3 * i] << 24 | (uint32_t)raw[3 * i + 1] << 16 |
+                             (uint32_t)raw[3 * i + 2] << 8) >> 8;
+    return;
+}
+
+/**
+ * ads125x_burst_select - Put the k-th smallest code at @k, smaller ones before it
+ */
+static int32_t ads125x_burst_select(int32_t *a, int n, int k)
+{
+    int lo = 0, hi = n - 1, i, j;
+    int32_t pivot, t;
+
+    while (lo < hi)
+    {
+        pivot = a[lo + (hi - lo) / 2];
+        for (i = lo, j = hi; i <= j;)
+        {
+            while (a[i] < pivot)
+                ++i;
+            while (a[j] > pivot)
+                --j;
+            if (i <= j)
+            {
+                t = a[i];
+                a[i++] = a[j];
+                a[j--] = t;
+            }
+        }
+        if (k <= j)
+            hi = j;
+        else if (k >= i)
+            lo = i;
+        else
+            break;
+    }
+    return a[k];
+}
+
+/**
+ * ads125x_burst_filter - Mean or median and noise of the conversions of a burst
+ */
+static void ads125x_burst_filter(int32_t *codes, int n, int filter, ads125x_burst *result)
+{
+    int64_t sum = 0, dsum = 0, dsq = 0, d;
+    int32_t mean, below, med;
+    int i;
+
+    // Integer sums are exact, deviations from the integer mean keep the squares small
+    for (i = 0; i < n; ++i)
+        sum += codes[i];
+    mean = (int32_t)(sum / n);
+    for (i = 0; i < n; ++i)
+    {
+        d = codes[i] - mean;
+        dsum += d;
+        dsq += d * d;
+    }
+    result->count = n;
+    result->value = (double)sum / n;
+    result->noise_rms = n > 1 ? sqrt(((double)dsq - (double)dsum * dsum / n) / (n - 1)) : 0;
+    result->noise = result->noise_rms / sqrt(n);
+    if (filter != ADS125x_BURST_MEDIAN)
+        return;
+
+    result->value = ads125x_burst_select(codes, n, n / 2);
+    if (n % 2 == 0)
+    {
+        for (below = codes[0], i = 1; i < n / 2; ++i)
+            below = codes[i] > below ? codes[i] : below;
+        result->value = (result->value + below) / 2;
+    }
+    // Spikes the median rejects would dominate the standard deviation, use the MAD
+    med = (int32_t)result->value;
+    for (i = 0; i < n; ++i)
+        codes[i] = codes[i] > med ? codes[i] - med : med - codes[i];
+    result->noise_rms = 1.4826 * ads125x_burst_select(codes, n, n / 2);
+    result->noise = result->noise_rms / sqrt(n) * sqrt(M_PI / 2);
+    return;
+}
+
+/**
+ * ads125xBurstRead - One-shot read averaged over a burst of conversions
+ * @dev: The ads125x dev info struct pointer, not in RDATAC mode.
+ * @dr: The data rate of the burst, see ADS125x_DR_*, the DRATE of the
+ *      device is set back afterwards.
+ * @count: Conversions, up to ADS125x_BURST_MAX.
+ * @filter: ADS125x_BURST_MEAN or ADS125x_BURST_MEDIAN, the median
+ *          rejects spikes at the cost of a sqrt(pi / 2) higher noise.
+ * @result: Used to store the value, its noise and the latency.
+ *
+ * SYNC and WAKEUP start the burst so that only settled conversions are
+ * read, then @count conversions are read in RDATAC. The DRATE is set
+ * back even if the burst fails.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xBurstRead(ads125x_dev *dev, const uint8_t dr, int count, int filter, ads125x_burst *result)
+{
+    uint8_t raw[ADS125x_BURST_MAX * ADS125x_DATA_LEN_BYTE];
+    int32_t codes[ADS125x_BURST_MAX];
+    uint8_t old_dr = dev->regs[ADS125x_REG_ADDR_DRATE];
+    int restore = (dev->regs_valid & (1 << ADS125x_REG_ADDR_DRATE)) && old_dr != dr;
+    uint64_t start = ads125xNowNs();
+    int ret, err;
+
+    if (count < 1 || count > ADS125x_BURST_MAX || dev->rdatac || ads125xDRATEToSPS(dr) == 0 ||
+        (filter != ADS125x_BURST_MEAN && filter != ADS125x_BURST_MEDIAN))
+        return ADS125x_ERR_INVAL;
+    if ((!(dev->regs_valid & (1 << ADS125x_REG_ADDR_DRATE)) || old_dr != dr) &&
+        (ret = ads125xSetDRATE(dev, dr)) < 0)
+        return ret;
+    if ((ret = ads125xSendCMD(dev, ADS125x_CMD_SYNC)) >= 0 && (ret = ads125xWAKEUP(dev)) >= 0 &&
+        (ret = ads125xRDATACStart(dev)) >= 0)
+    {
+        ret = ads125xRDATACRead(dev, raw, count);
+        if ((err = ads125xRDATACStop(dev)) < 0 && ret >= 0)
+            ret = err;
+    }
+    // A failed burst still leaves the device at its DRATE
+    if (restore && (err = ads125xSetDRATE(dev, old_dr)) < 0 && ret >= 0)
+        ret = err;
+    if (ret < 0)
+        return ret;
+
+    ads125x_burst_widen(raw, codes, count);
+    ads125x_burst_filter(codes, count, filter, result);
+    result->latency_ns = ads125xNowNs() - start;
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xControlRun - Run a control callback on every conversion
+ * @dev: The ads125x dev info struct pointer.
+ * @control: Latency accounting of the run, owned by the caller.
+ * @fn: Called with each conversion right after it is read.
+ * @arg: Passed to @fn.
+ * @deadline_ns: Deadline from DRDY to the return of @fn, 0 is none.
+ * @count: Conversions, 0 is until @fn stops.
+ *
+ * Enters RDATAC and for each DRDY reads the 3 bytes and calls @fn on
+ * the same thread, with no block buffer in between. The SPI transfer is
+ * set up once, and on hardware the bytes are read() from spidev, which
+ * skips the transfer array of SPI_IOC_MESSAGE. For the lowest latency
+ * run on an isolated core with ADS125x_WAIT_SPIN or ADS125x_WAIT_PREDICT.
+ *
+ * @control is reset here and updated after every call, see
+ * ads125xControlGetStats(). Overruns are only counted when the DRATE
+ * register is cached. A failed read ends the run, without
+ * ads125xRecover().
+ *
+ * @return: ADS125x_OK, the error returned by @fn, or a ADS125x_ERR_* error.
+ */
+int ads125xControlRun(ads125x_dev *dev, ads125x_control *control, ads125x_control_fn fn, void *arg, uint64_t deadline_ns,
+                      uint64_t count)
+{
+    ads125x_control *c = control;
+    uint8_t raw[ADS125x_DATA_LEN_BYTE];
+    uint64_t i, called, returned, lat, last = 0, gap, period;
+    double sps = 0;
+    int ret, stop;
+    struct spi_ioc_transfer spi;
+
+    if (!c || !fn || dev->rdatac)
+        return ADS125x_ERR_INVAL;
+    memset(c, 0x00, sizeof(*c));
+    c->deadline_ns = deadline_ns;
+    // With the DRATE not cached the period is unknown, overruns are not counted
+    if (dev->regs_valid & (1 << ADS125x_REG_ADDR_DRATE))
+        sps = ads125xDRATEToSPS(dev->regs[ADS125x_REG_ADDR_DRATE]);
+    period = sps ? (uint64_t)(1e9 / sps) : 0;
+
+    memset(&spi, 0, sizeof(spi));
+    spi.rx_buf = (unsigned long)raw;
+    spi.len = ADS125x_DATA_LEN_BYTE;
+    spi.speed_hz = dev->spi_speed;
+    spi.bits_per_word = dev->spi_bit_p_word;
+
+    if ((ret = ads125xRDATACStart(dev)) < 0)
+        return ret;
+    for (i = 0; count == 0 || i < count; ++i)
+    {
+        if ((ret = ads125xwaitDRDY(dev)) < 0)
+            break;
+        if (dev->backend)
+            ret = ads125xTransfer(dev, &spi, 1);
+        else
+        {
+            dev->io.transfers++;
+            ret = read(dev->fd, raw, ADS125x_DATA_LEN_BYTE) == ADS125x_DATA_LEN_BYTE ? 0 : -1;
+        }
+        if (ret < 0)
+        {
+            ret = FailurePrint("Control read error: %s\n", strerror(errno));
+            break;
+        }
+        called = ads125xNowNs();
+        stop = fn(arg, (int32_t)((uint32_t)raw[0] << 24 | (uint32_t)raw[1] << 16 | (uint32_t)raw[2] << 8) >> 8,
+                  dev->drdy_ns);
+        returned = ads125xNowNs();
+
+        lat = called > dev->drdy_ns ? called - dev->drdy_ns : 0;
+        returned = returned > dev->drdy_ns ? returned - dev->drdy_ns : 0;
+        c->calls++;
+        c->lat_sum_ns += lat;
+        c->lat_max_ns = lat > c->lat_max_ns ? lat : c->lat_max_ns;
+        c->done_max_ns = returned > c->done_max_ns ? returned : c->done_max_ns;
+        c->hist[lat / ADS125x_CONTROL_BUCKET_NS < ADS125x_CONTROL_BUCKETS ? lat / ADS125x_CONTROL_BUCKET_NS
+                                                                         : ADS125x_CONTROL_BUCKETS - 1]++;
+        if (deadline_ns && returned > deadline_ns)
+            c->misses++;
+        // The chip overwrites a conversion that was not read before the next DRDY
+        if (period && last && (gap = dev->drdy_ns - last) > period + period / 2)
+            c->overruns += (gap + period / 2) / period - 1;
+        last = dev->drdy_ns;
+        dev->rdatac_count++;
+        dev->last_sample_ns = called;
+        if (stop)
+        {
+            ret = stop < 0 ? stop : ADS125x_OK;
+            break;
+        }
+    }
+    stop = ads125xRDATACStop(dev);
+    return ret < 0 ? ret : stop;
+}
+
+/**
+ * ads125xControlGetStats - Get the latencies and deadline misses of the control mode
+ * @control: Given to ads125xControlRun().
+ * @stats: Returns the statistics since ads125xControlRun() started. From
+ *         another thread during the run they are approximate.
+ */
+void ads125xControlGetStats(const ads125x_control *control, ads125x_control_stats *stats)
+{
+    const ads125x_control *c = control;
+    uint64_t seen = 0;
+    double edge;
+    int i;
+
+    memset(stats, 0x00, sizeof(*stats));
+    stats->calls = c->calls;
+    stats->misses = c->misses;
+    stats->overruns = c->overruns;
+    if (!c->calls)
+        return;
+    stats->lat_mean_us = c->lat_sum_ns * 1e-3 / c->calls;
+    stats->lat_max_us = c->lat_max_ns * 1e-3;
+    stats->done_max_us = c->done_max_ns * 1e-3;
+    // Upper edge of the bucket, the last bucket is open so it ends at the maximum
+    for (i = 0; i < ADS125x_CONTROL_BUCKETS; ++i)
+    {
+        seen += c->hist[i];
+        edge = i + 1 < ADS125x_CONTROL_BUCKETS ? (i + 1) * ADS125x_CONTROL_BUCKET_NS * 1e-3 : stats->lat_max_us;
+        edge = edge < stats->lat_max_us ? edge : stats->lat_max_us;
+        if (!stats->lat_p50_us && seen * 2 >= c->calls)
+            stats->lat_p50_us = edge;
+        if (seen * 100 >= c->calls * 99)
+        {
+            stats->lat_p99_us = edge;
+            break;
+        }
+    }
     return;
 }
 
@@ -579,41 +1560,268 @@ void ads125xRDATAC(ads125x_dev *dev, uint8_t *data, int times)
  * @dev: The ads125x dev info struct pointer.
  * @status: PDWN status, 0 is low, 1 is high.
  *
- * @return: 0 success
- *          1 is Invalid status.
- *          2 is set gpio line value failed.
+ * A backend drives its own PDWN, see ads125x_backend.set_pdwn.
+ *
+ * @return: ADS125x_OK, ADS125x_ERR_INVAL is a status other than 0 or 1,
+ *          ADS125x_ERR_IO is set the line failed.
  */
 int ads125xSetPDWN(ads125x_dev *dev, uint8_t status)
 {
     if (status & 0xFE)
     {
         fprintf(stderr, "Invalid status %d.\n", status);
-        return 1;
+        return ADS125x_ERR_INVAL;
     }
-    return (gpiod_line_set_value(dev->pin_PDWN_line, status));
+    if (dev->backend)
+        return dev->backend->set_pdwn && dev->backend->set_pdwn(dev, status) >= 0 ? ADS125x_OK : ADS125x_ERR_IO;
+    return gpiod_line_set_value(dev->pin_PDWN_line, status) < 0 ? ADS125x_ERR_IO : ADS125x_OK;
 }
 
 /**
  * ads125xRESET - Send RESET command to ADS1256
  * 
  * @dev: The ads125x dev info struct pointer.
+ *
+ * RESET is sent without waiting for DRDY, so it also works on a chip
+ * whose DRDY is stuck.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
  */
-void ads125xRESET(ads125x_dev *dev)
+int ads125xRESET(ads125x_dev *dev)
 {
-    uint8_t spiTxData = ADS125x_CMD_RESET;
-    struct spi_ioc_transfer spi;
+    return ads125x_send_byte(dev, ADS125x_CMD_RESET);
+}
 
-    memset(&spi, 0, sizeof(spi));
+/**
+ * ads125xWAKEUP - Leave standby mode and start a conversion
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * Sent without waiting for DRDY, the conversion is ready after the
+ * settling time of the DRATE, see ads125xDRATEToSettleUs().
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xWAKEUP(ads125x_dev *dev)
+{
+    return ads125x_send_byte(dev, ADS125x_CMD_WAKEUP);
+}
 
-    spi.tx_buf = (unsigned long)&spiTxData;
-    spi.rx_buf = 0;
-    spi.len = 1;
-    spi.delay_usecs = 0;
-    spi.speed_hz = dev->spi_speed;
-    spi.bits_per_word = dev->spi_bit_p_word;
-    spi.cs_change = 0;
+/**
+ * ads125xSTANDBY - Enter standby mode
+ * @dev: The ads125x dev info struct pointer, not in RDATAC mode.
+ *
+ * The analog part and the digital filter stop, the oscillator and the
+ * registers are kept, so ads125xWAKEUP() costs only the settling time.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xSTANDBY(ads125x_dev *dev)
+{
+    if (dev->rdatac)
+        return ADS125x_ERR_INVAL;
+    return ads125x_send_byte(dev, ADS125x_CMD_STANDBY);
+}
 
-    if (ioctl(dev->fd, SPI_IOC_MESSAGE(1), &spi) < 0)
-        FailurePrint("Send command error: %s\n", strerror(errno));
-    return;
-}
\ No newline at end of file
+/**
+ * ads125x_restore_regs - Write back each run of known registers
+ */
+static int ads125x_restore_regs(ads125x_dev *dev, const uint8_t *regs, uint16_t valid)
+{
+    uint8_t buf[ADS125x_REG_NUM];
+    int first, last, ret;
+
+    memcpy(buf, regs, sizeof(buf));
+    for (first = 0; first < ADS125x_REG_NUM; first = last)
+    {
+        for (; first < ADS125x_REG_NUM && !(valid & (1 << first)); ++first)
+            ;
+        for (last = first; last < ADS125x_REG_NUM && (valid & (1 << last)); ++last)
+            ;
+        if (last > first && (ret = ads125xWREG(dev, first, buf + first, last - first)) < 0)
+            return ret;
+    }
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xPowerDown - Power the chip down through PDWN
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * Everything stops, the oscillator too. The register cache is kept for
+ * ads125xPowerUp().
+ *
+ * @return: ADS125x_OK, ADS125x_ERR_INVAL is no PDWN line,
+ *          ADS125x_ERR_IO is set PDWN failed.
+ */
+int ads125xPowerDown(ads125x_dev *dev)
+{
+    if (!dev->pin_PDWN_line && !(dev->backend && dev->backend->set_pdwn))
+        return ADS125x_ERR_INVAL;
+    if (ads125xSetPDWN(dev, 0) < 0)
+        return ADS125x_ERR_IO;
+    dev->rdatac = 0;
+    dev->power = ADS125x_POWER_DOWN;
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xPowerUp - Power the chip up and bring back its cached state
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * Waits for the oscillator, ADS125x_PDWN_WAKE_US, then writes back the
+ * cached configuration and calibration registers instead of calibrating
+ * again. The chip converts with them after the next SYNC and WAKEUP.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xPowerUp(ads125x_dev *dev)
+{
+    uint8_t regs[ADS125x_REG_NUM];
+    uint16_t valid = dev->regs_valid;
+    unsigned int timeout = dev->drdy_timeout_us;
+    int ret;
+
+    memcpy(regs, dev->regs, sizeof(regs));
+    if (ads125xSetPDWN(dev, 1) < 0)
+        return ADS125x_ERR_IO;
+    ads125x_track_cmd(dev, ADS125x_CMD_RESET);
+    // The first DRDY comes after the oscillator and a settling time at the reset DRATE
+    dev->drdy_timeout_us = ADS125x_PDWN_WAKE_US * 2 + ADS125x_DRDY_TIMEOUT_MARGIN_US;
+    ret = ads125xwaitDRDY(dev);
+    dev->drdy_timeout_us = timeout;
+    if (ret < 0)
+        return ret;
+    return ads125x_restore_regs(dev, regs, valid);
+}
+
+/**
+ * ads125x_calibrate - Run a calibration command and cache its result
+ */
+static int ads125x_calibrate(ads125x_dev *dev, const uint8_t cmd)
+{
+    uint8_t cal[ADS125x_REG_NUM];
+    uint64_t deadline;
+    int ret;
+
+    if ((ret = ads125xSendCMD(dev, cmd)) < 0)
+        return ret;
+    // DRDY goes high while calibrating, and low when the calibration is done
+    deadline = ads125xNowNs() + ADS125x_CAL_DRDY_HIGH_US * 1000ULL;
+    while (ads125xGetDRDY(dev) == 0 && ads125xNowNs() < deadline)
+        ;
+    if ((ret = ads125xwaitDRDY(dev)) < 0)
+        return ret;
+    return ads125xRREG(dev, ADS125x_REG_ADDR_OFC0, cal, ADS125x_REG_ADDR_FSC2 - ADS125x_REG_ADDR_OFC0 + 1);
+}
+
+/**
+ * ads125xSELFCAL - Self offset and gain calibration
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * Waits for the calibration and caches the OFC/FSC registers, so that
+ * ads125xRecover() can restore them without calibrating again.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xSELFCAL(ads125x_dev *dev)
+{
+    return ads125x_calibrate(dev, ADS125x_CMD_SELFCAL);
+}
+
+/**
+ * ads125xSELFOCAL - Self offset calibration, see ads125xSELFCAL()
+ */
+int ads125xSELFOCAL(ads125x_dev *dev)
+{
+    return ads125x_calibrate(dev, ADS125x_CMD_SELFOCAL);
+}
+
+/**
+ * ads125xSELFGCAL - Self gain calibration, see ads125xSELFCAL()
+ */
+int ads125xSELFGCAL(ads125x_dev *dev)
+{
+    return ads125x_calibrate(dev, ADS125x_CMD_SELFGCAL);
+}
+
+/**
+ * ads125xSYSOCAL - System offset calibration, see ads125xSELFCAL()
+ */
+int ads125xSYSOCAL(ads125x_dev *dev)
+{
+    return ads125x_calibrate(dev, ADS125x_CMD_SYSOCAL);
+}
+
+/**
+ * ads125xSYSGCAL - System gain calibration, see ads125xSELFCAL()
+ */
+int ads125xSYSGCAL(ads125x_dev *dev)
+{
+    return ads125x_calibrate(dev, ADS125x_CMD_SYSGCAL);
+}
+
+/**
+ * ads125xRecover - Bring a failing ADS1256 back to its cached state
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * Sends SDATAC and RESET, power cycles the chip through PDWN if DRDY
+ * still does not come back, writes back the cached configuration and
+ * calibration registers, and enters RDATAC again if the device was
+ * streaming. The conversions missed while streaming are counted in
+ * dev->recovery.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xRecover(ads125x_dev *dev)
+{
+    uint8_t regs[ADS125x_REG_NUM];
+    uint16_t valid = dev->regs_valid;
+    int streaming = dev->rdatac;
+    int ret;
+    uint64_t now, gap, lost;
+    double sps;
+
+    memcpy(regs, dev->regs, sizeof(regs));
+
+    // DRDY may be stuck, do not wait for it before SDATAC and RESET
+    ads125x_send_byte(dev, ADS125x_CMD_SDATAC);
+    ret = ads125xRESET(dev);
+    if (ret == ADS125x_OK)
+        ret = ads125xwaitDRDY(dev);
+    if (ret < 0 && !dev->backend && dev->pin_PDWN_line)
+    {
+        if ((ret = ads125xSetPDWN(dev, 0)) < 0)
+            return ret;
+        usleep(ADS125x_RECOVER_PDWN_US);
+        if ((ret = ads125xSetPDWN(dev, 1)) < 0)
+            return ret;
+        ads125x_track_cmd(dev, ADS125x_CMD_RESET);
+        ret = ads125xwaitDRDY(dev);
+    }
+    if (ret < 0)
+        return ret;
+
+    if ((ret = ads125x_restore_regs(dev, regs, valid)) < 0)
+        return ret;
+    if ((ret = ads125xSendCMD(dev, ADS125x_CMD_SYNC)) < 0 ||
+        (ret = ads125x_send_byte(dev, ADS125x_CMD_WAKEUP)) < 0)
+        return ret;
+
+    if (streaming)
+    {
+        if ((ret = ads125xSendCMD(dev, ADS125x_CMD_RDATAC)) < 0)
+            return ret;
+        now = ads125xNowNs();
+        gap = now - dev->last_sample_ns;
+        sps = ads125xDRATEToSPS(dev->regs[ADS125x_REG_ADDR_DRATE]);
+        lost = (uint64_t)(gap * 1e-9 * sps + 0.5);
+        dev->recovery.lost_samples += lost ? lost - 1 : 0;
+        dev->recovery.last_index = dev->rdatac_count;
+        dev->recovery.last_gap_ns = gap;
+        dev->last_sample_ns = now;
+    }
+    dev->recovery.count++;
+    if (ADS125xDriverDebug)
+        fprintf(stdout, "ADS125x recovered, %llu conversions lost.\n", (unsigned long long)dev->recovery.lost_samples);
+    return ADS125x_OK;
+}
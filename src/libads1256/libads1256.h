@@ -31,10 +31,261 @@
  *             https://www.ti.com/lit/gpn/ads1255
  */
 
+#ifndef LIBADS1256_H
+#define LIBADS1256_H
+
 #include <stdint.h>
 #include <gpiod.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define ADS125x_DATA_LEN_BYTE 3
+#define ADS125x_REG_NUM 11
+// OFC0 ~ FSC2 in ads125x_dev.regs_valid
+#define ADS125x_REG_CAL_MASK 0x07E0
+
+// ads125x_dev.power
+#define ADS125x_POWER_ON 0
+#define ADS125x_POWER_STANDBY 1  // STANDBY, left with WAKEUP
+#define ADS125x_POWER_DOWN 2     // PDWN low, the registers are lost
+
+// Return values of the ads125x* functions that talk to the chip
+#define ADS125x_OK 0
+#define ADS125x_ERR_IO -1
+#define ADS125x_ERR_TIMEOUT -2
+#define ADS125x_ERR_INVAL -3
+#define ADS125x_ERR_OVERRUN -4   // A reader fell behind and samples were lost
+
+// ads125x_dev.flags
+#define ADS125x_FLAG_RECOVER 0x01
+
+#define ADS125x_DRDY_TIMEOUT_PERIODS 4
+#define ADS125x_DRDY_TIMEOUT_MARGIN_US 2000
+#define ADS125x_CAL_DRDY_HIGH_US 1000
+#define ADS125x_RECOVER_TRIES 3
+#define ADS125x_RECOVER_PDWN_US 1000
+// Crystal oscillator start-up after PDWN goes high, typical
+#define ADS125x_PDWN_WAKE_US 30000
+
+// ads125x_dev.wait_mode, how ads125xwaitDRDY() polls DRDY
+#define ADS125x_WAIT_SPIN 0
+#define ADS125x_WAIT_YIELD 1    // sched_yield() between polls
+#define ADS125x_WAIT_SLEEP 2    // Sleep ADS125x_WAIT_SLEEP_US between polls
+#define ADS125x_WAIT_PREDICT 3  // In RDATAC, sleep until just before the predicted edge, needs dev->predict
+#define ADS125x_WAIT_SLEEP_US 50
+#define ADS125x_PREDICT_MARGIN_US 100       // Initial margin before the predicted edge
+#define ADS125x_PREDICT_MARGIN_MIN_US 10
+// RDATA or RREG command to the first data bit, t6 = 50 tCLKIN
+#define ADS125x_T6_US 7
+
+struct spi_ioc_transfer;
+struct ads125x_dev_struct;
+struct ads125x_latest_struct;
+
+/**
+ * ads125x_backend - Transport used by a ads125x_dev instead of spidev/gpiod
+ * @name: Backend name, for debug output.
+ * @transfer: Execute @n SPI transfers as one message, like SPI_IOC_MESSAGE(n).
+ *            Return < 0 on failure.
+ * @get_drdy: Return the DRDY level, 0 is low (data ready), 1 is high.
+ * @drdy_time: Optional, return the CLOCK_MONOTONIC time in ns at which
+ *             DRDY went low, 0 is unknown.
+ * @event_fd: Return a fd which polls readable when DRDY goes low.
+ * @event_arm: Clear the event fd and arm it for the next DRDY falling edge.
+ * @set_pdwn: Optional, drive PDWN, 0 powers the chip down. Return < 0 on
+ *            failure.
+ * @release: Free the backend private data.
+ *
+ * A device with a NULL backend talks to the real hardware.
+ */
+typedef struct ads125x_backend_struct
+{
+    const char *name;
+    int (*transfer)(struct ads125x_dev_struct *dev, struct spi_ioc_transfer *xfer, int n);
+    int (*get_drdy)(struct ads125x_dev_struct *dev);
+    uint64_t (*drdy_time)(struct ads125x_dev_struct *dev);
+    int (*event_fd)(struct ads125x_dev_struct *dev);
+    int (*event_arm)(struct ads125x_dev_struct *dev);
+    int (*set_pdwn)(struct ads125x_dev_struct *dev, int level);
+    void (*release)(struct ads125x_dev_struct *dev);
+} ads125x_backend;
+
+/**
+ * ads125x_recovery - Recovery statistics of a device
+ * @count: Successful ads125xRecover() calls.
+ * @failures: Reads that gave up after ADS125x_RECOVER_TRIES recoveries.
+ * @lost_samples: Conversions estimated lost during recoveries while streaming.
+ * @last_index: Index of the first sample read after the last recovery.
+ * @last_gap_ns: Time between the last good sample and the end of the last recovery.
+ */
+typedef struct ads125x_recovery_struct
+{
+    uint64_t count;
+    uint64_t failures;
+    uint64_t lost_samples;
+    uint64_t last_index;
+    uint64_t last_gap_ns;
+} ads125x_recovery;
+
+/**
+ * ads125x_io_stats - Bus and DRDY activity of a device
+ * @transfers: SPI messages, one ioctl each on hardware.
+ * @drdy_polls: DRDY reads, one ioctl each on hardware.
+ * @sleeps: sched_yield() or sleep calls while waiting for DRDY.
+ */
+typedef struct ads125x_io_stats_struct
+{
+    uint64_t transfers;
+    uint64_t drdy_polls;
+    uint64_t sleeps;
+} ads125x_io_stats;
+
+/**
+ * ads125x_predict - DRDY edge prediction of ADS125x_WAIT_PREDICT
+ * @edge_ns: Last DRDY falling edge, 0 is none since RDATAC.
+ * @period_ns: Measured DRDY period, starts at the DRATE period.
+ * @margin_ns: Wake up this long before the predicted edge.
+ * @wake_lat_ns: Smoothed lateness of the wakeups.
+ */
+typedef struct ads125x_predict_struct
+{
+    uint64_t edge_ns;
+    uint64_t period_ns;
+    uint64_t margin_ns;
+    uint64_t wake_lat_ns;
+} ads125x_predict;
+
+/**
+ * ads125x_chop - State of the input-swap chopping mode
+ * @mux: MUX of the two phases, (P,N) then (N,P).
+ * @phase: Phase of the conversion running on the chip.
+ * @pending: ads125xChopRead() has the first phase of a pair.
+ * @first: Result of that first phase, in codes.
+ * @first_ns: DRDY time of that first phase.
+ * @pairs: Chopped results since ads125xChopStart().
+ * @start_ns: Time of ads125xChopStart().
+ * @mean: Running mean of the chopped results.
+ * @m2: Running sum of their squared deviations from the mean.
+ * @offset_sum: Sum of the offsets (first + second) / 2 of the pairs.
+ */
+typedef struct ads125x_chop_struct
+{
+    uint8_t mux[2];
+    uint8_t phase;
+    uint8_t pending;
+    int32_t first;
+    uint64_t first_ns;
+    uint64_t pairs;
+    uint64_t start_ns;
+    double mean;
+    double m2;
+    double offset_sum;
+} ads125x_chop;
+
+/**
+ * ads125x_chop_stats - What the chopping mode achieves
+ * @rate_sps: Chopped results per second since ads125xChopStart().
+ * @noise_rms: Standard deviation of the chopped results, in codes.
+ * @offset: Mean offset cancelled by the chopping, in codes.
+ * @pairs: Chopped results since ads125xChopStart().
+ */
+typedef struct ads125x_chop_stats_struct
+{
+    double rate_sps;
+    double noise_rms;
+    double offset;
+    uint64_t pairs;
+} ads125x_chop_stats;
+
+// ads125xBurstRead() filters
+#define ADS125x_BURST_MEAN 0
+#define ADS125x_BURST_MEDIAN 1
+#define ADS125x_BURST_MAX 2048  // Conversions of a burst
+
+/**
+ * ads125x_burst - Result of a burst one-shot read
+ * @value: Mean or median of the conversions, in codes.
+ * @noise_rms: Standard deviation of the conversions, in codes, from the
+ *             median absolute deviation for the median.
+ * @noise: Expected standard deviation of @value, in codes. @noise_rms
+ *         over sqrt(@count), sqrt(pi / 2) times that for the median.
+ * @latency_ns: From the call to the result, settling time included.
+ * @count: Conversions filtered.
+ */
+typedef struct ads125x_burst_struct
+{
+    double value;
+    double noise_rms;
+    double noise;
+    uint64_t latency_ns;
+    int count;
+} ads125x_burst;
+
+// ads125xControlRun() latency histogram
+#define ADS125x_CONTROL_BUCKETS 128
+#define ADS125x_CONTROL_BUCKET_NS 1000  // The last bucket also holds all later calls
+
+/**
+ * ads125x_control_fn - Control callback of ads125xControlRun()
+ * @arg: Given to ads125xControlRun().
+ * @code: The conversion, sign-extended.
+ * @ts: Its DRDY falling edge, CLOCK_MONOTONIC ns.
+ *
+ * Runs on the acquisition thread before the next DRDY is waited for, a
+ * callback longer than a conversion period loses conversions.
+ *
+ * @return: 0 to go on, > 0 to stop, or a ADS125x_ERR_* error to stop with.
+ */
+typedef int (*ads125x_control_fn)(void *arg, int32_t code, uint64_t ts);
+
+/**
+ * ads125x_control - Latency accounting of the closed-loop control mode
+ * @deadline_ns: From DRDY to the return of the callback, 0 is none.
+ * @calls: Callbacks since ads125xControlRun() started.
+ * @misses: Callbacks that returned after @deadline_ns.
+ * @overruns: Conversions lost between two callbacks, from DRDY gaps
+ *            longer than 1.5 periods.
+ * @lat_sum_ns: Sum of the DRDY to callback latencies.
+ * @lat_max_ns: Largest DRDY to callback latency.
+ * @done_max_ns: Largest DRDY to callback return time.
+ * @hist: DRDY to callback latencies, ADS125x_CONTROL_BUCKET_NS per bucket.
+ */
+typedef struct ads125x_control_struct
+{
+    uint64_t deadline_ns;
+    uint64_t calls;
+    uint64_t misses;
+    uint64_t overruns;
+    uint64_t lat_sum_ns;
+    uint64_t lat_max_ns;
+    uint64_t done_max_ns;
+    uint64_t hist[ADS125x_CONTROL_BUCKETS];
+} ads125x_control;
+
+/**
+ * ads125x_control_stats - Latency summary of the closed-loop control mode
+ * @calls: Callbacks since ads125xControlRun() started.
+ * @misses: Callbacks that returned after the deadline.
+ * @overruns: Conversions lost between two callbacks.
+ * @lat_mean_us: Mean DRDY to callback latency.
+ * @lat_p50_us: Median of it, from the histogram.
+ * @lat_p99_us: 99th percentile of it, from the histogram.
+ * @lat_max_us: Largest of it.
+ * @done_max_us: Largest DRDY to callback return time.
+ */
+typedef struct ads125x_control_stats_struct
+{
+    uint64_t calls;
+    uint64_t misses;
+    uint64_t overruns;
+    double lat_mean_us;
+    double lat_p50_us;
+    double lat_p99_us;
+    double lat_max_us;
+    double done_max_us;
+} ads125x_control_stats;
 
 typedef struct ads125x_dev_struct
 {
@@ -49,6 +300,33 @@ typedef struct ads125x_dev_struct
 
     struct gpiod_chip *pin_PDWN_chip;
     struct gpiod_line *pin_PDWN_line;
+
+    const ads125x_backend *backend;
+    void *backend_data;
+
+    // Register cache, bit n of regs_valid is set when regs[n] is known
+    uint8_t regs[ADS125x_REG_NUM];
+    uint16_t regs_valid;
+    uint8_t rdatac;
+    uint8_t power;
+
+    int flags;
+    // 0 is derived from DRATE, see ads125xDRDYTimeout()
+    unsigned int drdy_timeout_us;
+    uint64_t rdatac_count;
+    uint64_t last_sample_ns;
+    ads125x_recovery recovery;
+
+    int wait_mode;
+    // DRDY line requested for falling edge events, see ads125xDRDYEventFd()
+    uint8_t drdy_events;
+    // Time DRDY went low before the last completed ads125xwaitDRDY()
+    uint64_t drdy_ns;
+    ads125x_io_stats io;
+    // State of ADS125x_WAIT_PREDICT owned by the caller, NULL spins instead
+    ads125x_predict *predict;
+    // Latest-value cache, see libads1256latest.h
+    struct ads125x_latest_struct *latest;
 } ads125x_dev;
 
 int FailurePrint(const char *message, ...);
@@ -57,24 +335,54 @@ int ads125xGetGPIOLine(char *chip, int line, struct gpiod_chip **cp, struct gpio
 int ads125xOpenDRDY(ads125x_dev *dev, char *chip, int line);
 int ads125xOpenPDWN(ads125x_dev *dev, char *chip, int line, uint8_t init_status);
 void ads125xCloseDRDY(ads125x_dev *dev);
-void ads125xwaitDRDY(struct gpiod_line *line);
+int ads125xGetDRDY(ads125x_dev *dev);
+uint64_t ads125xNowNs(void);
+uint64_t ads125xDRDYTimeout(ads125x_dev *dev);
+int ads125xwaitDRDY(ads125x_dev *dev);
+int ads125xDRDYEventFd(ads125x_dev *dev);
+int ads125xDRDYEventArm(ads125x_dev *dev);
+int ads125xTransfer(ads125x_dev *dev, struct spi_ioc_transfer *xfer, int n);
+double ads125xDRATEToSPS(const uint8_t dr);
+double ads125xDRATEToSettleUs(const uint8_t dr);
 int SPISetup(const int channel, const int port, const int speed, const int spiBPW, const int mode);
 int SPIRelease(const int fd);
 int ads125xSetup(ads125x_dev *dev, int spiChannel, int spiPort);
-void ads125xSetMUX(ads125x_dev *dev, const uint8_t psel, const uint8_t nsel);
-void ads125xSetDRATE(ads125x_dev *dev, const uint8_t dr);
-void ads125xSendCMD(ads125x_dev *dev, const uint8_t cmd);
-void ads125xRREG(ads125x_dev *dev, const uint8_t regaddr, uint8_t *data, const uint8_t len);
-void ads125xWREG(ads125x_dev *dev, const uint8_t regaddr, uint8_t *data, const uint8_t len);
-void ads125xRDATA(ads125x_dev *dev, uint8_t *data);
-void ads125xRDATAC(ads125x_dev *dev, uint8_t *data, int times);
+int ads125xSetMUX(ads125x_dev *dev, const uint8_t psel, const uint8_t nsel);
+int ads125xSetDRATE(ads125x_dev *dev, const uint8_t dr);
+int ads125xSendCMD(ads125x_dev *dev, const uint8_t cmd);
+int ads125xRREG(ads125x_dev *dev, const uint8_t regaddr, uint8_t *data, const uint8_t len);
+int ads125xWREG(ads125x_dev *dev, const uint8_t regaddr, uint8_t *data, const uint8_t len);
+int ads125xRDATA(ads125x_dev *dev, uint8_t *data);
+int ads125xRDATAC(ads125x_dev *dev, uint8_t *data, int times);
+int ads125xRDATACStart(ads125x_dev *dev);
+int ads125xRDATACRead(ads125x_dev *dev, uint8_t *data, int times);
+int ads125xRDATACReadTs(ads125x_dev *dev, uint8_t *data, uint64_t *ts, int times);
+int ads125xRDATACStop(ads125x_dev *dev);
+int ads125xChopStart(ads125x_dev *dev, ads125x_chop *chop, const uint8_t psel, const uint8_t nsel);
+int ads125xChopRead(ads125x_dev *dev, ads125x_chop *chop, int32_t *data, uint64_t *ts, int times);
+int ads125xChopStop(ads125x_dev *dev, const ads125x_chop *chop);
+void ads125xChopGetStats(const ads125x_chop *chop, ads125x_chop_stats *stats);
+double ads125xBurstLatencyUs(const uint8_t dr, int count);
+int ads125xBurstRead(ads125x_dev *dev, const uint8_t dr, int count, int filter, ads125x_burst *result);
+int ads125xControlRun(ads125x_dev *dev, ads125x_control *control, ads125x_control_fn fn, void *arg, uint64_t deadline_ns,
+                      uint64_t count);
+void ads125xControlGetStats(const ads125x_control *control, ads125x_control_stats *stats);
 int ads125xSetPDWN(ads125x_dev *dev, uint8_t status);
 void ads125xClosePDWN(ads125x_dev *dev);
-// void ads125xSELFCAL(ads125x_dev *dev);
-// void ads125xSELFOCAL(ads125x_dev *dev);
-// void ads125xSELFGCAL(ads125x_dev *dev);
-// void ads125xSYSOCAL(ads125x_dev *dev);
-// void ads125xSYSGCAL(ads125x_dev *dev);
-// void ads125xWAKEUP(ads125x_dev *dev);
-// void ads125xSTANDBY(ads125x_dev *dev);
-void ads125xRESET(ads125x_dev *dev);
+int ads125xSELFCAL(ads125x_dev *dev);
+int ads125xSELFOCAL(ads125x_dev *dev);
+int ads125xSELFGCAL(ads125x_dev *dev);
+int ads125xSYSOCAL(ads125x_dev *dev);
+int ads125xSYSGCAL(ads125x_dev *dev);
+int ads125xWAKEUP(ads125x_dev *dev);
+int ads125xSTANDBY(ads125x_dev *dev);
+int ads125xPowerDown(ads125x_dev *dev);
+int ads125xPowerUp(ads125x_dev *dev);
+int ads125xRESET(ads125x_dev *dev);
+int ads125xRecover(ads125x_dev *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
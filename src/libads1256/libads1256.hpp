@@ -0,0 +1,380 @@
+/**
+ * libads1256.hpp - C++ interface of the ADS1255/ADS1256 driver library
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256_HPP
+#define LIBADS1256_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <linux/spi/spidev.h>
+
+#include "libads1256.h"
+#include "libads1256reg.h"
+#include "libads1256replay.h"
+
+/**
+ * Header-only C++17 layer over libads1256.
+ *
+ * The register values become typed enums, a device releases its SPI fd
+ * and GPIO lines in its destructor, and a continuous read session leaves
+ * RDATAC in its destructor. The gain, the reference voltage and the sample
+ * type are template parameters, so the code-to-volt factor and the buffer
+ * layout are constants. All members are inline calls to the C functions.
+ */
+namespace ads125x
+{
+
+enum class DataRate : uint8_t
+{
+    SPS_2_5 = ADS125x_DR_2_5,
+    SPS_5 = ADS125x_DR_5,
+    SPS_10 = ADS125x_DR_10,
+    SPS_15 = ADS125x_DR_15,
+    SPS_25 = ADS125x_DR_25,
+    SPS_30 = ADS125x_DR_30,
+    SPS_50 = ADS125x_DR_50,
+    SPS_60 = ADS125x_DR_60,
+    SPS_100 = ADS125x_DR_100,
+    SPS_500 = ADS125x_DR_500,
+    SPS_1000 = ADS125x_DR_1000,
+    SPS_2000 = ADS125x_DR_2000,
+    SPS_3750 = ADS125x_DR_3750,
+    SPS_7500 = ADS125x_DR_7500,
+    SPS_15000 = ADS125x_DR_15000,
+    SPS_30000 = ADS125x_DR_30000,
+};
+
+enum class Gain : uint8_t
+{
+    x1 = ADS125x_ADCON_PGA_1,
+    x2 = ADS125x_ADCON_PGA_2,
+    x4 = ADS125x_ADCON_PGA_4,
+    x8 = ADS125x_ADCON_PGA_8,
+    x16 = ADS125x_ADCON_PGA_16,
+    x32 = ADS125x_ADCON_PGA_32,
+    x64 = ADS125x_ADCON_PGA_64,
+};
+
+// AIN2 to AIN7 are ADS1256 only
+enum class Input : uint8_t
+{
+    AIN0 = 0,
+    AIN1,
+    AIN2,
+    AIN3,
+    AIN4,
+    AIN5,
+    AIN6,
+    AIN7,
+    AINCOM,
+};
+
+// A conversion as shifted out by the chip, 3 bytes MSB first
+struct Raw
+{
+    uint8_t b[ADS125x_DATA_LEN_BYTE];
+};
+static_assert(sizeof(Raw) == ADS125x_DATA_LEN_BYTE, "Raw must match the RDATAC buffer layout");
+
+constexpr unsigned gain_factor(Gain g) { return 1u << static_cast<uint8_t>(g); }
+
+constexpr uint8_t mux(Input p, Input n)
+{
+    return static_cast<uint8_t>((static_cast<uint8_t>(p) << 4) | static_cast<uint8_t>(n));
+}
+
+constexpr int32_t decode(const uint8_t *b)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(b[0]) << 24 | static_cast<uint32_t>(b[1]) << 16 |
+                                static_cast<uint32_t>(b[2]) << 8) >> 8;
+}
+
+/**
+ * Scale - Code to volt factor, full scale is +-2 VREF / PGA
+ */
+template <Gain G, unsigned VrefMicrovolts>
+struct Scale
+{
+    static constexpr double volts_per_code = 2.0 * (VrefMicrovolts * 1e-6) / (gain_factor(G) * 8388608.0);
+    static constexpr double volts(int32_t code) { return code * volts_per_code; }
+};
+
+template <typename Sample, typename S>
+constexpr Sample convert(const uint8_t *b)
+{
+    if constexpr (std::is_same_v<Sample, Raw>)
+        return Raw{{b[0], b[1], b[2]}};
+    else if constexpr (std::is_integral_v<Sample>)
+        return static_cast<Sample>(decode(b));
+    else
+        return static_cast<Sample>(S::volts(decode(b)));
+}
+
+class Error : public std::runtime_error
+{
+public:
+    Error(const std::string &what, int code) : std::runtime_error(what), code_(code) {}
+    int code() const noexcept { return code_; }
+
+private:
+    int code_;
+};
+
+// Throw the ADS125x_ERR_* code of a failed library call
+inline void check(int ret, const char *what)
+{
+    if (ret < 0)
+        throw Error(what, ret);
+}
+
+// Wiring of a device, see ads1256.h for the Orange Pi 5 Pro values
+struct Pins
+{
+    const char *drdy_chip;
+    int drdy_line;
+    const char *pdwn_chip;
+    int pdwn_line;
+    int spi_channel = 0;
+    int spi_port = 0;
+    int spi_speed = 1920000;
+    uint8_t spi_mode = SPI_MODE_1;
+};
+
+/**
+ * Device - A powered up ADS125x
+ * @G: PGA gain, programmed by reset().
+ * @VrefMicrovolts: Reference voltage.
+ * @Sample: Raw, an integral type for codes or a floating type for volts.
+ */
+template <Gain G = Gain::x1, unsigned VrefMicrovolts = 2500000, typename Sample = int32_t>
+class Device
+{
+public:
+    using sample_type = Sample;
+    using scale = Scale<G, VrefMicrovolts>;
+    static constexpr Gain gain = G;
+
+    class Stream;
+
+    explicit Device(const Pins &pins)
+    {
+        int ret;
+
+        init();
+        dev_.spi_mode = pins.spi_mode;
+        dev_.spi_bit_p_word = 8;
+        dev_.spi_speed = pins.spi_speed;
+        if ((dev_.fd = ads125xSetup(&dev_, pins.spi_channel, pins.spi_port)) < 0)
+            throw Error("SPI setup failed", dev_.fd);
+        if ((ret = ads125xOpenDRDY(&dev_, const_cast<char *>(pins.drdy_chip), pins.drdy_line)))
+        {
+            release();
+            throw Error("Open DRDY failed", ret);
+        }
+        if ((ret = ads125xOpenPDWN(&dev_, const_cast<char *>(pins.pdwn_chip), pins.pdwn_line, 0)))
+        {
+            release();
+            throw Error("Open PDWN failed", ret);
+        }
+        if ((ret = ads125xSetPDWN(&dev_, 1)))
+        {
+            release();
+            throw Error("Set PDWN failed", ret);
+        }
+    }
+
+    // A device replaying a capture, see libads1256replay.h
+    static Device replay(const char *path, int flags = ADS125x_REPLAY_PACED, int format = ADS125x_REPLAY_FMT_AUTO)
+    {
+        Device d;
+        int ret;
+
+        if ((ret = ads125xReplayOpen(&d.dev_, path, format, flags)))
+            throw Error(std::string("Open replay ") + path + " failed", ret);
+        return d;
+    }
+
+    // A emulated device serving @count raw samples from memory
+    static Device emulate(const uint8_t *samples, std::size_t count, int flags = ADS125x_REPLAY_PACED)
+    {
+        Device d;
+        int ret;
+
+        if ((ret = ads125xReplayOpenBuffer(&d.dev_, samples, count, flags)))
+            throw Error("Open emulated device failed", ret);
+        return d;
+    }
+
+    ~Device() { release(); }
+
+    Device(const Device &) = delete;
+    Device &operator=(const Device &) = delete;
+    Device(Device &&other) noexcept : dev_(other.dev_) { other.init(); }
+    Device &operator=(Device &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            dev_ = other.dev_;
+            other.init();
+        }
+        return *this;
+    }
+
+    ads125x_dev *native() noexcept { return &dev_; }
+
+    // Recover from DRDY timeouts and SPI errors while streaming, see ads125xRecover()
+    void set_recover(bool on) noexcept
+    {
+        dev_.flags = on ? dev_.flags | ADS125x_FLAG_RECOVER : dev_.flags & ~ADS125x_FLAG_RECOVER;
+    }
+    const ads125x_recovery &recovery() const noexcept { return dev_.recovery; }
+
+    // RESET the chip and program the gain of the device type
+    void reset()
+    {
+        uint8_t adcon = ADS125x_ADCON_CLK_FEQIN | static_cast<uint8_t>(G);
+
+        check(ads125xRESET(&dev_), "RESET failed");
+        check(ads125xWREG(&dev_, ADS125x_REG_ADDR_ADCON, &adcon, 1), "Set ADCON failed");
+    }
+    void set_rate(DataRate r) { check(ads125xSetDRATE(&dev_, static_cast<uint8_t>(r)), "Set DRATE failed"); }
+    void set_mux(Input p, Input n)
+    {
+        check(ads125xSetMUX(&dev_, mux(p, n) & 0xF0, mux(p, n) & 0x0F), "Set MUX failed");
+    }
+    void self_calibrate() { check(ads125xSELFCAL(&dev_), "SELFCAL failed"); }
+    void standby() { check(ads125xSTANDBY(&dev_), "STANDBY failed"); }
+    void wakeup() { check(ads125xWAKEUP(&dev_), "WAKEUP failed"); }
+    // Registers are cached across the power down and written back on power up
+    void power_down() { check(ads125xPowerDown(&dev_), "Power down failed"); }
+    void power_up() { check(ads125xPowerUp(&dev_), "Power up failed"); }
+
+    Sample read_one()
+    {
+        uint8_t raw[ADS125x_DATA_LEN_BYTE];
+
+        check(ads125xRDATA(&dev_, raw), "RDATA failed");
+        return convert<Sample, scale>(raw);
+    }
+
+    Stream stream() { return Stream(*this); }
+
+private:
+    Device() { init(); }
+
+    void init() noexcept
+    {
+        std::memset(&dev_, 0x00, sizeof(dev_));
+        dev_.name = const_cast<char *>("ADS1256");
+        dev_.fd = -1;
+    }
+
+    void release() noexcept
+    {
+        if (dev_.backend)
+        {
+            dev_.backend->release(&dev_);
+        }
+        else
+        {
+            if (dev_.pin_PDWN_line)
+                ads125xSetPDWN(&dev_, 0);
+            ads125xCloseDRDY(&dev_);
+            ads125xClosePDWN(&dev_);
+            if (dev_.fd >= 0)
+                SPIRelease(dev_.fd);
+        }
+        init();
+    }
+
+    ads125x_dev dev_;
+};
+
+/**
+ * Device::Stream - A RDATAC session, SDATAC is sent when it goes out of scope
+ */
+template <Gain G, unsigned VrefMicrovolts, typename Sample>
+class Device<G, VrefMicrovolts, Sample>::Stream
+{
+public:
+    explicit Stream(Device &d) : dev_(d.native()) { check(ads125xRDATACStart(dev_), "RDATAC failed"); }
+    ~Stream()
+    {
+        if (dev_)
+            ads125xRDATACStop(dev_);
+    }
+
+    Stream(const Stream &) = delete;
+    Stream &operator=(const Stream &) = delete;
+    Stream(Stream &&other) noexcept : dev_(std::exchange(other.dev_, nullptr)) {}
+    Stream &operator=(Stream &&) = delete;
+
+    void read(Sample *out, std::size_t n)
+    {
+        if constexpr (std::is_same_v<Sample, Raw>)
+        {
+            check(ads125xRDATACRead(dev_, reinterpret_cast<uint8_t *>(out), static_cast<int>(n)), "Read failed");
+        }
+        else
+        {
+            std::array<uint8_t, chunk * ADS125x_DATA_LEN_BYTE> raw;
+            std::size_t i, m;
+
+            for (; n > 0; n -= m, out += m)
+            {
+                m = n < chunk ? n : chunk;
+                check(ads125xRDATACRead(dev_, raw.data(), static_cast<int>(m)), "Read failed");
+                for (i = 0; i < m; ++i)
+                    out[i] = convert<Sample, scale>(raw.data() + i * ADS125x_DATA_LEN_BYTE);
+            }
+        }
+    }
+
+    template <std::size_t N>
+    void read(std::array<Sample, N> &out) { read(out.data(), N); }
+
+private:
+    static constexpr std::size_t chunk = 256;
+    ads125x_dev *dev_;
+};
+
+} // namespace ads125x
+
+#endif
@@ -0,0 +1,307 @@
+/**
+ * libads1256align.c - Clock drift estimation and aligned merging of several ADS125x
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "libads1256align.h"
+
+#define MERGE_MASK (ADS125x_MERGE_HISTORY - 1)
+
+typedef struct ads125x_merge_dev_struct
+{
+    ads125x_clock clock;
+    double hist[ADS125x_MERGE_HISTORY];
+    uint64_t last;
+} ads125x_merge_dev;
+
+struct ads125x_merge_struct
+{
+    int ndev;
+    double step_ns;
+    // Output times are next_ns after base_ns
+    uint64_t base_ns;
+    double next_ns;
+    int started;
+    uint64_t frames;
+    uint64_t underruns;
+    ads125x_merge_dev dev[];
+};
+
+/**
+ * ads125xClockInit - Start a clock estimate
+ * @c: The clock.
+ * @sps: Nominal data rate, see ads125xDRATEToSPS().
+ */
+void ads125xClockInit(ads125x_clock *c, double sps)
+{
+    memset(c, 0x00, sizeof(*c));
+    c->nominal_ns = c->period_ns = 1e9 / sps;
+    return;
+}
+
+/**
+ * ads125xClockUpdate - Feed the DRDY timestamp of the next sample
+ * @c: The clock.
+ * @t_ns: DRDY time of the sample, CLOCK_MONOTONIC ns.
+ *
+ * The gains follow a growing memory least squares fit until they reach
+ * ADS125x_CLOCK_GAIN, so the estimate converges quickly and then keeps
+ * tracking slow drift.
+ *
+ * @return: The conversion index of the sample, the first one is 0.
+ */
+uint64_t ads125xClockUpdate(ads125x_clock *c, uint64_t t_ns)
+{
+    double x, pred, e, clip, step, a, b, n;
+    uint64_t k;
+
+    if (c->samples++ == 0)
+    {
+        c->base_ns = t_ns;
+        return 0;
+    }
+    x = (double)(int64_t)(t_ns - c->base_ns);
+    // Timestamps are only ever late, a sample late by most of a period is
+    // still the next conversion, the chip would have overwritten it after
+    step = (x - c->phase_ns) / c->period_ns;
+    k = step < 1.75 ? 1 : (uint64_t)(step + 0.25);
+    c->missed += k - 1;
+    c->index += k;
+    pred = c->phase_ns + k * c->period_ns;
+    e = x - pred;
+
+    // A timestamp taken after a preemption is late, do not follow it
+    clip = 4 * c->jitter_ns + c->period_ns / 64;
+    if (fabs(e) > clip)
+    {
+        e = e > 0 ? clip : -clip;
+        c->clipped++;
+    }
+    c->jitter_ns += (fabs(e) - c->jitter_ns) / 64;
+
+    n = (double)c->samples;
+    a = 2 * (2 * n - 1) / (n * (n + 1));
+    b = 6 / (n * (n + 1));
+    if (a < ADS125x_CLOCK_GAIN)
+    {
+        a = ADS125x_CLOCK_GAIN;
+        b = a * a / (2 - a);
+    }
+    c->phase_ns = pred + a * e;
+    c->period_ns += b * e / k;
+    return c->index;
+}
+
+/**
+ * ads125xClockTime - Estimated DRDY time of a sample
+ * @c: The clock.
+ * @index: Conversion index, may be fractional.
+ *
+ * @return: ns after c->base_ns.
+ */
+double ads125xClockTime(const ads125x_clock *c, double index)
+{
+    return c->phase_ns + (index - (double)c->index) * c->period_ns;
+}
+
+/**
+ * ads125xClockPPM - Rate error of the chip against the nominal DRATE
+ *
+ * @return: Positive if the chip converts faster than nominal, in ppm.
+ */
+double ads125xClockPPM(const ads125x_clock *c)
+{
+    return (c->nominal_ns / c->period_ns - 1) * 1e6;
+}
+
+int ads125xClockLocked(const ads125x_clock *c)
+{
+    return c->samples >= ADS125x_CLOCK_LOCK_SAMPLES;
+}
+
+/**
+ * ads125xMergeOpen - Create a merger of several devices
+ * @ndev: Number of devices.
+ * @sps: Nominal data rate of each device.
+ * @out_sps: Rate of the merged frames.
+ *
+ * @return: The merger, NULL is allocate memory failed.
+ */
+ads125x_merge *ads125xMergeOpen(int ndev, const double *sps, double out_sps)
+{
+    ads125x_merge *m;
+    int i;
+
+    if (ndev < 1 || out_sps <= 0)
+        return NULL;
+    if ((m = (ads125x_merge *)calloc(1, sizeof(*m) + ndev * sizeof(ads125x_merge_dev))) == NULL)
+    {
+        fprintf(stderr, "Allocated memory for merge failed.\n");
+        return NULL;
+    }
+    m->ndev = ndev;
+    m->step_ns = 1e9 / out_sps;
+    for (i = 0; i < ndev; ++i)
+        ads125xClockInit(&m->dev[i].clock, sps[i]);
+    return m;
+}
+
+/**
+ * ads125xMergePush - Add samples of a device
+ * @m: The merger.
+ * @dev: Device number.
+ * @codes: @n conversions, see convert_to_signed_24bit().
+ * @ts: Their DRDY timestamps, from ads125xRDATACReadTs().
+ * @n: Number of samples.
+ *
+ * Push the devices in turn, in blocks much shorter than
+ * ADS125x_MERGE_HISTORY. A conversion missed by the reader holds the
+ * previous value.
+ *
+ * @return: 0 success, 1 is invalid device.
+ */
+int ads125xMergePush(ads125x_merge *m, int dev, const int32_t *codes, const uint64_t *ts, size_t n)
+{
+    ads125x_merge_dev *d;
+    uint64_t idx, j;
+    size_t i;
+
+    if (dev < 0 || dev >= m->ndev)
+        return 1;
+    d = &m->dev[dev];
+    for (i = 0; i < n; ++i)
+    {
+        idx = ads125xClockUpdate(&d->clock, ts[i]);
+        if (idx > d->last + 1)
+        {
+            j = idx - d->last > ADS125x_MERGE_HISTORY ? idx - ADS125x_MERGE_HISTORY : d->last + 1;
+            for (; j < idx; ++j)
+                d->hist[j & MERGE_MASK] = d->hist[d->last & MERGE_MASK];
+        }
+        d->hist[idx & MERGE_MASK] = codes[i];
+        d->last = idx;
+    }
+    return 0;
+}
+
+/**
+ * ads125xMergePull - Get the merged frames ready so far
+ * @m: The merger.
+ * @t_ns: Used to store the time of each frame, CLOCK_MONOTONIC ns.
+ * @frames: Used to store @max frames of m->ndev values each.
+ * @max: Max number of frames.
+ *
+ * A frame is ready when every device has the samples on both sides of
+ * its time. The first frame is at the latest second sample of all
+ * devices.
+ *
+ * @return: Number of frames.
+ */
+size_t ads125xMergePull(ads125x_merge *m, uint64_t *t_ns, double *frames, size_t max)
+{
+    ads125x_merge_dev *d;
+    const double *h;
+    double p, mu, t, cm, c0, c1, c2;
+    int64_t i0, oldest;
+    size_t count;
+    int k;
+
+    if (!m->started)
+    {
+        for (k = 0; k < m->ndev; ++k)
+            if (m->dev[k].clock.samples < 4)
+                return 0;
+        m->base_ns = m->dev[0].clock.base_ns;
+        m->next_ns = 0;
+        for (k = 0; k < m->ndev; ++k)
+        {
+            d = &m->dev[k];
+            t = (double)(int64_t)(d->clock.base_ns - m->base_ns) + ads125xClockTime(&d->clock, 1);
+            if (t > m->next_ns)
+                m->next_ns = t;
+        }
+        m->started = 1;
+    }
+
+    for (count = 0; count < max; ++count, m->next_ns += m->step_ns)
+    {
+        for (k = 0; k < m->ndev; ++k)
+        {
+            d = &m->dev[k];
+            // Sample position of the frame time on this device
+            t = m->next_ns - (double)(int64_t)(d->clock.base_ns - m->base_ns);
+            p = (double)d->clock.index + (t - d->clock.phase_ns) / d->clock.period_ns;
+            i0 = (int64_t)floor(p);
+            if (i0 + 2 > (int64_t)d->last)
+                return count;
+            mu = p - i0;
+            oldest = (int64_t)d->last - ADS125x_MERGE_HISTORY + 1;
+            if (i0 - 1 < oldest || i0 < 1)
+            {
+                m->underruns++;
+                i0 = oldest > 1 ? oldest + 1 : 1;
+                mu = 0;
+            }
+
+            // Cubic Lagrange interpolation over samples i0-1 .. i0+2
+            cm = -mu * (mu - 1) * (mu - 2) / 6;
+            c0 = (mu + 1) * (mu - 1) * (mu - 2) / 2;
+            c1 = -(mu + 1) * mu * (mu - 2) / 2;
+            c2 = (mu + 1) * mu * (mu - 1) / 6;
+            h = d->hist;
+            frames[count * m->ndev + k] = cm * h[(i0 - 1) & MERGE_MASK] + c0 * h[i0 & MERGE_MASK] +
+                                          c1 * h[(i0 + 1) & MERGE_MASK] + c2 * h[(i0 + 2) & MERGE_MASK];
+        }
+        t_ns[count] = m->base_ns + (uint64_t)llround(m->next_ns);
+        m->frames++;
+    }
+    return count;
+}
+
+/**
+ * ads125xMergeClock - Get the clock estimate of a device
+ */
+const ads125x_clock *ads125xMergeClock(ads125x_merge *m, int dev)
+{
+    if (dev < 0 || dev >= m->ndev)
+        return NULL;
+    return &m->dev[dev].clock;
+}
+
+void ads125xMergeClose(ads125x_merge *m)
+{
+    free(m);
+    return;
+}
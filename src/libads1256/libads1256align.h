@@ -0,0 +1,105 @@
+/**
+ * libads1256align.h - Clock drift estimation and aligned merging of several ADS125x
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256ALIGN_H
+#define LIBADS1256ALIGN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Every ADS125x converts on its own crystal, so the sample streams of
+ * several chips drift apart. ads125x_clock tracks the true sample period
+ * and phase of one device from its DRDY timestamps, see
+ * ads125xRDATACReadTs(), with a second order PLL: the phase error of each
+ * timestamp corrects the phase and, scaled down, the period. Timestamps
+ * late by more than a few times the usual jitter (preemption) are
+ * clipped, conversions missed by the reader are recognized by the gap.
+ *
+ * ads125x_merge resamples several devices onto one time grid. Each output
+ * frame takes the value of each device at the frame time, interpolated
+ * between its four nearest samples with a cubic Lagrange fractional delay
+ * filter. Both are incremental and cost O(1) per sample.
+ */
+#define ADS125x_CLOCK_GAIN          (1.0 / 1024)    // Phase gain of the PLL
+#define ADS125x_CLOCK_LOCK_SAMPLES  1024            // Samples until the estimate is trusted
+#define ADS125x_MERGE_HISTORY       256             // Samples kept per device, power of two
+
+/**
+ * ads125x_clock - Sample clock estimate of one device
+ * @base_ns: Timestamp of the first sample, times below are relative to it.
+ * @phase_ns: Estimated time of sample @index.
+ * @period_ns: Estimated sample period.
+ * @nominal_ns: The DRATE period.
+ * @jitter_ns: Smoothed absolute phase error.
+ * @index: Conversion index of the last sample, missed conversions count.
+ * @samples: Timestamps seen.
+ * @missed: Conversions missed by the reader.
+ * @clipped: Timestamps clipped as outliers.
+ */
+typedef struct ads125x_clock_struct
+{
+    uint64_t base_ns;
+    double phase_ns;
+    double period_ns;
+    double nominal_ns;
+    double jitter_ns;
+    uint64_t index;
+    uint64_t samples;
+    uint64_t missed;
+    uint64_t clipped;
+} ads125x_clock;
+
+void ads125xClockInit(ads125x_clock *c, double sps);
+uint64_t ads125xClockUpdate(ads125x_clock *c, uint64_t t_ns);
+double ads125xClockTime(const ads125x_clock *c, double index);
+double ads125xClockPPM(const ads125x_clock *c);
+int ads125xClockLocked(const ads125x_clock *c);
+
+typedef struct ads125x_merge_struct ads125x_merge;
+
+ads125x_merge *ads125xMergeOpen(int ndev, const double *sps, double out_sps);
+int ads125xMergePush(ads125x_merge *m, int dev, const int32_t *codes, const uint64_t *ts, size_t n);
+size_t ads125xMergePull(ads125x_merge *m, uint64_t *t_ns, double *frames, size_t max);
+const ads125x_clock *ads125xMergeClock(ads125x_merge *m, int dev);
+void ads125xMergeClose(ads125x_merge *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,339 @@
+/**
+ * libads1256arena.c - Preallocated, prefaulted buffers of an acquisition session
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+#include "libads1256arena.h"
+
+#define POOL_NONE                   0xFFFFFFFFu
+
+extern int ADS125xDriverDebug;
+
+struct ads125x_arena_struct
+{
+    uint8_t *base;          // What mmap() returned
+    size_t map_size;
+    uint8_t *mem;           // Start of the usable part
+    size_t size;
+    size_t used;
+    int fd;
+    int hugepages;
+    int locked;
+};
+
+struct ads125x_pool_struct
+{
+    uint8_t *blocks;
+    size_t block_size;
+    uint32_t count;
+    uint32_t *next;
+    // Index of the top free block, tagged against ABA in the high half
+    uint64_t head;
+};
+
+/**
+ * ads125xPrefault - Fault in the pages of a buffer now
+ * @addr: The buffer.
+ * @len: Its length.
+ *
+ * Writes every page, so the first store in the acquisition loop finds
+ * them mapped and writable.
+ */
+void ads125xPrefault(void *addr, size_t len)
+{
+    volatile uint8_t *p = (volatile uint8_t *)addr;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE), i;
+
+    for (i = 0; i < len; i += page)
+        p[i] = p[i];
+    if (len)
+        p[len - 1] = p[len - 1];
+    return;
+}
+
+/**
+ * ads125xPageFaults - Page faults of the calling thread so far
+ *
+ * @return: Minor plus major faults, compare it around a section.
+ */
+uint64_t ads125xPageFaults(void)
+{
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_THREAD, &ru))
+        return 0;
+    return (uint64_t)ru.ru_minflt + (uint64_t)ru.ru_majflt;
+}
+
+static int arena_map(ads125x_arena *a, size_t size, int flags)
+{
+    int shared = (flags & ADS125x_ARENA_MEMFD) ? MAP_SHARED : MAP_PRIVATE | MAP_ANONYMOUS;
+    size_t huge = ADS125x_HUGEPAGE_SIZE;
+
+    a->fd = -1;
+    if (flags & ADS125x_ARENA_HUGEPAGE)
+    {
+        // Reserved hugepages first, they need /proc/sys/vm/nr_hugepages
+        a->map_size = (size + huge - 1) & ~(huge - 1);
+        if (flags & ADS125x_ARENA_MEMFD)
+            a->fd = memfd_create("ads125x-arena", MFD_CLOEXEC | MFD_HUGETLB);
+        if (!(flags & ADS125x_ARENA_MEMFD) || (a->fd >= 0 && ftruncate(a->fd, a->map_size) == 0))
+        {
+            a->base = mmap(NULL, a->map_size, PROT_READ | PROT_WRITE, shared | MAP_HUGETLB | MAP_POPULATE, a->fd, 0);
+            if (a->base != MAP_FAILED)
+            {
+                a->mem = a->base;
+                a->hugepages = ADS125x_ARENA_PAGES_HUGETLB;
+                return 0;
+            }
+        }
+        if (a->fd >= 0)
+            close(a->fd);
+        a->fd = -1;
+        if (ADS125xDriverDebug)
+            fprintf(stderr, "Arena: no reserved hugepages, using transparent hugepages.\n");
+    }
+
+    // Normal pages, with a hugepage aligned start for THP if asked
+    a->map_size = size + ((flags & ADS125x_ARENA_HUGEPAGE) ? huge : 0);
+    if (flags & ADS125x_ARENA_MEMFD)
+    {
+        if ((a->fd = memfd_create("ads125x-arena", MFD_CLOEXEC)) < 0 || ftruncate(a->fd, a->map_size))
+            return -1;
+    }
+    if ((a->base = mmap(NULL, a->map_size, PROT_READ | PROT_WRITE, shared, a->fd, 0)) == MAP_FAILED)
+        return -1;
+    a->mem = a->base;
+    if (flags & ADS125x_ARENA_HUGEPAGE)
+    {
+        a->mem = (uint8_t *)(((uintptr_t)a->base + huge - 1) & ~((uintptr_t)huge - 1));
+        if (madvise(a->mem, size, MADV_HUGEPAGE) == 0)
+            a->hugepages = ADS125x_ARENA_PAGES_THP;
+    }
+    return 0;
+}
+
+/**
+ * ads125xArenaOpen - Map and fault in the memory of a session
+ * @size: Bytes of all the buffers, plus ADS125x_ARENA_ALIGN per buffer.
+ * @flags: ADS125x_ARENA_HUGEPAGE, ADS125x_ARENA_MEMFD, ADS125x_ARENA_LOCK.
+ *
+ * Without reserved hugepages ADS125x_ARENA_HUGEPAGE falls back to
+ * transparent hugepages, and a failed mlock() leaves the arena unlocked,
+ * see ads125xArenaGetStats() for what was obtained.
+ *
+ * @return: The arena, or NULL on failure.
+ */
+ads125x_arena *ads125xArenaOpen(size_t size, int flags)
+{
+    ads125x_arena *a;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (size == 0 || (a = (ads125x_arena *)calloc(1, sizeof(*a))) == NULL)
+        return NULL;
+    size = (size + page - 1) & ~(page - 1);
+    if (arena_map(a, size, flags))
+    {
+        fprintf(stderr, "Arena: map %zu bytes failed: %s\n", size, strerror(errno));
+        if (a->fd >= 0)
+            close(a->fd);
+        free(a);
+        return NULL;
+    }
+    a->size = size;
+    if ((flags & ADS125x_ARENA_LOCK) && mlock(a->mem, a->size) == 0)
+        a->locked = 1;
+    ads125xPrefault(a->mem, a->size);
+    return a;
+}
+
+/**
+ * ads125xArenaAlloc - Carve a buffer out of the arena
+ * @arena: The arena.
+ * @size: Bytes, the buffer is aligned to ADS125x_ARENA_ALIGN.
+ *
+ * The memory is zeroed on the first use of the arena only, not after
+ * ads125xArenaReset().
+ *
+ * @return: The buffer, or NULL once the arena is full.
+ */
+void *ads125xArenaAlloc(ads125x_arena *arena, size_t size)
+{
+    size_t off = (arena->used + ADS125x_ARENA_ALIGN - 1) & ~((size_t)ADS125x_ARENA_ALIGN - 1);
+
+    if (size > arena->size || off > arena->size - size)
+    {
+        if (ADS125xDriverDebug)
+            fprintf(stderr, "Arena: %zu bytes wanted, %zu of %zu used.\n", size, arena->used, arena->size);
+        return NULL;
+    }
+    arena->used = off + size;
+    return arena->mem + off;
+}
+
+/**
+ * ads125xArenaReset - Give back every buffer of the arena at once
+ * @arena: The arena.
+ *
+ * The pages stay mapped and faulted in for the next session.
+ */
+void ads125xArenaReset(ads125x_arena *arena)
+{
+    arena->used = 0;
+    return;
+}
+
+/**
+ * ads125xArenaFd - The memfd behind an arena
+ * @arena: The arena, opened with ADS125x_ARENA_MEMFD.
+ *
+ * Another process can map the buffers of the session through it.
+ *
+ * @return: The fd, or -1.
+ */
+int ads125xArenaFd(ads125x_arena *arena)
+{
+    return arena->fd;
+}
+
+/**
+ * ads125xArenaGetStats - Size, use and kind of pages of an arena
+ * @arena: The arena.
+ * @stats: Returns the figures.
+ */
+void ads125xArenaGetStats(ads125x_arena *arena, ads125x_arena_stats *stats)
+{
+    stats->size = arena->size;
+    stats->used = arena->used;
+    stats->hugepages = arena->hugepages;
+    stats->locked = arena->locked;
+    stats->fd = arena->fd;
+    return;
+}
+
+/**
+ * ads125xArenaClose - Unmap an arena
+ * @arena: The arena, every buffer and pool of it is gone afterwards.
+ */
+void ads125xArenaClose(ads125x_arena *arena)
+{
+    if (arena->locked)
+        munlock(arena->mem, arena->size);
+    munmap(arena->base, arena->map_size);
+    if (arena->fd >= 0)
+        close(arena->fd);
+    free(arena);
+    return;
+}
+
+/**
+ * ads125xArenaPool - A pool of fixed-size blocks in the arena
+ * @arena: The arena.
+ * @block_size: Bytes per block, rounded up to ADS125x_ARENA_ALIGN.
+ * @count: Number of blocks, all free at first.
+ *
+ * @return: The pool, or NULL if the arena is too small.
+ */
+ads125x_pool *ads125xArenaPool(ads125x_arena *arena, size_t block_size, uint32_t count)
+{
+    ads125x_pool *pool;
+    uint32_t i;
+
+    if (!block_size || !count || count == POOL_NONE)
+        return NULL;
+    block_size = (block_size + ADS125x_ARENA_ALIGN - 1) & ~((size_t)ADS125x_ARENA_ALIGN - 1);
+    if ((pool = (ads125x_pool *)ads125xArenaAlloc(arena, sizeof(*pool))) == NULL ||
+        (pool->next = (uint32_t *)ads125xArenaAlloc(arena, count * sizeof(uint32_t))) == NULL ||
+        (pool->blocks = (uint8_t *)ads125xArenaAlloc(arena, block_size * count)) == NULL)
+        return NULL;
+    pool->block_size = block_size;
+    pool->count = count;
+    for (i = 0; i < count; ++i)
+        pool->next[i] = i + 1 < count ? i + 1 : POOL_NONE;
+    pool->head = 0;
+    return pool;
+}
+
+/**
+ * ads125xPoolGet - Take a free block
+ * @pool: The pool.
+ *
+ * @return: The block, or NULL if all blocks are in use.
+ */
+void *ads125xPoolGet(ads125x_pool *pool)
+{
+    uint64_t head = __atomic_load_n(&pool->head, __ATOMIC_ACQUIRE), want;
+    uint32_t idx;
+
+    do
+    {
+        if ((idx = (uint32_t)head) == POOL_NONE)
+            return NULL;
+        want = ((head >> 32) + 1) << 32 | __atomic_load_n(&pool->next[idx], __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&pool->head, &head, want, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    return pool->blocks + (size_t)idx * pool->block_size;
+}
+
+/**
+ * ads125xPoolPut - Give a block back
+ * @pool: The pool.
+ * @block: A block of ads125xPoolGet().
+ */
+void ads125xPoolPut(ads125x_pool *pool, void *block)
+{
+    uint32_t idx = (uint32_t)(((uint8_t *)block - pool->blocks) / pool->block_size);
+    uint64_t head = __atomic_load_n(&pool->head, __ATOMIC_RELAXED), want;
+
+    do
+    {
+        __atomic_store_n(&pool->next[idx], (uint32_t)head, __ATOMIC_RELAXED);
+        want = ((head >> 32) + 1) << 32 | idx;
+    } while (!__atomic_compare_exchange_n(&pool->head, &head, want, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    return;
+}
+
+/**
+ * ads125xPoolBlockSize - Usable bytes of each block of a pool
+ * @pool: The pool.
+ */
+size_t ads125xPoolBlockSize(ads125x_pool *pool)
+{
+    return pool->block_size;
+}
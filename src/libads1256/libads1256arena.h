@@ -0,0 +1,100 @@
+/**
+ * libads1256arena.h - Preallocated, prefaulted buffers of an acquisition session
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256ARENA_H
+#define LIBADS1256ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * An arena is one mapping made and faulted in before a session starts,
+ * every sample, timestamp and scratch buffer of the session is carved
+ * out of it. Between RDATAC and SDATAC nothing is allocated and no page
+ * is touched for the first time, so the DRDY loop takes no page fault.
+ * ads125xPageFaults() checks that.
+ *
+ * Buffers are never freed one by one, the whole arena is reset or closed
+ * at the end of the session. Streaming buffers which are handed back and
+ * forth come from a pool of fixed-size blocks in the arena, getting and
+ * putting a block is lock-free.
+ */
+// Arena flags
+#define ADS125x_ARENA_HUGEPAGE      0x01    // 2 MB pages, reserved ones or transparent
+#define ADS125x_ARENA_MEMFD         0x02    // Backed by a memfd, see ads125xArenaFd()
+#define ADS125x_ARENA_LOCK          0x04    // mlock() the arena
+
+#define ADS125x_ARENA_ALIGN         64      // Alignment of every buffer
+#define ADS125x_HUGEPAGE_SIZE       (2UL << 20)
+
+// ads125x_arena_stats.hugepages
+#define ADS125x_ARENA_PAGES_NORMAL  0
+#define ADS125x_ARENA_PAGES_HUGETLB 1       // MAP_HUGETLB / MFD_HUGETLB
+#define ADS125x_ARENA_PAGES_THP     2       // Aligned and MADV_HUGEPAGE
+
+typedef struct ads125x_arena_struct ads125x_arena;
+typedef struct ads125x_pool_struct ads125x_pool;
+
+typedef struct ads125x_arena_stats_struct
+{
+    size_t size;            // Bytes mapped
+    size_t used;            // Bytes handed out
+    int hugepages;          // ADS125x_ARENA_PAGES_*
+    int locked;
+    int fd;                 // The memfd, -1 without
+} ads125x_arena_stats;
+
+ads125x_arena *ads125xArenaOpen(size_t size, int flags);
+void *ads125xArenaAlloc(ads125x_arena *arena, size_t size);
+void ads125xArenaReset(ads125x_arena *arena);
+int ads125xArenaFd(ads125x_arena *arena);
+void ads125xArenaGetStats(ads125x_arena *arena, ads125x_arena_stats *stats);
+void ads125xArenaClose(ads125x_arena *arena);
+
+ads125x_pool *ads125xArenaPool(ads125x_arena *arena, size_t block_size, uint32_t count);
+void *ads125xPoolGet(ads125x_pool *pool);
+void ads125xPoolPut(ads125x_pool *pool, void *block);
+size_t ads125xPoolBlockSize(ads125x_pool *pool);
+
+void ads125xPrefault(void *addr, size_t len);
+uint64_t ads125xPageFaults(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
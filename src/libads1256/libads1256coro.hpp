@@ -0,0 +1,426 @@
+/**
+ * libads1256coro.hpp - C++20 coroutine interface of libads1256
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256CORO_HPP
+#define LIBADS1256CORO_HPP
+
+#if __cplusplus < 202002L
+#error "libads1256coro.hpp needs C++20"
+#endif
+
+#include <cerrno>
+#include <coroutine>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "libads1256.hpp"
+
+/**
+ * Coroutines over the DRDY event fd, see ads125xDRDYEventFd().
+ *
+ * A EventLoop is a epoll executor: one thread calls run() and drives
+ * any number of devices and consumers. `co_await` on a AsyncDevice
+ * suspends the coroutine until DRDY falls, nothing spins and no thread
+ * blocks in ads125xwaitDRDY().
+ *
+ *     ads125x::Task<void> consume(ads125x::AsyncDevice<> &adc)
+ *     {
+ *         auto block = co_await adc.next_block(100);
+ *         auto one = co_await adc.read_one();
+ *     }
+ *
+ *     ads125x::EventLoop loop;
+ *     ads125x::Device<> dev(pins);
+ *     ads125x::AsyncDevice<> adc(loop, dev);
+ *     loop.spawn(consume(adc));
+ *     loop.run();
+ */
+namespace ads125x
+{
+
+template <typename T = void>
+class Task;
+
+namespace detail
+{
+
+// Resume the awaiting coroutine when a task finishes
+struct FinalAwaiter
+{
+    bool await_ready() const noexcept { return false; }
+    template <typename P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
+    {
+        if (h.promise().continuation)
+            return h.promise().continuation;
+        return std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+};
+
+struct PromiseBase
+{
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase
+{
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+    template <typename U>
+    void return_value(U &&v) { value.emplace(std::forward<U>(v)); }
+    T result()
+    {
+        if (error)
+            std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase
+{
+    Task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+    void result()
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+// A coroutine started by EventLoop::spawn(), frees itself when done
+struct Detached
+{
+    struct promise_type
+    {
+        // Frames of the loop not done yet, this one is taken off when freed
+        std::unordered_set<void *> *live = nullptr;
+
+        ~promise_type()
+        {
+            if (live)
+                live->erase(std::coroutine_handle<promise_type>::from_promise(*this).address());
+        }
+        Detached get_return_object() noexcept
+        {
+            return Detached{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+    std::coroutine_handle<promise_type> handle;
+};
+
+} // namespace detail
+
+/**
+ * Task - A lazily started coroutine returning @T
+ *
+ * It runs when it is awaited, and resumes its awaiter when it returns.
+ * A exception leaving the task is thrown again by the co_await.
+ */
+template <typename T>
+class Task
+{
+public:
+    using promise_type = detail::Promise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> h) noexcept : h_(h) {}
+    Task(Task &&other) noexcept : h_(std::exchange(other.h_, nullptr)) {}
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    Task &operator=(Task &&) = delete;
+    ~Task()
+    {
+        if (h_)
+            h_.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+        h_.promise().continuation = awaiter;
+        return h_;
+    }
+    T await_resume() { return h_.promise().result(); }
+
+private:
+    std::coroutine_handle<promise_type> h_;
+};
+
+namespace detail
+{
+
+template <typename T>
+Task<T> Promise<T>::get_return_object() noexcept
+{
+    return Task<T>{std::coroutine_handle<Promise<T>>::from_promise(*this)};
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept
+{
+    return Task<void>{std::coroutine_handle<Promise<void>>::from_promise(*this)};
+}
+
+} // namespace detail
+
+/**
+ * EventLoop - epoll executor resuming coroutines on readable fds
+ *
+ * One coroutine at a time may wait on a fd. The loop is single threaded,
+ * all its members are called from the thread running run().
+ *
+ * When a spawned task throws, run() destroys the coroutines still ready
+ * or waiting before it throws again, and the loop can be used again.
+ * Coroutines left when the loop is destroyed are destroyed with it.
+ */
+class EventLoop
+{
+public:
+    EventLoop() : epfd_(epoll_create1(EPOLL_CLOEXEC))
+    {
+        if (epfd_ < 0)
+            throw Error(std::string("epoll_create1 failed: ") + std::strerror(errno), ADS125x_ERR_IO);
+    }
+    ~EventLoop()
+    {
+        abandon();
+        close(epfd_);
+    }
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    // Resume @h the next time @fd is readable
+    void wait_readable(int fd, std::coroutine_handle<> h)
+    {
+        struct epoll_event ev;
+
+        ev.events = EPOLLIN | EPOLLONESHOT;
+        ev.data.fd = fd;
+        if (epoll_ctl(epfd_, registered_.count(fd) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev) < 0)
+            throw Error(std::string("epoll_ctl failed: ") + std::strerror(errno), ADS125x_ERR_IO);
+        registered_.insert(fd);
+        waiting_[fd] = h;
+    }
+
+    // Stop watching @fd before it is closed
+    void forget(int fd) noexcept
+    {
+        if (registered_.erase(fd))
+            epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+        waiting_.erase(fd);
+    }
+
+    // Run @task from the next run(), a exception leaving it stops run()
+    void spawn(Task<void> task)
+    {
+        auto h = drive(this, std::move(task)).handle;
+
+        live_.insert(h.address());
+        h.promise().live = &live_;
+        ready_.push_back(h);
+    }
+
+    // Resume coroutines until none is ready or waiting
+    void run()
+    {
+        struct epoll_event events[max_events];
+        std::coroutine_handle<> h;
+        int i, n;
+
+        while (!ready_.empty() || !waiting_.empty())
+        {
+            while (!ready_.empty())
+            {
+                h = ready_.front();
+                ready_.pop_front();
+                h.resume();
+                rethrow();
+            }
+            if (waiting_.empty())
+                break;
+            if ((n = epoll_wait(epfd_, events, max_events, -1)) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw Error(std::string("epoll_wait failed: ") + std::strerror(errno), ADS125x_ERR_IO);
+            }
+            for (i = 0; i < n; ++i)
+            {
+                auto it = waiting_.find(events[i].data.fd);
+                if (it == waiting_.end())
+                    continue;
+                h = it->second;
+                waiting_.erase(it);
+                h.resume();
+                rethrow();
+            }
+        }
+    }
+
+private:
+    static constexpr int max_events = 64;
+
+    static detail::Detached drive(EventLoop *loop, Task<void> task)
+    {
+        try
+        {
+            co_await std::move(task);
+        }
+        catch (...)
+        {
+            loop->error_ = std::current_exception();
+        }
+    }
+
+    void rethrow()
+    {
+        if (!error_)
+            return;
+        abandon();
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+
+    /**
+     * abandon - Destroy the spawned coroutines not done
+     *
+     * The handles in waiting_ and ready_ may be inner tasks, owned by the
+     * frame awaiting them. Destroying the frame of drive() frees its
+     * whole chain, and the promise takes it off live_.
+     */
+    void abandon() noexcept
+    {
+        waiting_.clear();
+        ready_.clear();
+        while (!live_.empty())
+            std::coroutine_handle<>::from_address(*live_.begin()).destroy();
+    }
+
+    int epfd_;
+    std::unordered_set<int> registered_;
+    std::unordered_map<int, std::coroutine_handle<>> waiting_;
+    std::deque<std::coroutine_handle<>> ready_;
+    std::unordered_set<void *> live_;
+    std::exception_ptr error_;
+};
+
+/**
+ * AsyncDevice - Awaitable samples of a Device in RDATAC mode
+ *
+ * Enters RDATAC on construction and leaves it on destruction, the Device
+ * must outlive it. One coroutine at a time may await a AsyncDevice.
+ */
+template <Gain G = Gain::x1, unsigned VrefMicrovolts = 2500000, typename Sample = int32_t>
+class AsyncDevice
+{
+public:
+    using device_type = Device<G, VrefMicrovolts, Sample>;
+
+    AsyncDevice(EventLoop &loop, device_type &device)
+        : loop_(loop), dev_(device.native()), fd_(ads125xDRDYEventFd(dev_)), stream_(device)
+    {
+        check(fd_, "DRDY event fd failed");
+    }
+    ~AsyncDevice() { loop_.forget(fd_); }
+
+    AsyncDevice(const AsyncDevice &) = delete;
+    AsyncDevice &operator=(const AsyncDevice &) = delete;
+
+    // Suspends until DRDY is low
+    struct DRDYAwaiter
+    {
+        AsyncDevice *self;
+
+        bool await_ready()
+        {
+            if (ads125xGetDRDY(self->dev_) == 0)
+                return true;
+            check(ads125xDRDYEventArm(self->dev_), "Arm DRDY event failed");
+            return ads125xGetDRDY(self->dev_) == 0;
+        }
+        void await_suspend(std::coroutine_handle<> h) { self->loop_.wait_readable(self->fd_, h); }
+        void await_resume() const noexcept {}
+    };
+
+    DRDYAwaiter drdy() noexcept { return DRDYAwaiter{this}; }
+
+    Task<Sample> read_one()
+    {
+        Sample s;
+
+        co_await drdy();
+        stream_.read(&s, 1);
+        co_return s;
+    }
+
+    Task<std::vector<Sample>> next_block(std::size_t n)
+    {
+        std::vector<Sample> block(n);
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            co_await drdy();
+            stream_.read(&block[i], 1);
+        }
+        co_return block;
+    }
+
+private:
+    EventLoop &loop_;
+    ads125x_dev *dev_;
+    int fd_;
+    typename device_type::Stream stream_;
+};
+
+} // namespace ads125x
+
+#endif
@@ -0,0 +1,479 @@
+/**
+ * libads1256detect.c - Inline event detection on ADS1255/ADS1256 streams
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "libads1256detect.h"
+
+struct ads125x_detect_struct
+{
+    ads125x_detect_config cfg;
+    // Samples base ~ base + len - 1, the last block after hist older ones
+    int32_t *x;
+    uint64_t *ts;
+    int64_t *sum;           // sum[k] = x[0] + ... + x[k - 1]
+    size_t hist;
+    size_t len;
+    uint64_t base;
+
+    // LEVEL: 0 inside the levels, 1 above high, -1 below low
+    int level;
+    // STEP: next point to test, and the strongest point of the run over @step
+    uint64_t step_next;
+    int step_run;
+    int64_t step_diff;
+    ads125x_event step_best;
+    // FLATLINE: the run so far
+    int flat_init;
+    int flat_reported;
+    int32_t flat_ref;
+    uint64_t flat_start;
+
+    ads125x_event pend[ADS125x_DETECT_PENDING];
+    int pend_n;
+    ads125x_detect_stats stats;
+};
+
+static const char *detect_event_names[ADS125x_EVENT_TYPES] = {"high", "low", "normal", "spike", "step", "flatline"};
+
+/**
+ * ads125xDetectConfigInit - Default configuration, every detector off
+ * @cfg: The configuration to fill, set @mask and the levels of the
+ *       detectors to run afterwards.
+ */
+void ads125xDetectConfigInit(ads125x_detect_config *cfg)
+{
+    memset(cfg, 0x00, sizeof(*cfg));
+    cfg->high = INT32_MAX;
+    cfg->low = INT32_MIN;
+    cfg->step_window = 64;
+    cfg->flat_samples = 1000;
+    cfg->context = 8;
+    return;
+}
+
+/**
+ * ads125xDetectOpen - Create a detector
+ * @cfg: What to detect, copied.
+ *
+ * @return: The detector, NULL on an invalid configuration or out of memory.
+ */
+ads125x_detect *ads125xDetectOpen(const ads125x_detect_config *cfg)
+{
+    ads125x_detect *d;
+    size_t cap;
+
+    if (cfg->hysteresis < 0 || cfg->spike < 0 || cfg->step < 0 || cfg->flat_delta < 0 ||
+        cfg->step_window < 1 || cfg->step_window > ADS125x_DETECT_MAX_WINDOW ||
+        cfg->flat_samples < 2 || cfg->context > ADS125x_DETECT_CONTEXT_MAX)
+        return NULL;
+    if ((d = (ads125x_detect *)calloc(1, sizeof(*d))) == NULL)
+        return NULL;
+    d->cfg = *cfg;
+    // Enough for the window on both sides of the last point tested and the context of its event
+    d->hist = 2 * cfg->step_window + 2 * cfg->context + 2;
+    cap = d->hist + ADS125x_DETECT_BLOCK;
+    d->x = (int32_t *)malloc(cap * sizeof(int32_t));
+    d->ts = (uint64_t *)malloc(cap * sizeof(uint64_t));
+    d->sum = (int64_t *)calloc(cap + 1, sizeof(int64_t));
+    if (!d->x || !d->ts || !d->sum)
+    {
+        ads125xDetectClose(d);
+        return NULL;
+    }
+    d->step_next = cfg->step_window;
+    return d;
+}
+
+static void detect_event(ads125x_detect *d, int type, uint64_t index, uint64_t ts, int32_t code, int32_t ref)
+{
+    ads125x_event *ev;
+
+    d->stats.events[type]++;
+    if (d->pend_n == ADS125x_DETECT_PENDING)
+    {
+        d->stats.dropped++;
+        return;
+    }
+    ev = &d->pend[d->pend_n++];
+    ev->index = index;
+    ev->ts = ts;
+    ev->type = type;
+    ev->code = code;
+    ev->ref = ref;
+    ev->context_n = 0;
+    return;
+}
+
+/**
+ * detect_collect - Return the events whose context is complete
+ * @all: Return every event, with the context there is.
+ */
+static int detect_collect(ads125x_detect *d, ads125x_event *out, int max, int all)
+{
+    uint64_t end = d->base + d->len, first, last;
+    ads125x_event *ev;
+    int i, j, n = 0;
+
+    for (i = 0, j = 0; i < d->pend_n; ++i)
+    {
+        ev = &d->pend[i];
+        if (n == max || (!all && ev->index + d->cfg.context >= end))
+        {
+            d->pend[j++] = *ev;
+            continue;
+        }
+        first = ev->index > d->cfg.context ? ev->index - d->cfg.context : 0;
+        first = first > d->base ? first : d->base;
+        last = ev->index + d->cfg.context < end ? ev->index + d->cfg.context : end - 1;
+        ev->context_index = first;
+        ev->context_n = first <= last ? (uint32_t)(last - first + 1) : 0;
+        memcpy(ev->context, d->x + (first - d->base), ev->context_n * sizeof(int32_t));
+        out[n++] = *ev;
+    }
+    d->pend_n = j;
+    return n;
+}
+
+static int detect_level(ads125x_detect *d, size_t s, size_t e, int32_t mn, int32_t mx)
+{
+    const ads125x_detect_config *c = &d->cfg;
+    int64_t back_high = (int64_t)c->high - c->hysteresis, back_low = (int64_t)c->low + c->hysteresis;
+    size_t i;
+
+    if ((d->level == 0 && mx <= c->high && mn >= c->low) ||
+        (d->level > 0 && mn >= back_high) || (d->level < 0 && mx <= back_low))
+        return 0;
+    for (i = s; i < e; ++i)
+    {
+        if ((d->level > 0 && d->x[i] < back_high) || (d->level < 0 && d->x[i] > back_low))
+        {
+            detect_event(d, ADS125x_EVENT_NORMAL, d->base + i, d->ts[i], d->x[i], d->level > 0 ? (int32_t)back_high : (int32_t)back_low);
+            d->level = 0;
+        }
+        if (d->level == 0 && d->x[i] > c->high)
+        {
+            detect_event(d, ADS125x_EVENT_HIGH, d->base + i, d->ts[i], d->x[i], c->high);
+            d->level = 1;
+        }
+        else if (d->level == 0 && d->x[i] < c->low)
+        {
+            detect_event(d, ADS125x_EVENT_LOW, d->base + i, d->ts[i], d->x[i], c->low);
+            d->level = -1;
+        }
+    }
+    return 1;
+}
+
+static int detect_spike(ads125x_detect *d, size_t s, size_t e, int32_t dmax)
+{
+    int32_t sp = d->cfg.spike, a, b;
+    size_t j;
+
+    // A spike is two jumps over @spike, none in the block
+    if (dmax <= sp)
+        return 0;
+    // The last sample of the previous block is tested now that its right neighbour is in
+    for (j = s > 1 ? s - 1 : 1; j + 1 < e; ++j)
+    {
+        a = d->x[j] - d->x[j - 1];
+        b = d->x[j + 1] - d->x[j];
+        if ((a > sp && b < -sp) || (a < -sp && b > sp))
+            detect_event(d, ADS125x_EVENT_SPIKE, d->base + j, d->ts[j], d->x[j],
+                         (int32_t)(((int64_t)d->x[j - 1] + d->x[j + 1]) / 2));
+    }
+    return 1;
+}
+
+static int detect_step(ads125x_detect *d, size_t e)
+{
+    int64_t w = d->cfg.step_window, limit = (int64_t)d->cfg.step * w, v, m = 0;
+    const int64_t *sum = d->sum;
+    size_t i, lo, hi;
+
+    // Point i compares x[i - w] ~ x[i - 1] with x[i] ~ x[i + w - 1]
+    if (d->step_next + w > d->base + e)
+        return 0;
+    lo = d->step_next - d->base;
+    hi = e - w;
+    d->step_next = d->base + hi + 1;
+    for (i = lo; i <= hi; ++i)
+    {
+        v = sum[i + w] - 2 * sum[i] + sum[i - w];
+        v = v < 0 ? -v : v;
+        m = v > m ? v : m;
+    }
+    if (m <= limit && !d->step_run)
+        return 0;
+    for (i = lo; i <= hi; ++i)
+    {
+        v = sum[i + w] - 2 * sum[i] + sum[i - w];
+        v = v < 0 ? -v : v;
+        if (v > limit)
+        {
+            // The change is where the difference of the means peaks
+            if (!d->step_run || v > d->step_diff)
+            {
+                d->step_diff = v;
+                d->step_best.index = d->base + i;
+                d->step_best.ts = d->ts[i];
+                d->step_best.code = (int32_t)((sum[i + w] - sum[i]) / w);
+                d->step_best.ref = (int32_t)((sum[i] - sum[i - w]) / w);
+            }
+            d->step_run = 1;
+        }
+        else if (d->step_run)
+        {
+            detect_event(d, ADS125x_EVENT_STEP, d->step_best.index, d->step_best.ts, d->step_best.code, d->step_best.ref);
+            d->step_run = 0;
+        }
+    }
+    return 1;
+}
+
+static int detect_flatline(ads125x_detect *d, size_t s, size_t e, int32_t mn, int32_t mx)
+{
+    const ads125x_detect_config *c = &d->cfg;
+    uint64_t at;
+    size_t i;
+
+    if (!d->flat_init)
+    {
+        d->flat_init = 1;
+        d->flat_ref = d->x[s];
+        d->flat_start = d->base + s;
+    }
+    // The whole block continues the run
+    if ((int64_t)mx - d->flat_ref <= c->flat_delta && (int64_t)d->flat_ref - mn <= c->flat_delta)
+    {
+        at = d->flat_start + c->flat_samples - 1;
+        if (!d->flat_reported && at < d->base + e)
+        {
+            detect_event(d, ADS125x_EVENT_FLATLINE, at, d->ts[at - d->base], d->x[at - d->base], d->flat_ref);
+            d->flat_reported = 1;
+        }
+        return 0;
+    }
+    for (i = s; i < e; ++i)
+    {
+        if (llabs((int64_t)d->x[i] - d->flat_ref) <= c->flat_delta)
+        {
+            if (!d->flat_reported && d->base + i - d->flat_start + 1 >= c->flat_samples)
+            {
+                detect_event(d, ADS125x_EVENT_FLATLINE, d->base + i, d->ts[i], d->x[i], d->flat_ref);
+                d->flat_reported = 1;
+            }
+        }
+        else
+        {
+            d->flat_ref = d->x[i];
+            d->flat_start = d->base + i;
+            d->flat_reported = 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * detect_reserve - Make room for @n samples after the history
+ *
+ * @return: Where the samples go.
+ */
+static size_t detect_reserve(ads125x_detect *d, size_t n)
+{
+    size_t off, k;
+
+    if (d->len + n > d->hist + ADS125x_DETECT_BLOCK)
+    {
+        off = d->len - d->hist;
+        memmove(d->x, d->x + off, d->hist * sizeof(int32_t));
+        memmove(d->ts, d->ts + off, d->hist * sizeof(uint64_t));
+        for (k = 0; k <= d->hist; ++k)
+            d->sum[k] = d->sum[k + off] - d->sum[off];
+        d->base += off;
+        d->len = d->hist;
+    }
+    return d->len;
+}
+
+/**
+ * detect_block - Run the detectors on the @n samples just stored at @s
+ */
+static void detect_block(ads125x_detect *d, size_t s, size_t n, const uint64_t *ts)
+{
+    const int32_t *x = d->x;
+    size_t e = s + n, i;
+    int32_t mn = INT32_MAX, mx = INT32_MIN, dmax = 0, v;
+    int scanned = 0;
+
+    if (ts)
+        memcpy(d->ts + s, ts, n * sizeof(uint64_t));
+    else
+        memset(d->ts + s, 0x00, n * sizeof(uint64_t));
+    // Summary of the block, without branches so that they vectorize
+    for (i = s; i < e; ++i)
+    {
+        mn = x[i] < mn ? x[i] : mn;
+        mx = x[i] > mx ? x[i] : mx;
+    }
+    for (i = s ? s : 1; i < e; ++i)
+    {
+        v = x[i] - x[i - 1];
+        v = v < 0 ? -v : v;
+        dmax = v > dmax ? v : dmax;
+    }
+    for (i = s; i < e; ++i)
+        d->sum[i + 1] = d->sum[i] + x[i];
+    d->len = e;
+    d->stats.samples += n;
+    d->stats.blocks++;
+
+    if (d->cfg.mask & ADS125x_DETECT_LEVEL)
+        scanned |= detect_level(d, s, e, mn, mx);
+    if (d->cfg.mask & ADS125x_DETECT_SPIKE)
+        scanned |= detect_spike(d, s, e, dmax);
+    if (d->cfg.mask & ADS125x_DETECT_STEP)
+        scanned |= detect_step(d, e);
+    if (d->cfg.mask & ADS125x_DETECT_FLATLINE)
+        scanned |= detect_flatline(d, s, e, mn, mx);
+    d->stats.scanned += scanned;
+    return;
+}
+
+/**
+ * ads125xDetectPush - Run the detectors on the next samples of the stream
+ * @d: The detector.
+ * @codes: @n conversions.
+ * @ts: Their DRDY times, see ads125xRDATACReadTs(), may be NULL.
+ * @n: Number of samples.
+ * @events: Used to store the events completed by these samples.
+ * @max: Room in @events, the events that do not fit are returned by
+ *       the next call.
+ *
+ * @return: Number of events stored.
+ */
+int ads125xDetectPush(ads125x_detect *d, const int32_t *codes, const uint64_t *ts, size_t n, ads125x_event *events, int max)
+{
+    size_t m, s;
+    int count = 0;
+
+    while (n)
+    {
+        m = n < ADS125x_DETECT_BLOCK ? n : ADS125x_DETECT_BLOCK;
+        s = detect_reserve(d, m);
+        memcpy(d->x + s, codes, m * sizeof(int32_t));
+        detect_block(d, s, m, ts);
+        count += detect_collect(d, events + count, max - count, 0);
+        codes += m;
+        ts = ts ? ts + m : NULL;
+        n -= m;
+    }
+    return count;
+}
+
+/**
+ * ads125xDetectPushRaw - Run the detectors on samples as read by ads125xRDATACReadTs()
+ * @raw: @n 3 byte samples, MSB first.
+ *
+ * See ads125xDetectPush().
+ */
+int ads125xDetectPushRaw(ads125x_detect *d, const uint8_t *raw, const uint64_t *ts, size_t n, ads125x_event *events, int max)
+{
+    size_t i, m, s;
+    int count = 0;
+
+    while (n)
+    {
+        m = n < ADS125x_DETECT_BLOCK ? n : ADS125x_DETECT_BLOCK;
+        s = detect_reserve(d, m);
+        for (i = 0; i < m; ++i, raw += 3)
+            d->x[s + i] = (int32_t)((uint32_t)raw[0] << 24 | (uint32_t)raw[1] << 16 | (uint32_t)raw[2] << 8) >> 8;
+        detect_block(d, s, m, ts);
+        count += detect_collect(d, events + count, max - count, 0);
+        ts = ts ? ts + m : NULL;
+        n -= m;
+    }
+    return count;
+}
+
+/**
+ * ads125xDetectFlush - Return the events still waiting, at the end of a stream
+ * @d: The detector.
+ * @events: Used to store the events, their context after may be short.
+ * @max: Room in @events.
+ *
+ * A step still rising at the end is returned too.
+ *
+ * @return: Number of events stored, call again while it is @max.
+ */
+int ads125xDetectFlush(ads125x_detect *d, ads125x_event *events, int max)
+{
+    if (d->step_run)
+    {
+        detect_event(d, ADS125x_EVENT_STEP, d->step_best.index, d->step_best.ts, d->step_best.code, d->step_best.ref);
+        d->step_run = 0;
+    }
+    return detect_collect(d, events, max, 1);
+}
+
+/**
+ * ads125xDetectGetStats - Get what a detector did so far
+ */
+void ads125xDetectGetStats(const ads125x_detect *d, ads125x_detect_stats *stats)
+{
+    *stats = d->stats;
+    return;
+}
+
+/**
+ * ads125xEventName - Name of a ADS125x_EVENT_* type
+ */
+const char *ads125xEventName(int type)
+{
+    return type >= 0 && type < ADS125x_EVENT_TYPES ? detect_event_names[type] : "unknown";
+}
+
+/**
+ * ads125xDetectClose - Free a detector, pending events are lost
+ */
+void ads125xDetectClose(ads125x_detect *d)
+{
+    if (!d)
+        return;
+    free(d->x);
+    free(d->ts);
+    free(d->sum);
+    free(d);
+    return;
+}
@@ -0,0 +1,174 @@
+/**
+ * libads1256detect.h - Inline event detection on ADS1255/ADS1256 streams
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256DETECT_H
+#define LIBADS1256DETECT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libads1256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A detector turns a stream of conversions into a few event records, so
+ * an alarm needs neither the samples nor a later pass over them:
+ *
+ *  - LEVEL:    the code went above @high or below @low, and back inside
+ *              by @hysteresis.
+ *  - SPIKE:    a single sample jumped more than @spike away from both
+ *              neighbours, in opposite directions.
+ *  - STEP:     the mean of the @step_window samples after a point moved
+ *              more than @step from the mean of the ones before it.
+ *  - FLATLINE: @flat_samples samples stayed within @flat_delta of the
+ *              first one, a stuck input or a dead sensor.
+ *
+ * The samples are handled in blocks of ADS125x_DETECT_BLOCK. The minimum,
+ * maximum and largest difference of a block are computed by branch-free
+ * loops the compiler vectorizes, and a detector looks at the samples one
+ * by one only when these show the block may hold an event of its kind.
+ * A quiet stream costs a few compares per sample. FLATLINE is the
+ * exception, it follows its run sample by sample in every block that
+ * moves more than @flat_delta.
+ *
+ * An event is returned once @context samples after it are in, with up to
+ * @context samples on each side.
+ */
+#define ADS125x_DETECT_LEVEL        0x01
+#define ADS125x_DETECT_SPIKE        0x02
+#define ADS125x_DETECT_STEP         0x04
+#define ADS125x_DETECT_FLATLINE     0x08
+
+#define ADS125x_DETECT_BLOCK        1024
+#define ADS125x_DETECT_MAX_WINDOW   4096
+#define ADS125x_DETECT_CONTEXT_MAX  16
+#define ADS125x_DETECT_PENDING      256     // Events waiting for their context
+
+#define ADS125x_EVENT_HIGH          0
+#define ADS125x_EVENT_LOW           1
+#define ADS125x_EVENT_NORMAL        2
+#define ADS125x_EVENT_SPIKE         3
+#define ADS125x_EVENT_STEP          4
+#define ADS125x_EVENT_FLATLINE      5
+#define ADS125x_EVENT_TYPES         6
+
+/**
+ * ads125x_detect_config - What to detect, see ads125xDetectConfigInit()
+ * @mask: ADS125x_DETECT_* detectors to run.
+ * @high: A code above it is a HIGH event.
+ * @low: A code below it is a LOW event.
+ * @hysteresis: A NORMAL event needs the code back this far inside the level.
+ * @spike: Smallest jump of a spike, in codes.
+ * @step: Smallest change of the mean of a step, in codes.
+ * @step_window: Samples averaged on each side of a step.
+ * @flat_delta: Largest change of a flatline, in codes.
+ * @flat_samples: Length of a flatline.
+ * @context: Samples recorded on each side of an event.
+ */
+typedef struct ads125x_detect_config_struct
+{
+    int mask;
+    int32_t high;
+    int32_t low;
+    int32_t hysteresis;
+    int32_t spike;
+    int32_t step;
+    uint32_t step_window;
+    int32_t flat_delta;
+    uint64_t flat_samples;
+    uint32_t context;
+} ads125x_detect_config;
+
+/**
+ * ads125x_event - One detected event
+ * @index: Sample of the event, the first pushed sample is 0. A STEP is
+ *         the first sample after the change, a FLATLINE the sample that
+ *         made it long enough.
+ * @ts: Its DRDY time, CLOCK_MONOTONIC ns, 0 if pushed without timestamps.
+ * @type: ADS125x_EVENT_*.
+ * @code: The sample, for a STEP the mean after it.
+ * @ref: What it was compared to: the level crossed, the mean of the
+ *       neighbours of a spike, the mean before a step, the first sample
+ *       of a flatline.
+ * @context_index: Sample of context[0].
+ * @context_n: Samples in @context.
+ */
+typedef struct ads125x_event_struct
+{
+    uint64_t index;
+    uint64_t ts;
+    int type;
+    int32_t code;
+    int32_t ref;
+    uint64_t context_index;
+    uint32_t context_n;
+    int32_t context[2 * ADS125x_DETECT_CONTEXT_MAX + 1];
+} ads125x_event;
+
+/**
+ * ads125x_detect_stats - What a detector did
+ * @samples: Samples pushed.
+ * @events: Events of each type detected.
+ * @dropped: Events lost because ADS125x_DETECT_PENDING were waiting.
+ * @blocks: Blocks of samples handled.
+ * @scanned: Blocks a detector had to check sample by sample, the others
+ *           were ruled out by their minimum, maximum and differences.
+ */
+typedef struct ads125x_detect_stats_struct
+{
+    uint64_t samples;
+    uint64_t events[ADS125x_EVENT_TYPES];
+    uint64_t dropped;
+    uint64_t blocks;
+    uint64_t scanned;
+} ads125x_detect_stats;
+
+typedef struct ads125x_detect_struct ads125x_detect;
+
+void ads125xDetectConfigInit(ads125x_detect_config *cfg);
+ads125x_detect *ads125xDetectOpen(const ads125x_detect_config *cfg);
+int ads125xDetectPush(ads125x_detect *d, const int32_t *codes, const uint64_t *ts, size_t n, ads125x_event *events, int max);
+int ads125xDetectPushRaw(ads125x_detect *d, const uint8_t *raw, const uint64_t *ts, size_t n, ads125x_event *events, int max);
+int ads125xDetectFlush(ads125x_detect *d, ads125x_event *events, int max);
+void ads125xDetectGetStats(const ads125x_detect *d, ads125x_detect_stats *stats);
+const char *ads125xEventName(int type);
+void ads125xDetectClose(ads125x_detect *d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,350 @@
+/**
+ * libads1256duty.c - Duty-cycled low-rate sampling of ADS1255/ADS1256
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spi.h>
+#include <linux/spi/spidev.h>
+
+#include "libads1256reg.h"
+#include "libads1256duty.h"
+
+static const char *const duty_state_name[ADS125x_DUTY_STATES] = {"auto", "awake", "standby", "pdwn"};
+// Power between the readings of each state
+static const double duty_sleep_uw[ADS125x_DUTY_STATES] = {
+    0, ADS125x_POWER_ACTIVE_UW, ADS125x_POWER_STANDBY_UW, ADS125x_POWER_PDWN_UW,
+};
+
+static int duty_has_pdwn(ads125x_dev *dev)
+{
+    return dev->pin_PDWN_line || (dev->backend && dev->backend->set_pdwn);
+}
+
+/**
+ * ads125xDutyPlan - Plan a duty cycle at the cached DRATE of a device
+ * @dev: The ads125x dev info struct pointer, DRATE set.
+ * @d: Used to store the plan.
+ * @rate_hz: Readings per second.
+ * @state: ADS125x_DUTY_AUTO picks the cheapest state, or force one of
+ *         the other ADS125x_DUTY_* states.
+ *
+ * The energy of each state is estimated over a period: the awake time at
+ * ADS125x_POWER_ACTIVE_UW and the rest at the power of the state. PDWN
+ * saves more than STANDBY between the readings but its wakeup is much
+ * longer, it only pays off at low rates.
+ *
+ * @return: ADS125x_OK, or ADS125x_ERR_INVAL if the DRATE is unknown or
+ *          no state, or not the one asked for, fits the period.
+ */
+int ads125xDutyPlan(ads125x_dev *dev, ads125x_duty *d, double rate_hz, int state)
+{
+    double wake_us[ADS125x_DUTY_STATES], period_us, conv_us, settle_us, sps = 0;
+    int s, best = 0;
+
+    if (rate_hz <= 0 || state < ADS125x_DUTY_AUTO || state >= ADS125x_DUTY_STATES)
+        return ADS125x_ERR_INVAL;
+    if (dev->regs_valid & (1 << ADS125x_REG_ADDR_DRATE))
+        sps = ads125xDRATEToSPS(dev->regs[ADS125x_REG_ADDR_DRATE]);
+    if (sps == 0)
+        return ADS125x_ERR_INVAL;
+
+    memset(d, 0x00, sizeof(*d));
+    d->rate_hz = rate_hz;
+    period_us = 1e6 / rate_hz;
+    d->period_ns = (uint64_t)(period_us * 1000);
+    conv_us = 1e6 / sps;
+    settle_us = ads125xDRATEToSettleUs(dev->regs[ADS125x_REG_ADDR_DRATE]);
+
+    // Converting all the time, a reading waits for the next DRDY
+    wake_us[ADS125x_DUTY_AWAKE] = conv_us;
+    d->awake_us[ADS125x_DUTY_AWAKE] = period_us;
+    // WAKEUP, then RDATA and STANDBY in one message
+    wake_us[ADS125x_DUTY_STANDBY] = ADS125x_DUTY_XFER_US + settle_us;
+    d->awake_us[ADS125x_DUTY_STANDBY] = wake_us[ADS125x_DUTY_STANDBY] + ADS125x_DUTY_XFER_US;
+    // Oscillator and a settling time at the reset DRATE, the registers, SYNC and WAKEUP
+    wake_us[ADS125x_DUTY_PDWN] = ADS125x_PDWN_WAKE_US + ads125xDRATEToSettleUs(ADS125x_DR_30000) +
+                                 3 * ADS125x_DUTY_XFER_US + settle_us;
+    d->awake_us[ADS125x_DUTY_PDWN] = wake_us[ADS125x_DUTY_PDWN] + ADS125x_DUTY_XFER_US;
+
+    for (s = ADS125x_DUTY_AWAKE; s < ADS125x_DUTY_STATES; ++s)
+    {
+        if (s == ADS125x_DUTY_PDWN && !duty_has_pdwn(dev))
+            continue;
+        if (wake_us[s] + ADS125x_DUTY_XFER_US + (s == ADS125x_DUTY_AWAKE ? 0 : ADS125x_DUTY_MARGIN_US) > period_us)
+            continue;
+        d->energy_uj[s] = (ADS125x_POWER_ACTIVE_UW * d->awake_us[s] +
+                           duty_sleep_uw[s] * (period_us - d->awake_us[s])) * 1e-6;
+        if (!best || d->energy_uj[s] < d->energy_uj[best])
+            best = s;
+    }
+    if (state != ADS125x_DUTY_AUTO)
+        best = d->energy_uj[state] > 0 ? state : 0;
+    if (!best)
+        return ADS125x_ERR_INVAL;
+    d->state = best;
+    d->wake_us = wake_us[best];
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xDutyPrint - Print the plan of a duty cycle
+ * @d: The planned duty cycle.
+ * @fp: Where to print.
+ */
+void ads125xDutyPrint(const ads125x_duty *d, FILE *fp)
+{
+    int s;
+
+    fprintf(fp, "Duty cycle %.3lf Hz in %s, wake up %.3lf ms before each reading, awake %.3lf ms (%.2lf %%)\n",
+            d->rate_hz, duty_state_name[d->state], d->wake_us * 1e-3, d->awake_us[d->state] * 1e-3,
+            d->awake_us[d->state] * 1e5 / d->period_ns);
+    for (s = ADS125x_DUTY_AWAKE; s < ADS125x_DUTY_STATES; ++s)
+    {
+        if (d->energy_uj[s] > 0)
+            fprintf(fp, "  %-8s %10.3lf uJ per reading, %10.3lf uW\n", duty_state_name[s],
+                    d->energy_uj[s], d->energy_uj[s] * d->rate_hz);
+        else
+            fprintf(fp, "  %-8s not possible\n", duty_state_name[s]);
+    }
+    return;
+}
+
+/**
+ * duty_sleep_until - Sleep until a CLOCK_MONOTONIC time in ns
+ */
+static void duty_sleep_until(uint64_t ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = ns / 1000000000ULL;
+    ts.tv_nsec = ns % 1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+    return;
+}
+
+/**
+ * duty_read_message - One SPI message: RDATA, then STANDBY if asked
+ * @data: Used to store the conversion, give 3 bytes.
+ */
+static int duty_read_message(ads125x_dev *dev, uint8_t *data, int standby)
+{
+    uint8_t tx[2] = {ADS125x_CMD_RDATA, ADS125x_CMD_STANDBY};
+    struct spi_ioc_transfer spi[3];
+    int n = 2, i;
+
+    memset(&spi, 0, sizeof(spi));
+    spi[0].tx_buf = (unsigned long)&tx[0];
+    spi[0].len = 1;
+    spi[0].delay_usecs = ADS125x_T6_US;
+    spi[1].rx_buf = (unsigned long)data;
+    spi[1].len = 3;
+    if (standby)
+    {
+        spi[2].tx_buf = (unsigned long)&tx[1];
+        spi[2].len = 1;
+        n = 3;
+    }
+    for (i = 0; i < n; ++i)
+    {
+        spi[i].speed_hz = dev->spi_speed;
+        spi[i].bits_per_word = dev->spi_bit_p_word;
+    }
+    if (ads125xTransfer(dev, spi, n) < 0)
+        return FailurePrint("Duty cycle read error: %s\n", strerror(errno));
+    if (standby)
+        dev->power = ADS125x_POWER_STANDBY;
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xDutyStart - Put the chip in the planned state
+ * @dev: The ads125x dev info struct pointer, not in RDATAC mode.
+ * @d: The planned duty cycle.
+ *
+ * For PDWN all the registers are read first, so that they are all
+ * cached and written back after each power up.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xDutyStart(ads125x_dev *dev, ads125x_duty *d)
+{
+    uint8_t regs[ADS125x_REG_NUM];
+    int ret;
+
+    if (!d->state || dev->rdatac)
+        return ADS125x_ERR_INVAL;
+    memset(&d->stats, 0x00, sizeof(d->stats));
+    d->lead_ns = (uint64_t)(d->wake_us * 1000) + ADS125x_DUTY_MARGIN_US * 1000ULL;
+    d->next_ns = ads125xNowNs() + d->lead_ns;
+
+    switch (d->state)
+    {
+    case ADS125x_DUTY_AWAKE:
+        if ((ret = ads125xSendCMD(dev, ADS125x_CMD_SYNC)) < 0)
+            return ret;
+        return ads125xWAKEUP(dev);
+    case ADS125x_DUTY_STANDBY:
+        if ((ret = ads125xwaitDRDY(dev)) < 0)
+            return ret;
+        return ads125xSTANDBY(dev);
+    default:
+        if (dev->regs_valid != (1 << ADS125x_REG_NUM) - 1 &&
+            (ret = ads125xRREG(dev, ADS125x_REG_ADDR_STATUS, regs, ADS125x_REG_NUM)) < 0)
+            return ret;
+        return ads125xPowerDown(dev);
+    }
+}
+
+/**
+ * duty_account - Update the statistics and the wakeup lead with a reading
+ * @wake_at: When the wakeup was planned.
+ * @deadline: When the reading was due.
+ */
+static void duty_account(ads125x_duty *d, ads125x_duty_sample *out, uint64_t wake_at, uint64_t deadline)
+{
+    ads125x_duty_stats *st = &d->stats;
+    uint64_t need, awake = out->awake_ns < d->period_ns ? out->awake_ns : d->period_ns;
+
+    out->late_ns = (int64_t)(out->ts - deadline);
+    st->readings++;
+    if (out->late_ns > 0)
+    {
+        st->late++;
+        if ((uint64_t)out->late_ns > st->late_max_ns)
+            st->late_max_ns = out->late_ns;
+    }
+    else if ((uint64_t)-out->late_ns > st->early_max_ns)
+        st->early_max_ns = -out->late_ns;
+    st->awake_ns += out->awake_ns;
+    if (out->awake_ns > st->awake_max_ns)
+        st->awake_max_ns = out->awake_ns;
+    st->energy_uj += (ADS125x_POWER_ACTIVE_UW * awake + duty_sleep_uw[d->state] * (d->period_ns - awake)) * 1e-9;
+
+    // Grow the lead at once when late, shrink it slowly when early
+    if (d->state == ADS125x_DUTY_AWAKE)
+        return;
+    need = out->ts - wake_at + ADS125x_DUTY_MARGIN_US * 1000ULL;
+    if (need > d->lead_ns)
+        d->lead_ns = need;
+    else
+        d->lead_ns -= (d->lead_ns - need) / 8;
+    return;
+}
+
+/**
+ * ads125xDutyRead - Take the next readings of a running duty cycle
+ * @dev: The ads125x dev info struct pointer.
+ * @d: The duty cycle, see ads125xDutyStart().
+ * @out: Used to store the readings, give times space.
+ * @times: Read times
+ *
+ * Sleeps until each wakeup. A caller that comes back too late for a
+ * wakeup skips the periods it missed, they are counted in the stats.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xDutyRead(ads125x_dev *dev, ads125x_duty *d, ads125x_duty_sample *out, int times)
+{
+    uint8_t raw[3];
+    uint64_t wake_at, wake_ns, now, missed;
+    int i, ret;
+
+    for (i = 0; i < times; ++i)
+    {
+        wake_at = d->next_ns - d->lead_ns;
+        if ((now = ads125xNowNs()) > wake_at + d->period_ns)
+        {
+            missed = (now - wake_at) / d->period_ns;
+            d->stats.skipped += missed;
+            d->next_ns += missed * d->period_ns;
+            wake_at += missed * d->period_ns;
+        }
+        duty_sleep_until(wake_at);
+        wake_ns = ads125xNowNs();
+
+        switch (d->state)
+        {
+        case ADS125x_DUTY_AWAKE:
+            if ((ret = ads125xwaitDRDY(dev)) < 0 || (ret = duty_read_message(dev, raw, 0)) < 0)
+                return ret;
+            break;
+        case ADS125x_DUTY_STANDBY:
+            if ((ret = ads125xWAKEUP(dev)) < 0 || (ret = ads125xwaitDRDY(dev)) < 0 ||
+                (ret = duty_read_message(dev, raw, 1)) < 0)
+                return ret;
+            break;
+        default:
+            if ((ret = ads125xPowerUp(dev)) < 0 || (ret = ads125xSendCMD(dev, ADS125x_CMD_SYNC)) < 0 ||
+                (ret = ads125xWAKEUP(dev)) < 0 || (ret = ads125xwaitDRDY(dev)) < 0 ||
+                (ret = duty_read_message(dev, raw, 0)) < 0 || (ret = ads125xPowerDown(dev)) < 0)
+                return ret;
+            break;
+        }
+        out[i].code = convert_to_signed_24bit(raw);
+        out[i].ts = dev->drdy_ns;
+        out[i].awake_ns = d->state == ADS125x_DUTY_AWAKE ? d->period_ns : ads125xNowNs() - wake_ns;
+        duty_account(d, &out[i], wake_at, d->next_ns);
+        d->next_ns += d->period_ns;
+    }
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xDutyStop - Leave the chip awake and converting
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xDutyStop(ads125x_dev *dev)
+{
+    if (dev->power == ADS125x_POWER_DOWN)
+        return ads125xPowerUp(dev);
+    if (dev->power == ADS125x_POWER_STANDBY)
+        return ads125xWAKEUP(dev);
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xDutyGetStats - Get what a duty cycle achieved since ads125xDutyStart()
+ * @d: The duty cycle.
+ * @stats: Used to store the statistics.
+ */
+void ads125xDutyGetStats(const ads125x_duty *d, ads125x_duty_stats *stats)
+{
+    *stats = d->stats;
+    return;
+}
@@ -0,0 +1,148 @@
+/**
+ * libads1256duty.h - Duty-cycled low-rate sampling of ADS1255/ADS1256
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256DUTY_H
+#define LIBADS1256DUTY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "libads1256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A duty cycle takes one conversion per period and keeps the chip in a
+ * low-power state in between. Before each reading the chip is
+ *
+ *  - woken from STANDBY, the oscillator kept running so the reading
+ *    costs the settling time of the DRATE, see ads125xDRATEToSettleUs(),
+ *  - or powered up through PDWN, which first waits for the oscillator,
+ *    ADS125x_PDWN_WAKE_US, and writes back the cached registers,
+ *  - or not put to sleep at all when the period is too short for either.
+ *
+ * ads125xDutyPlan() picks the state with the lowest energy per period
+ * that still wakes up in time. ads125xDutyRead() wakes the chip that
+ * long before each deadline, and learns how long the wakeups really take,
+ * so each reading is ready at its deadline and the chip is awake no
+ * longer than needed.
+ */
+#define ADS125x_DUTY_AUTO           0
+#define ADS125x_DUTY_AWAKE          1
+#define ADS125x_DUTY_STANDBY        2
+#define ADS125x_DUTY_PDWN           3
+#define ADS125x_DUTY_STATES         4
+
+#define ADS125x_DUTY_XFER_US        30      // SPI message and ioctl
+#define ADS125x_DUTY_MARGIN_US      200     // Wake up this much before the expected DRDY
+
+// Typical power dissipation used to compare the states, in uW
+#define ADS125x_POWER_ACTIVE_UW     38000
+#define ADS125x_POWER_STANDBY_UW    400
+#define ADS125x_POWER_PDWN_UW       10
+
+/**
+ * ads125x_duty_sample - One reading of a duty cycle
+ * @code: The conversion.
+ * @ts: DRDY time, CLOCK_MONOTONIC ns.
+ * @late_ns: DRDY time minus the deadline, < 0 is early.
+ * @awake_ns: Time the chip was out of its low-power state for it.
+ */
+typedef struct ads125x_duty_sample_struct
+{
+    int32_t code;
+    uint64_t ts;
+    int64_t late_ns;
+    uint64_t awake_ns;
+} ads125x_duty_sample;
+
+/**
+ * ads125x_duty_stats - What a duty cycle achieved
+ * @readings: Readings taken.
+ * @skipped: Periods skipped because the caller was too late to wake up.
+ * @late: Readings ready after their deadline.
+ * @late_max_ns: Largest lateness.
+ * @early_max_ns: Largest time a reading was ready before its deadline.
+ * @awake_ns: Total awake time.
+ * @awake_max_ns: Longest awake time of a reading.
+ * @energy_uj: Estimated chip energy, from the ADS125x_POWER_* figures.
+ */
+typedef struct ads125x_duty_stats_struct
+{
+    uint64_t readings;
+    uint64_t skipped;
+    uint64_t late;
+    uint64_t late_max_ns;
+    uint64_t early_max_ns;
+    uint64_t awake_ns;
+    uint64_t awake_max_ns;
+    double energy_uj;
+} ads125x_duty_stats;
+
+/**
+ * ads125x_duty - A planned duty cycle
+ * @rate_hz: Readings per second.
+ * @period_ns: Time between the deadlines.
+ * @state: ADS125x_DUTY_* state between the readings.
+ * @wake_us: Planned time from the wakeup to DRDY.
+ * @awake_us: Planned awake time per reading, of each state.
+ * @energy_uj: Planned energy per period, of each state, 0 is not possible.
+ */
+typedef struct ads125x_duty_struct
+{
+    double rate_hz;
+    uint64_t period_ns;
+    int state;
+    double wake_us;
+    double awake_us[ADS125x_DUTY_STATES];
+    double energy_uj[ADS125x_DUTY_STATES];
+    // Run state, the next deadline and how long before it to wake up
+    uint64_t next_ns;
+    uint64_t lead_ns;
+    ads125x_duty_stats stats;
+} ads125x_duty;
+
+int ads125xDutyPlan(ads125x_dev *dev, ads125x_duty *d, double rate_hz, int state);
+void ads125xDutyPrint(const ads125x_duty *d, FILE *fp);
+int ads125xDutyStart(ads125x_dev *dev, ads125x_duty *d);
+int ads125xDutyRead(ads125x_dev *dev, ads125x_duty *d, ads125x_duty_sample *out, int times);
+int ads125xDutyStop(ads125x_dev *dev);
+void ads125xDutyGetStats(const ads125x_duty *d, ads125x_duty_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
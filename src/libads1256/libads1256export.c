@@ -0,0 +1,395 @@
+/**
+ * libads1256export.c - Parallel CSV export of ADS1255/ADS1256 captures
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "libads1256export.h"
+
+#define EXPORT_FRAC_DIGITS  12
+#define EXPORT_FRAC_SCALE   1000000000000ULL    // 10^EXPORT_FRAC_DIGITS
+#define EXPORT_CODE_BITS    23
+
+// "00" ~ "ff" and "00" ~ "99", filled once by export_init_tables()
+static char export_hex[256][2];
+static char export_dec[100][2];
+static pthread_once_t export_once = PTHREAD_ONCE_INIT;
+
+typedef struct export_slot_struct
+{
+    char *buf;
+    size_t len;
+    int ready;
+} export_slot;
+
+typedef struct export_job_struct
+{
+    const uint8_t *raw;
+    size_t count;
+    uint64_t first;
+    size_t chunks;
+    export_slot *slots;
+    int nslots;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    size_t next;            // Next chunk to format
+    size_t written;         // Chunks written, a chunk is formatted only when its slot is free
+    int stop;
+} export_job;
+
+static void export_init_tables(void)
+{
+    static const char digits[] = "0123456789abcdef";
+    int i;
+
+    for (i = 0; i < 256; ++i)
+    {
+        export_hex[i][0] = digits[i >> 4];
+        export_hex[i][1] = digits[i & 0x0F];
+    }
+    for (i = 0; i < 100; ++i)
+    {
+        export_dec[i][0] = '0' + i / 10;
+        export_dec[i][1] = '0' + i % 10;
+    }
+    return;
+}
+
+static uint64_t export_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * export_index - Print @n right-aligned in 5 columns, as "%5llu"
+ */
+static char *export_index(char *p, uint64_t n)
+{
+    char tmp[20];
+    int len = 0;
+
+    while (n >= 100)
+    {
+        len += 2;
+        memcpy(tmp + sizeof(tmp) - len, export_dec[n % 100], 2);
+        n /= 100;
+    }
+    if (n >= 10)
+    {
+        len += 2;
+        memcpy(tmp + sizeof(tmp) - len, export_dec[n], 2);
+    }
+    else
+        tmp[sizeof(tmp) - ++len] = '0' + n;
+    while (len < 5)
+        tmp[sizeof(tmp) - ++len] = ' ';
+    memcpy(p, tmp + sizeof(tmp) - len, len);
+    return p + len;
+}
+
+/**
+ * export_volt - Print the volts of @code, as "%.12lf"
+ *
+ * code * FULL_SCALE / 2^23 has 23 binary decimals, its 12 decimal
+ * digits are the integer (frac * 10^12) >> 23, which fits in 64 bits.
+ * The remainder rounds it to nearest, ties to even, as printf does.
+ */
+static char *export_volt(char *p, int32_t code)
+{
+    uint64_t v = (uint64_t)(code < 0 ? -(int64_t)code : code) * ADS125x_EXPORT_FULL_SCALE;
+    uint64_t ip = v >> EXPORT_CODE_BITS;
+    uint64_t x = (v & ((1ULL << EXPORT_CODE_BITS) - 1)) * EXPORT_FRAC_SCALE;
+    uint64_t frac = x >> EXPORT_CODE_BITS;
+    uint64_t rem = x & ((1ULL << EXPORT_CODE_BITS) - 1);
+    uint64_t half = 1ULL << (EXPORT_CODE_BITS - 1);
+    int i;
+
+    if (rem > half || (rem == half && (frac & 1)))
+        ++frac;
+    if (frac == EXPORT_FRAC_SCALE)
+    {
+        frac = 0;
+        ++ip;
+    }
+    if (code < 0)
+        *p++ = '-';
+    // Full scale is 5 V, the integer part is a single digit
+    *p++ = '0' + ip;
+    *p++ = '.';
+    for (i = EXPORT_FRAC_DIGITS - 2; i >= 0; i -= 2)
+    {
+        memcpy(p + i, export_dec[frac % 100], 2);
+        frac /= 100;
+    }
+    return p + EXPORT_FRAC_DIGITS;
+}
+
+/**
+ * ads125xExportFormat - Format samples as CSV lines
+ * @out: At least @count * ADS125x_EXPORT_LINE_MAX bytes.
+ * @raw: @count raw samples, 3 bytes each.
+ * @count: Number of samples.
+ * @first: Index printed on the first line, the first sample of a capture is 1.
+ *
+ * @return: Bytes written to @out, not NUL terminated.
+ */
+size_t ads125xExportFormat(char *out, const uint8_t *raw, size_t count, uint64_t first)
+{
+    char *p = out;
+    size_t i;
+
+    pthread_once(&export_once, export_init_tables);
+    for (i = 0; i < count; ++i, raw += ADS125x_DATA_LEN_BYTE)
+    {
+        p = export_index(p, first + i);
+        *p++ = ',';
+        memcpy(p, export_hex[raw[0]], 2);
+        memcpy(p + 2, export_hex[raw[1]], 2);
+        memcpy(p + 4, export_hex[raw[2]], 2);
+        p += 6;
+        *p++ = ',';
+        p = export_volt(p, convert_to_signed_24bit((uint8_t *)raw));
+        *p++ = '\n';
+    }
+    return p - out;
+}
+
+static int export_write_all(int fd, const char *buf, size_t len)
+{
+    ssize_t n;
+
+    while (len > 0)
+    {
+        if ((n = write(fd, buf, len)) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return FailurePrint("Export: write error: %s\n", strerror(errno));
+        }
+        buf += n;
+        len -= n;
+    }
+    return ADS125x_OK;
+}
+
+static void export_format_chunk(export_job *job, size_t k, export_slot *slot)
+{
+    size_t start = k * ADS125x_EXPORT_CHUNK;
+    size_t n = job->count - start < ADS125x_EXPORT_CHUNK ? job->count - start : ADS125x_EXPORT_CHUNK;
+
+    slot->len = ads125xExportFormat(slot->buf, job->raw + start * ADS125x_DATA_LEN_BYTE, n, job->first + start);
+    return;
+}
+
+static void *export_worker(void *arg)
+{
+    export_job *job = (export_job *)arg;
+    export_slot *slot;
+    size_t k;
+
+    pthread_mutex_lock(&job->lock);
+    for (;;)
+    {
+        while (!job->stop && job->next < job->chunks && job->next >= job->written + job->nslots)
+            pthread_cond_wait(&job->cond, &job->lock);
+        if (job->stop || job->next >= job->chunks)
+            break;
+        k = job->next++;
+        slot = &job->slots[k % job->nslots];
+        pthread_mutex_unlock(&job->lock);
+
+        export_format_chunk(job, k, slot);
+
+        pthread_mutex_lock(&job->lock);
+        slot->ready = 1;
+        pthread_cond_broadcast(&job->cond);
+    }
+    pthread_mutex_unlock(&job->lock);
+    return NULL;
+}
+
+/**
+ * ads125xExportWrite - Format samples as CSV on a pool of threads and write them in order
+ * @fd: Destination, flush any stdio buffer of it first.
+ * @raw: @count raw samples, 3 bytes each.
+ * @count: Number of samples.
+ * @first: Index of the first line.
+ * @threads: Formatting threads, <= 0 is one per online CPU, 1 formats
+ *           in the calling thread.
+ * @stats: Filled with what was done, may be NULL.
+ *
+ * @return: ADS125x_OK, ADS125x_ERR_IO on a write or allocation failure.
+ */
+int ads125xExportWrite(int fd, const uint8_t *raw, size_t count, uint64_t first, int threads, ads125x_export_stats *stats)
+{
+    export_job job;
+    pthread_t workers[ADS125x_EXPORT_MAX_THREADS];
+    export_slot *slot;
+    uint64_t start = export_now_ns(), bytes = 0;
+    size_t k;
+    int i, started = 0, ret = ADS125x_OK;
+
+    memset(&job, 0x00, sizeof(job));
+    job.raw = raw;
+    job.count = count;
+    job.first = first;
+    job.chunks = (count + ADS125x_EXPORT_CHUNK - 1) / ADS125x_EXPORT_CHUNK;
+    if (threads <= 0)
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > ADS125x_EXPORT_MAX_THREADS)
+        threads = ADS125x_EXPORT_MAX_THREADS;
+    if ((size_t)threads > job.chunks)
+        threads = (int)job.chunks;
+    if (threads < 1)
+        threads = 1;
+    job.nslots = threads > 1 ? threads * 2 : 1;
+    if ((job.slots = (export_slot *)calloc(job.nslots, sizeof(export_slot))) == NULL)
+        return FailurePrint("Export: allocate slots failed.\n");
+    for (i = 0; i < job.nslots; ++i)
+        if ((job.slots[i].buf = (char *)malloc(ADS125x_EXPORT_CHUNK * ADS125x_EXPORT_LINE_MAX)) == NULL)
+        {
+            ret = FailurePrint("Export: allocate chunk buffers failed.\n");
+            goto out;
+        }
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.cond, NULL);
+
+    if (threads > 1)
+        for (started = 0; started < threads; ++started)
+            if (pthread_create(&workers[started], NULL, export_worker, &job))
+                break;
+    // Without a worker the calling thread formats each chunk itself
+    for (k = 0; k < job.chunks && ret == ADS125x_OK; ++k)
+    {
+        slot = &job.slots[k % job.nslots];
+        if (started == 0)
+            export_format_chunk(&job, k, slot);
+        else
+        {
+            pthread_mutex_lock(&job.lock);
+            while (!slot->ready)
+                pthread_cond_wait(&job.cond, &job.lock);
+            pthread_mutex_unlock(&job.lock);
+        }
+        ret = export_write_all(fd, slot->buf, slot->len);
+        bytes += slot->len;
+
+        pthread_mutex_lock(&job.lock);
+        slot->ready = 0;
+        job.written = k + 1;
+        if (ret != ADS125x_OK)
+            job.stop = 1;
+        pthread_cond_broadcast(&job.cond);
+        pthread_mutex_unlock(&job.lock);
+    }
+    for (i = 0; i < started; ++i)
+        pthread_join(workers[i], NULL);
+    pthread_cond_destroy(&job.cond);
+    pthread_mutex_destroy(&job.lock);
+
+    if (stats)
+    {
+        stats->samples = ret == ADS125x_OK ? count : 0;
+        stats->bytes = bytes;
+        stats->threads = started ? started : 1;
+        stats->elapsed = (export_now_ns() - start) * 1e-9;
+    }
+out:
+    for (i = 0; i < job.nslots; ++i)
+        free(job.slots[i].buf);
+    free(job.slots);
+    return ret;
+}
+
+/**
+ * ads125xExportFile - Export a binary capture to CSV
+ * @capture: Binary capture, 3 bytes per sample, see ads125xWriterOpen().
+ * @csv: CSV file to create, "-" is stdout.
+ * @threads: Formatting threads, see ads125xExportWrite().
+ * @stats: Filled with what was done, may be NULL.
+ *
+ * A trailing partial sample of the capture is ignored.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xExportFile(const char *capture, const char *csv, int threads, ads125x_export_stats *stats)
+{
+    struct stat st;
+    void *map = NULL;
+    size_t count;
+    int in, out, ret;
+
+    if ((in = open(capture, O_RDONLY)) < 0)
+        return FailurePrint("Export: open %s error: %s\n", capture, strerror(errno));
+    if (fstat(in, &st) < 0)
+    {
+        close(in);
+        return FailurePrint("Export: stat %s error: %s\n", capture, strerror(errno));
+    }
+    count = (size_t)st.st_size / ADS125x_DATA_LEN_BYTE;
+    if (count > 0 && (map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, in, 0)) == MAP_FAILED)
+    {
+        close(in);
+        return FailurePrint("Export: map %s error: %s\n", capture, strerror(errno));
+    }
+    close(in);
+    if (map)
+        madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    if (strcmp(csv, "-") == 0)
+        out = STDOUT_FILENO;
+    else if ((out = open(csv, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+    {
+        if (map)
+            munmap(map, st.st_size);
+        return FailurePrint("Export: open %s error: %s\n", csv, strerror(errno));
+    }
+    ret = ads125xExportWrite(out, (const uint8_t *)map, count, 1, threads, stats);
+    if (out != STDOUT_FILENO && close(out) < 0 && ret == ADS125x_OK)
+        ret = FailurePrint("Export: close %s error: %s\n", csv, strerror(errno));
+    if (map)
+        munmap(map, st.st_size);
+    return ret;
+}
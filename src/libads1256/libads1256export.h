@@ -0,0 +1,90 @@
+/**
+ * libads1256export.h - Parallel CSV export of ADS1255/ADS1256 captures
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256EXPORT_H
+#define LIBADS1256EXPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libads1256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The export writes the CSV of the continuous mode, one line per sample:
+ *
+ *     <index>,<raw hex>,<volt>
+ *
+ * the index right-aligned in 5 columns and counted from 1, the volts
+ * with 12 decimals for ADS125x_EXPORT_FULL_SCALE at code 2^23. It is
+ * byte for byte the output of "%5d,%02x%02x%02x,%.12lf\n", without the
+ * printf: the volts of a code are an exact binary fraction, which is
+ * rounded to 12 decimals in integer arithmetic, and the hex and index
+ * digits come from lookup tables.
+ *
+ * The samples are cut into chunks of ADS125x_EXPORT_CHUNK, formatted by
+ * a pool of threads and written in order by the calling thread. At most
+ * two chunks per thread are in memory.
+ */
+#define ADS125x_EXPORT_CHUNK        8192
+#define ADS125x_EXPORT_LINE_MAX     48      // 20 index digits, hex and "-5.000000000000"
+#define ADS125x_EXPORT_MAX_THREADS  64
+#define ADS125x_EXPORT_FULL_SCALE   5       // Volts of code 2^23, as continu_read() prints
+
+/**
+ * ads125x_export_stats - What an export did
+ * @samples: Samples written.
+ * @bytes: CSV bytes written.
+ * @threads: Formatting threads used.
+ * @elapsed: Wall time, in seconds.
+ */
+typedef struct ads125x_export_stats_struct
+{
+    uint64_t samples;
+    uint64_t bytes;
+    int threads;
+    double elapsed;
+} ads125x_export_stats;
+
+size_t ads125xExportFormat(char *out, const uint8_t *raw, size_t count, uint64_t first);
+int ads125xExportWrite(int fd, const uint8_t *raw, size_t count, uint64_t first, int threads, ads125x_export_stats *stats);
+int ads125xExportFile(const char *capture, const char *csv, int threads, ads125x_export_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
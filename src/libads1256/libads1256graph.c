@@ -0,0 +1,873 @@
+/**
+ * libads1256graph.c - Dataflow graph of ADS1255/ADS1256 sources, transforms and sinks
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libads1256graph.h"
+#include "libads1256arena.h"
+
+// Blocks a node takes from its input per run, then it yields its worker
+#define GRAPH_RUN_BLOCKS            8
+
+typedef struct graph_queue_struct
+{
+    ads125x_gblock *slot[ADS125x_GRAPH_QUEUE];
+    uint64_t head __attribute__((aligned(ADS125x_ARENA_ALIGN)));    // Consumer side
+    uint64_t tail __attribute__((aligned(ADS125x_ARENA_ALIGN)));    // Producer side
+} graph_queue;
+
+typedef struct graph_node_struct
+{
+    ads125x_graph *g;
+    int id;
+    int type;
+    ads125x_graph_fn fn;
+    void *arg;
+    void *owned;            // State of a built-in node, freed with the graph
+    // Source
+    ads125x_dev *dev;
+    uint64_t samples;       // 0 is until ads125xGraphStop()
+    uint8_t *raw;
+    pthread_t thread;
+    // The only input, the queue belongs to its consumer
+    graph_queue *in;
+    int producer;
+    int outs[ADS125x_GRAPH_MAX_OUTPUTS];
+    int nout;
+    // Set while the node is in a deque or running, a node runs on one worker at a time
+    int queued;
+    ads125x_graph_node_stats stats;
+} graph_node;
+
+typedef struct graph_worker_struct
+{
+    ads125x_graph *g;
+    pthread_t thread;
+    // Runnable nodes, the owner pops the newest at tail, thieves the oldest at head
+    pthread_mutex_t lock;
+    int ring[ADS125x_GRAPH_MAX_NODES];
+    unsigned head;
+    unsigned tail;
+    uint64_t runs;
+    uint64_t steals;
+} __attribute__((aligned(ADS125x_ARENA_ALIGN))) graph_worker;
+
+struct ads125x_graph_struct
+{
+    size_t block_samples;
+    graph_node nodes[ADS125x_GRAPH_MAX_NODES];
+    int nnodes;
+    graph_worker *workers;
+    int nworkers;
+    ads125x_arena *arena;
+    ads125x_pool *pool;
+
+    // Idle workers wait on cond, ads125xGraphWait() on drained
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_cond_t drained;
+    int ntasks;
+    int sleepers;
+    int inflight;           // Blocks in the queues or being processed
+    int sources_left;
+    int stop;
+    int done;
+    unsigned next_worker;
+    int started;
+    int err;
+    uint64_t start_ns;
+    uint64_t end_ns;
+};
+
+// The worker running on this thread, to queue the nodes it wakes on its own deque
+static __thread graph_worker *graph_self;
+
+static uint64_t graph_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int graph_queue_len(const graph_queue *q)
+{
+    return (int)(__atomic_load_n(&q->tail, __ATOMIC_SEQ_CST) - __atomic_load_n(&q->head, __ATOMIC_SEQ_CST));
+}
+
+static int graph_runnable(ads125x_graph *g, graph_node *node)
+{
+    int i;
+
+    if (!node->in || graph_queue_len(node->in) == 0)
+        return 0;
+    for (i = 0; i < node->nout; ++i)
+        if (graph_queue_len(g->nodes[node->outs[i]].in) >= ADS125x_GRAPH_QUEUE)
+            return 0;
+    return 1;
+}
+
+static void graph_push_task(ads125x_graph *g, int id)
+{
+    graph_worker *w = graph_self && graph_self->g == g ? graph_self
+                    : &g->workers[__atomic_fetch_add(&g->next_worker, 1, __ATOMIC_RELAXED) % g->nworkers];
+
+    pthread_mutex_lock(&w->lock);
+    w->ring[w->tail++ % ADS125x_GRAPH_MAX_NODES] = id;
+    pthread_mutex_unlock(&w->lock);
+    __atomic_add_fetch(&g->ntasks, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&g->sleepers, __ATOMIC_SEQ_CST) > 0)
+    {
+        pthread_mutex_lock(&g->lock);
+        pthread_cond_signal(&g->cond);
+        pthread_mutex_unlock(&g->lock);
+    }
+    return;
+}
+
+/**
+ * graph_wake - Queue a node if it can run, after its input or an output queue changed
+ */
+static void graph_wake(ads125x_graph *g, graph_node *node)
+{
+    if (node->type == ADS125x_GRAPH_SOURCE || !graph_runnable(g, node))
+        return;
+    if (!__atomic_exchange_n(&node->queued, 1, __ATOMIC_SEQ_CST))
+        graph_push_task(g, node->id);
+    return;
+}
+
+// Keep the first error for ads125xGraphWait()
+static void graph_error(ads125x_graph *g, graph_node *node, int err)
+{
+    int none = ADS125x_OK;
+
+    node->stats.errors++;
+    __atomic_compare_exchange_n(&g->err, &none, err, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    return;
+}
+
+static void graph_release(ads125x_graph *g, ads125x_gblock *blk)
+{
+    if (__atomic_sub_fetch(&blk->refs, 1, __ATOMIC_ACQ_REL) == 0)
+        ads125xPoolPut(g->pool, blk);
+    return;
+}
+
+/**
+ * graph_send - Queue a block on every output of a node
+ *
+ * A transform only runs with room in all its outputs, a source drops
+ * the block on a full one.
+ *
+ * @return: Outputs the block was dropped on.
+ */
+static int graph_send(ads125x_graph *g, graph_node *node, ads125x_gblock *blk)
+{
+    graph_queue *q;
+    int i, room[ADS125x_GRAPH_MAX_OUTPUTS], n = 0;
+
+    for (i = 0; i < node->nout; ++i)
+        n += room[i] = graph_queue_len(g->nodes[node->outs[i]].in) < ADS125x_GRAPH_QUEUE;
+    if (n == 0)
+    {
+        ads125xPoolPut(g->pool, blk);
+        return node->nout;
+    }
+    blk->refs = n;
+    __atomic_add_fetch(&g->inflight, n, __ATOMIC_SEQ_CST);
+    for (i = 0; i < node->nout; ++i)
+    {
+        if (!room[i])
+            continue;
+        q = g->nodes[node->outs[i]].in;
+        q->slot[q->tail % ADS125x_GRAPH_QUEUE] = blk;
+        __atomic_store_n(&q->tail, q->tail + 1, __ATOMIC_SEQ_CST);
+        graph_wake(g, &g->nodes[node->outs[i]]);
+    }
+    return node->nout - n;
+}
+
+static void graph_consumed(ads125x_graph *g)
+{
+    if (__atomic_sub_fetch(&g->inflight, 1, __ATOMIC_SEQ_CST) == 0)
+    {
+        pthread_mutex_lock(&g->lock);
+        pthread_cond_broadcast(&g->drained);
+        pthread_mutex_unlock(&g->lock);
+    }
+    return;
+}
+
+static ads125x_gblock *graph_block(ads125x_graph *g, void *mem)
+{
+    ads125x_gblock *blk = (ads125x_gblock *)mem;
+
+    blk->codes = (int32_t *)((uint8_t *)mem + ADS125x_ARENA_ALIGN);
+    blk->ts = (uint64_t *)(blk->codes + g->block_samples);
+    blk->cap = g->block_samples;
+    blk->n = 0;
+    blk->refs = 0;
+    return blk;
+}
+
+static void graph_run_node(ads125x_graph *g, graph_node *node)
+{
+    ads125x_gblock *in, *out;
+    uint64_t t0;
+    void *mem;
+    int k, ret;
+
+    for (k = 0; k < GRAPH_RUN_BLOCKS && graph_runnable(g, node); ++k)
+    {
+        in = node->in->slot[node->in->head % ADS125x_GRAPH_QUEUE];
+        t0 = graph_now_ns();
+        if (node->type == ADS125x_GRAPH_SINK)
+            ret = node->fn(node->arg, in, NULL);
+        else if ((mem = ads125xPoolGet(g->pool)) == NULL)
+            ret = ADS125x_ERR_OVERRUN;
+        else
+        {
+            out = graph_block(g, mem);
+            out->seq = in->seq;
+            out->source = in->source;
+            if ((ret = node->fn(node->arg, in, out)) >= 0 && out->n > 0)
+                graph_send(g, node, out);
+            else
+                ads125xPoolPut(g->pool, out);
+        }
+        node->stats.busy_ns += graph_now_ns() - t0;
+        node->stats.blocks++;
+        node->stats.samples += in->n;
+        if (ret < 0)
+            graph_error(g, node, ret);
+
+        __atomic_store_n(&node->in->head, node->in->head + 1, __ATOMIC_SEQ_CST);
+        graph_release(g, in);
+        if (node->producer >= 0)
+            graph_wake(g, &g->nodes[node->producer]);
+        graph_consumed(g);
+    }
+    // Whatever came in while running is seen here or queues the node again
+    __atomic_store_n(&node->queued, 0, __ATOMIC_SEQ_CST);
+    graph_wake(g, node);
+    return;
+}
+
+static int graph_pop(graph_worker *w)
+{
+    int id = -1;
+
+    pthread_mutex_lock(&w->lock);
+    if (w->head != w->tail)
+        id = w->ring[--w->tail % ADS125x_GRAPH_MAX_NODES];
+    pthread_mutex_unlock(&w->lock);
+    return id;
+}
+
+static int graph_steal(ads125x_graph *g, graph_worker *self)
+{
+    graph_worker *w;
+    int i, id = -1;
+
+    for (i = 1; i < g->nworkers && id < 0; ++i)
+    {
+        w = &g->workers[(self - g->workers + i) % g->nworkers];
+        pthread_mutex_lock(&w->lock);
+        if (w->head != w->tail)
+            id = w->ring[w->head++ % ADS125x_GRAPH_MAX_NODES];
+        pthread_mutex_unlock(&w->lock);
+    }
+    return id;
+}
+
+static void *graph_worker_run(void *arg)
+{
+    graph_worker *w = (graph_worker *)arg;
+    ads125x_graph *g = w->g;
+    int id;
+
+    graph_self = w;
+    for (;;)
+    {
+        if ((id = graph_pop(w)) < 0 && (id = graph_steal(g, w)) >= 0)
+            w->steals++;
+        if (id >= 0)
+        {
+            __atomic_sub_fetch(&g->ntasks, 1, __ATOMIC_SEQ_CST);
+            w->runs++;
+            graph_run_node(g, &g->nodes[id]);
+            continue;
+        }
+        pthread_mutex_lock(&g->lock);
+        __atomic_add_fetch(&g->sleepers, 1, __ATOMIC_SEQ_CST);
+        while (!g->done && __atomic_load_n(&g->ntasks, __ATOMIC_SEQ_CST) == 0)
+            pthread_cond_wait(&g->cond, &g->lock);
+        __atomic_sub_fetch(&g->sleepers, 1, __ATOMIC_SEQ_CST);
+        if (g->done && __atomic_load_n(&g->ntasks, __ATOMIC_SEQ_CST) == 0)
+        {
+            pthread_mutex_unlock(&g->lock);
+            break;
+        }
+        pthread_mutex_unlock(&g->lock);
+    }
+    return NULL;
+}
+
+static void *graph_source_run(void *arg)
+{
+    graph_node *node = (graph_node *)arg;
+    ads125x_graph *g = node->g;
+    ads125x_gblock *blk;
+    const uint8_t *raw;
+    uint64_t done = 0, seq = 0, t0;
+    size_t n, i;
+    void *mem;
+    int ret;
+
+    ret = ads125xRDATACStart(node->dev);
+    while (ret == ADS125x_OK && !__atomic_load_n(&g->stop, __ATOMIC_ACQUIRE) &&
+           (node->samples == 0 || done < node->samples))
+    {
+        n = node->samples && node->samples - done < g->block_samples ? node->samples - done : g->block_samples;
+        t0 = graph_now_ns();
+        // Out of blocks the conversions are still read, the acquisition never stalls
+        if ((mem = ads125xPoolGet(g->pool)) == NULL)
+        {
+            if ((ret = ads125xRDATACRead(node->dev, node->raw, n)) < 0)
+                break;
+            node->stats.dropped++;
+            node->stats.blocks++;
+            node->stats.samples += n;
+            done += n;
+            ++seq;
+            continue;
+        }
+        blk = graph_block(g, mem);
+        if ((ret = ads125xRDATACReadTs(node->dev, node->raw, blk->ts, n)) < 0)
+        {
+            ads125xPoolPut(g->pool, blk);
+            break;
+        }
+        for (i = 0, raw = node->raw; i < n; ++i, raw += 3)
+            blk->codes[i] = (int32_t)((uint32_t)raw[0] << 24 | (uint32_t)raw[1] << 16 | (uint32_t)raw[2] << 8) >> 8;
+        blk->n = n;
+        blk->seq = seq++;
+        blk->source = node->id;
+        node->stats.dropped += graph_send(g, node, blk) > 0;
+        node->stats.busy_ns += graph_now_ns() - t0;
+        node->stats.blocks++;
+        node->stats.samples += n;
+        done += n;
+    }
+    if (node->dev->rdatac)
+        ads125xRDATACStop(node->dev);
+    if (ret < 0)
+        graph_error(g, node, ret);
+    __atomic_sub_fetch(&g->sources_left, 1, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+/**
+ * ads125xGraphOpen - Create an empty graph
+ * @block_samples: Samples per block, a source reads that many at a time.
+ *
+ * @return: The graph, NULL on failure.
+ */
+ads125x_graph *ads125xGraphOpen(size_t block_samples)
+{
+    ads125x_graph *g;
+
+    if (block_samples == 0 || (g = (ads125x_graph *)calloc(1, sizeof(*g))) == NULL)
+        return NULL;
+    g->block_samples = block_samples;
+    pthread_mutex_init(&g->lock, NULL);
+    pthread_cond_init(&g->cond, NULL);
+    pthread_cond_init(&g->drained, NULL);
+    return g;
+}
+
+static int graph_add(ads125x_graph *g, int type, ads125x_graph_fn fn, void *arg)
+{
+    graph_node *node;
+
+    if (g->started || g->nnodes == ADS125x_GRAPH_MAX_NODES || (type != ADS125x_GRAPH_SOURCE && !fn))
+        return ADS125x_ERR_INVAL;
+    node = &g->nodes[g->nnodes];
+    memset(node, 0x00, sizeof(*node));
+    node->g = g;
+    node->id = g->nnodes;
+    node->type = type;
+    node->fn = fn;
+    node->arg = arg;
+    node->producer = -1;
+    node->stats.type = type;
+    if (type != ADS125x_GRAPH_SOURCE &&
+        posix_memalign((void **)&node->in, ADS125x_ARENA_ALIGN, sizeof(graph_queue)))
+        return ADS125x_ERR_IO;
+    if (node->in)
+        memset(node->in, 0x00, sizeof(graph_queue));
+    return g->nnodes++;
+}
+
+/**
+ * ads125xGraphAddSource - Add a device as a source
+ * @g: The graph.
+ * @dev: The device, set up and not in RDATAC mode. Its thread owns it
+ *       until ads125xGraphWait() returns.
+ * @samples: Conversions to read, 0 is until ads125xGraphStop().
+ *
+ * @return: The node, or a ADS125x_ERR_* error.
+ */
+int ads125xGraphAddSource(ads125x_graph *g, ads125x_dev *dev, uint64_t samples)
+{
+    int id;
+
+    if (!dev)
+        return ADS125x_ERR_INVAL;
+    if ((id = graph_add(g, ADS125x_GRAPH_SOURCE, NULL, NULL)) >= 0)
+    {
+        g->nodes[id].dev = dev;
+        g->nodes[id].samples = samples;
+    }
+    return id;
+}
+
+/**
+ * ads125xGraphAddTransform - Add a node turning each block into a new one
+ * @g: The graph.
+ * @fn: The work, see ads125x_graph_fn.
+ * @arg: Passed to @fn.
+ *
+ * @return: The node, or a ADS125x_ERR_* error.
+ */
+int ads125xGraphAddTransform(ads125x_graph *g, ads125x_graph_fn fn, void *arg)
+{
+    return graph_add(g, ADS125x_GRAPH_TRANSFORM, fn, arg);
+}
+
+/**
+ * ads125xGraphAddSink - Add a node consuming blocks
+ * @g: The graph.
+ * @fn: The work, see ads125x_graph_fn, called with out NULL.
+ * @arg: Passed to @fn.
+ *
+ * @return: The node, or a ADS125x_ERR_* error.
+ */
+int ads125xGraphAddSink(ads125x_graph *g, ads125x_graph_fn fn, void *arg)
+{
+    return graph_add(g, ADS125x_GRAPH_SINK, fn, arg);
+}
+
+typedef struct graph_decimate_struct
+{
+    int factor;
+    int count;
+    int64_t sum;
+    uint64_t ts;
+} graph_decimate;
+
+static int graph_decimate_fn(void *arg, const ads125x_gblock *in, ads125x_gblock *out)
+{
+    graph_decimate *d = (graph_decimate *)arg;
+    size_t i;
+
+    for (i = 0; i < in->n; ++i)
+    {
+        if (d->count == 0)
+            d->ts = in->ts[i];
+        d->sum += in->codes[i];
+        if (++d->count == d->factor)
+        {
+            out->codes[out->n] = (int32_t)(d->sum / d->factor);
+            out->ts[out->n++] = d->ts;
+            d->sum = 0;
+            d->count = 0;
+        }
+    }
+    return ADS125x_OK;
+}
+
+typedef struct graph_boxcar_struct
+{
+    int length;
+    int count;
+    int pos;
+    int64_t sum;
+    int32_t hist[];
+} graph_boxcar;
+
+static int graph_boxcar_fn(void *arg, const ads125x_gblock *in, ads125x_gblock *out)
+{
+    graph_boxcar *b = (graph_boxcar *)arg;
+    size_t i;
+
+    for (i = 0; i < in->n; ++i)
+    {
+        if (b->count == b->length)
+            b->sum -= b->hist[b->pos];
+        else
+            b->count++;
+        b->hist[b->pos] = in->codes[i];
+        b->sum += in->codes[i];
+        b->pos = b->pos + 1 == b->length ? 0 : b->pos + 1;
+        out->codes[i] = (int32_t)(b->sum / b->count);
+        out->ts[i] = in->ts[i];
+    }
+    out->n = in->n;
+    return ADS125x_OK;
+}
+
+typedef struct graph_file_struct
+{
+    int fd;
+    uint8_t raw[];
+} graph_file;
+
+static int graph_file_fn(void *arg, const ads125x_gblock *in, ads125x_gblock *out)
+{
+    graph_file *f = (graph_file *)arg;
+    const uint8_t *p = f->raw;
+    size_t i, len = in->n * ADS125x_DATA_LEN_BYTE;
+    ssize_t n;
+
+    (void)out;
+    for (i = 0; i < in->n; ++i)
+    {
+        f->raw[i * 3 + 0] = (in->codes[i] >> 16) & 0xFF;
+        f->raw[i * 3 + 1] = (in->codes[i] >> 8) & 0xFF;
+        f->raw[i * 3 + 2] = in->codes[i] & 0xFF;
+    }
+    while (len > 0)
+    {
+        if ((n = write(f->fd, p, len)) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return ADS125x_ERR_IO;
+        }
+        p += n;
+        len -= n;
+    }
+    return ADS125x_OK;
+}
+
+static int graph_pub_fn(void *arg, const ads125x_gblock *in, ads125x_gblock *out)
+{
+    (void)out;
+    return ads125xPubPublish((ads125x_pub *)arg, in->codes, in->ts, in->n);
+}
+
+static int graph_add_owned(ads125x_graph *g, int type, ads125x_graph_fn fn, void *state)
+{
+    int id;
+
+    if (!state)
+        return ADS125x_ERR_IO;
+    if ((id = graph_add(g, type, fn, state)) < 0)
+        free(state);
+    else
+        g->nodes[id].owned = state;
+    return id;
+}
+
+/**
+ * ads125xGraphAddDecimate - Add a transform keeping the mean of every @factor samples
+ * @g: The graph.
+ * @factor: Samples per output sample, >= 1. The timestamp is the one
+ *          of the first sample.
+ *
+ * @return: The node, or a ADS125x_ERR_* error.
+ */
+int ads125xGraphAddDecimate(ads125x_graph *g, int factor)
+{
+    graph_decimate *d;
+
+    if (factor < 1)
+        return ADS125x_ERR_INVAL;
+    if ((d = (graph_decimate *)calloc(1, sizeof(*d))) != NULL)
+        d->factor = factor;
+    return graph_add_owned(g, ADS125x_GRAPH_TRANSFORM, graph_decimate_fn, d);
+}
+
+/**
+ * ads125xGraphAddBoxcar - Add a moving average of @length samples
+ * @g: The graph.
+ * @length: Samples averaged, >= 1.
+ *
+ * @return: The node, or a ADS125x_ERR_* error.
+ */
+int ads125xGraphAddBoxcar(ads125x_graph *g, int length)
+{
+    graph_boxcar *b;
+
+    if (length < 1)
+        return ADS125x_ERR_INVAL;
+    if ((b = (graph_boxcar *)calloc(1, sizeof(*b) + length * sizeof(int32_t))) != NULL)
+        b->length = length;
+    return graph_add_owned(g, ADS125x_GRAPH_TRANSFORM, graph_boxcar_fn, b);
+}
+
+/**
+ * ads125xGraphAddFileSink - Add a sink writing 3 byte samples to a file or socket
+ * @g: The graph.
+ * @fd: Open for writing, left open. A file is a binary capture, see
+ *      ads125xReplayOpen() and ads125xExportFile().
+ *
+ * @return: The node, or a ADS125x_ERR_* error.
+ */
+int ads125xGraphAddFileSink(ads125x_graph *g, int fd)
+{
+    graph_file *f;
+
+    if (fd < 0)
+        return ADS125x_ERR_INVAL;
+    if ((f = (graph_file *)malloc(sizeof(*f) + g->block_samples * ADS125x_DATA_LEN_BYTE)) != NULL)
+        f->fd = fd;
+    return graph_add_owned(g, ADS125x_GRAPH_SINK, graph_file_fn, f);
+}
+
+/**
+ * ads125xGraphAddPubSink - Add a sink publishing to a ring, see libads1256pubsub.h
+ * @g: The graph.
+ * @pub: The publisher, e.g. of a network server.
+ *
+ * @return: The node, or a ADS125x_ERR_* error.
+ */
+int ads125xGraphAddPubSink(ads125x_graph *g, ads125x_pub *pub)
+{
+    if (!pub)
+        return ADS125x_ERR_INVAL;
+    return graph_add(g, ADS125x_GRAPH_SINK, graph_pub_fn, pub);
+}
+
+/**
+ * ads125xGraphConnect - Send the blocks of a node to another one
+ * @g: The graph.
+ * @from: A source or a transform.
+ * @to: A transform or a sink, without input yet.
+ *
+ * @return: ADS125x_OK or ADS125x_ERR_INVAL.
+ */
+int ads125xGraphConnect(ads125x_graph *g, int from, int to)
+{
+    graph_node *src, *dst;
+
+    if (g->started || from < 0 || from >= g->nnodes || to < 0 || to >= g->nnodes || from == to)
+        return ADS125x_ERR_INVAL;
+    src = &g->nodes[from];
+    dst = &g->nodes[to];
+    if (src->type == ADS125x_GRAPH_SINK || dst->type == ADS125x_GRAPH_SOURCE ||
+        dst->producer >= 0 || src->nout == ADS125x_GRAPH_MAX_OUTPUTS)
+        return ADS125x_ERR_INVAL;
+    src->outs[src->nout++] = to;
+    dst->producer = from;
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xGraphStart - Start the sources and the workers
+ * @g: The graph.
+ * @threads: Worker threads, <= 0 is one per online CPU not taken by a source.
+ *
+ * @return: ADS125x_OK, ADS125x_ERR_INVAL is a node without input, or
+ *          ADS125x_ERR_IO.
+ */
+int ads125xGraphStart(ads125x_graph *g, int threads)
+{
+    size_t block_size = ADS125x_ARENA_ALIGN + g->block_samples * (sizeof(int32_t) + sizeof(uint64_t));
+    uint32_t count = 0;
+    int i, sources = 0, cpus;
+
+    if (g->started)
+        return ADS125x_ERR_INVAL;
+    for (i = 0; i < g->nnodes; ++i)
+    {
+        if (g->nodes[i].type == ADS125x_GRAPH_SOURCE)
+            ++sources;
+        else if (g->nodes[i].producer < 0)
+            return ADS125x_ERR_INVAL;
+    }
+    // Every queue full, a block in every running node and source, none ever runs out
+    count = (g->nnodes - sources) * (ADS125x_GRAPH_QUEUE + 1) + sources * 2;
+    block_size = (block_size + ADS125x_ARENA_ALIGN - 1) & ~((size_t)ADS125x_ARENA_ALIGN - 1);
+    if ((g->arena = ads125xArenaOpen((size_t)count * (block_size + sizeof(uint32_t)) +
+                                     sources * (g->block_samples * ADS125x_DATA_LEN_BYTE + ADS125x_ARENA_ALIGN) +
+                                     4 * ADS125x_ARENA_ALIGN, 0)) == NULL ||
+        (g->pool = ads125xArenaPool(g->arena, block_size, count)) == NULL)
+        return FailurePrint("Graph: allocate %u blocks failed.\n", count);
+    for (i = 0; i < g->nnodes; ++i)
+        if (g->nodes[i].type == ADS125x_GRAPH_SOURCE &&
+            (g->nodes[i].raw = (uint8_t *)ads125xArenaAlloc(g->arena, g->block_samples * ADS125x_DATA_LEN_BYTE)) == NULL)
+            return FailurePrint("Graph: allocate source buffers failed.\n");
+
+    cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0)
+        threads = cpus - sources > 1 ? cpus - sources : 1;
+    if (threads > ADS125x_GRAPH_MAX_THREADS)
+        threads = ADS125x_GRAPH_MAX_THREADS;
+    if (posix_memalign((void **)&g->workers, ADS125x_ARENA_ALIGN, threads * sizeof(graph_worker)))
+        return FailurePrint("Graph: allocate workers failed.\n");
+    memset(g->workers, 0x00, threads * sizeof(graph_worker));
+    g->start_ns = graph_now_ns();
+    g->started = 1;
+    for (g->nworkers = 0; g->nworkers < threads; ++g->nworkers)
+    {
+        g->workers[g->nworkers].g = g;
+        pthread_mutex_init(&g->workers[g->nworkers].lock, NULL);
+        if (pthread_create(&g->workers[g->nworkers].thread, NULL, graph_worker_run, &g->workers[g->nworkers]))
+            break;
+    }
+    if (g->nworkers == 0)
+        return FailurePrint("Graph: create workers failed.\n");
+    g->sources_left = sources;
+    for (i = 0; i < g->nnodes; ++i)
+    {
+        if (g->nodes[i].type != ADS125x_GRAPH_SOURCE)
+            continue;
+        if (pthread_create(&g->nodes[i].thread, NULL, graph_source_run, &g->nodes[i]))
+        {
+            FailurePrint("Graph: create source thread failed: %s\n", strerror(errno));
+            g->nodes[i].dev = NULL;
+            __atomic_sub_fetch(&g->sources_left, 1, __ATOMIC_SEQ_CST);
+            g->err = ADS125x_ERR_IO;
+        }
+    }
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xGraphWait - Wait for the sources to finish and the graph to drain
+ * @g: The graph.
+ *
+ * @return: ADS125x_OK, or the first error of a source or a node.
+ */
+int ads125xGraphWait(ads125x_graph *g)
+{
+    int i;
+
+    if (!g->started || g->done)
+        return g->err;
+    for (i = 0; i < g->nnodes; ++i)
+        if (g->nodes[i].type == ADS125x_GRAPH_SOURCE && g->nodes[i].dev)
+            pthread_join(g->nodes[i].thread, NULL);
+    pthread_mutex_lock(&g->lock);
+    while (__atomic_load_n(&g->inflight, __ATOMIC_SEQ_CST) > 0)
+        pthread_cond_wait(&g->drained, &g->lock);
+    g->done = 1;
+    pthread_cond_broadcast(&g->cond);
+    pthread_mutex_unlock(&g->lock);
+    for (i = 0; i < g->nworkers; ++i)
+        pthread_join(g->workers[i].thread, NULL);
+    g->end_ns = graph_now_ns();
+    return g->err;
+}
+
+/**
+ * ads125xGraphStop - Stop the sources, then drain the graph
+ * @g: The graph.
+ *
+ * @return: See ads125xGraphWait().
+ */
+int ads125xGraphStop(ads125x_graph *g)
+{
+    __atomic_store_n(&g->stop, 1, __ATOMIC_RELEASE);
+    return ads125xGraphWait(g);
+}
+
+/**
+ * ads125xGraphGetStats - Get what the workers did
+ */
+void ads125xGraphGetStats(ads125x_graph *g, ads125x_graph_stats *stats)
+{
+    int i;
+
+    memset(stats, 0x00, sizeof(*stats));
+    stats->threads = g->nworkers;
+    for (i = 0; i < g->nworkers; ++i)
+    {
+        stats->runs += g->workers[i].runs;
+        stats->steals += g->workers[i].steals;
+    }
+    if (g->started)
+        stats->elapsed = ((g->end_ns ? g->end_ns : graph_now_ns()) - g->start_ns) * 1e-9;
+    return;
+}
+
+/**
+ * ads125xGraphGetNodeStats - Get what a node did
+ *
+ * @return: ADS125x_OK or ADS125x_ERR_INVAL.
+ */
+int ads125xGraphGetNodeStats(ads125x_graph *g, int node, ads125x_graph_node_stats *stats)
+{
+    if (node < 0 || node >= g->nnodes)
+        return ADS125x_ERR_INVAL;
+    *stats = g->nodes[node].stats;
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xGraphClose - Stop and free a graph, the devices are left open
+ */
+void ads125xGraphClose(ads125x_graph *g)
+{
+    int i;
+
+    if (!g)
+        return;
+    if (g->started)
+        ads125xGraphStop(g);
+    for (i = 0; i < g->nnodes; ++i)
+    {
+        free(g->nodes[i].in);
+        if (g->nodes[i].type != ADS125x_GRAPH_SOURCE)
+            free(g->nodes[i].owned);
+    }
+    for (i = 0; i < g->nworkers; ++i)
+        pthread_mutex_destroy(&g->workers[i].lock);
+    free(g->workers);
+    if (g->arena)
+        ads125xArenaClose(g->arena);
+    pthread_cond_destroy(&g->drained);
+    pthread_cond_destroy(&g->cond);
+    pthread_mutex_destroy(&g->lock);
+    free(g);
+    return;
+}
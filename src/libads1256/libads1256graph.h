@@ -0,0 +1,164 @@
+/**
+ * libads1256graph.h - Dataflow graph of ADS1255/ADS1256 sources, transforms and sinks
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256GRAPH_H
+#define LIBADS1256GRAPH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libads1256.h"
+#include "libads1256pubsub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A graph moves blocks of samples from sources (devices) through
+ * transforms (filter, decimate, ...) to sinks (file, socket, publisher),
+ * along edges that are bounded queues of ADS125x_GRAPH_QUEUE blocks.
+ *
+ *  - Every source has a dedicated thread running RDATAC. It never waits
+ *    for the graph: a block whose queue is full is dropped and counted.
+ *  - Transforms and sinks run on a pool of worker threads. A node with
+ *    input, and room in all of its output queues, is queued on the deque
+ *    of the worker that made it runnable; a worker takes its own newest
+ *    node first and steals the oldest node of another worker when it has
+ *    none. A node runs on one worker at a time, so it may keep state.
+ *  - A full output queue stops its producer until the consumer catches
+ *    up, which bounds the memory to the queues.
+ *
+ * Blocks come from a pool in a prefaulted arena, a block sent to several
+ * nodes is shared and returned to the pool by its last consumer. A node
+ * has at most one input, and any number of outputs.
+ */
+#define ADS125x_GRAPH_MAX_NODES     64
+#define ADS125x_GRAPH_MAX_OUTPUTS   8
+#define ADS125x_GRAPH_MAX_THREADS   64
+#define ADS125x_GRAPH_QUEUE         16      // Blocks per edge, a power of two
+
+#define ADS125x_GRAPH_SOURCE        0
+#define ADS125x_GRAPH_TRANSFORM     1
+#define ADS125x_GRAPH_SINK          2
+
+/**
+ * ads125x_gblock - A block of samples moving along the graph
+ * @codes: Conversions.
+ * @ts: Their DRDY times, CLOCK_MONOTONIC ns.
+ * @n: Samples in the block.
+ * @cap: Room of @codes and @ts.
+ * @seq: Block number of its source.
+ * @source: Node of its source.
+ * @refs: Queues still holding it, kept by the graph.
+ */
+typedef struct ads125x_gblock_struct
+{
+    int32_t *codes;
+    uint64_t *ts;
+    size_t n;
+    size_t cap;
+    uint64_t seq;
+    int source;
+    uint32_t refs;
+} ads125x_gblock;
+
+/**
+ * ads125x_graph_fn - Work of a transform or a sink
+ * @arg: Given to ads125xGraphAddTransform() / ads125xGraphAddSink().
+ * @in: The input block, read-only.
+ * @out: An empty block of the same @cap for a transform, leave @n at 0
+ *       to send nothing. NULL for a sink.
+ *
+ * @return: >= 0, or a ADS125x_ERR_* error which the graph reports.
+ */
+typedef int (*ads125x_graph_fn)(void *arg, const ads125x_gblock *in, ads125x_gblock *out);
+
+/**
+ * ads125x_graph_node_stats - What a node did
+ * @type: ADS125x_GRAPH_SOURCE, TRANSFORM or SINK.
+ * @blocks: Blocks read by a source, or taken from the input.
+ * @samples: Samples of these blocks.
+ * @dropped: Blocks a source dropped on a full output queue, or for lack
+ *           of a free block.
+ * @busy_ns: Time spent reading or running the node.
+ * @errors: Failed reads or calls.
+ */
+typedef struct ads125x_graph_node_stats_struct
+{
+    int type;
+    uint64_t blocks;
+    uint64_t samples;
+    uint64_t dropped;
+    uint64_t busy_ns;
+    uint64_t errors;
+} ads125x_graph_node_stats;
+
+/**
+ * ads125x_graph_stats - What a graph did
+ * @threads: Worker threads.
+ * @runs: Node runs by the workers.
+ * @steals: Runs taken from the deque of another worker.
+ * @elapsed: Wall time from ads125xGraphStart() to the end, in seconds.
+ */
+typedef struct ads125x_graph_stats_struct
+{
+    int threads;
+    uint64_t runs;
+    uint64_t steals;
+    double elapsed;
+} ads125x_graph_stats;
+
+typedef struct ads125x_graph_struct ads125x_graph;
+
+ads125x_graph *ads125xGraphOpen(size_t block_samples);
+int ads125xGraphAddSource(ads125x_graph *g, ads125x_dev *dev, uint64_t samples);
+int ads125xGraphAddTransform(ads125x_graph *g, ads125x_graph_fn fn, void *arg);
+int ads125xGraphAddSink(ads125x_graph *g, ads125x_graph_fn fn, void *arg);
+int ads125xGraphAddDecimate(ads125x_graph *g, int factor);
+int ads125xGraphAddBoxcar(ads125x_graph *g, int length);
+int ads125xGraphAddFileSink(ads125x_graph *g, int fd);
+int ads125xGraphAddPubSink(ads125x_graph *g, ads125x_pub *pub);
+int ads125xGraphConnect(ads125x_graph *g, int from, int to);
+int ads125xGraphStart(ads125x_graph *g, int threads);
+int ads125xGraphWait(ads125x_graph *g);
+int ads125xGraphStop(ads125x_graph *g);
+void ads125xGraphGetStats(ads125x_graph *g, ads125x_graph_stats *stats);
+int ads125xGraphGetNodeStats(ads125x_graph *g, int node, ads125x_graph_node_stats *stats);
+void ads125xGraphClose(ads125x_graph *g);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,347 @@
+/**
+ * libads1256latest.c - Lock-free latest-value cache of ADS1255/ADS1256 inputs
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "libads1256latest.h"
+#include "libads1256reg.h"
+
+struct ads125x_latest_struct
+{
+    ads125x_latest_table *table;
+    char *shm_name;         // Unlinked on close, NULL is private memory
+
+    // Background acquisition, see ads125xLatestStart()
+    ads125x_dev *dev;
+    ads125x_scan *scan;
+    pthread_t thread;
+    int running;
+    int stop;
+    int result;
+};
+
+/**
+ * latest_write - Write a slot, the only writer of the table
+ */
+static void latest_write(ads125x_latest_slot *s, uint8_t mux, int32_t code, uint64_t ts)
+{
+    uint64_t seq = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&s->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&s->code, code, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->mux, mux, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->ts, ts, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->seq, seq + 2, __ATOMIC_RELEASE);
+    return;
+}
+
+/**
+ * ads125xLatestOpen - Give a device a latest-value cache
+ * @dev: The ads125x dev info struct pointer.
+ * @shm_name: POSIX shared memory name like "/ads1256", NULL keeps the
+ *            table private to the process. The name must not exist, a
+ *            table has one publisher. One left by a crashed publisher
+ *            has to be removed with shm_unlink() first.
+ *
+ * @return: The cache, owned by the device until ads125xLatestClose(),
+ *          NULL on failure.
+ */
+ads125x_latest *ads125xLatestOpen(ads125x_dev *dev, const char *shm_name)
+{
+    ads125x_latest *l;
+    void *mem = NULL;
+    int fd;
+
+    if (dev->latest || (l = (ads125x_latest *)calloc(1, sizeof(*l))) == NULL)
+        return NULL;
+    if (!shm_name)
+    {
+        if (posix_memalign(&mem, ADS125x_LATEST_ALIGN, sizeof(ads125x_latest_table)))
+            mem = NULL;
+    }
+    // Never wipe the table of another publisher under its readers
+    else if ((fd = shm_open(shm_name, O_CREAT | O_EXCL | O_RDWR, 0644)) < 0)
+        FailurePrint("Latest: create %s error: %s\n", shm_name, strerror(errno));
+    else
+    {
+        if (ftruncate(fd, sizeof(ads125x_latest_table)) < 0 ||
+            (mem = mmap(NULL, sizeof(ads125x_latest_table), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+        {
+            FailurePrint("Latest: map %s error: %s\n", shm_name, strerror(errno));
+            shm_unlink(shm_name);
+            mem = NULL;
+        }
+        close(fd);
+        if (mem && (l->shm_name = strdup(shm_name)) == NULL)
+        {
+            munmap(mem, sizeof(ads125x_latest_table));
+            shm_unlink(shm_name);
+            mem = NULL;
+        }
+    }
+    if (!mem)
+    {
+        free(l);
+        return NULL;
+    }
+
+    l->table = (ads125x_latest_table *)mem;
+    memset(l->table, 0x00, sizeof(*l->table));
+    l->table->version = ADS125x_LATEST_VERSION;
+    l->table->channels = ADS125x_LATEST_CHANNELS;
+    // A mapping process checks the magic, it goes last
+    __atomic_store_n(&l->table->magic, ADS125x_LATEST_MAGIC, __ATOMIC_RELEASE);
+    dev->latest = l;
+    return l;
+}
+
+/**
+ * ads125xLatestPut - Publish a conversion to the cache of a device
+ * @dev: The ads125x dev info struct pointer, with a cache.
+ * @mux: MUX of the conversion, its positive input picks the slot.
+ * @code: The conversion.
+ * @ts: DRDY time, see dev->drdy_ns.
+ *
+ * For acquisition loops of the caller's own, there must be one writer
+ * per cache.
+ */
+void ads125xLatestPut(ads125x_dev *dev, uint8_t mux, int32_t code, uint64_t ts)
+{
+    if (dev->latest && (mux >> 4) < ADS125x_LATEST_CHANNELS)
+        latest_write(&dev->latest->table->slot[mux >> 4], mux, code, ts);
+    return;
+}
+
+/**
+ * ads125xLatestRead - Read the latest conversion of an input from a cache table
+ * @table: The table, see ads125xLatestMap().
+ * @ch: The positive input, 0 ~ 7 for AIN0 ~ AIN7, 8 for AINCOM.
+ * @value: Used to store a consistent copy of the slot.
+ *
+ * Never blocks the writer, only retries while a write is in progress.
+ *
+ * @return: ADS125x_OK, ADS125x_ERR_INVAL is an invalid input.
+ */
+int ads125xLatestRead(const ads125x_latest_table *table, int ch, ads125x_latest_value *value)
+{
+    const ads125x_latest_slot *s;
+    uint64_t seq;
+
+    if (!table || ch < 0 || ch >= ADS125x_LATEST_CHANNELS)
+        return ADS125x_ERR_INVAL;
+    s = &table->slot[ch];
+    for (;;)
+    {
+        if ((seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE)) & 1)
+            continue;
+        value->code = __atomic_load_n(&s->code, __ATOMIC_RELAXED);
+        value->mux = __atomic_load_n(&s->mux, __ATOMIC_RELAXED);
+        value->ts = __atomic_load_n(&s->ts, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) == seq)
+            break;
+    }
+    value->seq = seq / 2;
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xGetLatest - Read the latest conversion of an input of a device
+ * @dev: The ads125x dev info struct pointer, with a cache.
+ * @ch: The positive input, 0 ~ 7 for AIN0 ~ AIN7, 8 for AINCOM.
+ * @value: Used to store the conversion, value->seq is 0 if the input
+ *         was not converted yet.
+ *
+ * Safe from any thread while the acquisition runs.
+ *
+ * @return: ADS125x_OK, ADS125x_ERR_INVAL is no cache or an invalid input.
+ */
+int ads125xGetLatest(ads125x_dev *dev, int ch, ads125x_latest_value *value)
+{
+    if (!dev->latest)
+        return ADS125x_ERR_INVAL;
+    return ads125xLatestRead(dev->latest->table, ch, value);
+}
+
+static void *latest_run(void *arg)
+{
+    ads125x_latest *l = (ads125x_latest *)arg;
+    ads125x_dev *dev = l->dev;
+    ads125x_scan_sample sample;
+    const ads125x_scan_channel *c;
+    uint8_t raw[ADS125x_DATA_LEN_BYTE];
+    uint64_t ts;
+    int ret;
+
+    ret = l->scan ? ads125xScanStart(dev, l->scan) : ads125xRDATACStart(dev);
+    // One conversion at a time, each is published as soon as it is read
+    while (ret == ADS125x_OK && !__atomic_load_n(&l->stop, __ATOMIC_ACQUIRE))
+    {
+        if (l->scan)
+        {
+            if ((ret = ads125xScanRead(dev, l->scan, &sample, 1)) < 0)
+                break;
+            c = &l->scan->ch[sample.channel];
+            latest_write(&l->table->slot[c->psel >> 4], c->psel | c->nsel, sample.code, sample.ts);
+        }
+        else
+        {
+            if ((ret = ads125xRDATACReadTs(dev, raw, &ts, 1)) < 0)
+                break;
+            ads125xLatestPut(dev, dev->regs[ADS125x_REG_ADDR_MUX], convert_to_signed_24bit(raw), ts);
+        }
+    }
+    if (!l->scan && dev->rdatac && ads125xRDATACStop(dev) < 0 && ret == ADS125x_OK)
+        ret = ADS125x_ERR_IO;
+    l->result = ret;
+    return NULL;
+}
+
+/**
+ * ads125xLatestStart - Keep the cache of a device up to date in the background
+ * @dev: The ads125x dev info struct pointer, with a cache, not in RDATAC
+ *       mode. Leave it to the thread until ads125xLatestStop().
+ * @scan: A planned scan to run, see libads1256scan.h, NULL is RDATAC at
+ *        the current MUX.
+ *
+ * @return: ADS125x_OK, ADS125x_ERR_INVAL is no cache or already running,
+ *          ADS125x_ERR_IO is create the thread failed.
+ */
+int ads125xLatestStart(ads125x_dev *dev, ads125x_scan *scan)
+{
+    ads125x_latest *l = dev->latest;
+
+    if (!l || l->running || dev->rdatac)
+        return ADS125x_ERR_INVAL;
+    l->dev = dev;
+    l->scan = scan;
+    l->stop = 0;
+    l->result = ADS125x_OK;
+    if (pthread_create(&l->thread, NULL, latest_run, l))
+        return FailurePrint("Latest: create thread error: %s\n", strerror(errno));
+    l->running = 1;
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xLatestStop - Stop the background acquisition
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * The slots keep their last conversions.
+ *
+ * @return: What stopped the acquisition, ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xLatestStop(ads125x_dev *dev)
+{
+    ads125x_latest *l = dev->latest;
+
+    if (!l || !l->running)
+        return ADS125x_ERR_INVAL;
+    __atomic_store_n(&l->stop, 1, __ATOMIC_RELEASE);
+    pthread_join(l->thread, NULL);
+    l->running = 0;
+    return l->result;
+}
+
+/**
+ * ads125xLatestClose - Stop the background acquisition and free the cache
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * A shared memory table is unlinked, mapping processes keep their copy
+ * until they unmap it.
+ */
+void ads125xLatestClose(ads125x_dev *dev)
+{
+    ads125x_latest *l = dev->latest;
+
+    if (!l)
+        return;
+    if (l->running)
+        ads125xLatestStop(dev);
+    if (l->shm_name)
+    {
+        munmap(l->table, sizeof(*l->table));
+        shm_unlink(l->shm_name);
+        free(l->shm_name);
+    }
+    else
+        free(l->table);
+    free(l);
+    dev->latest = NULL;
+    return;
+}
+
+/**
+ * ads125xLatestMap - Map the cache table published by another process
+ * @shm_name: The name given to ads125xLatestOpen().
+ *
+ * @return: The read-only table, NULL if it does not exist or is not a
+ *          cache table of this version.
+ */
+const ads125x_latest_table *ads125xLatestMap(const char *shm_name)
+{
+    ads125x_latest_table *table;
+    int fd;
+
+    if ((fd = shm_open(shm_name, O_RDONLY, 0)) < 0)
+        return NULL;
+    table = (ads125x_latest_table *)mmap(NULL, sizeof(*table), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (table == MAP_FAILED)
+        return NULL;
+    if (__atomic_load_n(&table->magic, __ATOMIC_ACQUIRE) != ADS125x_LATEST_MAGIC ||
+        table->version != ADS125x_LATEST_VERSION || table->channels != ADS125x_LATEST_CHANNELS)
+    {
+        munmap(table, sizeof(*table));
+        return NULL;
+    }
+    return table;
+}
+
+/**
+ * ads125xLatestUnmap - Unmap a table of ads125xLatestMap()
+ */
+void ads125xLatestUnmap(const ads125x_latest_table *table)
+{
+    if (table)
+        munmap((void *)table, sizeof(*table));
+    return;
+}
@@ -0,0 +1,123 @@
+/**
+ * libads1256latest.h - Lock-free latest-value cache of ADS1255/ADS1256 inputs
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256LATEST_H
+#define LIBADS1256LATEST_H
+
+#include <stdint.h>
+
+#include "libads1256.h"
+#include "libads1256scan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The latest conversion of every input is kept in a slot of its own,
+ * guarded by a sequence lock: the acquisition, the only writer, makes the
+ * sequence odd, writes the slot and makes the sequence even again. A
+ * reader copies the slot and tries again if the sequence was odd or has
+ * changed meanwhile. Readers never write to the table, so any number of
+ * them leaves the timing of the acquisition alone, and a read is a few
+ * loads.
+ *
+ * A slot belongs to the positive input of the MUX, AIN0 ~ AIN7 and
+ * AINCOM (8), and sits on a cache line of its own. The table can be a
+ * POSIX shared memory object, which other processes map read-only with
+ * ads125xLatestMap().
+ */
+#define ADS125x_LATEST_MAGIC        0x54534C41  // "ALST"
+#define ADS125x_LATEST_VERSION      1
+#define ADS125x_LATEST_CHANNELS     9
+#define ADS125x_LATEST_ALIGN        64
+
+/**
+ * ads125x_latest_slot - Latest conversion of one input
+ * @seq: Odd while the slot is written, twice the conversions written.
+ * @ts: DRDY time, CLOCK_MONOTONIC ns.
+ * @code: The conversion.
+ * @mux: MUX it was taken with, the negative input is in the low nibble.
+ */
+typedef struct ads125x_latest_slot_struct
+{
+    uint64_t seq;
+    uint64_t ts;
+    int32_t code;
+    uint8_t mux;
+} __attribute__((aligned(ADS125x_LATEST_ALIGN))) ads125x_latest_slot;
+
+/**
+ * ads125x_latest_table - Layout of the cache, in memory or shared memory
+ */
+typedef struct ads125x_latest_table_struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t channels;
+    ads125x_latest_slot slot[ADS125x_LATEST_CHANNELS];
+} ads125x_latest_table;
+
+/**
+ * ads125x_latest_value - A consistent copy of a slot
+ * @code: The conversion.
+ * @mux: MUX it was taken with.
+ * @ts: DRDY time, CLOCK_MONOTONIC ns.
+ * @seq: Number of the conversion in the slot from 1, 0 is none yet.
+ */
+typedef struct ads125x_latest_value_struct
+{
+    int32_t code;
+    uint8_t mux;
+    uint64_t ts;
+    uint64_t seq;
+} ads125x_latest_value;
+
+typedef struct ads125x_latest_struct ads125x_latest;
+
+ads125x_latest *ads125xLatestOpen(ads125x_dev *dev, const char *shm_name);
+void ads125xLatestPut(ads125x_dev *dev, uint8_t mux, int32_t code, uint64_t ts);
+int ads125xGetLatest(ads125x_dev *dev, int ch, ads125x_latest_value *value);
+int ads125xLatestStart(ads125x_dev *dev, ads125x_scan *scan);
+int ads125xLatestStop(ads125x_dev *dev);
+void ads125xLatestClose(ads125x_dev *dev);
+
+const ads125x_latest_table *ads125xLatestMap(const char *shm_name);
+int ads125xLatestRead(const ads125x_latest_table *table, int ch, ads125x_latest_value *value);
+void ads125xLatestUnmap(const ads125x_latest_table *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,813 @@
+/**
+ * libads1256net.c - Stream ADS125x samples over TCP or UDP
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#define _GNU_SOURCE
+#include <endian.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <linux/errqueue.h>
+
+#include "libads1256net.h"
+
+#define NET_BUFS_MIN                4       // Frame buffers per link
+#define NET_POLL_MS                 100     // Stop flag check of blocking waits
+#define NET_UDP_RCVBUF              (4 << 20)
+
+extern int ADS125xDriverDebug;
+
+typedef struct net_buf_struct
+{
+    uint8_t *data;
+    size_t len;
+    uint64_t zc_id;         // Zerocopy send that used it last, 0 for none
+} net_buf;
+
+typedef struct net_link_struct
+{
+    struct ads125x_net_struct *net;
+    struct net_link_struct *next;
+    int fd;
+    ads125x_sub *sub;
+    pthread_t thread;
+    uint8_t *mem;
+    net_buf *bufs;
+    int nbufs;
+    int cur;
+    int zerocopy;
+    uint64_t zc_calls;
+    uint64_t zc_done;
+    ads125x_net_stats stats;
+} net_link;
+
+struct ads125x_net_struct
+{
+    ads125x_pub *pub;
+    ads125x_net_cfg cfg;
+    size_t frame_samples;   // Samples per frame
+    int frames_per_send;
+    int listen_fd;
+    pthread_t acceptor;
+    int has_acceptor;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    net_link *links;
+    int clients;
+    int stop;
+};
+
+struct ads125x_net_client_struct
+{
+    int fd;
+    int proto;
+    uint8_t *buf;           // One datagram
+    int started;
+    uint64_t next_seq;
+    ads125x_net_client_stats stats;
+};
+
+// Resolve "[host:]port", host may be "[v6]", without it passive binds any
+static struct addrinfo *net_resolve(const char *addr, int type, int passive)
+{
+    struct addrinfo hints, *res = NULL;
+    char host[256];
+    const char *port, *colon;
+    size_t len;
+
+    memset(&hints, 0x00, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = type;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+    if ((colon = strrchr(addr, ':')) == NULL || (addr[0] == '[' && colon < strchr(addr, ']')))
+    {
+        port = addr;
+        len = 0;
+    }
+    else
+    {
+        port = colon + 1;
+        len = colon - addr;
+        if (addr[0] == '[' && len >= 2 && addr[len - 1] == ']')
+        {
+            addr++;
+            len -= 2;
+        }
+    }
+    if (len >= sizeof(host))
+        return NULL;
+    memcpy(host, addr, len);
+    host[len] = '\0';
+    if (getaddrinfo(len ? host : NULL, port, &hints, &res))
+        return NULL;
+    return res;
+}
+
+static int net_socket(const char *addr, int type, int passive)
+{
+    struct addrinfo *res, *ai;
+    int fd = -1, one = 1;
+
+    if ((res = net_resolve(addr, type, passive)) == NULL)
+    {
+        fprintf(stderr, "Resolve %s failed.\n", addr);
+        return -1;
+    }
+    for (ai = res; ai; ai = ai->ai_next)
+    {
+        if ((fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol)) < 0)
+            continue;
+        if (passive)
+        {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 &&
+                (type != SOCK_STREAM || listen(fd, 8) == 0))
+                break;
+        }
+        else if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd < 0)
+        fprintf(stderr, "%s %s failed: %s\n", passive ? "Bind" : "Connect", addr, strerror(errno));
+    return fd;
+}
+
+// Collect the MSG_ZEROCOPY completions, waiting until zc_id is done if asked
+static void net_reap(net_link *l, uint64_t zc_id)
+{
+#ifdef MSG_ZEROCOPY
+    struct sock_extended_err *serr;
+    struct cmsghdr *cm;
+    struct msghdr msg;
+    struct pollfd pfd;
+    char control[256];
+
+    while (l->zc_done < l->zc_calls)
+    {
+        memset(&msg, 0x00, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(l->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        {
+            if (errno != EAGAIN || l->zc_done >= zc_id)
+                return;
+            pfd.fd = l->fd;
+            pfd.events = 0;
+            if (poll(&pfd, 1, NET_POLL_MS) > 0 && (pfd.revents & POLLNVAL))
+                return;
+            continue;
+        }
+        for (cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm))
+        {
+            if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                  (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)))
+                continue;
+            serr = (struct sock_extended_err *)CMSG_DATA(cm);
+            if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+                continue;
+            // Sends are numbered from 0 by the kernel, from 1 in zc_id
+            if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                l->stats.zc_copied += serr->ee_data - serr->ee_info + 1;
+            if ((uint64_t)serr->ee_data + 1 > l->zc_done)
+                l->zc_done = (uint64_t)serr->ee_data + 1;
+        }
+    }
+#endif
+    return;
+}
+
+// Next frame buffer, which the kernel may still be sending from
+static net_buf *net_get_buf(net_link *l)
+{
+    net_buf *b = &l->bufs[l->cur];
+
+    l->cur = (l->cur + 1) % l->nbufs;
+    if (b->zc_id > l->zc_done)
+        net_reap(l, b->zc_id);
+    return b;
+}
+
+static void net_fill(net_buf *b, const ads125x_slice *sl, size_t first, size_t n, uint64_t lost)
+{
+    uint8_t *p = b->data;
+    int32_t code;
+    uint32_t w;
+    uint64_t v;
+    size_t i;
+
+    w = htole32(ADS125x_NET_MAGIC);
+    memcpy(p, &w, 4);
+    w = htole32((uint32_t)ADS125x_NET_VERSION | (uint32_t)(uint16_t)n << 16);
+    memcpy(p + 4, &w, 4);
+    v = htole64(sl->seq + first);
+    memcpy(p + 8, &v, 8);
+    v = htole64(lost);
+    memcpy(p + 16, &v, 8);
+    p += ADS125x_NET_HDR_BYTES;
+    for (i = 0; i < n; ++i, p += 4)
+    {
+        code = (int32_t)htole32((uint32_t)sl->codes[first + i]);
+        memcpy(p, &code, 4);
+    }
+    for (i = 0; i < n; ++i, p += 8)
+    {
+        v = htole64(sl->ts[first + i]);
+        memcpy(p, &v, 8);
+    }
+    b->len = p - b->data;
+    return;
+}
+
+static int net_zc_flag(net_link *l, size_t len)
+{
+#ifdef MSG_ZEROCOPY
+    if (l->zerocopy && len >= ADS125x_NET_ZEROCOPY_MIN)
+        return MSG_ZEROCOPY;
+#endif
+    return 0;
+}
+
+// One frame on the stream, a short write is continued
+static int net_send_tcp(net_link *l, net_buf *b)
+{
+    size_t off = 0;
+    ssize_t ret;
+    int zc;
+
+    while (off < b->len)
+    {
+        zc = net_zc_flag(l, b->len - off);
+        if ((ret = send(l->fd, b->data + off, b->len - off, MSG_NOSIGNAL | zc)) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            // Out of optmem for pinned pages, copy this one
+            if (errno == ENOBUFS && zc)
+            {
+                l->zerocopy = 0;
+                continue;
+            }
+            return ADS125x_ERR_IO;
+        }
+        l->stats.sends++;
+        if (zc)
+        {
+            l->stats.zc_sends++;
+            b->zc_id = ++l->zc_calls;
+        }
+        off += ret;
+    }
+    return ADS125x_OK;
+}
+
+// Frames of a batch in one sendmmsg(), UDP errors only lose the frames
+static int net_send_udp(net_link *l, net_buf **frames, int nframes)
+{
+    struct mmsghdr msgs[nframes];
+    struct iovec iov[nframes];
+    int i, done = 0, ret, zc = 0;
+
+    memset(msgs, 0x00, sizeof(msgs));
+    for (i = 0; i < nframes; ++i)
+    {
+        iov[i].iov_base = frames[i]->data;
+        iov[i].iov_len = frames[i]->len;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        zc |= net_zc_flag(l, frames[i]->len);
+    }
+    while (done < nframes)
+    {
+        if ((ret = sendmmsg(l->fd, msgs + done, nframes - done, MSG_NOSIGNAL | zc)) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == ENOBUFS && zc)
+            {
+                l->zerocopy = zc = 0;
+                continue;
+            }
+            // Nobody listening yet, the frame is lost like on the wire
+            if (errno == ECONNREFUSED)
+            {
+                done++;
+                continue;
+            }
+            return ADS125x_ERR_IO;
+        }
+        l->stats.sends++;
+        for (i = done; i < done + ret; ++i)
+            if (zc)
+            {
+                l->stats.zc_sends++;
+                frames[i]->zc_id = ++l->zc_calls;
+            }
+        done += ret;
+    }
+    return ADS125x_OK;
+}
+
+// Wait for a full batch, at most until the first sample is latency_us old
+static int net_batch_ready(ads125x_net *net, const ads125x_slice *sl, size_t n)
+{
+    uint64_t now, deadline, fill;
+    struct timespec ts;
+
+    if (n >= net->cfg.batch || __atomic_load_n(&net->stop, __ATOMIC_ACQUIRE))
+        return 1;
+    // The slice ends at the end of the ring, the rest is ready behind it
+    if (ads125xPubCount(net->pub) > sl->seq + n * sl->stride)
+        return 1;
+    now = ads125xNowNs();
+    deadline = sl->ts[0] + (uint64_t)net->cfg.latency_us * 1000;
+    if (now >= deadline)
+        return 1;
+    // Sleep for the expected time to fill the batch, the rate is the one seen so far
+    fill = deadline - now;
+    if (n > 1 && sl->ts[(n - 1) * sl->stride] > sl->ts[0])
+    {
+        uint64_t period = (sl->ts[(n - 1) * sl->stride] - sl->ts[0]) / (n - 1);
+        if (period * (net->cfg.batch - n) < fill)
+            fill = period * (net->cfg.batch - n);
+    }
+    ts.tv_sec = fill / 1000000000;
+    ts.tv_nsec = fill % 1000000000;
+    nanosleep(&ts, NULL);
+    return 0;
+}
+
+static void *net_link_run(void *arg)
+{
+    net_link *l = (net_link *)arg;
+    ads125x_net *net = l->net;
+    net_buf *frames[net->frames_per_send];
+    ads125x_sub_stats ss;
+    ads125x_slice sl;
+    size_t m, off, k;
+    int n, nf, ret = ADS125x_OK;
+
+    while (ret == ADS125x_OK)
+    {
+        n = ads125xSubPeek(l->sub, &sl, NET_POLL_MS * 1000);
+        if (n == ADS125x_ERR_OVERRUN)
+            continue;
+        if (n == ADS125x_ERR_TIMEOUT)
+        {
+            if (__atomic_load_n(&net->stop, __ATOMIC_ACQUIRE))
+                break;
+            continue;
+        }
+        if (n <= 0)
+            break;
+        if (!net_batch_ready(net, &sl, (size_t)n))
+            continue;
+        m = (size_t)n < net->cfg.batch ? (size_t)n : net->cfg.batch;
+        ads125xSubGetStats(l->sub, &ss);
+        for (off = 0, nf = 0; off < m; off += k, ++nf)
+        {
+            k = m - off < net->frame_samples ? m - off : net->frame_samples;
+            frames[nf] = net_get_buf(l);
+            net_fill(frames[nf], &sl, off, k, ss.dropped);
+            if (net->cfg.proto == ADS125x_NET_TCP && (ret = net_send_tcp(l, frames[nf])))
+                break;
+            l->stats.frames++;
+            l->stats.bytes += frames[nf]->len;
+        }
+        if (ret == ADS125x_OK && net->cfg.proto == ADS125x_NET_UDP)
+            ret = net_send_udp(l, frames, nf);
+        if (ret == ADS125x_OK)
+            l->stats.samples += m;
+        ads125xSubRelease(l->sub, m);
+    }
+    net_reap(l, l->zc_calls);
+    ads125xSubGetStats(l->sub, &ss);
+    l->stats.dropped = ss.dropped;
+    // A TCP client sees the end of the stream
+    shutdown(l->fd, SHUT_WR);
+    return NULL;
+}
+
+static void net_link_free(net_link *l)
+{
+    if (l->sub)
+        ads125xUnsubscribe(l->sub);
+    if (l->fd >= 0)
+        close(l->fd);
+    free(l->bufs);
+    free(l->mem);
+    free(l);
+    return;
+}
+
+static int net_link_start(ads125x_net *net, int fd)
+{
+    size_t frame_bytes = ADS125x_NET_HDR_BYTES + net->frame_samples * ADS125x_NET_SAMPLE_BYTES;
+    net_link *l;
+    int i, one = 1;
+
+    if ((l = calloc(1, sizeof(*l))) == NULL)
+    {
+        close(fd);
+        return ADS125x_ERR_IO;
+    }
+    l->net = net;
+    l->fd = fd;
+    // Twice a batch, so a batch is built while the last one is still in flight
+    l->nbufs = 2 * net->frames_per_send < NET_BUFS_MIN ? NET_BUFS_MIN : 2 * net->frames_per_send;
+    if ((l->sub = ads125xSubscribe(net->pub, net->cfg.policy, 0)) == NULL ||
+        (l->mem = malloc(frame_bytes * l->nbufs)) == NULL ||
+        (l->bufs = calloc(l->nbufs, sizeof(*l->bufs))) == NULL)
+    {
+        net_link_free(l);
+        return ADS125x_ERR_IO;
+    }
+    for (i = 0; i < l->nbufs; ++i)
+        l->bufs[i].data = l->mem + i * frame_bytes;
+    if (net->cfg.proto == ADS125x_NET_TCP)
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_ZEROCOPY
+    if ((net->cfg.flags & ADS125x_NET_ZEROCOPY) &&
+        setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0)
+        l->zerocopy = 1;
+#endif
+    if (pthread_create(&l->thread, NULL, net_link_run, l))
+    {
+        net_link_free(l);
+        return ADS125x_ERR_IO;
+    }
+    pthread_mutex_lock(&net->lock);
+    l->next = net->links;
+    net->links = l;
+    if (net->cfg.proto == ADS125x_NET_TCP)
+        net->clients++;
+    pthread_cond_broadcast(&net->cond);
+    pthread_mutex_unlock(&net->lock);
+    return ADS125x_OK;
+}
+
+static void *net_accept_run(void *arg)
+{
+    ads125x_net *net = (ads125x_net *)arg;
+    struct pollfd pfd;
+    int fd;
+
+    pfd.fd = net->listen_fd;
+    pfd.events = POLLIN;
+    while (!__atomic_load_n(&net->stop, __ATOMIC_ACQUIRE))
+    {
+        if (poll(&pfd, 1, NET_POLL_MS) <= 0)
+            continue;
+        if ((fd = accept4(net->listen_fd, NULL, NULL, SOCK_CLOEXEC)) < 0)
+            continue;
+        if (net_link_start(net, fd) && ADS125xDriverDebug)
+            fprintf(stderr, "Drop a client, out of memory.\n");
+    }
+    return NULL;
+}
+
+/**
+ * ads125xNetServe - Start streaming a publisher
+ * @pub: The publisher, it must outlive the server.
+ * @cfg: Protocol, address, batching and flags, 0 fields take the defaults.
+ *
+ * TCP clients get the samples published after they connected. UDP frames
+ * go to a single destination, which may be started after the server.
+ *
+ * @return: The server, or NULL on failure.
+ */
+ads125x_net *ads125xNetServe(ads125x_pub *pub, const ads125x_net_cfg *cfg)
+{
+    ads125x_net *net;
+    size_t fit;
+    int fd;
+
+    if (cfg->proto != ADS125x_NET_TCP && cfg->proto != ADS125x_NET_UDP)
+        return NULL;
+    // A strided slice would have to be gathered, frames carry every sample
+    if (cfg->policy != ADS125x_SUB_BLOCK && cfg->policy != ADS125x_SUB_DROP_OLDEST)
+        return NULL;
+    if ((net = calloc(1, sizeof(*net))) == NULL)
+        return NULL;
+    net->pub = pub;
+    net->cfg = *cfg;
+    net->listen_fd = -1;
+    if (!net->cfg.batch)
+        net->cfg.batch = ADS125x_NET_BATCH;
+    if (net->cfg.latency_us <= 0)
+        net->cfg.latency_us = ADS125x_NET_LATENCY_US;
+    if (!net->cfg.datagram)
+        net->cfg.datagram = ADS125x_NET_DATAGRAM;
+    net->frame_samples = ADS125x_NET_MAX_COUNT;
+    if (cfg->proto == ADS125x_NET_UDP)
+    {
+        if (net->cfg.datagram < ADS125x_NET_HDR_BYTES + ADS125x_NET_SAMPLE_BYTES)
+        {
+            free(net);
+            return NULL;
+        }
+        fit = (net->cfg.datagram - ADS125x_NET_HDR_BYTES) / ADS125x_NET_SAMPLE_BYTES;
+        if (fit < net->frame_samples)
+            net->frame_samples = fit;
+    }
+    if (net->frame_samples > net->cfg.batch)
+        net->frame_samples = net->cfg.batch;
+    net->frames_per_send = (net->cfg.batch + net->frame_samples - 1) / net->frame_samples;
+    pthread_mutex_init(&net->lock, NULL);
+    pthread_cond_init(&net->cond, NULL);
+
+    if (cfg->proto == ADS125x_NET_UDP)
+    {
+        if ((fd = net_socket(cfg->addr, SOCK_DGRAM, 0)) < 0 || net_link_start(net, fd))
+        {
+            ads125xNetClose(net, NULL);
+            return NULL;
+        }
+        return net;
+    }
+    if ((net->listen_fd = net_socket(cfg->addr, SOCK_STREAM, 1)) < 0 ||
+        pthread_create(&net->acceptor, NULL, net_accept_run, net))
+    {
+        ads125xNetClose(net, NULL);
+        return NULL;
+    }
+    net->has_acceptor = 1;
+    return net;
+}
+
+/**
+ * ads125xNetWaitClients - Wait until enough TCP clients are connected
+ * @net: The server.
+ * @clients: Number of clients served so far to wait for.
+ * @timeout_us: Longest wait, -1 for no limit.
+ *
+ * Lets the acquisition start only once the first receiver is there, a
+ * UDP server returns at once.
+ *
+ * @return: ADS125x_OK or ADS125x_ERR_TIMEOUT.
+ */
+int ads125xNetWaitClients(ads125x_net *net, int clients, int timeout_us)
+{
+    struct timespec ts;
+    int ret = 0;
+
+    if (net->cfg.proto != ADS125x_NET_TCP)
+        return ADS125x_OK;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_us / 1000000;
+    ts.tv_nsec += (timeout_us % 1000000) * 1000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_mutex_lock(&net->lock);
+    while (net->clients < clients && ret == 0)
+        ret = timeout_us < 0 ? pthread_cond_wait(&net->cond, &net->lock)
+                             : pthread_cond_timedwait(&net->cond, &net->lock, &ts);
+    pthread_mutex_unlock(&net->lock);
+    return ret ? ADS125x_ERR_TIMEOUT : ADS125x_OK;
+}
+
+/**
+ * ads125xNetClose - Stop the server
+ * @net: The server.
+ * @stats: Returns the counters of all links, may be NULL.
+ *
+ * What is already published is sent first, so close the publisher before
+ * to send everything, the server does not wait for new samples.
+ *
+ * @return: ADS125x_OK.
+ */
+int ads125xNetClose(ads125x_net *net, ads125x_net_stats *stats)
+{
+    net_link *l, *next;
+
+    __atomic_store_n(&net->stop, 1, __ATOMIC_RELEASE);
+    if (net->has_acceptor)
+        pthread_join(net->acceptor, NULL);
+    if (net->listen_fd >= 0)
+        close(net->listen_fd);
+    if (stats)
+    {
+        memset(stats, 0x00, sizeof(*stats));
+        stats->clients = net->clients;
+    }
+    for (l = net->links; l; l = next)
+    {
+        next = l->next;
+        pthread_join(l->thread, NULL);
+        if (stats)
+        {
+            stats->frames += l->stats.frames;
+            stats->samples += l->stats.samples;
+            stats->bytes += l->stats.bytes;
+            stats->sends += l->stats.sends;
+            stats->dropped += l->stats.dropped;
+            stats->zc_sends += l->stats.zc_sends;
+            stats->zc_copied += l->stats.zc_copied;
+        }
+        net_link_free(l);
+    }
+    pthread_cond_destroy(&net->cond);
+    pthread_mutex_destroy(&net->lock);
+    free(net);
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xNetConnect - Open the receiving side of a stream
+ * @proto: ADS125x_NET_TCP or ADS125x_NET_UDP.
+ * @addr: TCP: host:port of the server, UDP: [host:]port to receive on.
+ *
+ * @return: The client, or NULL on failure.
+ */
+ads125x_net_client *ads125xNetConnect(int proto, const char *addr)
+{
+    ads125x_net_client *cli;
+    int size = NET_UDP_RCVBUF;
+
+    if (proto != ADS125x_NET_TCP && proto != ADS125x_NET_UDP)
+        return NULL;
+    if ((cli = calloc(1, sizeof(*cli))) == NULL)
+        return NULL;
+    cli->proto = proto;
+    if (proto == ADS125x_NET_UDP)
+    {
+        if ((cli->buf = malloc(ADS125x_NET_HDR_BYTES + ADS125x_NET_MAX_COUNT * ADS125x_NET_SAMPLE_BYTES)) == NULL ||
+            (cli->fd = net_socket(addr, SOCK_DGRAM, 1)) < 0)
+        {
+            free(cli->buf);
+            free(cli);
+            return NULL;
+        }
+        // Loopback bursts are larger than the default buffer
+        setsockopt(cli->fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        return cli;
+    }
+    if ((cli->fd = net_socket(addr, SOCK_STREAM, 0)) < 0)
+    {
+        free(cli);
+        return NULL;
+    }
+    return cli;
+}
+
+static int net_parse_hdr(const uint8_t *p, ads125x_net_frame *frame)
+{
+    uint32_t magic, ver_count;
+
+    memcpy(&magic, p, 4);
+    memcpy(&ver_count, p + 4, 4);
+    ver_count = le32toh(ver_count);
+    if (le32toh(magic) != ADS125x_NET_MAGIC || (ver_count & 0xffff) != ADS125x_NET_VERSION)
+        return ADS125x_ERR_INVAL;
+    frame->count = ver_count >> 16;
+    memcpy(&frame->seq, p + 8, 8);
+    memcpy(&frame->lost, p + 16, 8);
+    frame->seq = le64toh(frame->seq);
+    frame->lost = le64toh(frame->lost);
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xNetRecv - Receive the next frame
+ * @cli: The client.
+ * @frame: Returns the header.
+ * @codes: Room for ADS125x_NET_MAX_COUNT codes.
+ * @ts: Room for ADS125x_NET_MAX_COUNT timestamps.
+ * @timeout_us: Longest wait, -1 for no limit.
+ *
+ * @return: Samples in the frame, 0 once a TCP server has closed the stream,
+ * ADS125x_ERR_TIMEOUT, ADS125x_ERR_INVAL for a malformed frame or
+ * ADS125x_ERR_IO.
+ */
+int ads125xNetRecv(ads125x_net_client *cli, ads125x_net_frame *frame,
+                   int32_t *codes, uint64_t *ts, int timeout_us)
+{
+    uint8_t hdr[ADS125x_NET_HDR_BYTES];
+    struct pollfd pfd;
+    struct msghdr msg;
+    struct iovec iov[2];
+    ssize_t ret;
+    size_t i, bytes;
+
+    pfd.fd = cli->fd;
+    pfd.events = POLLIN;
+    if ((ret = poll(&pfd, 1, timeout_us < 0 ? -1 : timeout_us / 1000)) == 0)
+        return ADS125x_ERR_TIMEOUT;
+    if (ret < 0)
+        return ADS125x_ERR_IO;
+
+    if (cli->proto == ADS125x_NET_UDP)
+    {
+        if ((ret = recv(cli->fd, cli->buf, ADS125x_NET_HDR_BYTES + ADS125x_NET_MAX_COUNT * ADS125x_NET_SAMPLE_BYTES, 0)) < 0)
+            return ADS125x_ERR_IO;
+        bytes = ret;
+        if (bytes < ADS125x_NET_HDR_BYTES || net_parse_hdr(cli->buf, frame) ||
+            bytes != ADS125x_NET_HDR_BYTES + frame->count * ADS125x_NET_SAMPLE_BYTES)
+            return ADS125x_ERR_INVAL;
+        memcpy(codes, cli->buf + ADS125x_NET_HDR_BYTES, frame->count * 4);
+        memcpy(ts, cli->buf + ADS125x_NET_HDR_BYTES + frame->count * 4, frame->count * 8);
+    }
+    else
+    {
+        if ((ret = recv(cli->fd, hdr, sizeof(hdr), MSG_WAITALL)) == 0)
+            return 0;
+        if (ret != sizeof(hdr))
+            return ADS125x_ERR_IO;
+        if (net_parse_hdr(hdr, frame))
+            return ADS125x_ERR_INVAL;
+        // The payload lands straight in the caller's arrays
+        iov[0].iov_base = codes;
+        iov[0].iov_len = frame->count * 4;
+        iov[1].iov_base = ts;
+        iov[1].iov_len = frame->count * 8;
+        memset(&msg, 0x00, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 2;
+        bytes = frame->count * ADS125x_NET_SAMPLE_BYTES;
+        if ((ret = recvmsg(cli->fd, &msg, MSG_WAITALL)) < 0 || (size_t)ret != bytes)
+            return ADS125x_ERR_IO;
+        bytes += ADS125x_NET_HDR_BYTES;
+    }
+    for (i = 0; i < frame->count; ++i)
+    {
+        codes[i] = (int32_t)le32toh((uint32_t)codes[i]);
+        ts[i] = le64toh(ts[i]);
+    }
+
+    if (cli->started && frame->seq > cli->next_seq)
+        cli->stats.gaps += frame->seq - cli->next_seq;
+    if (!cli->started || frame->seq >= cli->next_seq)
+        cli->next_seq = frame->seq + frame->count;
+    cli->started = 1;
+    cli->stats.frames++;
+    cli->stats.samples += frame->count;
+    cli->stats.bytes += bytes;
+    cli->stats.lost = frame->lost;
+    return (int)frame->count;
+}
+
+/**
+ * ads125xNetClientGetStats - Received frames and losses of a client
+ * @cli: The client.
+ * @stats: Returns the counters.
+ */
+void ads125xNetClientGetStats(ads125x_net_client *cli, ads125x_net_client_stats *stats)
+{
+    *stats = cli->stats;
+    return;
+}
+
+/**
+ * ads125xNetDisconnect - Close a client
+ * @cli: The client.
+ */
+void ads125xNetDisconnect(ads125x_net_client *cli)
+{
+    close(cli->fd);
+    free(cli->buf);
+    free(cli);
+    return;
+}
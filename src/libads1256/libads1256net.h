@@ -0,0 +1,144 @@
+/**
+ * libads1256net.h - Stream ADS125x samples over TCP or UDP
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256NET_H
+#define LIBADS1256NET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libads1256pubsub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The server sends the samples of a publisher (libads1256pubsub.h) in
+ * frames. Every TCP client and the UDP destination is a subscriber of its
+ * own, so a slow link loses samples on its own and never stalls the
+ * acquisition. A frame is a header followed by the codes and then the
+ * timestamps of its samples, all fields little-endian:
+ *
+ *  uint32 magic    ADS125x_NET_MAGIC
+ *  uint16 version  ADS125x_NET_VERSION
+ *  uint16 count    Samples in the frame
+ *  uint64 seq      Publish index of the first sample, a gap is a loss
+ *  uint64 lost     Samples the server dropped for this link so far
+ *  int32  code[count]
+ *  uint64 ts[count]    ads125xNowNs() at DRDY
+ *
+ * Over TCP the frames follow each other on the stream, over UDP every
+ * datagram is one frame.
+ *
+ * A frame is sent once it holds batch samples or once its first sample is
+ * latency_us old, so batch trades system calls for latency. UDP frames are
+ * cut at the datagram limit, the frames of one batch go out with a single
+ * sendmmsg(). With ADS125x_NET_ZEROCOPY large sends use MSG_ZEROCOPY, the
+ * frame buffers are recycled only once the kernel reports them done.
+ */
+#define ADS125x_NET_MAGIC           0x35324441  // "AD25"
+#define ADS125x_NET_VERSION         1
+#define ADS125x_NET_HDR_BYTES       24
+#define ADS125x_NET_SAMPLE_BYTES    12
+#define ADS125x_NET_MAX_COUNT       65535
+
+#define ADS125x_NET_TCP             0
+#define ADS125x_NET_UDP             1
+
+// Server flags
+#define ADS125x_NET_ZEROCOPY        0x01
+
+// Defaults of ads125x_net_cfg
+#define ADS125x_NET_BATCH           1024
+#define ADS125x_NET_LATENCY_US      20000
+#define ADS125x_NET_DATAGRAM        1472    // One Ethernet frame
+#define ADS125x_NET_ZEROCOPY_MIN    16384   // Smaller sends are cheaper to copy
+
+typedef struct ads125x_net_struct ads125x_net;
+typedef struct ads125x_net_client_struct ads125x_net_client;
+
+typedef struct ads125x_net_cfg_struct
+{
+    int proto;              // ADS125x_NET_TCP or ADS125x_NET_UDP
+    const char *addr;       // TCP: [host:]port to listen on, UDP: host:port to send to
+    size_t batch;           // Samples per send, 0 for ADS125x_NET_BATCH
+    int latency_us;         // Longest wait for a full batch, 0 for ADS125x_NET_LATENCY_US
+    size_t datagram;        // UDP payload limit, 0 for ADS125x_NET_DATAGRAM
+    int policy;             // ADS125x_SUB_DROP_OLDEST or ADS125x_SUB_BLOCK
+    int flags;
+} ads125x_net_cfg;
+
+typedef struct ads125x_net_stats_struct
+{
+    uint64_t frames;
+    uint64_t samples;
+    uint64_t bytes;
+    uint64_t sends;         // send system calls
+    uint64_t dropped;       // Samples lost to slow links
+    uint64_t zc_sends;      // Sends with MSG_ZEROCOPY
+    uint64_t zc_copied;     // Of those, the kernel copied anyway
+    int clients;            // TCP clients served
+} ads125x_net_stats;
+
+typedef struct ads125x_net_frame_struct
+{
+    uint64_t seq;
+    uint64_t lost;
+    size_t count;
+} ads125x_net_frame;
+
+typedef struct ads125x_net_client_stats_struct
+{
+    uint64_t frames;
+    uint64_t samples;
+    uint64_t bytes;
+    uint64_t gaps;          // Samples missing between frames
+    uint64_t lost;          // Latest loss reported by the server
+} ads125x_net_client_stats;
+
+ads125x_net *ads125xNetServe(ads125x_pub *pub, const ads125x_net_cfg *cfg);
+int ads125xNetWaitClients(ads125x_net *net, int clients, int timeout_us);
+int ads125xNetClose(ads125x_net *net, ads125x_net_stats *stats);
+
+ads125x_net_client *ads125xNetConnect(int proto, const char *addr);
+int ads125xNetRecv(ads125x_net_client *cli, ads125x_net_frame *frame,
+                   int32_t *codes, uint64_t *ts, int timeout_us);
+void ads125xNetClientGetStats(ads125x_net_client *cli, ads125x_net_client_stats *stats);
+void ads125xNetDisconnect(ads125x_net_client *cli);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
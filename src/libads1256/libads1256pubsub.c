@@ -0,0 +1,436 @@
+/**
+ * libads1256pubsub.c - Publish one ADS125x stream to many subscribers
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "libads1256pubsub.h"
+
+#define PUB_ALIGN                   64
+
+struct ads125x_pub_struct
+{
+    size_t cap;
+    size_t mask;
+    int32_t *codes;
+    uint64_t *ts;
+    int closed;
+    int refs;
+    // Written by the publisher only. Samples before head are readable,
+    // samples before reserved may already be overwritten in the ring.
+    uint64_t head __attribute__((aligned(PUB_ALIGN)));
+    uint64_t reserved;
+    // Futex word, bumped on every commit
+    uint32_t wake __attribute__((aligned(PUB_ALIGN)));
+    uint32_t waiters;
+};
+
+struct ads125x_sub_struct
+{
+    ads125x_pub *pub;
+    int policy;
+    size_t max_stride;
+    size_t stride;
+    uint64_t cursor;
+    ads125x_sub_stats stats;
+};
+
+static void pub_unref(ads125x_pub *pub)
+{
+    if (__atomic_sub_fetch(&pub->refs, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        free(pub->codes);
+        free(pub->ts);
+        free(pub);
+    }
+    return;
+}
+
+static void pub_wake(ads125x_pub *pub)
+{
+    __atomic_add_fetch(&pub->wake, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&pub->waiters, __ATOMIC_SEQ_CST))
+        syscall(SYS_futex, &pub->wake, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    return;
+}
+
+/**
+ * ads125xPubOpen - Create a publisher
+ * @capacity: Samples kept in the ring, a power of two of at least 64.
+ *
+ * @return: The publisher, or NULL on failure.
+ */
+ads125x_pub *ads125xPubOpen(size_t capacity)
+{
+    ads125x_pub *pub;
+
+    if (capacity < 64 || (capacity & (capacity - 1)))
+        return NULL;
+    if (posix_memalign((void **)&pub, PUB_ALIGN, sizeof(*pub)))
+        return NULL;
+    memset(pub, 0x00, sizeof(*pub));
+    pub->cap = capacity;
+    pub->mask = capacity - 1;
+    pub->refs = 1;
+    if (posix_memalign((void **)&pub->codes, PUB_ALIGN, capacity * sizeof(int32_t)) ||
+        posix_memalign((void **)&pub->ts, PUB_ALIGN, capacity * sizeof(uint64_t)))
+    {
+        free(pub->codes);
+        free(pub);
+        return NULL;
+    }
+    // Fault the ring in now rather than in the acquisition loop
+    memset(pub->codes, 0x00, capacity * sizeof(int32_t));
+    memset(pub->ts, 0x00, capacity * sizeof(uint64_t));
+    return pub;
+}
+
+/**
+ * ads125xPubReserve - Get ring space to publish into
+ * @pub: The publisher.
+ * @ts: Returns where the timestamps of the reserved samples go.
+ * @n: Samples wanted, returns the samples reserved.
+ *
+ * The space is contiguous, so fewer samples than wanted may be reserved
+ * at the end of the ring, and at most a quarter of the ring. Only one
+ * thread may publish.
+ *
+ * @return: Where the codes of the reserved samples go.
+ */
+int32_t *ads125xPubReserve(ads125x_pub *pub, uint64_t **ts, size_t *n)
+{
+    size_t idx = pub->head & pub->mask;
+
+    if (*n > pub->cap - idx)
+        *n = pub->cap - idx;
+    if (*n > pub->cap / 4)
+        *n = pub->cap / 4;
+    // Subscribers check reserved after reading, as in a seqlock
+    __atomic_store_n(&pub->reserved, pub->head + *n, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    *ts = pub->ts + idx;
+    return pub->codes + idx;
+}
+
+/**
+ * ads125xPubCommit - Make reserved samples visible to the subscribers
+ * @pub: The publisher.
+ * @n: Samples written, at most the samples reserved.
+ *
+ * @return: ADS125x_OK, or ADS125x_ERR_INVAL.
+ */
+int ads125xPubCommit(ads125x_pub *pub, size_t n)
+{
+    if (pub->head + n > pub->reserved)
+        return ADS125x_ERR_INVAL;
+    __atomic_store_n(&pub->head, pub->head + n, __ATOMIC_RELEASE);
+    pub_wake(pub);
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xPubPublish - Copy samples into the ring and publish them
+ * @pub: The publisher.
+ * @codes: Signed conversion results.
+ * @ts: DRDY times of the samples, or NULL.
+ * @n: Number of samples.
+ *
+ * @return: ADS125x_OK.
+ */
+int ads125xPubPublish(ads125x_pub *pub, const int32_t *codes, const uint64_t *ts, size_t n)
+{
+    int32_t *dst;
+    uint64_t *dst_ts;
+    size_t m;
+
+    while (n)
+    {
+        m = n;
+        dst = ads125xPubReserve(pub, &dst_ts, &m);
+        memcpy(dst, codes, m * sizeof(*codes));
+        if (ts)
+            memcpy(dst_ts, ts, m * sizeof(*ts));
+        else
+            memset(dst_ts, 0x00, m * sizeof(*ts));
+        ads125xPubCommit(pub, m);
+        codes += m;
+        if (ts)
+            ts += m;
+        n -= m;
+    }
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xPubRDATAC - Read samples in RDATAC mode straight into the ring
+ * @dev: The device, in RDATAC mode.
+ * @pub: The publisher.
+ * @n: Number of samples, subscribers see them n at a time.
+ *
+ * The 3 byte results are read into the back of the reserved space and
+ * widened in place from the front, every int32 lands on bytes that have
+ * already been converted.
+ *
+ * @return: ADS125x_OK, or the error of ads125xRDATACReadTs().
+ */
+int ads125xPubRDATAC(ads125x_dev *dev, ads125x_pub *pub, size_t n)
+{
+    int32_t *codes;
+    uint64_t *ts;
+    uint8_t *raw;
+    size_t i, m;
+    int ret;
+
+    while (n)
+    {
+        m = n;
+        codes = ads125xPubReserve(pub, &ts, &m);
+        raw = (uint8_t *)codes + m;
+        if ((ret = ads125xRDATACReadTs(dev, raw, ts, m)) < 0)
+            return ret;
+        for (i = 0; i < m; ++i)
+            codes[i] = convert_to_signed_24bit(raw + 3 * i);
+        ads125xPubCommit(pub, m);
+        n -= m;
+    }
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xPubCount - Samples published so far
+ * @pub: The publisher.
+ */
+uint64_t ads125xPubCount(ads125x_pub *pub)
+{
+    return __atomic_load_n(&pub->head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * ads125xPubClose - Stop publishing
+ * @pub: The publisher.
+ *
+ * Subscribers read what is left and then get 0 from ads125xSubPeek().
+ * The ring is freed after the last subscriber is gone.
+ */
+void ads125xPubClose(ads125x_pub *pub)
+{
+    __atomic_store_n(&pub->closed, 1, __ATOMIC_RELEASE);
+    pub_wake(pub);
+    pub_unref(pub);
+    return;
+}
+
+/**
+ * ads125xSubscribe - Attach a subscriber
+ * @pub: The publisher.
+ * @policy: ADS125x_SUB_BLOCK, ADS125x_SUB_DROP_OLDEST or ADS125x_SUB_DECIMATE.
+ * @max_stride: Decimation limit for ADS125x_SUB_DECIMATE, a power of two,
+ *              0 for ADS125x_SUB_MAX_STRIDE.
+ *
+ * The subscriber starts at the next sample published.
+ *
+ * @return: The subscriber, or NULL on failure.
+ */
+ads125x_sub *ads125xSubscribe(ads125x_pub *pub, int policy, size_t max_stride)
+{
+    ads125x_sub *sub;
+
+    if (policy < ADS125x_SUB_BLOCK || policy > ADS125x_SUB_DECIMATE)
+        return NULL;
+    if (policy != ADS125x_SUB_DECIMATE)
+        max_stride = 1;
+    else if (!max_stride)
+        max_stride = ADS125x_SUB_MAX_STRIDE;
+    if ((max_stride & (max_stride - 1)) || max_stride > pub->cap / 8)
+        return NULL;
+    if ((sub = calloc(1, sizeof(*sub))) == NULL)
+        return NULL;
+    __atomic_add_fetch(&pub->refs, 1, __ATOMIC_ACQ_REL);
+    sub->pub = pub;
+    sub->policy = policy;
+    sub->max_stride = max_stride;
+    sub->stride = 1;
+    sub->cursor = ads125xPubCount(pub);
+    return sub;
+}
+
+// Move the cursor forward over samples the subscriber will not read
+static void sub_skip(ads125x_sub *sub, uint64_t to)
+{
+    sub->stats.dropped += to - sub->cursor;
+    sub->cursor = to;
+    return;
+}
+
+/**
+ * ads125xSubPeek - Get the next samples in place
+ * @sub: The subscriber.
+ * @slice: Returns where the samples are.
+ * @timeout_us: Longest wait for new samples, 0 to not wait, -1 for no limit.
+ *
+ * The samples stay in the ring until ads125xSubRelease(), a slice never
+ * wraps around the end of the ring.
+ *
+ * @return: Number of samples, 0 once the publisher is closed and all
+ * samples are read, ADS125x_ERR_TIMEOUT, or ADS125x_ERR_OVERRUN for an
+ * ADS125x_SUB_BLOCK subscriber that lost samples.
+ */
+int ads125xSubPeek(ads125x_sub *sub, ads125x_slice *slice, int timeout_us)
+{
+    ads125x_pub *pub = sub->pub;
+    uint64_t head, reserved, lag, idx, n, deadline = 0, now;
+    uint32_t wake;
+    struct timespec ts;
+    size_t contig;
+
+    if (timeout_us > 0)
+        deadline = ads125xNowNs() + (uint64_t)timeout_us * 1000;
+    for (;;)
+    {
+        wake = __atomic_load_n(&pub->wake, __ATOMIC_SEQ_CST);
+        head = __atomic_load_n(&pub->head, __ATOMIC_ACQUIRE);
+        reserved = __atomic_load_n(&pub->reserved, __ATOMIC_ACQUIRE);
+        if (sub->cursor + pub->cap < reserved)
+        {
+            // Keep the newest half, the publisher reserves at most a quarter
+            sub->stats.overruns++;
+            sub_skip(sub, head - pub->cap / 2);
+            if (sub->policy == ADS125x_SUB_BLOCK)
+                return ADS125x_ERR_OVERRUN;
+        }
+        lag = head - sub->cursor;
+        if (sub->policy == ADS125x_SUB_DECIMATE)
+        {
+            while (lag > pub->cap / 2 && sub->stride < sub->max_stride)
+                sub->stride <<= 1;
+            if (lag < pub->cap / 8 && sub->stride > 1)
+                sub->stride >>= 1;
+            // Strided slices start on a multiple of the stride so they
+            // end exactly on the end of the ring
+            idx = sub->cursor & (sub->stride - 1);
+            if (idx && lag >= sub->stride - idx)
+            {
+                sub_skip(sub, sub->cursor + sub->stride - idx);
+                lag = head - sub->cursor;
+            }
+        }
+        idx = sub->cursor & pub->mask;
+        contig = pub->cap - idx;
+        n = (lag < contig ? lag : contig) / sub->stride;
+        if (n)
+        {
+            slice->codes = pub->codes + idx;
+            slice->ts = pub->ts + idx;
+            slice->stride = sub->stride;
+            slice->seq = sub->cursor;
+            return n > INT_MAX ? INT_MAX : (int)n;
+        }
+        if (__atomic_load_n(&pub->closed, __ATOMIC_ACQUIRE))
+            return 0;
+        if (timeout_us == 0)
+            return ADS125x_ERR_TIMEOUT;
+        if (timeout_us > 0)
+        {
+            if ((now = ads125xNowNs()) >= deadline)
+                return ADS125x_ERR_TIMEOUT;
+            ts.tv_sec = (deadline - now) / 1000000000;
+            ts.tv_nsec = (deadline - now) % 1000000000;
+        }
+        __atomic_add_fetch(&pub->waiters, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&pub->wake, __ATOMIC_SEQ_CST) == wake)
+            syscall(SYS_futex, &pub->wake, FUTEX_WAIT_PRIVATE, wake,
+                    timeout_us > 0 ? &ts : NULL, NULL, 0);
+        __atomic_sub_fetch(&pub->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * ads125xSubRelease - Done with samples from ads125xSubPeek()
+ * @sub: The subscriber.
+ * @n: Samples of the slice used, at most the number peeked.
+ *
+ * @return: ADS125x_OK, ADS125x_ERR_INVAL, or ADS125x_ERR_OVERRUN if the
+ * publisher overwrote the slice while it was being read.
+ */
+int ads125xSubRelease(ads125x_sub *sub, size_t n)
+{
+    ads125x_pub *pub = sub->pub;
+    uint64_t bump = (uint64_t)n * sub->stride;
+    uint64_t reserved;
+    int ret = ADS125x_OK;
+
+    if (sub->cursor + bump > __atomic_load_n(&pub->head, __ATOMIC_ACQUIRE))
+        return ADS125x_ERR_INVAL;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    reserved = __atomic_load_n(&pub->reserved, __ATOMIC_RELAXED);
+    if (sub->cursor + pub->cap < reserved)
+    {
+        sub->stats.overruns++;
+        ret = ADS125x_ERR_OVERRUN;
+    }
+    sub->cursor += bump;
+    sub->stats.delivered += n;
+    sub->stats.dropped += bump - n;
+    return ret;
+}
+
+/**
+ * ads125xSubGetStats - Delivered and dropped samples of a subscriber
+ * @sub: The subscriber.
+ * @stats: Returns the counters.
+ */
+void ads125xSubGetStats(ads125x_sub *sub, ads125x_sub_stats *stats)
+{
+    *stats = sub->stats;
+    stats->stride = sub->stride;
+    return;
+}
+
+/**
+ * ads125xUnsubscribe - Detach and free a subscriber
+ * @sub: The subscriber.
+ */
+void ads125xUnsubscribe(ads125x_sub *sub)
+{
+    pub_unref(sub->pub);
+    free(sub);
+    return;
+}
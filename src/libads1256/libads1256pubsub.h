@@ -0,0 +1,112 @@
+/**
+ * libads1256pubsub.h - Publish one ADS125x stream to many subscribers
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256PUBSUB_H
+#define LIBADS1256PUBSUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libads1256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The acquisition thread publishes each sample once into a shared ring,
+ * any number of subscribers read it in place through their own cursor.
+ * Publishing never looks at the subscribers and never waits, so a slow or
+ * stuck subscriber cannot stall acquisition or the other subscribers.
+ * Reading is a pointer into the ring and releasing is a cursor bump, no
+ * sample is copied per subscriber.
+ *
+ * A subscriber that falls behind by more than the ring is handled by its
+ * policy:
+ *  BLOCK       Lossless. Reads wait for new samples and an overrun is
+ *              reported as ADS125x_ERR_OVERRUN, so size the ring for
+ *              the longest stall of such a consumer.
+ *  DROP_OLDEST Skips to the newest half of the ring and counts the loss.
+ *  DECIMATE    Reads every stride-th sample while it lags behind, the
+ *              stride doubles while more than half the ring is unread and
+ *              halves again once it has caught up.
+ */
+// Subscriber policies
+#define ADS125x_SUB_BLOCK           0
+#define ADS125x_SUB_DROP_OLDEST     1
+#define ADS125x_SUB_DECIMATE        2
+
+#define ADS125x_SUB_MAX_STRIDE      64      // Default decimation limit
+
+typedef struct ads125x_pub_struct ads125x_pub;
+typedef struct ads125x_sub_struct ads125x_sub;
+
+/**
+ * A run of samples readable in place. Sample i is codes[i * stride],
+ * taken at ts[i * stride]. seq is the publish index of the first one.
+ */
+typedef struct ads125x_slice_struct
+{
+    const int32_t *codes;
+    const uint64_t *ts;
+    size_t stride;
+    uint64_t seq;
+} ads125x_slice;
+
+typedef struct ads125x_sub_stats_struct
+{
+    uint64_t delivered;     // Samples released
+    uint64_t dropped;       // Samples skipped by the policy
+    uint64_t overruns;      // Times the subscriber was a whole ring behind
+    size_t stride;          // Current decimation
+} ads125x_sub_stats;
+
+ads125x_pub *ads125xPubOpen(size_t capacity);
+int32_t *ads125xPubReserve(ads125x_pub *pub, uint64_t **ts, size_t *n);
+int ads125xPubCommit(ads125x_pub *pub, size_t n);
+int ads125xPubPublish(ads125x_pub *pub, const int32_t *codes, const uint64_t *ts, size_t n);
+int ads125xPubRDATAC(ads125x_dev *dev, ads125x_pub *pub, size_t n);
+uint64_t ads125xPubCount(ads125x_pub *pub);
+void ads125xPubClose(ads125x_pub *pub);
+
+ads125x_sub *ads125xSubscribe(ads125x_pub *pub, int policy, size_t max_stride);
+int ads125xSubPeek(ads125x_sub *sub, ads125x_slice *slice, int timeout_us);
+int ads125xSubRelease(ads125x_sub *sub, size_t n);
+void ads125xSubGetStats(ads125x_sub *sub, ads125x_sub_stats *stats);
+void ads125xUnsubscribe(ads125x_sub *sub);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
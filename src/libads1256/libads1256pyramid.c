@@ -0,0 +1,495 @@
+/**
+ * libads1256pyramid.c - Min/max/mean summary pyramid of a ADS125x capture
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "libads1256.h"
+#include "libads1256pyramid.h"
+
+#define PYR_SPAN0                   (1U << ADS125x_PYR_BASE_SHIFT)
+// Samples converted at a time by ads125xPyrPushRaw()
+#define PYR_RAW_CHUNK               1024
+// Entries or samples read at a time by ads125xPyrQuery()
+#define PYR_READ_CHUNK              4096
+#define PYR_FILE_BUF                65536
+// Entries per pixel at least, an entry crossing a pixel border blurs it
+#define PYR_PIXEL_ENTRIES           4
+
+struct ads125x_pyr_struct
+{
+    char *dir;
+    FILE *fp[ADS125x_PYR_MAX_LEVELS];
+    // Level 0 entry being summed
+    ads125x_pyr_entry acc;
+    uint32_t acc_n;
+    // A finished entry of level k waiting for its pair to make one of k + 1
+    ads125x_pyr_entry pend[ADS125x_PYR_MAX_LEVELS];
+    uint8_t has_pend[ADS125x_PYR_MAX_LEVELS];
+    uint64_t samples;
+    int err;
+};
+
+struct ads125x_pyr_view_struct
+{
+    int levels;
+    int fd[ADS125x_PYR_MAX_LEVELS];
+    uint64_t entries[ADS125x_PYR_MAX_LEVELS];
+    uint64_t samples;
+    // The capture itself when it is binary, for zooms finer than level 0
+    int raw_fd;
+};
+
+static void pyr_combine(ads125x_pyr_entry *a, const ads125x_pyr_entry *b)
+{
+    if (b->min < a->min)
+        a->min = b->min;
+    if (b->max > a->max)
+        a->max = b->max;
+    a->sum += b->sum;
+}
+
+static char *pyr_level_path(const char *dir, int k)
+{
+    size_t len = strlen(dir) + 16;
+    char *path = (char *)malloc(len);
+
+    if (path)
+        snprintf(path, len, "%s/level%02d", dir, k);
+    return path;
+}
+
+static FILE *pyr_level_create(ads125x_pyr *p, int k)
+{
+    ads125x_pyr_header hdr;
+    char *path;
+    FILE *fp;
+
+    if ((path = pyr_level_path(p->dir, k)) == NULL)
+        return NULL;
+    fp = fopen(path, "w+b");
+    free(path);
+    if (fp == NULL)
+    {
+        FailurePrint("Pyramid: create level %d error: %s\n", k, strerror(errno));
+        return NULL;
+    }
+    setvbuf(fp, NULL, _IOFBF, PYR_FILE_BUF);
+    memset(&hdr, 0x00, sizeof(hdr));
+    memcpy(hdr.magic, ADS125x_PYR_MAGIC, sizeof(ADS125x_PYR_MAGIC));
+    hdr.shift = ADS125x_PYR_BASE_SHIFT + k;
+    hdr.entry_size = sizeof(ads125x_pyr_entry);
+    fwrite(&hdr, sizeof(hdr), 1, fp);
+    return fp;
+}
+
+/**
+ * pyr_emit - Store a finished entry of level k and carry it up
+ */
+static void pyr_emit(ads125x_pyr *p, int k, ads125x_pyr_entry e)
+{
+    for (; k < ADS125x_PYR_MAX_LEVELS; ++k)
+    {
+        if (!p->fp[k] && (p->fp[k] = pyr_level_create(p, k)) == NULL)
+        {
+            p->err = ADS125x_ERR_IO;
+            return;
+        }
+        if (fwrite(&e, sizeof(e), 1, p->fp[k]) != 1)
+            p->err = ADS125x_ERR_IO;
+        if (!p->has_pend[k])
+        {
+            p->pend[k] = e;
+            p->has_pend[k] = 1;
+            return;
+        }
+        pyr_combine(&e, &p->pend[k]);
+        p->has_pend[k] = 0;
+    }
+}
+
+/**
+ * ads125xPyrCreate - Start the pyramid of a capture
+ * @capture: Path of the capture, the pyramid goes to "<capture>.pyr".
+ *
+ * @return: The pyramid builder, or NULL on failure.
+ */
+ads125x_pyr *ads125xPyrCreate(const char *capture)
+{
+    ads125x_pyr *p;
+    size_t len = strlen(capture) + sizeof(ADS125x_PYR_SUFFIX);
+
+    if ((p = (ads125x_pyr *)calloc(1, sizeof(*p))) == NULL)
+        return NULL;
+    if ((p->dir = (char *)malloc(len)) == NULL)
+    {
+        free(p);
+        return NULL;
+    }
+    snprintf(p->dir, len, "%s%s", capture, ADS125x_PYR_SUFFIX);
+    if (mkdir(p->dir, 0755) < 0 && errno != EEXIST)
+    {
+        FailurePrint("Pyramid: create %s error: %s\n", p->dir, strerror(errno));
+        free(p->dir);
+        free(p);
+        return NULL;
+    }
+    p->acc.min = INT32_MAX;
+    p->acc.max = INT32_MIN;
+    return p;
+}
+
+/**
+ * ads125xPyrPush - Add samples to the pyramid
+ * @p: The pyramid builder.
+ * @codes: Signed conversion results.
+ * @n: Number of samples.
+ *
+ * Costs O(1) per sample, the per-entry loop has no branches and
+ * vectorizes.
+ *
+ * @return: ADS125x_OK, or ADS125x_ERR_IO once a level failed to write.
+ */
+int ads125xPyrPush(ads125x_pyr *p, const int32_t *codes, size_t n)
+{
+    int32_t mn, mx;
+    int64_t sum;
+    size_t i, m;
+
+    while (n)
+    {
+        m = PYR_SPAN0 - p->acc_n;
+        if (m > n)
+            m = n;
+        mn = p->acc.min;
+        mx = p->acc.max;
+        sum = 0;
+        for (i = 0; i < m; ++i)
+        {
+            mn = codes[i] < mn ? codes[i] : mn;
+            mx = codes[i] > mx ? codes[i] : mx;
+            sum += codes[i];
+        }
+        p->acc.min = mn;
+        p->acc.max = mx;
+        p->acc.sum += sum;
+        p->acc_n += m;
+        p->samples += m;
+        codes += m;
+        n -= m;
+        if (p->acc_n == PYR_SPAN0)
+        {
+            pyr_emit(p, 0, p->acc);
+            p->acc.min = INT32_MAX;
+            p->acc.max = INT32_MIN;
+            p->acc.sum = 0;
+            p->acc_n = 0;
+        }
+    }
+    return p->err;
+}
+
+/**
+ * ads125xPyrPushRaw - Add samples as read by ads125xRDATACRead()
+ * @p: The pyramid builder.
+ * @raw: 3 byte samples, MSB first.
+ * @n: Number of samples.
+ *
+ * @return: See ads125xPyrPush().
+ */
+int ads125xPyrPushRaw(ads125x_pyr *p, const uint8_t *raw, size_t n)
+{
+    int32_t codes[PYR_RAW_CHUNK];
+    size_t i, m;
+    int ret = ADS125x_OK;
+
+    while (n)
+    {
+        m = n < PYR_RAW_CHUNK ? n : PYR_RAW_CHUNK;
+        for (i = 0; i < m; ++i, raw += 3)
+            codes[i] = (int32_t)((uint32_t)raw[0] << 24 | (uint32_t)raw[1] << 16 | (uint32_t)raw[2] << 8) >> 8;
+        ret = ads125xPyrPush(p, codes, m);
+        n -= m;
+    }
+    return ret;
+}
+
+/**
+ * ads125xPyrClose - Finish and close the pyramid
+ * @p: The pyramid builder.
+ *
+ * Writes the partial last entry of each level, up to a top level of a
+ * single entry, and the sample count into every level header.
+ *
+ * @return: ADS125x_OK, or ADS125x_ERR_IO if a level failed to write.
+ */
+int ads125xPyrClose(ads125x_pyr *p)
+{
+    ads125x_pyr_entry tail;
+    int k, has_tail = p->acc_n > 0, ret;
+
+    tail = p->acc;
+    // Level k is left with its pending entry and the tail of level k - 1
+    for (k = 0; k < ADS125x_PYR_MAX_LEVELS; ++k)
+    {
+        if (k > 0 && p->has_pend[k - 1])
+        {
+            if (has_tail)
+                pyr_combine(&tail, &p->pend[k - 1]);
+            else
+                tail = p->pend[k - 1];
+            has_tail = 1;
+        }
+        if (k > 0 && p->samples <= (uint64_t)PYR_SPAN0 << (k - 1))
+            break;
+        if (!has_tail)
+            continue;
+        if (!p->fp[k] && (p->fp[k] = pyr_level_create(p, k)) == NULL)
+        {
+            p->err = ADS125x_ERR_IO;
+            break;
+        }
+        if (fwrite(&tail, sizeof(tail), 1, p->fp[k]) != 1)
+            p->err = ADS125x_ERR_IO;
+    }
+
+    for (k = 0; k < ADS125x_PYR_MAX_LEVELS; ++k)
+    {
+        if (!p->fp[k])
+            continue;
+        if (fflush(p->fp[k]) != 0 ||
+            pwrite(fileno(p->fp[k]), &p->samples, sizeof(p->samples), offsetof(ads125x_pyr_header, samples)) != sizeof(p->samples))
+            p->err = ADS125x_ERR_IO;
+        if (fclose(p->fp[k]) != 0)
+            p->err = ADS125x_ERR_IO;
+    }
+    ret = p->err;
+    free(p->dir);
+    free(p);
+    return ret;
+}
+
+/**
+ * ads125xPyrOpen - Open the pyramid of a capture for queries
+ * @capture: Path of the capture.
+ *
+ * A pyramid still being built can be opened, it then covers the samples
+ * of its finished level 0 entries.
+ *
+ * @return: The view, or NULL if there is no valid pyramid.
+ */
+ads125x_pyr_view *ads125xPyrOpen(const char *capture)
+{
+    ads125x_pyr_view *v;
+    ads125x_pyr_header hdr;
+    size_t len = strlen(capture) + sizeof(ADS125x_PYR_SUFFIX);
+    char *dir, *path;
+    struct stat st;
+    int k, fd;
+
+    if ((v = (ads125x_pyr_view *)calloc(1, sizeof(*v))) == NULL)
+        return NULL;
+    if ((dir = (char *)malloc(len)) == NULL)
+    {
+        free(v);
+        return NULL;
+    }
+    snprintf(dir, len, "%s%s", capture, ADS125x_PYR_SUFFIX);
+    for (k = 0; k < ADS125x_PYR_MAX_LEVELS; ++k)
+    {
+        if ((path = pyr_level_path(dir, k)) == NULL)
+            break;
+        fd = open(path, O_RDONLY | O_CLOEXEC);
+        free(path);
+        if (fd < 0)
+            break;
+        if (pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) || memcmp(hdr.magic, ADS125x_PYR_MAGIC, sizeof(ADS125x_PYR_MAGIC)) ||
+            hdr.shift != (uint32_t)(ADS125x_PYR_BASE_SHIFT + k) || hdr.entry_size != sizeof(ads125x_pyr_entry) ||
+            fstat(fd, &st) < 0)
+        {
+            close(fd);
+            break;
+        }
+        v->fd[k] = fd;
+        v->entries[k] = (st.st_size - sizeof(hdr)) / sizeof(ads125x_pyr_entry);
+        if (k == 0)
+            v->samples = hdr.samples ? hdr.samples : v->entries[0] << ADS125x_PYR_BASE_SHIFT;
+        v->levels++;
+    }
+    free(dir);
+    if (v->levels == 0)
+    {
+        free(v);
+        return NULL;
+    }
+    // A CSV capture has no fixed sample size, zooms below level 0 use level 0
+    len = strlen(capture);
+    v->raw_fd = len > 4 && strcasecmp(capture + len - 4, ".csv") == 0 ? -1 : open(capture, O_RDONLY | O_CLOEXEC);
+    return v;
+}
+
+/**
+ * ads125xPyrSamples - Number of samples covered by a pyramid
+ * @v: The view.
+ */
+uint64_t ads125xPyrSamples(ads125x_pyr_view *v)
+{
+    return v->samples;
+}
+
+static void pyr_point_init(ads125x_pyr_point *out, int pixels)
+{
+    int i;
+
+    for (i = 0; i < pixels; ++i)
+    {
+        out[i].min = INT32_MAX;
+        out[i].max = INT32_MIN;
+        out[i].mean = 0;
+        out[i].count = 0;
+    }
+}
+
+static int pyr_query_raw(ads125x_pyr_view *v, uint64_t first, uint64_t count, ads125x_pyr_point *out, int pixels)
+{
+    uint8_t buf[PYR_READ_CHUNK * 3];
+    uint64_t i, m, done;
+    ads125x_pyr_point *pt;
+    int32_t code;
+    ssize_t got;
+
+    for (done = 0; done < count; done += m)
+    {
+        m = count - done < PYR_READ_CHUNK ? count - done : PYR_READ_CHUNK;
+        got = pread(v->raw_fd, buf, m * 3, (first + done) * 3);
+        if (got < (ssize_t)(m * 3))
+            return FailurePrint("Pyramid: read capture error: %s\n", got < 0 ? strerror(errno) : "short read");
+        for (i = 0; i < m; ++i)
+        {
+            code = (int32_t)((uint32_t)buf[3 * i] << 24 | (uint32_t)buf[3 * i + 1] << 16 | (uint32_t)buf[3 * i + 2] << 8) >> 8;
+            pt = out + (done + i) * pixels / count;
+            pt->min = code < pt->min ? code : pt->min;
+            pt->max = code > pt->max ? code : pt->max;
+            pt->mean += code;
+            pt->count++;
+        }
+    }
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xPyrQuery - Summarize a range of the capture into pixels
+ * @v: The view.
+ * @first: First sample of the range.
+ * @count: Samples in the range.
+ * @out: Used to store the pixels, give pixels space.
+ * @pixels: Number of pixels, at most count.
+ *
+ * Reads the coarsest level with PYR_PIXEL_ENTRIES entries per pixel, so
+ * at most 2 * PYR_PIXEL_ENTRIES * pixels + 2 entries. An entry crossing a
+ * pixel border goes to the pixel it starts in. Finer than level 0 the
+ * samples are read from a binary capture.
+ *
+ * @return: ADS125x_OK, ADS125x_ERR_INVAL, or ADS125x_ERR_IO.
+ */
+int ads125xPyrQuery(ads125x_pyr_view *v, uint64_t first, uint64_t count, ads125x_pyr_point *out, int pixels)
+{
+    ads125x_pyr_entry buf[PYR_READ_CHUNK];
+    uint64_t per, e, e0, e1, m, i, start, span, n;
+    ads125x_pyr_point *pt;
+    ssize_t got;
+    int k;
+
+    if (pixels <= 0 || count < (uint64_t)pixels || first + count > v->samples)
+        return ADS125x_ERR_INVAL;
+    pyr_point_init(out, pixels);
+    per = count / pixels / PYR_PIXEL_ENTRIES;
+    if (per < PYR_SPAN0 && v->raw_fd >= 0)
+    {
+        if ((k = pyr_query_raw(v, first, count, out, pixels)) < 0)
+            return k;
+        goto done;
+    }
+    for (k = 0; k + 1 < v->levels && ((uint64_t)PYR_SPAN0 << (k + 1)) <= per; ++k)
+        ;
+    span = (uint64_t)PYR_SPAN0 << k;
+    e0 = first / span;
+    e1 = (first + count - 1) / span + 1;
+    if (e1 > v->entries[k])
+        e1 = v->entries[k];
+    for (e = e0; e < e1; e += m)
+    {
+        m = e1 - e < PYR_READ_CHUNK ? e1 - e : PYR_READ_CHUNK;
+        got = pread(v->fd[k], buf, m * sizeof(*buf), sizeof(ads125x_pyr_header) + e * sizeof(*buf));
+        if (got < (ssize_t)(m * sizeof(*buf)))
+            return FailurePrint("Pyramid: read level %d error: %s\n", k, got < 0 ? strerror(errno) : "short read");
+        for (i = 0; i < m; ++i)
+        {
+            start = (e + i) * span;
+            n = v->samples - start < span ? v->samples - start : span;
+            pt = out + (start > first ? (start - first) * pixels / count : 0);
+            pt->min = buf[i].min < pt->min ? buf[i].min : pt->min;
+            pt->max = buf[i].max > pt->max ? buf[i].max : pt->max;
+            pt->mean += buf[i].sum;
+            pt->count += n;
+        }
+    }
+done:
+    for (k = 0; k < pixels; ++k)
+        if (out[k].count)
+            out[k].mean /= out[k].count;
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xPyrViewClose - Close a pyramid view
+ * @v: The view.
+ */
+void ads125xPyrViewClose(ads125x_pyr_view *v)
+{
+    int k;
+
+    for (k = 0; k < v->levels; ++k)
+        close(v->fd[k]);
+    if (v->raw_fd >= 0)
+        close(v->raw_fd);
+    free(v);
+    return;
+}
@@ -0,0 +1,108 @@
+/**
+ * libads1256pyramid.h - Min/max/mean summary pyramid of a ADS125x capture
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256PYRAMID_H
+#define LIBADS1256PYRAMID_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A pyramid summarizes a capture at power-of-two decimations, an entry of
+ * level k holds the min, max and sum of 2^(ADS125x_PYR_BASE_SHIFT + k)
+ * samples. It is built while the capture is recorded and stored next to
+ * it, in the directory "<capture>.pyr", one append-only file per level:
+ *
+ *  levelNN:    ads125x_pyr_header, then ads125x_pyr_entry[].
+ *
+ * Any range of the capture at any zoom is then read from the level whose
+ * entries are just finer than the pixels, O(pixels) entries, instead of
+ * from the samples. The storage is about 1/6 of a 3 byte capture.
+ */
+#define ADS125x_PYR_BASE_SHIFT      6       // 64 samples per level 0 entry
+#define ADS125x_PYR_MAX_LEVELS      32
+#define ADS125x_PYR_MAGIC           "ADSPYR1"
+#define ADS125x_PYR_SUFFIX          ".pyr"
+
+typedef struct ads125x_pyr_entry_struct
+{
+    int32_t min;
+    int32_t max;
+    int64_t sum;
+} ads125x_pyr_entry;
+
+/**
+ * @samples: Samples in the capture, written when the pyramid is closed,
+ *           0 while it is being built. The last entry of a level may then
+ *           hold fewer samples than its span.
+ */
+typedef struct ads125x_pyr_header_struct
+{
+    char magic[8];
+    uint32_t shift;         // log2 of the samples per entry
+    uint32_t entry_size;
+    uint64_t samples;
+    uint64_t reserved;
+} ads125x_pyr_header;
+
+// One pixel of a query
+typedef struct ads125x_pyr_point_struct
+{
+    int32_t min;
+    int32_t max;
+    double mean;
+    uint64_t count;         // Samples in the pixel
+} ads125x_pyr_point;
+
+typedef struct ads125x_pyr_struct ads125x_pyr;
+typedef struct ads125x_pyr_view_struct ads125x_pyr_view;
+
+ads125x_pyr *ads125xPyrCreate(const char *capture);
+int ads125xPyrPush(ads125x_pyr *p, const int32_t *codes, size_t n);
+int ads125xPyrPushRaw(ads125x_pyr *p, const uint8_t *raw, size_t n);
+int ads125xPyrClose(ads125x_pyr *p);
+
+ads125x_pyr_view *ads125xPyrOpen(const char *capture);
+uint64_t ads125xPyrSamples(ads125x_pyr_view *v);
+int ads125xPyrQuery(ads125x_pyr_view *v, uint64_t first, uint64_t count, ads125x_pyr_point *out, int pixels);
+void ads125xPyrViewClose(ads125x_pyr_view *v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
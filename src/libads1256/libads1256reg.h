@@ -31,6 +31,9 @@
  *  Datasheet: https://www.ti.com/lit/gpn/ads1256
  */
 
+#ifndef LIBADS1256REG_H
+#define LIBADS1256REG_H
+
 // DEFAULT CONFIG
 
 // Register address
@@ -147,3 +150,5 @@
 #define ADS125x_CMD_SYNC                    0xFC
 #define ADS125x_CMD_STANDBY                 0xFD
 #define ADS125x_CMD_RESET                   0xFE
+
+#endif
@@ -0,0 +1,759 @@
+/**
+ * libads1256replay.c - Replay backend for the ADS1255/ADS1256 driver library
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include <linux/spi/spidev.h>
+
+#include "libads1256reg.h"
+#include "libads1256.h"
+#include "libads1256replay.h"
+
+#define ADS125x_REPLAY_LINE_LEN     128
+
+// Command parser state, reset when CS is released at the end of a message.
+#define REPLAY_PARSE_IDLE           0
+#define REPLAY_PARSE_WREG_N         1
+#define REPLAY_PARSE_WREG_DATA      2
+#define REPLAY_PARSE_RREG_N         3
+
+extern int ADS125xDriverDebug;
+
+typedef struct ads125x_replay_struct
+{
+    uint8_t *samples;
+    size_t count;
+    int flags;
+
+    uint8_t regs[ADS125x_REG_NUM];
+    int parse;
+    uint8_t addr;
+    int left;
+
+    // Data shifted out on DOUT
+    uint8_t out[ADS125x_REG_NUM];
+    int out_len;
+    int out_pos;
+
+    // Next sample for RDATA, and the RDATAC window
+    size_t pos;
+    int rdatac;
+    double sps;
+    uint64_t epoch_ns;
+    uint64_t served;
+    uint64_t dropped;
+    // Outside RDATAC the chip converts from WAKEUP to STANDBY, the first
+    // conversion ends at ready_ns, 0 is not converting, the next ones a
+    // DRATE period apart. conv_read is the last one read by RDATA.
+    uint64_t ready_ns;
+    double conv_period_ns;
+    int64_t conv_read;
+    // MUX of that conversion, and of the one in the output register
+    uint8_t conv_mux;
+    uint8_t data_mux;
+    // Emulated input offset, see ads125xReplaySetOffset()
+    int32_t offset;
+    double drift_per_s;
+    uint64_t offset_epoch_ns;
+    // DRDY event fd, a timerfd expiring at the next conversion
+    int event_fd;
+    // PDWN is low, see replay_set_pdwn()
+    int powered_down;
+
+    // Injected fault, armed once `fault_after` RDATAC reads are done
+    int fault;
+    uint64_t fault_after;
+    int fault_left;
+    uint64_t reads;
+} ads125x_replay;
+
+static const uint8_t replay_reg_default[ADS125x_REG_NUM] = {
+    0x30, 0x01, 0x20, 0xF0, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40,
+};
+
+static uint64_t replay_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * replay_latest - Number of the latest finished conversion since RDATAC
+ *
+ * Conversions are numbered from 1, conversion k is the sample pos + k - 1
+ * of the capture. In paced mode conversion k finishes k DRATE periods
+ * after RDATAC, a conversion which is not read before the next one is
+ * overwritten, as on the chip.
+ */
+static uint64_t replay_latest(ads125x_replay *rp)
+{
+    uint64_t done, avail;
+
+    if (rp->flags & ADS125x_REPLAY_FAST)
+        done = rp->served + 1;
+    else
+        done = (uint64_t)((double)(replay_now_ns() - rp->epoch_ns) * 1e-9 * rp->sps);
+
+    if (!(rp->flags & ADS125x_REPLAY_LOOP))
+    {
+        avail = rp->count - rp->pos;
+        if (done > avail)
+            done = avail;
+    }
+    return done;
+}
+
+/**
+ * replay_conv_done - Latest finished conversion outside RDATAC, -1 is none
+ */
+static int64_t replay_conv_done(ads125x_replay *rp)
+{
+    uint64_t now = replay_now_ns();
+
+    if (!rp->ready_ns || now < rp->ready_ns)
+        return -1;
+    return (int64_t)((now - rp->ready_ns) / rp->conv_period_ns);
+}
+
+/**
+ * replay_shift_sample - Put a conversion of the capture into the output register
+ * @mux: MUX the conversion was taken with.
+ *
+ * The capture is the input seen with PSEL below NSEL, swapped inputs
+ * see it negated. The emulated offset adds to both.
+ */
+static void replay_shift_sample(ads125x_replay *rp, size_t idx, uint8_t mux)
+{
+    const uint8_t *sample = rp->samples + (idx % rp->count) * ADS125x_DATA_LEN_BYTE;
+    double v;
+
+    rp->out_len = ADS125x_DATA_LEN_BYTE;
+    rp->out_pos = 0;
+    if ((mux >> 4) <= (mux & 0x0F) && !rp->offset && rp->drift_per_s == 0)
+    {
+        memcpy(rp->out, sample, ADS125x_DATA_LEN_BYTE);
+        return;
+    }
+    v = convert_to_signed_24bit(sample);
+    if ((mux >> 4) > (mux & 0x0F))
+        v = -v;
+    v += rp->offset + rp->drift_per_s * (double)(replay_now_ns() - rp->offset_epoch_ns) * 1e-9;
+    if (v > 0x7FFFFF)
+        v = 0x7FFFFF;
+    if (v < -0x800000)
+        v = -0x800000;
+    rp->out[0] = ((int32_t)v >> 16) & 0xFF;
+    rp->out[1] = ((int32_t)v >> 8) & 0xFF;
+    rp->out[2] = (int32_t)v & 0xFF;
+}
+
+/**
+ * replay_latch - Latch the latest RDATAC conversion into the output register
+ */
+static void replay_latch(ads125x_replay *rp)
+{
+    uint64_t latest = replay_latest(rp);
+
+    if (latest > rp->served)
+    {
+        rp->dropped += latest - rp->served - 1;
+        rp->served = latest;
+    }
+    if (rp->served == 0)
+    {
+        memset(rp->out, 0x00, ADS125x_DATA_LEN_BYTE);
+        rp->out_len = ADS125x_DATA_LEN_BYTE;
+        rp->out_pos = 0;
+        return;
+    }
+    replay_shift_sample(rp, rp->pos + rp->served - 1, rp->regs[ADS125x_REG_ADDR_MUX]);
+}
+
+static void replay_rdatac_stop(ads125x_replay *rp)
+{
+    uint64_t latest;
+
+    // A paced chip kept converting, the conversions not read are gone
+    if (!(rp->flags & ADS125x_REPLAY_FAST) && (latest = replay_latest(rp)) > rp->served)
+        rp->served = latest;
+    rp->pos += rp->served;
+    if (rp->flags & ADS125x_REPLAY_LOOP)
+        rp->pos %= rp->count;
+    // Exhausted, the next RDATAC is still held at the last sample
+    else if (rp->pos >= rp->count)
+        rp->pos = rp->count - 1;
+    rp->rdatac = 0;
+}
+
+static void replay_command(ads125x_replay *rp, uint8_t b)
+{
+    double settle, sps;
+    int64_t done;
+    int i;
+
+    switch (rp->parse)
+    {
+    case REPLAY_PARSE_WREG_N:
+        rp->left = (b & 0x0F) + 1;
+        rp->parse = REPLAY_PARSE_WREG_DATA;
+        return;
+    case REPLAY_PARSE_WREG_DATA:
+        if (rp->addr < ADS125x_REG_NUM)
+            rp->regs[rp->addr++] = b;
+        if (--rp->left == 0)
+            rp->parse = REPLAY_PARSE_IDLE;
+        return;
+    case REPLAY_PARSE_RREG_N:
+        rp->out_len = 0;
+        rp->out_pos = 0;
+        for (i = 0; i <= (b & 0x0F) && rp->addr + i < ADS125x_REG_NUM; ++i)
+            rp->out[rp->out_len++] = rp->regs[rp->addr + i];
+        rp->parse = REPLAY_PARSE_IDLE;
+        return;
+    default:
+        break;
+    }
+
+    if ((b & 0xF0) == ADS125x_CMD_WREG)
+    {
+        rp->addr = b & 0x0F;
+        rp->parse = REPLAY_PARSE_WREG_N;
+        return;
+    }
+    if ((b & 0xF0) == ADS125x_CMD_RREG)
+    {
+        rp->addr = b & 0x0F;
+        rp->parse = REPLAY_PARSE_RREG_N;
+        return;
+    }
+
+    switch (b)
+    {
+    case ADS125x_CMD_RDATA:
+        // RDATA reads the last finished conversion, not the one WAKEUP started
+        if ((done = replay_conv_done(rp)) >= 0)
+        {
+            rp->data_mux = rp->conv_mux;
+            rp->conv_read = done;
+        }
+        replay_shift_sample(rp, rp->pos, rp->data_mux);
+        if (rp->pos + 1 < rp->count || (rp->flags & ADS125x_REPLAY_LOOP))
+            rp->pos = (rp->pos + 1) % rp->count;
+        break;
+    case ADS125x_CMD_RDATAC:
+        rp->rdatac = 1;
+        rp->sps = ads125xDRATEToSPS(rp->regs[ADS125x_REG_ADDR_DRATE]);
+        if (rp->sps == 0)
+            rp->sps = 30000;
+        rp->epoch_ns = replay_now_ns();
+        rp->served = 0;
+        rp->ready_ns = 0;
+        break;
+    case ADS125x_CMD_SDATAC:
+        if (rp->rdatac)
+            replay_rdatac_stop(rp);
+        break;
+    case ADS125x_CMD_RESET:
+        if (rp->rdatac)
+            replay_rdatac_stop(rp);
+        memcpy(rp->regs, replay_reg_default, sizeof(rp->regs));
+        rp->conv_mux = rp->data_mux = rp->regs[ADS125x_REG_ADDR_MUX];
+        rp->ready_ns = 0;
+        if (rp->fault == ADS125x_FAULT_DRDY_STUCK && rp->reads >= rp->fault_after)
+            rp->fault = ADS125x_FAULT_NONE;
+        break;
+    case ADS125x_CMD_WAKEUP:
+        // A conversion started by SYNC and WAKEUP takes the settling time
+        if (!rp->rdatac)
+        {
+            rp->data_mux = rp->conv_mux;
+            rp->conv_mux = rp->regs[ADS125x_REG_ADDR_MUX];
+        }
+        if (!rp->rdatac && !(rp->flags & ADS125x_REPLAY_FAST))
+        {
+            settle = ads125xDRATEToSettleUs(rp->regs[ADS125x_REG_ADDR_DRATE]);
+            sps = ads125xDRATEToSPS(rp->regs[ADS125x_REG_ADDR_DRATE]);
+            rp->ready_ns = replay_now_ns() + (uint64_t)((settle ? settle : 210) * 1000);
+            rp->conv_period_ns = 1e9 / (sps ? sps : 30000);
+            rp->conv_read = -1;
+        }
+        break;
+    case ADS125x_CMD_STANDBY:
+        rp->ready_ns = 0;
+        break;
+    default:
+        // SYNC and the calibrations have nothing to emulate
+        break;
+    }
+}
+
+static int replay_transfer(ads125x_dev *dev, struct spi_ioc_transfer *xfer, int n)
+{
+    ads125x_replay *rp = (ads125x_replay *)dev->backend_data;
+    const uint8_t *tx;
+    uint8_t *rx;
+    uint32_t i;
+    int k;
+
+    if (rp->fault == ADS125x_FAULT_XFER && rp->reads >= rp->fault_after)
+    {
+        if (--rp->fault_left <= 0)
+            rp->fault = ADS125x_FAULT_NONE;
+        errno = EIO;
+        return -1;
+    }
+    // A powered down chip shifts out nothing and ignores the commands
+    if (rp->powered_down)
+    {
+        for (k = 0; k < n; ++k)
+            if (xfer[k].rx_buf)
+                memset((uint8_t *)(uintptr_t)xfer[k].rx_buf, 0x00, xfer[k].len);
+        return 0;
+    }
+
+    for (k = 0; k < n; ++k)
+    {
+        tx = (const uint8_t *)(uintptr_t)xfer[k].tx_buf;
+        rx = (uint8_t *)(uintptr_t)xfer[k].rx_buf;
+
+        // A read without command in RDATAC mode shifts out the latest conversion
+        if (!tx && rp->rdatac && rp->out_pos >= rp->out_len)
+        {
+            replay_latch(rp);
+            rp->reads++;
+        }
+
+        for (i = 0; i < xfer[k].len; ++i)
+        {
+            uint8_t out = 0;
+
+            if (rp->out_pos < rp->out_len)
+                out = rp->out[rp->out_pos++];
+            else if (tx)
+                replay_command(rp, tx[i]);
+            if (rx)
+                rx[i] = out;
+        }
+    }
+
+    // CS goes high at the end of the message and resets the serial interface
+    rp->parse = REPLAY_PARSE_IDLE;
+    rp->out_len = 0;
+    rp->out_pos = 0;
+    return 0;
+}
+
+static int replay_get_drdy(ads125x_dev *dev)
+{
+    ads125x_replay *rp = (ads125x_replay *)dev->backend_data;
+
+    if ((rp->fault == ADS125x_FAULT_DRDY_STUCK && rp->reads >= rp->fault_after) || rp->powered_down)
+        return 1;
+    // Not converting is ready, a conversion is ready until RDATA reads it
+    if (!rp->rdatac)
+        return !rp->ready_ns || replay_conv_done(rp) > rp->conv_read ? 0 : 1;
+    // The chip keeps converting at the end of the capture, the last sample repeats
+    if (!(rp->flags & ADS125x_REPLAY_LOOP) && rp->served >= rp->count - rp->pos)
+        return 0;
+    return replay_latest(rp) > rp->served ? 0 : 1;
+}
+
+/**
+ * replay_drdy_time - When the conversion behind the current DRDY low finished
+ */
+static uint64_t replay_drdy_time(ads125x_dev *dev)
+{
+    ads125x_replay *rp = (ads125x_replay *)dev->backend_data;
+    int64_t done;
+
+    if (rp->flags & ADS125x_REPLAY_FAST)
+        return 0;
+    if (!rp->rdatac)
+    {
+        done = replay_conv_done(rp);
+        return done < 0 ? rp->ready_ns : rp->ready_ns + (uint64_t)(done * rp->conv_period_ns);
+    }
+    return rp->epoch_ns + (uint64_t)(replay_latest(rp) * 1e9 / rp->sps);
+}
+
+static int replay_event_fd(ads125x_dev *dev)
+{
+    ads125x_replay *rp = (ads125x_replay *)dev->backend_data;
+
+    if (rp->event_fd < 0 && (rp->event_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) < 0)
+        return FailurePrint("Replay: create timerfd error: %s\n", strerror(errno));
+    return rp->event_fd;
+}
+
+/**
+ * replay_event_arm - Set the timerfd to the time DRDY goes low
+ */
+static int replay_event_arm(ads125x_dev *dev)
+{
+    ads125x_replay *rp = (ads125x_replay *)dev->backend_data;
+    struct itimerspec its;
+    uint64_t expire, count;
+
+    if (replay_event_fd(dev) < 0)
+        return ADS125x_ERR_IO;
+    while (read(rp->event_fd, &count, sizeof(count)) > 0)
+        ;
+    if ((rp->fault == ADS125x_FAULT_DRDY_STUCK && rp->reads >= rp->fault_after) || rp->powered_down)
+        expire = replay_now_ns() + 1000000000ULL;
+    else if (!replay_get_drdy(dev))
+        expire = 1;
+    else if (!rp->rdatac)
+        expire = rp->ready_ns + (uint64_t)((rp->conv_read + 1) * rp->conv_period_ns);
+    else
+        expire = rp->epoch_ns + (uint64_t)((rp->served + 1) * 1e9 / rp->sps);
+
+    // An absolute time in the past expires at once
+    memset(&its, 0x00, sizeof(its));
+    its.it_value.tv_sec = expire / 1000000000ULL;
+    its.it_value.tv_nsec = expire % 1000000000ULL;
+    if (timerfd_settime(rp->event_fd, TFD_TIMER_ABSTIME, &its, NULL) < 0)
+        return FailurePrint("Replay: set timerfd error: %s\n", strerror(errno));
+    return ADS125x_OK;
+}
+
+/**
+ * replay_set_pdwn - Power the emulated chip down or up
+ *
+ * Powering up resets the registers, like the chip the first conversion
+ * is ready after the oscillator start-up and a settling time.
+ */
+static int replay_set_pdwn(ads125x_dev *dev, int level)
+{
+    ads125x_replay *rp = (ads125x_replay *)dev->backend_data;
+
+    if (!level)
+    {
+        if (rp->rdatac)
+            replay_rdatac_stop(rp);
+        rp->powered_down = 1;
+        rp->ready_ns = 0;
+        return 0;
+    }
+    if (!rp->powered_down)
+        return 0;
+    rp->powered_down = 0;
+    memcpy(rp->regs, replay_reg_default, sizeof(rp->regs));
+    rp->conv_mux = rp->data_mux = rp->regs[ADS125x_REG_ADDR_MUX];
+    if (rp->fault == ADS125x_FAULT_DRDY_STUCK && rp->reads >= rp->fault_after)
+        rp->fault = ADS125x_FAULT_NONE;
+    if (rp->flags & ADS125x_REPLAY_FAST)
+        return 0;
+    rp->ready_ns = replay_now_ns() + (ADS125x_PDWN_WAKE_US + (uint64_t)ads125xDRATEToSettleUs(ADS125x_DR_30000)) * 1000;
+    rp->conv_period_ns = 1e9 / 30000;
+    rp->conv_read = -1;
+    return 0;
+}
+
+static void replay_release(ads125x_dev *dev)
+{
+    ads125x_replay *rp = (ads125x_replay *)dev->backend_data;
+
+    if (rp->event_fd >= 0)
+        close(rp->event_fd);
+    free(rp->samples);
+    free(rp);
+    dev->backend = NULL;
+    dev->backend_data = NULL;
+    return;
+}
+
+static const ads125x_backend ads125x_replay_backend = {
+    .name = "replay",
+    .transfer = replay_transfer,
+    .get_drdy = replay_get_drdy,
+    .drdy_time = replay_drdy_time,
+    .event_fd = replay_event_fd,
+    .event_arm = replay_event_arm,
+    .set_pdwn = replay_set_pdwn,
+    .release = replay_release,
+};
+
+/**
+ * replay_load_csv - Parse a CSV capture written by continu_read()
+ *
+ * @return: number of samples, the sample buffer is returned in @data.
+ */
+static size_t replay_load_csv(FILE *fp, uint8_t **data)
+{
+    char line[ADS125x_REPLAY_LINE_LEN];
+    size_t count = 0, cap = 0;
+    unsigned int code;
+    uint8_t *buf = NULL, *tmp;
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (sscanf(line, " %*d,%6x,", &code) != 1)
+            continue;
+        if (count == cap)
+        {
+            cap = cap ? cap * 2 : 4096;
+            if ((tmp = (uint8_t *)realloc(buf, cap * ADS125x_DATA_LEN_BYTE)) == NULL)
+            {
+                free(buf);
+                return 0;
+            }
+            buf = tmp;
+        }
+        buf[count * 3 + 0] = (code >> 16) & 0xFF;
+        buf[count * 3 + 1] = (code >> 8) & 0xFF;
+        buf[count * 3 + 2] = code & 0xFF;
+        ++count;
+    }
+    *data = buf;
+    return count;
+}
+
+/**
+ * replay_load_bin - Read a binary capture, 3 bytes per sample
+ *
+ * @return: number of samples, the sample buffer is returned in @data.
+ */
+static size_t replay_load_bin(FILE *fp, uint8_t **data)
+{
+    long size;
+    uint8_t *buf;
+
+    if (fseek(fp, 0, SEEK_END) < 0 || (size = ftell(fp)) < ADS125x_DATA_LEN_BYTE)
+        return 0;
+    rewind(fp);
+    if (size % ADS125x_DATA_LEN_BYTE)
+        fprintf(stderr, "Replay: ignore %ld trailing bytes of the capture.\n", size % ADS125x_DATA_LEN_BYTE);
+    size -= size % ADS125x_DATA_LEN_BYTE;
+    if ((buf = (uint8_t *)malloc(size)) == NULL)
+        return 0;
+    if (fread(buf, 1, size, fp) != (size_t)size)
+    {
+        free(buf);
+        return 0;
+    }
+    *data = buf;
+    return size / ADS125x_DATA_LEN_BYTE;
+}
+
+static void replay_attach(ads125x_dev *dev, ads125x_replay *rp, int flags)
+{
+    rp->flags = flags;
+    rp->event_fd = -1;
+    memcpy(rp->regs, replay_reg_default, sizeof(rp->regs));
+    rp->conv_mux = rp->data_mux = rp->regs[ADS125x_REG_ADDR_MUX];
+    rp->offset_epoch_ns = replay_now_ns();
+    dev->fd = -1;
+    dev->backend = &ads125x_replay_backend;
+    dev->backend_data = rp;
+    return;
+}
+
+/**
+ * ads125xReplayOpen - Attach a replay backend to a ADS125x device
+ * @dev: The ads125x dev info struct pointer.
+ * @path: The recorded capture file.
+ * @format: ADS125x_REPLAY_FMT_*.
+ * @flags: ADS125x_REPLAY_PACED or ADS125x_REPLAY_FAST, ORed with
+ *         ADS125x_REPLAY_LOOP.
+ *
+ * The device needs no SPI bus or GPIO after this call, release it with
+ * ads125xReplayClose().
+ *
+ * @return: 0 is open replay successful,
+ *          1 is open capture file error,
+ *          2 is empty or invalid capture,
+ *          3 is allocate memory failed.
+ */
+int ads125xReplayOpen(ads125x_dev *dev, const char *path, int format, int flags)
+{
+    FILE *fp;
+    size_t len;
+    ads125x_replay *rp;
+
+    if ((rp = (ads125x_replay *)calloc(1, sizeof(*rp))) == NULL)
+    {
+        fprintf(stderr, "Allocated memory for replay failed.\n");
+        return 3;
+    }
+    if ((fp = fopen(path, "rb")) == NULL)
+    {
+        fprintf(stderr, "Cannot open capture %s: %s\n", path, strerror(errno));
+        free(rp);
+        return 1;
+    }
+    if (format == ADS125x_REPLAY_FMT_AUTO)
+    {
+        len = strlen(path);
+        format = (len > 4 && strcasecmp(path + len - 4, ".csv") == 0) ? ADS125x_REPLAY_FMT_CSV : ADS125x_REPLAY_FMT_BIN;
+    }
+    if (format == ADS125x_REPLAY_FMT_CSV)
+        rp->count = replay_load_csv(fp, &rp->samples);
+    else
+        rp->count = replay_load_bin(fp, &rp->samples);
+    fclose(fp);
+
+    if (rp->count == 0)
+    {
+        fprintf(stderr, "Capture %s has no samples.\n", path);
+        free(rp->samples);
+        free(rp);
+        return 2;
+    }
+
+    replay_attach(dev, rp, flags);
+    if (ADS125xDriverDebug)
+        fprintf(stdout, "Open replay %s with %zu samples.\n", path, rp->count);
+    return 0;
+}
+
+/**
+ * ads125xReplayOpenBuffer - Attach a replay backend serving samples from memory
+ * @dev: The ads125x dev info struct pointer.
+ * @samples: @count raw samples, 3 bytes each, MSB first. They are copied.
+ * @count: Number of samples.
+ * @flags: See ads125xReplayOpen().
+ *
+ * @return: 0 is open replay successful,
+ *          2 is empty capture,
+ *          3 is allocate memory failed.
+ */
+int ads125xReplayOpenBuffer(ads125x_dev *dev, const uint8_t *samples, size_t count, int flags)
+{
+    ads125x_replay *rp;
+
+    if (count == 0)
+        return 2;
+    if ((rp = (ads125x_replay *)calloc(1, sizeof(*rp))) == NULL ||
+        (rp->samples = (uint8_t *)malloc(count * ADS125x_DATA_LEN_BYTE)) == NULL)
+    {
+        fprintf(stderr, "Allocated memory for replay failed.\n");
+        free(rp);
+        return 3;
+    }
+    memcpy(rp->samples, samples, count * ADS125x_DATA_LEN_BYTE);
+    rp->count = count;
+    replay_attach(dev, rp, flags);
+    return 0;
+}
+
+/**
+ * ads125xReplayClose - Release the replay backend of a ADS125x device
+ * @dev: The ads125x dev info struct pointer.
+ */
+void ads125xReplayClose(ads125x_dev *dev)
+{
+    if (dev->backend == &ads125x_replay_backend)
+        dev->backend->release(dev);
+    return;
+}
+
+/**
+ * ads125xReplayCount - Get the number of samples in the capture
+ * @dev: The ads125x dev info struct pointer.
+ */
+size_t ads125xReplayCount(ads125x_dev *dev)
+{
+    if (dev->backend != &ads125x_replay_backend)
+        return 0;
+    return ((ads125x_replay *)dev->backend_data)->count;
+}
+
+/**
+ * ads125xReplayDropped - Get the number of conversions overwritten before read
+ * @dev: The ads125x dev info struct pointer.
+ *
+ * Only paced replays drop conversions, like the chip when the reader
+ * misses a DRDY period.
+ */
+uint64_t ads125xReplayDropped(ads125x_dev *dev)
+{
+    if (dev->backend != &ads125x_replay_backend)
+        return 0;
+    return ((ads125x_replay *)dev->backend_data)->dropped;
+}
+
+/**
+ * ads125xReplayInjectFault - Make a replay device fail like a broken chip or bus
+ * @dev: The ads125x dev info struct pointer.
+ * @fault: ADS125x_FAULT_NONE, ADS125x_FAULT_XFER or ADS125x_FAULT_DRDY_STUCK.
+ * @after: The fault starts after this many RDATAC reads, 0 is now.
+ * @count: Number of failed transfers for ADS125x_FAULT_XFER.
+ *
+ * ADS125x_FAULT_XFER fails the next @count SPI messages with EIO.
+ * ADS125x_FAULT_DRDY_STUCK holds DRDY high until the next RESET.
+ *
+ * @return: 0 success, 1 is not a replay device or invalid fault.
+ */
+int ads125xReplayInjectFault(ads125x_dev *dev, int fault, uint64_t after, int count)
+{
+    ads125x_replay *rp;
+
+    if (dev->backend != &ads125x_replay_backend || fault < ADS125x_FAULT_NONE || fault > ADS125x_FAULT_DRDY_STUCK)
+        return 1;
+    rp = (ads125x_replay *)dev->backend_data;
+    rp->fault = fault;
+    rp->fault_after = rp->reads + after;
+    rp->fault_left = count > 0 ? count : 1;
+    return 0;
+}
+
+/**
+ * ads125xReplaySetOffset - Add an input offset to the replayed conversions
+ * @dev: The ads125x dev info struct pointer.
+ * @offset: Offset in codes.
+ * @drift_per_s: Change of the offset per second, in codes.
+ *
+ * The offset does not swap sign with the inputs, like the offset of the
+ * chip, so chopping cancels it.
+ *
+ * @return: 0 success, 1 is not a replay device.
+ */
+int ads125xReplaySetOffset(ads125x_dev *dev, int32_t offset, double drift_per_s)
+{
+    ads125x_replay *rp;
+
+    if (dev->backend != &ads125x_replay_backend)
+        return 1;
+    rp = (ads125x_replay *)dev->backend_data;
+    rp->offset = offset;
+    rp->drift_per_s = drift_per_s;
+    rp->offset_epoch_ns = replay_now_ns();
+    return 0;
+}
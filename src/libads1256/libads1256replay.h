@@ -0,0 +1,91 @@
+/**
+ * libads1256replay.h - Replay backend for the ADS1255/ADS1256 driver library
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256REPLAY_H
+#define LIBADS1256REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libads1256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The replay backend emulates an ADS125x at the command level and serves
+ * the conversions of a recorded capture. All the libads1256 calls work on
+ * a replay device, so ads125xRDATAC() and the ads125xRDATACStart/Read/Stop
+ * streaming calls return the recorded samples.
+ *
+ * Capture formats:
+ *  CSV: The output of `ads1256 -c <times> -o <file>`, one "index,raw,volt"
+ *       line per sample. Lines which are not samples are skipped.
+ *  BIN: The raw RDATAC buffer, 3 bytes per sample, MSB first.
+ */
+#define ADS125x_REPLAY_FMT_AUTO     0   // CSV if the file name ends with .csv
+#define ADS125x_REPLAY_FMT_CSV      1
+#define ADS125x_REPLAY_FMT_BIN      2
+
+// Replay flags
+#define ADS125x_REPLAY_PACED        0x00    // DRDY follows the programmed DRATE
+#define ADS125x_REPLAY_FAST         0x01    // DRDY is always ready, as fast as possible
+#define ADS125x_REPLAY_LOOP         0x02    // Restart from the first sample at the end
+
+/**
+ * Without ADS125x_REPLAY_LOOP the input is held at the last sample once the
+ * capture is exhausted, use ads125xReplayCount() to size the reads.
+ *
+ * The capture is the input seen with PSEL below NSEL in the MUX register,
+ * a MUX with the inputs the other way round sees it negated.
+ */
+
+// Faults for ads125xReplayInjectFault()
+#define ADS125x_FAULT_NONE          0
+#define ADS125x_FAULT_XFER          1       // SPI messages fail with EIO
+#define ADS125x_FAULT_DRDY_STUCK    2       // DRDY stays high until RESET
+
+int ads125xReplayOpen(ads125x_dev *dev, const char *path, int format, int flags);
+int ads125xReplayOpenBuffer(ads125x_dev *dev, const uint8_t *samples, size_t count, int flags);
+void ads125xReplayClose(ads125x_dev *dev);
+size_t ads125xReplayCount(ads125x_dev *dev);
+uint64_t ads125xReplayDropped(ads125x_dev *dev);
+int ads125xReplayInjectFault(ads125x_dev *dev, int fault, uint64_t after, int count);
+int ads125xReplaySetOffset(ads125x_dev *dev, int32_t offset, double drift_per_s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
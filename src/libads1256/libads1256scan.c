@@ -0,0 +1,427 @@
+/**
+ * libads1256scan.c - Multi-channel scan scheduling for ADS125x
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spi.h>
+#include <linux/spi/spidev.h>
+
+#include "libads1256reg.h"
+#include "libads1256scan.h"
+
+// MUX, ADCON and DRATE are the registers a slot sets, in this order
+#define SCAN_REGS                   3
+
+static const uint8_t scan_rates[] = {
+    ADS125x_DR_2_5, ADS125x_DR_5, ADS125x_DR_10, ADS125x_DR_15,
+    ADS125x_DR_25, ADS125x_DR_30, ADS125x_DR_50, ADS125x_DR_60,
+    ADS125x_DR_100, ADS125x_DR_500, ADS125x_DR_1000, ADS125x_DR_2000,
+    ADS125x_DR_3750, ADS125x_DR_7500, ADS125x_DR_15000, ADS125x_DR_30000,
+};
+
+/**
+ * ads125xScanInit - Start an empty scan
+ * @s: The scan.
+ */
+void ads125xScanInit(ads125x_scan *s)
+{
+    memset(s, 0x00, sizeof(*s));
+    return;
+}
+
+/**
+ * ads125xScanAdd - Add an input to a scan
+ * @s: The scan.
+ * @psel: Postive Input Channel (AIN_P) select.
+ * @nsel: Negative Input Channel (AIN_N) select.
+ * @pga: ADCON PGA bits, ADS125x_ADCON_PGA_*.
+ * @drate: Data rate, ADS125x_DR_*, 0 to let ads125xScanPlan() pick it.
+ * @rate_sps: Wanted samples per second.
+ * @priority: Higher keeps its rate when the chip is too slow for all.
+ *
+ * @return: The channel index in the scan samples, or ADS125x_ERR_INVAL.
+ */
+int ads125xScanAdd(ads125x_scan *s, uint8_t psel, uint8_t nsel, uint8_t pga, uint8_t drate, double rate_sps, int priority)
+{
+    ads125x_scan_channel *c;
+
+    if (s->nch >= ADS125x_SCAN_MAX_CHANNELS || rate_sps <= 0 || pga > ADS125x_ADCON_PGA_64 ||
+        (drate && ads125xDRATEToSPS(drate) == 0))
+        return ADS125x_ERR_INVAL;
+    c = &s->ch[s->nch];
+    memset(c, 0x00, sizeof(*c));
+    c->psel = psel;
+    c->nsel = nsel;
+    c->pga = pga;
+    c->drate = drate;
+    c->priority = priority;
+    c->rate_sps = rate_sps;
+    return s->nch++;
+}
+
+/**
+ * scan_cost - Length of a frame giving each channel rate * scale over frame_us
+ * @burst: Used to store the conversions per frame of each channel.
+ *
+ * @return: The frame length in us.
+ */
+static double scan_cost(const ads125x_scan *s, const double *scale, double frame_us, int *burst)
+{
+    double t = 0, want, period;
+    int i, active = 0;
+
+    for (i = 0; i < s->nch; ++i)
+    {
+        want = s->ch[i].rate_sps * scale[i] * frame_us * 1e-6;
+        burst[i] = want > 0 ? (int)ceil(want - 1e-9) : 0;
+        active += burst[i] > 0;
+    }
+    for (i = 0; i < s->nch; ++i)
+    {
+        if (!burst[i])
+            continue;
+        period = 1e6 / ads125xDRATEToSPS(s->ch[i].drate);
+        if (period < ADS125x_SCAN_SLOT_US)
+            period = ADS125x_SCAN_SLOT_US;
+        // A single input never switches, it converts continuously
+        if (active > 1)
+            t += ads125xDRATEToSettleUs(s->ch[i].drate) + ADS125x_SCAN_SLOT_US + (burst[i] - 1) * period;
+        else
+            t += burst[i] * period;
+    }
+    return t;
+}
+
+/**
+ * scan_frame - Shortest frame that fits the scaled rates
+ *
+ * @return: The frame length tried, or 0 if none up to ADS125x_SCAN_MAX_FRAME_US fits.
+ */
+static double scan_frame(const ads125x_scan *s, const double *scale, int *burst)
+{
+    double f;
+
+    for (f = ADS125x_SCAN_SLOT_US; f < ADS125x_SCAN_MAX_FRAME_US; f *= ADS125x_SCAN_FRAME_STEP)
+        if (scan_cost(s, scale, f, burst) <= f)
+            return f;
+    return scan_cost(s, scale, ADS125x_SCAN_MAX_FRAME_US, burst) <= ADS125x_SCAN_MAX_FRAME_US ? ADS125x_SCAN_MAX_FRAME_US : 0;
+}
+
+/**
+ * scan_writes - WREG bytes to switch from channel a to channel b
+ */
+static int scan_writes(const ads125x_scan *s, int a, int b)
+{
+    const ads125x_scan_channel *x = &s->ch[a], *y = &s->ch[b];
+    int first = SCAN_REGS, last = -1;
+
+    if ((x->psel | x->nsel) != (y->psel | y->nsel))
+        first = last = 0;
+    if (x->pga != y->pga)
+    {
+        first = first < 1 ? first : 1;
+        last = 1;
+    }
+    if (x->drate != y->drate)
+    {
+        first = first < 2 ? first : 2;
+        last = 2;
+    }
+    return last < 0 ? 0 : last - first + 1;
+}
+
+// Slots with the same DRATE and PGA next to each other
+static int scan_before(const ads125x_scan *s, int a, int b)
+{
+    const ads125x_scan_channel *x = &s->ch[a], *y = &s->ch[b];
+
+    if (x->drate != y->drate)
+        return x->drate < y->drate;
+    if (x->pga != y->pga)
+        return x->pga < y->pga;
+    return a < b;
+}
+
+/**
+ * ads125xScanPlan - Plan the frame of a scan
+ * @s: The scan, with its channels added.
+ *
+ * Fills burst and achieved_sps of every channel, and the order, length
+ * and register writes of the frame. A channel with burst 0 does not fit
+ * and is not sampled.
+ *
+ * @return: ADS125x_OK, or ADS125x_ERR_INVAL if no channel fits.
+ */
+int ads125xScanPlan(ads125x_scan *s)
+{
+    double scale[ADS125x_SCAN_MAX_CHANNELS], lo, hi, mid;
+    int burst[ADS125x_SCAN_MAX_CHANNELS];
+    int i, j, k, prio, next, iter;
+    size_t r;
+
+    if (s->nch == 0)
+        return ADS125x_ERR_INVAL;
+    for (i = 0; i < s->nch; ++i)
+    {
+        scale[i] = 1;
+        if (s->ch[i].drate)
+            continue;
+        // The best resolution that leaves the chip time for the others
+        s->ch[i].drate = ADS125x_DR_30000;
+        for (r = 0; r < sizeof(scan_rates); ++r)
+            if (ads125xDRATEToSPS(scan_rates[r]) >= 2 * s->nch * s->ch[i].rate_sps)
+            {
+                s->ch[i].drate = scan_rates[r];
+                break;
+            }
+    }
+
+    // Slow down the lowest priority first, until the rest fits
+    for (prio = INT32_MIN; !scan_frame(s, scale, burst);)
+    {
+        next = INT32_MAX;
+        for (i = 0; i < s->nch; ++i)
+            if (s->ch[i].priority >= prio && s->ch[i].priority < next && scale[i] > 0)
+                next = s->ch[i].priority;
+        if (next == INT32_MAX)
+            return ADS125x_ERR_INVAL;
+        prio = next;
+        for (i = 0; i < s->nch; ++i)
+            if (s->ch[i].priority == prio)
+                scale[i] = 0;
+        if (!scan_frame(s, scale, burst))
+            continue;
+        for (lo = 0, hi = 1, iter = 0; iter < 30; ++iter)
+        {
+            mid = (lo + hi) / 2;
+            for (i = 0; i < s->nch; ++i)
+                if (s->ch[i].priority == prio)
+                    scale[i] = mid;
+            if (scan_frame(s, scale, burst))
+                lo = mid;
+            else
+                hi = mid;
+        }
+        for (i = 0; i < s->nch; ++i)
+            if (s->ch[i].priority == prio)
+                scale[i] = lo;
+    }
+
+    // The frame runs back to back, its real length is the cost
+    s->frame_us = scan_cost(s, scale, scan_frame(s, scale, burst), burst);
+    s->slots = 0;
+    for (i = 0; i < s->nch; ++i)
+    {
+        s->ch[i].burst = burst[i];
+        s->ch[i].achieved_sps = burst[i] * 1e6 / s->frame_us;
+        if (burst[i])
+            s->order[s->slots++] = i;
+    }
+    if (s->slots == 0)
+        return ADS125x_ERR_INVAL;
+    for (j = 1; j < s->slots; ++j)
+    {
+        k = s->order[j];
+        for (i = j; i > 0 && scan_before(s, k, s->order[i - 1]); --i)
+            s->order[i] = s->order[i - 1];
+        s->order[i] = k;
+    }
+    s->writes = 0;
+    for (j = 0; s->slots > 1 && j < s->slots; ++j)
+        s->writes += scan_writes(s, s->order[j], s->order[(j + 1) % s->slots]);
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xScanPrint - Print the plan of a scan
+ * @s: The planned scan.
+ * @fp: Where to print.
+ */
+void ads125xScanPrint(const ads125x_scan *s, FILE *fp)
+{
+    const ads125x_scan_channel *c;
+    int i;
+
+    fprintf(fp, "Scan frame %.3lf ms, %d register bytes written per frame\n", s->frame_us * 1e-3, s->writes);
+    for (i = 0; i < s->nch; ++i)
+    {
+        c = &s->ch[i];
+        fprintf(fp, "  ch%-2d MUX %02x PGA %d DRATE %-7g prio %-3d want %10.3lf sps, plan %10.3lf sps (%d per frame)\n",
+                i, c->psel | c->nsel, 1 << c->pga, ads125xDRATEToSPS(c->drate), c->priority,
+                c->rate_sps, c->achieved_sps, c->burst);
+    }
+    return;
+}
+
+static void scan_regs(ads125x_dev *dev, const ads125x_scan_channel *c, uint8_t *regs)
+{
+    uint8_t adcon = dev->regs_valid & (1 << ADS125x_REG_ADDR_ADCON) ? dev->regs[ADS125x_REG_ADDR_ADCON] : ADS125x_ADCON_CLK_FEQIN;
+
+    regs[0] = c->psel | c->nsel;
+    regs[1] = (adcon & 0xF8) | c->pga;
+    regs[2] = c->drate;
+}
+
+/**
+ * scan_message - One SPI message: switch to a channel if needed, then read
+ * @next: Channel to switch to, NULL to keep converting.
+ * @data: Used to store the previous conversion, NULL for none.
+ *
+ * Only the registers from the first to the last one that change are
+ * written. Switching restarts the conversion with SYNC and WAKEUP, the
+ * RDATA that follows still reads the conversion before.
+ */
+static int scan_message(ads125x_dev *dev, const ads125x_scan_channel *next, uint8_t *data)
+{
+    uint8_t regs[SCAN_REGS], tx[SCAN_REGS + 5];
+    struct spi_ioc_transfer spi[5];
+    int n = 0, first = SCAN_REGS, last = -1, i;
+
+    memset(&spi, 0, sizeof(spi));
+    if (next)
+    {
+        scan_regs(dev, next, regs);
+        for (i = 0; i < SCAN_REGS; ++i)
+            if (!(dev->regs_valid & (1 << (ADS125x_REG_ADDR_MUX + i))) || dev->regs[ADS125x_REG_ADDR_MUX + i] != regs[i])
+            {
+                first = first < i ? first : i;
+                last = i;
+            }
+    }
+    if (last >= 0)
+    {
+        tx[0] = ADS125x_CMD_WREG | (ADS125x_REG_ADDR_MUX + first);
+        tx[1] = last - first;
+        memcpy(tx + 2, regs + first, last - first + 1);
+        tx[last - first + 3] = ADS125x_CMD_SYNC;
+        tx[last - first + 4] = ADS125x_CMD_WAKEUP;
+        spi[n].tx_buf = (unsigned long)tx;
+        spi[n++].len = last - first + 4;
+        spi[n - 1].delay_usecs = 4;
+        spi[n].tx_buf = (unsigned long)&tx[last - first + 4];
+        spi[n++].len = 1;
+    }
+    if (data)
+    {
+        tx[SCAN_REGS + 4] = ADS125x_CMD_RDATA;
+        spi[n].tx_buf = (unsigned long)&tx[SCAN_REGS + 4];
+        spi[n].len = 1;
+        spi[n++].delay_usecs = ADS125x_T6_US;
+        spi[n].rx_buf = (unsigned long)data;
+        spi[n++].len = 3;
+    }
+    if (n == 0)
+        return ADS125x_OK;
+    for (i = 0; i < n; ++i)
+    {
+        spi[i].speed_hz = dev->spi_speed;
+        spi[i].bits_per_word = dev->spi_bit_p_word;
+    }
+    if (ads125xTransfer(dev, spi, n) < 0)
+        return FailurePrint("Scan error: %s\n", strerror(errno));
+    for (i = first; i <= last; ++i)
+    {
+        dev->regs[ADS125x_REG_ADDR_MUX + i] = regs[i];
+        dev->regs_valid |= 1 << (ADS125x_REG_ADDR_MUX + i);
+    }
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xScanStart - Start running a planned scan
+ * @dev: The ads125x dev info struct pointer, not in RDATAC mode.
+ * @s: The planned scan.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xScanStart(ads125x_dev *dev, ads125x_scan *s)
+{
+    int ret;
+
+    if (s->slots == 0 || dev->rdatac)
+        return ADS125x_ERR_INVAL;
+    if ((ret = ads125xwaitDRDY(dev)) < 0)
+        return ret;
+    // Invalidate MUX so the first slot always restarts the conversion
+    dev->regs_valid &= ~(1 << ADS125x_REG_ADDR_MUX);
+    if ((ret = scan_message(dev, &s->ch[s->order[0]], NULL)) < 0)
+        return ret;
+    s->pos = 0;
+    s->left = s->ch[s->order[0]].burst;
+    return ADS125x_OK;
+}
+
+/**
+ * ads125xScanRead - Read the next conversions of a running scan
+ * @dev: The ads125x dev info struct pointer.
+ * @s: The scan, see ads125xScanStart().
+ * @out: Used to store the samples, give times space.
+ * @times: Read times
+ *
+ * Each DRDY is served by one SPI message, which switches to the next
+ * slot when the burst of the current one is done.
+ *
+ * @return: ADS125x_OK or a ADS125x_ERR_* error.
+ */
+int ads125xScanRead(ads125x_dev *dev, ads125x_scan *s, ads125x_scan_sample *out, int times)
+{
+    const ads125x_scan_channel *next;
+    uint8_t raw[3];
+    int i, cur, ret;
+
+    if (s->slots == 0)
+        return ADS125x_ERR_INVAL;
+    for (i = 0; i < times; ++i)
+    {
+        cur = s->order[s->pos];
+        next = NULL;
+        if (--s->left <= 0)
+        {
+            s->pos = (s->pos + 1) % s->slots;
+            s->left = s->ch[s->order[s->pos]].burst;
+            next = &s->ch[s->order[s->pos]];
+        }
+        if ((ret = ads125xwaitDRDY(dev)) < 0)
+            return ret;
+        if ((ret = scan_message(dev, next, raw)) < 0)
+            return ret;
+        out[i].channel = cur;
+        out[i].code = convert_to_signed_24bit(raw);
+        out[i].ts = dev->drdy_ns;
+    }
+    return ADS125x_OK;
+}
@@ -0,0 +1,130 @@
+/**
+ * libads1256scan.h - Multi-channel scan scheduling for ADS125x
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256SCAN_H
+#define LIBADS1256SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "libads1256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A scan samples several inputs of one chip, each with its own rate,
+ * PGA and DRATE. ads125xScanPlan() turns the requirements into a
+ * repeating frame and reports the rates it achieves before anything is
+ * started:
+ *
+ *  - Switching to another input costs the settling time of its DRATE,
+ *    see ads125xDRATEToSettleUs(), further conversions of the same input
+ *    only a DRATE period. So each input is read in one burst per frame,
+ *    the frame is the shortest that fits all the wanted rates.
+ *  - Inputs with the same DRATE and PGA follow each other, so a switch
+ *    mostly writes only MUX. The writes per frame are reported.
+ *  - When the chip is too slow for all the wanted rates, inputs of lower
+ *    priority are slowed down first, down to not sampled at all.
+ *
+ * ads125xScanRead() then runs the frame, one SPI message per DRDY.
+ */
+#define ADS125x_SCAN_MAX_CHANNELS   16
+#define ADS125x_SCAN_SLOT_US        30      // SPI message and ioctl per conversion read
+#define ADS125x_SCAN_MAX_FRAME_US   1000000 // Longest frame, the latency of a burst
+#define ADS125x_SCAN_FRAME_STEP     1.05    // Frame lengths tried grow by this factor
+
+/**
+ * ads125x_scan_channel - Requirement and plan of one scanned input
+ * @psel: Postive Input Channel (AIN_P) select.
+ * @nsel: Negative Input Channel (AIN_N) select.
+ * @pga: ADCON PGA bits, ADS125x_ADCON_PGA_*.
+ * @drate: Data rate, ADS125x_DR_*, 0 picks the slowest one that is at
+ *         least 2 * channels * @rate_sps.
+ * @priority: Higher keeps its rate when the chip is too slow for all.
+ * @rate_sps: Wanted samples per second.
+ * @burst: Planned conversions per frame, 0 is not sampled.
+ * @achieved_sps: Planned samples per second.
+ */
+typedef struct ads125x_scan_channel_struct
+{
+    uint8_t psel;
+    uint8_t nsel;
+    uint8_t pga;
+    uint8_t drate;
+    int priority;
+    double rate_sps;
+    int burst;
+    double achieved_sps;
+} ads125x_scan_channel;
+
+/**
+ * ads125x_scan - A scan and its planned frame
+ * @order: Channels in the order of their bursts, @slots of them.
+ * @frame_us: Planned length of a frame.
+ * @writes: WREG bytes per frame.
+ */
+typedef struct ads125x_scan_struct
+{
+    int nch;
+    ads125x_scan_channel ch[ADS125x_SCAN_MAX_CHANNELS];
+    int order[ADS125x_SCAN_MAX_CHANNELS];
+    int slots;
+    double frame_us;
+    int writes;
+    // Run state, the slot converting now and its conversions left
+    int pos;
+    int left;
+} ads125x_scan;
+
+typedef struct ads125x_scan_sample_struct
+{
+    int channel;
+    int32_t code;
+    uint64_t ts;            // DRDY time, CLOCK_MONOTONIC ns
+} ads125x_scan_sample;
+
+void ads125xScanInit(ads125x_scan *s);
+int ads125xScanAdd(ads125x_scan *s, uint8_t psel, uint8_t nsel, uint8_t pga, uint8_t drate, double rate_sps, int priority);
+int ads125xScanPlan(ads125x_scan *s);
+void ads125xScanPrint(const ads125x_scan *s, FILE *fp);
+int ads125xScanStart(ads125x_dev *dev, ads125x_scan *s);
+int ads125xScanRead(ads125x_dev *dev, ads125x_scan *s, ads125x_scan_sample *out, int times);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,650 @@
+/**
+ * libads1256writer.c - Asynchronous capture writer for the ADS1255/ADS1256 driver library
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "libads1256writer.h"
+
+// user_data of the NOP which stops the io_uring reaper thread
+#define WRITER_STOP                 ((uint64_t)-1)
+
+extern int ADS125xDriverDebug;
+
+typedef struct writer_buf_struct
+{
+    uint8_t *data;
+    size_t len;
+    size_t io_len;
+    uint64_t offset;
+    uint64_t submit_ns;
+    int busy;           // Queued for writing, until writer_account()
+} writer_buf;
+
+struct ads125x_writer_struct
+{
+    int fd;
+    int flags;
+    size_t block_size;
+    int nbufs;
+    int depth;
+    uint8_t *mem;
+    writer_buf *bufs;
+
+    // Shared with the completion side, protected by lock
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int *free_stack;
+    int nfree;
+    int inflight;
+    int dead;           // The io_uring reaper is gone, nothing completes
+    uint64_t lat_sum_ns;
+    ads125x_writer_stats stats;
+
+    // Acquisition thread only
+    uint64_t offset;
+    int tail;
+    int *pending;
+    int pend_head;
+    int pend_count;
+
+    // io_uring engine
+    int use_uring;
+    int ring_fd;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr;
+    void *cq_ptr;
+    size_t sq_size;
+    size_t cq_size;
+    size_t sqes_size;
+    pthread_t reaper;
+
+    // pwrite thread pool engine
+    pthread_t *workers;
+    int *jobs;
+    int job_head;
+    int job_count;
+    int stop;
+};
+
+static uint64_t writer_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * writer_account - Account a finished write and recycle its buffer, under lock
+ * @res: Bytes written, or a negative errno.
+ *
+ * A buffer is accounted once, a late completion of a buffer already
+ * failed is ignored.
+ */
+static void writer_account(ads125x_writer *w, int idx, long res)
+{
+    writer_buf *b = &w->bufs[idx];
+    uint64_t lat = writer_now_ns() - b->submit_ns;
+
+    if (!b->busy)
+        return;
+    b->busy = 0;
+    if (res != (long)b->io_len)
+    {
+        if (w->stats.errors++ == 0)
+            fprintf(stderr, "Writer: write at %llu failed: %s\n", (unsigned long long)b->offset,
+                    res < 0 ? strerror((int)-res) : "short write");
+    }
+    else
+    {
+        w->stats.blocks++;
+        w->stats.bytes += b->len;
+        w->lat_sum_ns += lat;
+        if (w->stats.lat_min_ns == 0 || lat < w->stats.lat_min_ns)
+            w->stats.lat_min_ns = lat;
+        if (lat > w->stats.lat_max_ns)
+            w->stats.lat_max_ns = lat;
+    }
+    w->free_stack[w->nfree++] = idx;
+    w->inflight--;
+    pthread_cond_broadcast(&w->cond);
+}
+
+static void writer_complete(ads125x_writer *w, int idx, long res)
+{
+    pthread_mutex_lock(&w->lock);
+    writer_account(w, idx, res);
+    pthread_mutex_unlock(&w->lock);
+}
+
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+/**
+ * uring_setup - Map an io_uring instance
+ *
+ * @return: 0 is success, -1 is io_uring not usable.
+ */
+static int uring_setup(ads125x_writer *w)
+{
+    struct io_uring_params p;
+
+    memset(&p, 0, sizeof(p));
+    if ((w->ring_fd = (int)syscall(__NR_io_uring_setup, w->depth + 1, &p)) < 0)
+        return -1;
+    // IORING_OP_WRITE came with the same kernel as IORING_FEAT_RW_CUR_POS
+    if (!(p.features & IORING_FEAT_RW_CUR_POS))
+    {
+        close(w->ring_fd);
+        return -1;
+    }
+
+    w->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    w->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (w->cq_size > w->sq_size)
+            w->sq_size = w->cq_size;
+        w->cq_size = w->sq_size;
+    }
+    w->sq_ptr = mmap(NULL, w->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, w->ring_fd, IORING_OFF_SQ_RING);
+    if (w->sq_ptr == MAP_FAILED)
+        goto err_fd;
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        w->cq_ptr = w->sq_ptr;
+    else if ((w->cq_ptr = mmap(NULL, w->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                               w->ring_fd, IORING_OFF_CQ_RING)) == MAP_FAILED)
+        goto err_sq;
+    w->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    if ((w->sqes = (struct io_uring_sqe *)mmap(NULL, w->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                               w->ring_fd, IORING_OFF_SQES)) == MAP_FAILED)
+        goto err_cq;
+
+    w->sq_tail = (unsigned *)((char *)w->sq_ptr + p.sq_off.tail);
+    w->sq_mask = (unsigned *)((char *)w->sq_ptr + p.sq_off.ring_mask);
+    w->sq_array = (unsigned *)((char *)w->sq_ptr + p.sq_off.array);
+    w->cq_head = (unsigned *)((char *)w->cq_ptr + p.cq_off.head);
+    w->cq_tail = (unsigned *)((char *)w->cq_ptr + p.cq_off.tail);
+    w->cq_mask = (unsigned *)((char *)w->cq_ptr + p.cq_off.ring_mask);
+    w->cqes = (struct io_uring_cqe *)((char *)w->cq_ptr + p.cq_off.cqes);
+    return 0;
+
+err_cq:
+    if (w->cq_ptr != w->sq_ptr)
+        munmap(w->cq_ptr, w->cq_size);
+err_sq:
+    munmap(w->sq_ptr, w->sq_size);
+err_fd:
+    close(w->ring_fd);
+    return -1;
+}
+
+static void uring_release(ads125x_writer *w)
+{
+    munmap(w->sqes, w->sqes_size);
+    if (w->cq_ptr != w->sq_ptr)
+        munmap(w->cq_ptr, w->cq_size);
+    munmap(w->sq_ptr, w->sq_size);
+    close(w->ring_fd);
+}
+
+/**
+ * uring_queue - Fill a SQE, the caller publishes it with uring_enter()
+ */
+static void uring_queue(ads125x_writer *w, uint8_t opcode, int idx, uint64_t user_data)
+{
+    unsigned tail = *w->sq_tail;
+    unsigned slot = tail & *w->sq_mask;
+    struct io_uring_sqe *sqe = &w->sqes[slot];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = w->fd;
+    if (idx >= 0)
+    {
+        sqe->addr = (unsigned long)w->bufs[idx].data;
+        sqe->len = w->bufs[idx].io_len;
+        sqe->off = w->bufs[idx].offset;
+    }
+    sqe->user_data = user_data;
+    w->sq_array[slot] = slot;
+    __atomic_store_n(w->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static void *uring_reaper(void *arg)
+{
+    ads125x_writer *w = (ads125x_writer *)arg;
+    struct io_uring_cqe *cqe;
+    unsigned head, tail;
+    int i, stop = 0;
+
+    while (!stop)
+    {
+        if (uring_enter(w->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+        {
+            fprintf(stderr, "Writer: io_uring wait error: %s\n", strerror(errno));
+            // Nothing would complete the writes in flight, fail them so close does not wait forever
+            pthread_mutex_lock(&w->lock);
+            w->dead = 1;
+            for (i = 0; i < w->nbufs; ++i)
+                writer_account(w, i, -EIO);
+            pthread_mutex_unlock(&w->lock);
+            break;
+        }
+        head = *w->cq_head;
+        tail = __atomic_load_n(w->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+            cqe = &w->cqes[head & *w->cq_mask];
+            if (cqe->user_data == WRITER_STOP)
+                stop = 1;
+            else
+                writer_complete(w, (int)cqe->user_data, cqe->res);
+        }
+        __atomic_store_n(w->cq_head, head, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+/**
+ * uring_flush - Submit the pending buffers the queue depth allows
+ *
+ * The buffers io_uring does not take, or all of them once the reaper is
+ * gone, are failed at once and count as write errors.
+ *
+ * @return: 0 is submitted, -1 is some buffers failed.
+ */
+static int uring_flush(ads125x_writer *w)
+{
+    unsigned n = 0, tail;
+    int idx, ret, err, failed = 0;
+
+    pthread_mutex_lock(&w->lock);
+    while (w->pend_count > 0 && (w->dead || w->inflight < w->depth))
+    {
+        idx = w->pending[w->pend_head];
+        w->pend_head = (w->pend_head + 1) % w->nbufs;
+        w->pend_count--;
+        w->inflight++;
+        w->bufs[idx].busy = 1;
+        w->bufs[idx].submit_ns = writer_now_ns();
+        if (w->dead)
+        {
+            writer_account(w, idx, -EIO);
+            failed = 1;
+            continue;
+        }
+        uring_queue(w, IORING_OP_WRITE, idx, (uint64_t)idx);
+        ++n;
+    }
+    pthread_mutex_unlock(&w->lock);
+    if (n == 0)
+        return failed ? -1 : 0;
+
+    while ((ret = uring_enter(w->ring_fd, n, 0, 0)) < 0 && errno == EINTR)
+        ;
+    if (ret == (int)n)
+        return failed ? -1 : 0;
+    err = ret < 0 ? errno : EAGAIN;
+    fprintf(stderr, "Writer: io_uring submit error: %s\n", strerror(err));
+    // Take back the SQEs the kernel did not consume, the last ones queued
+    pthread_mutex_lock(&w->lock);
+    tail = *w->sq_tail;
+    for (; n > (unsigned)(ret > 0 ? ret : 0); --n)
+    {
+        --tail;
+        writer_account(w, (int)w->sqes[tail & *w->sq_mask].user_data, -err);
+    }
+    __atomic_store_n(w->sq_tail, tail, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&w->lock);
+    return -1;
+}
+
+static void *pool_worker(void *arg)
+{
+    ads125x_writer *w = (ads125x_writer *)arg;
+    writer_buf *b;
+    ssize_t ret = 0;
+    size_t done;
+    long res;
+    int idx;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&w->lock);
+        while (w->job_count == 0 && !w->stop)
+            pthread_cond_wait(&w->cond, &w->lock);
+        if (w->job_count == 0)
+        {
+            pthread_mutex_unlock(&w->lock);
+            return NULL;
+        }
+        idx = w->jobs[w->job_head];
+        w->job_head = (w->job_head + 1) % w->nbufs;
+        w->job_count--;
+        pthread_mutex_unlock(&w->lock);
+
+        b = &w->bufs[idx];
+        res = 0;
+        for (done = 0; done < b->io_len; done += ret)
+        {
+            ret = pwrite(w->fd, b->data + done, b->io_len - done, b->offset + done);
+            if (ret < 0 && errno == EINTR)
+            {
+                ret = 0;
+                continue;
+            }
+            // Nothing written would not get any further, a error as well
+            if (ret <= 0)
+            {
+                res = ret < 0 ? -errno : -EIO;
+                break;
+            }
+        }
+        writer_complete(w, idx, res < 0 ? res : (long)done);
+    }
+}
+
+/**
+ * ads125xWriterOpen - Create a asynchronous writer
+ * @path: Output file, created or truncated.
+ * @block_size: Size of a buffer, rounded up to ADS125x_WRITER_ALIGN.
+ * @nbufs: Number of buffers, should be larger than @depth so the
+ *         acquisition thread has buffers to fill while others are written.
+ * @depth: Maximum number of writes in flight (io_uring queue depth, or
+ *         number of pwrite threads).
+ * @flags: ADS125x_WRITER_* flags.
+ *
+ * @return: The writer, NULL is failed.
+ */
+ads125x_writer *ads125xWriterOpen(const char *path, size_t block_size, int nbufs, int depth, int flags)
+{
+    ads125x_writer *w;
+    int oflags = O_WRONLY | O_CREAT | O_TRUNC;
+    int i;
+
+    if (block_size == 0 || depth < 1 || nbufs < depth)
+    {
+        fprintf(stderr, "Writer: invalid block size %zu, %d buffers, depth %d.\n", block_size, nbufs, depth);
+        return NULL;
+    }
+    if ((w = (ads125x_writer *)calloc(1, sizeof(*w))) == NULL)
+        return NULL;
+    w->flags = flags;
+    w->nbufs = nbufs;
+    w->depth = depth;
+    w->block_size = (block_size + ADS125x_WRITER_ALIGN - 1) & ~((size_t)ADS125x_WRITER_ALIGN - 1);
+
+    if (flags & ADS125x_WRITER_DIRECT)
+        oflags |= O_DIRECT;
+    if ((w->fd = open(path, oflags, 0644)) < 0)
+    {
+        fprintf(stderr, "Writer: cannot open %s: %s\n", path, strerror(errno));
+        free(w);
+        return NULL;
+    }
+
+    w->bufs = (writer_buf *)calloc(nbufs, sizeof(writer_buf));
+    w->free_stack = (int *)calloc(nbufs, sizeof(int));
+    w->pending = (int *)calloc(nbufs, sizeof(int));
+    w->jobs = (int *)calloc(nbufs, sizeof(int));
+    if (!w->bufs || !w->free_stack || !w->pending || !w->jobs ||
+        posix_memalign((void **)&w->mem, ADS125x_WRITER_ALIGN, w->block_size * nbufs))
+    {
+        fprintf(stderr, "Allocated memory for writer failed.\n");
+        goto err;
+    }
+    // Fault the buffers in now rather than in the acquisition loop
+    memset(w->mem, 0x00, w->block_size * nbufs);
+    for (i = 0; i < nbufs; ++i)
+    {
+        w->bufs[i].data = w->mem + w->block_size * i;
+        w->free_stack[i] = nbufs - 1 - i;
+    }
+    w->nfree = nbufs;
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->cond, NULL);
+
+    if (!(flags & ADS125x_WRITER_POOL) && uring_setup(w) == 0)
+    {
+        if (pthread_create(&w->reaper, NULL, uring_reaper, w) == 0)
+            w->use_uring = 1;
+        else
+            uring_release(w);
+    }
+    if (!w->use_uring)
+    {
+        if ((w->workers = (pthread_t *)calloc(depth, sizeof(pthread_t))) == NULL)
+            goto err_sync;
+        for (i = 0; i < depth; ++i)
+            if (pthread_create(&w->workers[i], NULL, pool_worker, w))
+            {
+                fprintf(stderr, "Writer: cannot create pwrite thread.\n");
+                w->depth = i;
+                ads125xWriterClose(w, NULL);
+                return NULL;
+            }
+    }
+    w->stats.engine = w->use_uring ? "io_uring" : "pwrite";
+    if (ADS125xDriverDebug)
+        fprintf(stdout, "Open writer %s with %s, %d x %zu bytes, depth %d.\n",
+                path, w->stats.engine, nbufs, w->block_size, depth);
+    return w;
+
+err_sync:
+    pthread_cond_destroy(&w->cond);
+    pthread_mutex_destroy(&w->lock);
+err:
+    close(w->fd);
+    free(w->mem);
+    free(w->bufs);
+    free(w->free_stack);
+    free(w->pending);
+    free(w->jobs);
+    free(w);
+    return NULL;
+}
+
+/**
+ * ads125xWriterGetBuffer - Get a free buffer to fill
+ * @w: The writer.
+ *
+ * Never waits. A NULL return means all buffers are still being written,
+ * it is counted as an overrun.
+ *
+ * @return: A buffer of the writer block size, or NULL.
+ */
+uint8_t *ads125xWriterGetBuffer(ads125x_writer *w)
+{
+    int idx = -1;
+
+    pthread_mutex_lock(&w->lock);
+    if (w->nfree > 0)
+        idx = w->free_stack[--w->nfree];
+    else
+        w->stats.overruns++;
+    pthread_mutex_unlock(&w->lock);
+    return idx < 0 ? NULL : w->bufs[idx].data;
+}
+
+/**
+ * ads125xWriterSubmit - Queue a filled buffer for writing
+ * @w: The writer.
+ * @buf: A buffer from ads125xWriterGetBuffer().
+ * @len: Bytes to write. With ADS125x_WRITER_DIRECT only the last
+ *       buffer may be shorter than a multiple of ADS125x_WRITER_ALIGN.
+ *
+ * Buffers are written at consecutive file offsets in submit order.
+ * Never waits for the storage.
+ *
+ * @return: 0 is queued, -1 is invalid buffer or length, or io_uring
+ *          refused the write. A refused buffer is counted as a error and
+ *          goes back to the free buffers.
+ */
+int ads125xWriterSubmit(ads125x_writer *w, uint8_t *buf, size_t len)
+{
+    writer_buf *b;
+    int idx;
+
+    idx = (buf - w->mem) / (ptrdiff_t)w->block_size;
+    if (buf < w->mem || idx >= w->nbufs || buf != w->bufs[idx].data || len > w->block_size || w->tail)
+    {
+        fprintf(stderr, "Writer: invalid submit of %zu bytes.\n", len);
+        return -1;
+    }
+    b = &w->bufs[idx];
+    b->len = len;
+    b->io_len = len;
+    b->offset = w->offset;
+    w->offset += len;
+    if (w->flags & ADS125x_WRITER_DIRECT && len % ADS125x_WRITER_ALIGN)
+    {
+        // Pad the last block, the file is truncated to its size on close
+        b->io_len = (len + ADS125x_WRITER_ALIGN - 1) & ~((size_t)ADS125x_WRITER_ALIGN - 1);
+        memset(b->data + len, 0x00, b->io_len - len);
+        w->tail = 1;
+    }
+
+    if (w->use_uring)
+    {
+        w->pending[(w->pend_head + w->pend_count) % w->nbufs] = idx;
+        w->pend_count++;
+        return uring_flush(w);
+    }
+
+    pthread_mutex_lock(&w->lock);
+    b->busy = 1;
+    b->submit_ns = writer_now_ns();
+    w->jobs[(w->job_head + w->job_count) % w->nbufs] = idx;
+    w->job_count++;
+    w->inflight++;
+    pthread_cond_signal(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+    return 0;
+}
+
+/**
+ * ads125xWriterGetStats - Get the writer statistics
+ * @w: The writer.
+ * @stats: Filled with the statistics so far.
+ */
+void ads125xWriterGetStats(ads125x_writer *w, ads125x_writer_stats *stats)
+{
+    pthread_mutex_lock(&w->lock);
+    *stats = w->stats;
+    stats->lat_avg_ns = w->stats.blocks ? w->lat_sum_ns / w->stats.blocks : 0;
+    pthread_mutex_unlock(&w->lock);
+    return;
+}
+
+/**
+ * ads125xWriterClose - Wait for all writes and close the writer
+ * @w: The writer.
+ * @stats: Filled with the final statistics, can be NULL.
+ *
+ * @return: 0 is all data written, 1 is some writes failed.
+ */
+int ads125xWriterClose(ads125x_writer *w, ads125x_writer_stats *stats)
+{
+    int i, ret;
+
+    if (w->use_uring)
+    {
+        while (w->pend_count > 0)
+        {
+            pthread_mutex_lock(&w->lock);
+            while (!w->dead && w->inflight >= w->depth)
+                pthread_cond_wait(&w->cond, &w->lock);
+            pthread_mutex_unlock(&w->lock);
+            uring_flush(w);
+        }
+    }
+    pthread_mutex_lock(&w->lock);
+    while (w->inflight > 0)
+        pthread_cond_wait(&w->cond, &w->lock);
+    w->stop = 1;
+    pthread_cond_broadcast(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+
+    if (w->use_uring)
+    {
+        uring_queue(w, IORING_OP_NOP, -1, WRITER_STOP);
+        uring_enter(w->ring_fd, 1, 0, 0);
+        pthread_join(w->reaper, NULL);
+        uring_release(w);
+    }
+    else
+    {
+        for (i = 0; i < w->depth; ++i)
+            pthread_join(w->workers[i], NULL);
+        free(w->workers);
+    }
+
+    if (w->tail && ftruncate(w->fd, w->offset) < 0)
+        w->stats.errors++;
+    close(w->fd);
+
+    if (stats)
+        ads125xWriterGetStats(w, stats);
+    ret = w->stats.errors ? 1 : 0;
+
+    pthread_cond_destroy(&w->cond);
+    pthread_mutex_destroy(&w->lock);
+    free(w->mem);
+    free(w->bufs);
+    free(w->free_stack);
+    free(w->pending);
+    free(w->jobs);
+    free(w);
+    return ret;
+}
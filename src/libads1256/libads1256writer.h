@@ -0,0 +1,84 @@
+/**
+ * libads1256writer.h - Asynchronous capture writer for the ADS1255/ADS1256 driver library
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef LIBADS1256WRITER_H
+#define LIBADS1256WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The writer takes filled sample buffers from the acquisition thread and
+ * writes them to a file in the background, so a slow storage never stalls
+ * the DRDY loop. Writes go through io_uring, or through a pool of pwrite()
+ * threads if io_uring is not available.
+ *
+ * The acquisition thread gets a free buffer with ads125xWriterGetBuffer(),
+ * fills it and hands it back with ads125xWriterSubmit(). Neither call
+ * waits for the storage, buffers are recycled when their write completes.
+ */
+#define ADS125x_WRITER_ALIGN        4096
+
+// Writer flags
+#define ADS125x_WRITER_DIRECT       0x01    // Open the file with O_DIRECT
+#define ADS125x_WRITER_POOL         0x02    // Use the pwrite thread pool even if io_uring works
+
+typedef struct ads125x_writer_struct ads125x_writer;
+
+typedef struct ads125x_writer_stats_struct
+{
+    const char *engine;     // "io_uring" or "pwrite"
+    uint64_t blocks;        // Completed writes
+    uint64_t bytes;
+    uint64_t overruns;      // ads125xWriterGetBuffer() found no free buffer
+    uint64_t errors;        // Failed or short writes
+    uint64_t lat_min_ns;    // Submit to completion latency
+    uint64_t lat_avg_ns;
+    uint64_t lat_max_ns;
+} ads125x_writer_stats;
+
+ads125x_writer *ads125xWriterOpen(const char *path, size_t block_size, int nbufs, int depth, int flags);
+uint8_t *ads125xWriterGetBuffer(ads125x_writer *w);
+int ads125xWriterSubmit(ads125x_writer *w, uint8_t *buf, size_t len);
+void ads125xWriterGetStats(ads125x_writer *w, ads125x_writer_stats *stats);
+int ads125xWriterClose(ads125x_writer *w, ads125x_writer_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
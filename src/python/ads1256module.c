@@ -0,0 +1,993 @@
+/**
+ * ads1256module.c - Python bindings of libads1256
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <linux/spi/spidev.h>
+
+#include "libads1256.h"
+#include "libads1256reg.h"
+#include "libads1256replay.h"
+#include "ads1256.h"
+
+/**
+ * Samples reach Python without a Python object per sample and without a
+ * copy: a Block owns the buffers the library reads into, and its codes,
+ * timestamps and volts are exported through the buffer protocol, so
+ * memoryview(block.codes) or numpy.asarray(block.codes) see the library
+ * memory. The GIL is released while the library waits for the chip.
+ *
+ * Device.stream() runs the RDATAC loop on a thread of its own, into a
+ * pool of blocks. A block goes back to the pool once Python drops the
+ * last reference to it or to a view of it. When Python holds every
+ * block the loop reads into a scratch block and counts it as lost,
+ * the chip is never made to wait for Python.
+ */
+#define PY_STREAM_BLOCK             4096
+#define PY_STREAM_BLOCKS            16
+#define PY_WAIT_MS                  100     // Ctrl-C check while waiting for a block
+#define PY_VREF                     2.5
+
+typedef struct DeviceObject_struct
+{
+    PyObject_HEAD
+    ads125x_dev dev;
+    ads125x_predict predict;
+    double vref;
+    int opened;
+    int running;            // In RDATAC
+    int streaming;
+} DeviceObject;
+
+typedef struct stream_slot_struct
+{
+    int32_t *codes;
+    uint64_t *ts;
+    uint64_t seq;
+    size_t n;
+} stream_slot;
+
+typedef struct StreamObject_struct
+{
+    PyObject_HEAD
+    DeviceObject *device;
+    size_t block;
+    int nslots;
+    uint8_t *mem;
+    stream_slot *slots;     // nslots pool blocks and one scratch block
+    pthread_t thread;
+    int started;
+
+    // Shared with the acquisition thread, protected by lock
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int *free_stack;
+    int nfree;
+    int *ready;             // FIFO of filled slots
+    int ready_head;
+    int nready;
+    int stop;
+    int error;
+    uint64_t seq;
+    uint64_t lost;
+} StreamObject;
+
+typedef struct BlockObject_struct
+{
+    PyObject_HEAD
+    PyObject *owner;        // The stream of a pool block, NULL if owned
+    int slot;
+    int32_t *codes;
+    uint64_t *ts;
+    double *volts;          // Converted on first use
+    double volts_per_code;
+    uint64_t seq;
+    Py_ssize_t n;
+} BlockObject;
+
+typedef struct ViewObject_struct
+{
+    PyObject_HEAD
+    PyObject *block;
+    void *buf;
+    Py_ssize_t n;
+    Py_ssize_t itemsize;
+    char *format;
+} ViewObject;
+
+static PyTypeObject DeviceType;
+static PyTypeObject StreamType;
+static PyTypeObject BlockType;
+static PyTypeObject ViewType;
+static PyObject *Ads1256Error;
+
+static PyObject *raise_ret(int ret, const char *what)
+{
+    if (ret == ADS125x_ERR_TIMEOUT)
+        PyErr_Format(PyExc_TimeoutError, "%s: DRDY timeout", what);
+    else
+        PyErr_Format(Ads1256Error, "%s failed: %d", what, ret);
+    return NULL;
+}
+
+static double device_volts_per_code(DeviceObject *self)
+{
+    int pga = 0;
+
+    if (self->dev.regs_valid & (1 << ADS125x_REG_ADDR_ADCON))
+        pga = self->dev.regs[ADS125x_REG_ADDR_ADCON] & 0x07;
+    if (pga > 6)
+        pga = 6;
+    return 2.0 * self->vref / ((1 << pga) * 8388608.0);
+}
+
+// Widen 3 byte results read into the back of codes in place, see ads125xPubRDATAC()
+static int read_block(ads125x_dev *dev, int32_t *codes, uint64_t *ts, size_t n)
+{
+    uint8_t *raw = (uint8_t *)codes + n;
+    size_t i;
+    int ret;
+
+    if ((ret = ads125xRDATACReadTs(dev, raw, ts, (int)n)) < 0)
+        return ret;
+    for (i = 0; i < n; ++i)
+        codes[i] = convert_to_signed_24bit(raw + 3 * i);
+    return ADS125x_OK;
+}
+
+/* View: a typed, read-only buffer into a Block */
+
+static int View_getbuffer(ViewObject *self, Py_buffer *view, int flags)
+{
+    if (flags & PyBUF_WRITABLE)
+    {
+        PyErr_SetString(PyExc_BufferError, "sample views are read-only");
+        return -1;
+    }
+    view->obj = (PyObject *)self;
+    Py_INCREF(self);
+    view->buf = self->buf;
+    view->len = self->n * self->itemsize;
+    view->readonly = 1;
+    view->itemsize = self->itemsize;
+    view->format = (flags & PyBUF_FORMAT) ? self->format : NULL;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? &self->n : NULL;
+    view->strides = (flags & PyBUF_STRIDES) ? &view->itemsize : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    return 0;
+}
+
+static PyBufferProcs View_as_buffer = {
+    .bf_getbuffer = (getbufferproc)View_getbuffer,
+};
+
+static void View_dealloc(ViewObject *self)
+{
+    Py_XDECREF(self->block);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyTypeObject ViewType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "ads1256.View",
+    .tp_basicsize = sizeof(ViewObject),
+    .tp_dealloc = (destructor)View_dealloc,
+    .tp_as_buffer = &View_as_buffer,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Read-only buffer over the samples of a Block.",
+};
+
+static PyObject *make_view(BlockObject *block, void *buf, Py_ssize_t itemsize, char *format)
+{
+    ViewObject *view;
+    PyObject *mv;
+
+    if ((view = PyObject_New(ViewObject, &ViewType)) == NULL)
+        return NULL;
+    Py_INCREF(block);
+    view->block = (PyObject *)block;
+    view->buf = buf;
+    view->n = block->n;
+    view->itemsize = itemsize;
+    view->format = format;
+    mv = PyMemoryView_FromObject((PyObject *)view);
+    Py_DECREF(view);
+    return mv;
+}
+
+/* Block: samples of one read */
+
+static void Block_dealloc(BlockObject *self)
+{
+    StreamObject *st = (StreamObject *)self->owner;
+
+    if (st)
+    {
+        pthread_mutex_lock(&st->lock);
+        st->free_stack[st->nfree++] = self->slot;
+        pthread_mutex_unlock(&st->lock);
+        Py_DECREF(st);
+    }
+    else
+    {
+        PyMem_RawFree(self->codes);
+        PyMem_RawFree(self->ts);
+    }
+    PyMem_RawFree(self->volts);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int Block_getbuffer(BlockObject *self, Py_buffer *view, int flags)
+{
+    static Py_ssize_t itemsize = sizeof(int32_t);
+
+    if (PyBuffer_FillInfo(view, (PyObject *)self, self->codes, self->n * sizeof(int32_t), 1, flags))
+        return -1;
+    // FillInfo describes bytes, the shape is in codes
+    view->itemsize = sizeof(int32_t);
+    view->format = (flags & PyBUF_FORMAT) ? "i" : NULL;
+    view->shape = (flags & PyBUF_ND) ? &self->n : NULL;
+    view->strides = (flags & PyBUF_STRIDES) ? &itemsize : NULL;
+    return 0;
+}
+
+static PyBufferProcs Block_as_buffer = {
+    .bf_getbuffer = (getbufferproc)Block_getbuffer,
+};
+
+static Py_ssize_t Block_len(BlockObject *self)
+{
+    return self->n;
+}
+
+static PySequenceMethods Block_as_sequence = {
+    .sq_length = (lenfunc)Block_len,
+};
+
+static PyObject *Block_get_codes(BlockObject *self, void *closure)
+{
+    return make_view(self, self->codes, sizeof(int32_t), "i");
+}
+
+static PyObject *Block_get_ts(BlockObject *self, void *closure)
+{
+    return make_view(self, self->ts, sizeof(uint64_t), "Q");
+}
+
+static PyObject *Block_get_volts(BlockObject *self, void *closure)
+{
+    Py_ssize_t i;
+
+    if (!self->volts)
+    {
+        if ((self->volts = PyMem_RawMalloc(self->n * sizeof(double) + 1)) == NULL)
+            return PyErr_NoMemory();
+        for (i = 0; i < self->n; ++i)
+            self->volts[i] = self->codes[i] * self->volts_per_code;
+    }
+    return make_view(self, self->volts, sizeof(double), "d");
+}
+
+static PyObject *Block_get_seq(BlockObject *self, void *closure)
+{
+    return PyLong_FromUnsignedLongLong(self->seq);
+}
+
+static PyGetSetDef Block_getset[] = {
+    {"codes", (getter)Block_get_codes, NULL, "Signed 24 bit codes, memoryview of int32.", NULL},
+    {"ts", (getter)Block_get_ts, NULL, "ads125xNowNs() at DRDY of each sample, memoryview of uint64.", NULL},
+    {"volts", (getter)Block_get_volts, NULL, "Input voltage of each sample, memoryview of float64.", NULL},
+    {"seq", (getter)Block_get_seq, NULL, "Index of the first sample in the stream.", NULL},
+    {NULL}
+};
+
+static PyTypeObject BlockType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "ads1256.Block",
+    .tp_basicsize = sizeof(BlockObject),
+    .tp_dealloc = (destructor)Block_dealloc,
+    .tp_as_sequence = &Block_as_sequence,
+    .tp_as_buffer = &Block_as_buffer,
+    .tp_getset = Block_getset,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Samples of one read. The block is a buffer of its int32 codes,\n"
+              "codes, ts and volts are zero-copy memoryviews of it.",
+};
+
+static BlockObject *new_block(DeviceObject *dev, Py_ssize_t n)
+{
+    BlockObject *b;
+
+    if ((b = PyObject_New(BlockObject, &BlockType)) == NULL)
+        return NULL;
+    b->owner = NULL;
+    b->slot = -1;
+    b->volts = NULL;
+    b->volts_per_code = device_volts_per_code(dev);
+    b->seq = dev->dev.rdatac_count;
+    b->n = n;
+    b->codes = PyMem_RawMalloc(n * sizeof(int32_t) + 1);
+    b->ts = PyMem_RawMalloc(n * sizeof(uint64_t) + 1);
+    if (!b->codes || !b->ts)
+    {
+        Py_DECREF(b);
+        return (BlockObject *)PyErr_NoMemory();
+    }
+    return b;
+}
+
+/* Stream: RDATAC on a thread of its own into a pool of blocks */
+
+static void *stream_run(void *arg)
+{
+    StreamObject *st = (StreamObject *)arg;
+    ads125x_dev *dev = &st->device->dev;
+    stream_slot *s;
+    int slot, ret;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&st->lock);
+        if (st->stop)
+        {
+            pthread_mutex_unlock(&st->lock);
+            break;
+        }
+        slot = st->nfree ? st->free_stack[--st->nfree] : st->nslots;
+        pthread_mutex_unlock(&st->lock);
+
+        s = &st->slots[slot];
+        s->n = st->block;
+        ret = read_block(dev, s->codes, s->ts, s->n);
+
+        pthread_mutex_lock(&st->lock);
+        if (ret < 0)
+            st->error = ret;
+        else if (slot == st->nslots)
+            st->lost += s->n;
+        else
+        {
+            s->seq = st->seq;
+            st->ready[(st->ready_head + st->nready++) % st->nslots] = slot;
+        }
+        st->seq += s->n;
+        if (ret < 0)
+        {
+            if (slot != st->nslots)
+                st->free_stack[st->nfree++] = slot;
+            st->stop = 1;
+        }
+        pthread_cond_broadcast(&st->cond);
+        pthread_mutex_unlock(&st->lock);
+        if (ret < 0)
+            break;
+    }
+    return NULL;
+}
+
+static void stream_stop(StreamObject *st)
+{
+    if (!st->started)
+        return;
+    pthread_mutex_lock(&st->lock);
+    st->stop = 1;
+    pthread_mutex_unlock(&st->lock);
+    Py_BEGIN_ALLOW_THREADS
+    pthread_join(st->thread, NULL);
+    ads125xRDATACStop(&st->device->dev);
+    Py_END_ALLOW_THREADS
+    st->started = 0;
+    st->device->running = 0;
+    st->device->streaming = 0;
+}
+
+static void Stream_dealloc(StreamObject *self)
+{
+    stream_stop(self);
+    pthread_cond_destroy(&self->cond);
+    pthread_mutex_destroy(&self->lock);
+    PyMem_RawFree(self->mem);
+    PyMem_RawFree(self->slots);
+    PyMem_RawFree(self->free_stack);
+    PyMem_RawFree(self->ready);
+    Py_XDECREF(self->device);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *Stream_iter(PyObject *self)
+{
+    Py_INCREF(self);
+    return self;
+}
+
+static PyObject *Stream_next(StreamObject *self)
+{
+    struct timespec ts;
+    BlockObject *b;
+    stream_slot *s;
+    int slot = -1, error = 0;
+
+    for (;;)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += PY_WAIT_MS * 1000000L;
+        if (ts.tv_nsec >= 1000000000L)
+        {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&self->lock);
+        if (!self->nready && !self->stop)
+            pthread_cond_timedwait(&self->cond, &self->lock, &ts);
+        if (self->nready)
+        {
+            slot = self->ready[self->ready_head];
+            self->ready_head = (self->ready_head + 1) % self->nslots;
+            self->nready--;
+        }
+        error = self->error;
+        pthread_mutex_unlock(&self->lock);
+        Py_END_ALLOW_THREADS
+        if (slot >= 0)
+            break;
+        if (error)
+            return raise_ret(error, "RDATAC");
+        if (!self->started || self->stop)
+            return NULL;
+        if (PyErr_CheckSignals())
+            return NULL;
+    }
+
+    s = &self->slots[slot];
+    if ((b = PyObject_New(BlockObject, &BlockType)) == NULL)
+    {
+        pthread_mutex_lock(&self->lock);
+        self->free_stack[self->nfree++] = slot;
+        pthread_mutex_unlock(&self->lock);
+        return NULL;
+    }
+    Py_INCREF(self);
+    b->owner = (PyObject *)self;
+    b->slot = slot;
+    b->codes = s->codes;
+    b->ts = s->ts;
+    b->volts = NULL;
+    b->volts_per_code = device_volts_per_code(self->device);
+    b->seq = s->seq;
+    b->n = (Py_ssize_t)s->n;
+    return (PyObject *)b;
+}
+
+static PyObject *Stream_close(StreamObject *self, PyObject *unused)
+{
+    stream_stop(self);
+    Py_RETURN_NONE;
+}
+
+static PyObject *Stream_enter(PyObject *self, PyObject *unused)
+{
+    Py_INCREF(self);
+    return self;
+}
+
+static PyObject *Stream_exit(StreamObject *self, PyObject *args)
+{
+    stream_stop(self);
+    Py_RETURN_FALSE;
+}
+
+static PyObject *Stream_get_lost(StreamObject *self, void *closure)
+{
+    uint64_t lost;
+
+    pthread_mutex_lock(&self->lock);
+    lost = self->lost;
+    pthread_mutex_unlock(&self->lock);
+    return PyLong_FromUnsignedLongLong(lost);
+}
+
+static PyMethodDef Stream_methods[] = {
+    {"close", (PyCFunction)Stream_close, METH_NOARGS, "Stop the acquisition thread and leave RDATAC."},
+    {"__enter__", (PyCFunction)Stream_enter, METH_NOARGS, NULL},
+    {"__exit__", (PyCFunction)Stream_exit, METH_VARARGS, NULL},
+    {NULL}
+};
+
+static PyGetSetDef Stream_getset[] = {
+    {"lost", (getter)Stream_get_lost, NULL, "Samples read while Python held every block.", NULL},
+    {NULL}
+};
+
+static PyTypeObject StreamType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "ads1256.Stream",
+    .tp_basicsize = sizeof(StreamObject),
+    .tp_dealloc = (destructor)Stream_dealloc,
+    .tp_iter = Stream_iter,
+    .tp_iternext = (iternextfunc)Stream_next,
+    .tp_methods = Stream_methods,
+    .tp_getset = Stream_getset,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Iterator of Blocks filled by a RDATAC thread, see Device.stream().",
+};
+
+/* Device */
+
+static void device_release(DeviceObject *self)
+{
+    ads125x_dev *dev = &self->dev;
+
+    if (!self->opened)
+        return;
+    if (self->running)
+        ads125xRDATACStop(dev);
+    if (dev->backend)
+        dev->backend->release(dev);
+    else
+    {
+        if (dev->pin_PDWN_line)
+            ads125xSetPDWN(dev, 0);
+        ads125xCloseDRDY(dev);
+        ads125xClosePDWN(dev);
+        if (dev->fd > 0)
+            SPIRelease(dev->fd);
+    }
+    self->opened = 0;
+    self->running = 0;
+}
+
+static int Device_init(DeviceObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"replay", "fast", "loop", "spi_channel", "spi_port", "vref", "wait_mode", NULL};
+    const char *replay = NULL;
+    int fast = 0, loop = 0, channel = 0, port = 0, wait_mode = -1, ret;
+    double vref = PY_VREF;
+    ads125x_dev *dev = &self->dev;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|zppiidi", kwlist, &replay, &fast, &loop,
+                                     &channel, &port, &vref, &wait_mode))
+        return -1;
+    device_release(self);
+    memset(dev, 0x00, sizeof(*dev));
+    dev->name = "ADS1256";
+    dev->fd = -1;
+    self->vref = vref;
+
+    if (replay)
+    {
+        if ((ret = ads125xReplayOpen(dev, replay, ADS125x_REPLAY_FMT_AUTO,
+                                     (fast ? ADS125x_REPLAY_FAST : ADS125x_REPLAY_PACED) | (loop ? ADS125x_REPLAY_LOOP : 0))))
+        {
+            raise_ret(ret, "Open replay");
+            return -1;
+        }
+    }
+    else
+    {
+        dev->spi_mode = ADS125x_SPI_MODE;
+        dev->spi_bit_p_word = ADS125x_SPI_BIT_P_WORD;
+        dev->spi_speed = ADS125x_SPI_SPEED;
+        if ((dev->fd = ads125xSetup(dev, channel, port)) < 0)
+        {
+            raise_ret(dev->fd, "SPI setup");
+            return -1;
+        }
+        self->opened = 1;
+        if ((ret = ads125xOpenDRDY(dev, ADS125x_DRDY_CHIP, ADS125x_DRDY_LINE)) ||
+            (ret = ads125xOpenPDWN(dev, ADS125x_PDWN_CHIP, ADS125x_PDWN_LINE, 0)))
+        {
+            device_release(self);
+            raise_ret(ret, "Open DRDY/PDWN");
+            return -1;
+        }
+        ads125xSetPDWN(dev, 1);
+    }
+    if (wait_mode >= 0)
+        dev->wait_mode = wait_mode;
+    dev->predict = &self->predict;
+    // A stream survives a glitch, the lost conversions are in recovery
+    dev->flags |= ADS125x_FLAG_RECOVER;
+    self->opened = 1;
+    return 0;
+}
+
+static void Device_dealloc(DeviceObject *self)
+{
+    device_release(self);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int device_check(DeviceObject *self)
+{
+    if (!self->opened)
+    {
+        PyErr_SetString(PyExc_ValueError, "device is closed");
+        return -1;
+    }
+    if (self->streaming)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "device is streaming, close the stream first");
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *Device_configure(DeviceObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"drate", "psel", "nsel", "pga", "calibrate", NULL};
+    int drate = ADS125x_DR_1000, psel = 0, nsel = 1, pga = 0, calibrate = 1, ret = ADS125x_OK;
+    uint8_t adcon;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|iiiip", kwlist, &drate, &psel, &nsel, &pga, &calibrate))
+        return NULL;
+    if (device_check(self))
+        return NULL;
+    if (drate < 0 || drate > 0xff || psel < 0 || psel > 8 || nsel < 0 || nsel > 8 || pga < 0 || pga > 6)
+    {
+        PyErr_SetString(PyExc_ValueError, "drate is a DR_* code, psel/nsel 0-8 (8 is AINCOM), pga 0-6 for gain 1-64");
+        return NULL;
+    }
+    adcon = ADS125x_ADCON_CLK_FEQIN | (uint8_t)pga;
+    Py_BEGIN_ALLOW_THREADS
+    if (self->running)
+        ads125xRDATACStop(&self->dev);
+    self->running = 0;
+    if ((ret = ads125xRESET(&self->dev)) == ADS125x_OK &&
+        (ret = ads125xWREG(&self->dev, ADS125x_REG_ADDR_ADCON, &adcon, 1)) == ADS125x_OK &&
+        (ret = ads125xSetDRATE(&self->dev, (uint8_t)drate)) == ADS125x_OK &&
+        (ret = ads125xSetMUX(&self->dev, (uint8_t)(psel << 4), (uint8_t)nsel)) == ADS125x_OK && calibrate)
+        ret = ads125xSELFCAL(&self->dev);
+    Py_END_ALLOW_THREADS
+    if (ret < 0)
+        return raise_ret(ret, "Configure");
+    Py_RETURN_NONE;
+}
+
+static int device_start(DeviceObject *self)
+{
+    int ret = ADS125x_OK;
+
+    if (self->running)
+        return ADS125x_OK;
+    Py_BEGIN_ALLOW_THREADS
+    ret = ads125xRDATACStart(&self->dev);
+    Py_END_ALLOW_THREADS
+    if (ret < 0)
+    {
+        raise_ret(ret, "RDATAC");
+        return -1;
+    }
+    self->running = 1;
+    return 0;
+}
+
+static PyObject *Device_read(DeviceObject *self, PyObject *args)
+{
+    Py_ssize_t n;
+    BlockObject *b;
+    int ret;
+
+    if (!PyArg_ParseTuple(args, "n", &n))
+        return NULL;
+    if (n <= 0 || n > INT_MAX)
+    {
+        PyErr_SetString(PyExc_ValueError, "n out of range");
+        return NULL;
+    }
+    if (device_check(self) || device_start(self))
+        return NULL;
+    if ((b = new_block(self, n)) == NULL)
+        return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    ret = read_block(&self->dev, b->codes, b->ts, (size_t)n);
+    Py_END_ALLOW_THREADS
+    if (ret < 0)
+    {
+        Py_DECREF(b);
+        return raise_ret(ret, "RDATAC read");
+    }
+    return (PyObject *)b;
+}
+
+static PyObject *Device_read_into(DeviceObject *self, PyObject *args)
+{
+    Py_buffer codes, ts = {0};
+    PyObject *ts_obj = NULL;
+    Py_ssize_t n;
+    int ret;
+
+    if (!PyArg_ParseTuple(args, "w*|O", &codes, &ts_obj))
+        return NULL;
+    n = codes.len / (Py_ssize_t)sizeof(int32_t);
+    if (ts_obj && ts_obj != Py_None && PyObject_GetBuffer(ts_obj, &ts, PyBUF_WRITABLE))
+    {
+        PyBuffer_Release(&codes);
+        return NULL;
+    }
+    if (n <= 0 || n > INT_MAX || (ts.buf && ts.len < n * (Py_ssize_t)sizeof(uint64_t)) ||
+        (codes.itemsize != 1 && codes.itemsize != 4))
+    {
+        PyErr_SetString(PyExc_ValueError, "codes must be a writable int32 buffer, ts one uint64 per code");
+        ret = -1;
+    }
+    else if (device_check(self) || device_start(self))
+        ret = -1;
+    else
+    {
+        Py_BEGIN_ALLOW_THREADS
+        if (ts.buf)
+            ret = read_block(&self->dev, codes.buf, ts.buf, (size_t)n);
+        else
+        {
+            uint8_t *raw = (uint8_t *)codes.buf + n;
+            Py_ssize_t i;
+
+            if ((ret = ads125xRDATACRead(&self->dev, raw, (int)n)) == ADS125x_OK)
+                for (i = 0; i < n; ++i)
+                    ((int32_t *)codes.buf)[i] = convert_to_signed_24bit(raw + 3 * i);
+        }
+        Py_END_ALLOW_THREADS
+        if (ret < 0)
+            raise_ret(ret, "RDATAC read");
+    }
+    PyBuffer_Release(&codes);
+    if (ts.buf)
+        PyBuffer_Release(&ts);
+    if (ret < 0)
+        return NULL;
+    return PyLong_FromSsize_t(n);
+}
+
+static PyObject *Device_burst(DeviceObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"n", "median", "drate", NULL};
+    int n, median = 0, drate = ADS125x_DR_30000, ret = ADS125x_OK;
+    ads125x_burst br;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i|pi", kwlist, &n, &median, &drate))
+        return NULL;
+    if (n < 1 || n > ADS125x_BURST_MAX || drate < 0 || drate > 0xff)
+    {
+        PyErr_Format(PyExc_ValueError, "n is 1-%d, drate a DR_* code", ADS125x_BURST_MAX);
+        return NULL;
+    }
+    if (device_check(self))
+        return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    if (self->running)
+        ret = ads125xRDATACStop(&self->dev);
+    self->running = 0;
+    if (ret == ADS125x_OK)
+        ret = ads125xBurstRead(&self->dev, (uint8_t)drate, n, median ? ADS125x_BURST_MEDIAN : ADS125x_BURST_MEAN, &br);
+    Py_END_ALLOW_THREADS
+    if (ret < 0)
+        return raise_ret(ret, "Burst read");
+    return Py_BuildValue("(ddd)", br.value, br.noise, br.latency_ns * 1e-9);
+}
+
+static PyObject *Device_stop(DeviceObject *self, PyObject *unused)
+{
+    int ret = ADS125x_OK;
+
+    if (device_check(self))
+        return NULL;
+    if (self->running)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        ret = ads125xRDATACStop(&self->dev);
+        Py_END_ALLOW_THREADS
+        self->running = 0;
+    }
+    if (ret < 0)
+        return raise_ret(ret, "SDATAC");
+    Py_RETURN_NONE;
+}
+
+static PyObject *Device_stream(DeviceObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"block", "blocks", NULL};
+    Py_ssize_t block = PY_STREAM_BLOCK;
+    int blocks = PY_STREAM_BLOCKS, i;
+    size_t bytes;
+    StreamObject *st;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|ni", kwlist, &block, &blocks))
+        return NULL;
+    if (block <= 0 || block > INT_MAX || blocks < 2)
+    {
+        PyErr_SetString(PyExc_ValueError, "block must be positive and blocks at least 2");
+        return NULL;
+    }
+    if (device_check(self) || device_start(self))
+        return NULL;
+    if ((st = PyObject_New(StreamObject, &StreamType)) == NULL)
+        return NULL;
+    Py_INCREF(self);
+    st->device = self;
+    st->block = (size_t)block;
+    st->nslots = blocks;
+    st->started = 0;
+    st->nfree = blocks;
+    st->ready_head = st->nready = 0;
+    st->stop = st->error = 0;
+    st->seq = self->dev.rdatac_count;
+    st->lost = 0;
+    pthread_mutex_init(&st->lock, NULL);
+    pthread_cond_init(&st->cond, NULL);
+    // Codes then timestamps of every slot, the scratch slot last
+    bytes = st->block * (sizeof(int32_t) + sizeof(uint64_t));
+    st->mem = PyMem_RawMalloc(bytes * (blocks + 1));
+    st->slots = PyMem_RawCalloc(blocks + 1, sizeof(*st->slots));
+    st->free_stack = PyMem_RawMalloc(blocks * sizeof(int));
+    st->ready = PyMem_RawMalloc(blocks * sizeof(int));
+    if (!st->mem || !st->slots || !st->free_stack || !st->ready)
+    {
+        Py_DECREF(st);
+        return PyErr_NoMemory();
+    }
+    for (i = 0; i <= blocks; ++i)
+    {
+        st->slots[i].ts = (uint64_t *)(st->mem + i * bytes);
+        st->slots[i].codes = (int32_t *)(st->mem + i * bytes + st->block * sizeof(uint64_t));
+        if (i < blocks)
+            st->free_stack[i] = blocks - 1 - i;
+    }
+    if (pthread_create(&st->thread, NULL, stream_run, st))
+    {
+        Py_DECREF(st);
+        PyErr_SetString(Ads1256Error, "start the acquisition thread failed");
+        return NULL;
+    }
+    st->started = 1;
+    self->streaming = 1;
+    return (PyObject *)st;
+}
+
+static PyObject *Device_close(DeviceObject *self, PyObject *unused)
+{
+    if (self->streaming)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "device is streaming, close the stream first");
+        return NULL;
+    }
+    device_release(self);
+    Py_RETURN_NONE;
+}
+
+static PyObject *Device_get_dropped(DeviceObject *self, void *closure)
+{
+    uint64_t dropped = self->dev.recovery.lost_samples;
+
+    if (self->opened && self->dev.backend)
+        dropped += ads125xReplayDropped(&self->dev);
+    return PyLong_FromUnsignedLongLong(dropped);
+}
+
+static PyObject *Device_get_sps(DeviceObject *self, void *closure)
+{
+    if (!(self->dev.regs_valid & (1 << ADS125x_REG_ADDR_DRATE)))
+        Py_RETURN_NONE;
+    return PyFloat_FromDouble(ads125xDRATEToSPS(self->dev.regs[ADS125x_REG_ADDR_DRATE]));
+}
+
+static PyMethodDef Device_methods[] = {
+    {"configure", (PyCFunction)(void (*)(void))Device_configure, METH_VARARGS | METH_KEYWORDS,
+     "configure(drate=DR_1000, psel=0, nsel=1, pga=0, calibrate=True)\n"
+     "RESET, program ADCON, DRATE and MUX, then SELFCAL."},
+    {"read", (PyCFunction)Device_read, METH_VARARGS,
+     "read(n) -> Block\nRead n samples in RDATAC, entering it if needed, without the GIL."},
+    {"read_into", (PyCFunction)Device_read_into, METH_VARARGS,
+     "read_into(codes, ts=None) -> n\nRead len(codes) samples straight into a writable int32 buffer."},
+    {"stream", (PyCFunction)(void (*)(void))Device_stream, METH_VARARGS | METH_KEYWORDS,
+     "stream(block=4096, blocks=16) -> Stream\nRDATAC on a thread into a pool of blocks."},
+    {"burst", (PyCFunction)(void (*)(void))Device_burst, METH_VARARGS | METH_KEYWORDS,
+     "burst(n, median=False, drate=DR_30000) -> (code, noise, latency)\n"
+     "Mean or median of n settled conversions, the expected noise of it in codes and the latency in s."},
+    {"stop", (PyCFunction)Device_stop, METH_NOARGS, "Leave RDATAC."},
+    {"close", (PyCFunction)Device_close, METH_NOARGS, "Release the SPI bus and the GPIO lines, or the replay."},
+    {NULL}
+};
+
+static PyGetSetDef Device_getset[] = {
+    {"dropped", (getter)Device_get_dropped, NULL, "Conversions missed by the reads.", NULL},
+    {"sps", (getter)Device_get_sps, NULL, "Data rate of the DRATE register.", NULL},
+    {NULL}
+};
+
+static PyTypeObject DeviceType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "ads1256.Device",
+    .tp_basicsize = sizeof(DeviceObject),
+    .tp_dealloc = (destructor)Device_dealloc,
+    .tp_init = (initproc)Device_init,
+    .tp_new = PyType_GenericNew,
+    .tp_methods = Device_methods,
+    .tp_getset = Device_getset,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Device(replay=None, fast=False, loop=False, spi_channel=0, spi_port=0, vref=2.5, wait_mode=-1)\n"
+              "An ADS125x on the board pins, or the emulator replaying a capture.",
+};
+
+static struct PyModuleDef ads1256module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "ads1256",
+    .m_doc = "TI ADS125x acquisition, samples as zero-copy buffers.",
+    .m_size = -1,
+};
+
+PyMODINIT_FUNC PyInit_ads1256(void)
+{
+    static const struct { const char *name; int value; } consts[] = {
+        {"DR_2_5", ADS125x_DR_2_5}, {"DR_5", ADS125x_DR_5}, {"DR_10", ADS125x_DR_10},
+        {"DR_15", ADS125x_DR_15}, {"DR_25", ADS125x_DR_25}, {"DR_30", ADS125x_DR_30},
+        {"DR_50", ADS125x_DR_50}, {"DR_60", ADS125x_DR_60}, {"DR_100", ADS125x_DR_100},
+        {"DR_500", ADS125x_DR_500}, {"DR_1000", ADS125x_DR_1000}, {"DR_2000", ADS125x_DR_2000},
+        {"DR_3750", ADS125x_DR_3750}, {"DR_7500", ADS125x_DR_7500}, {"DR_15000", ADS125x_DR_15000},
+        {"DR_30000", ADS125x_DR_30000},
+        {"WAIT_SPIN", ADS125x_WAIT_SPIN}, {"WAIT_YIELD", ADS125x_WAIT_YIELD},
+        {"WAIT_SLEEP", ADS125x_WAIT_SLEEP}, {"WAIT_PREDICT", ADS125x_WAIT_PREDICT},
+        {"AINCOM", 8},
+    };
+    PyObject *m;
+    size_t i;
+
+    if (PyType_Ready(&DeviceType) < 0 || PyType_Ready(&StreamType) < 0 ||
+        PyType_Ready(&BlockType) < 0 || PyType_Ready(&ViewType) < 0)
+        return NULL;
+    if ((m = PyModule_Create(&ads1256module)) == NULL)
+        return NULL;
+    if ((Ads1256Error = PyErr_NewException("ads1256.Error", PyExc_OSError, NULL)) == NULL ||
+        PyModule_AddObjectRef(m, "Error", Ads1256Error) < 0 ||
+        PyModule_AddObjectRef(m, "Device", (PyObject *)&DeviceType) < 0 ||
+        PyModule_AddObjectRef(m, "Stream", (PyObject *)&StreamType) < 0 ||
+        PyModule_AddObjectRef(m, "Block", (PyObject *)&BlockType) < 0)
+    {
+        Py_DECREF(m);
+        return NULL;
+    }
+    for (i = 0; i < sizeof(consts) / sizeof(consts[0]); ++i)
+        if (PyModule_AddIntConstant(m, consts[i].name, consts[i].value) < 0)
+        {
+            Py_DECREF(m);
+            return NULL;
+        }
+    return m;
+}
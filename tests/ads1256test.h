@@ -0,0 +1,116 @@
+/**
+ * ads1256test.h - Checks shared by the tests of libads1256
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#ifndef ADS1256TEST_H
+#define ADS1256TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libads1256.h"
+#include "libads1256reg.h"
+#include "libads1256replay.h"
+
+/**
+ * Every test is one program run by `make test`. A failed check prints
+ * where it failed and the test goes on, test_done() sets the exit code.
+ */
+#define TEST_SAMPLES 4096
+
+static int test_failures;
+
+#define TEST_CHECK(cond)                                                            \
+    do                                                                              \
+    {                                                                               \
+        if (!(cond))                                                                \
+        {                                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++;                                                        \
+        }                                                                           \
+    } while (0)
+
+// Calls returning ADS125x_OK, or 0 for the other libraries
+#define TEST_OK(call) TEST_CHECK((call) == 0)
+
+/**
+ * test_ramp - Fill @raw with @count 3-byte samples counting up from @first
+ */
+static inline void test_ramp(uint8_t *raw, size_t count, int32_t first)
+{
+    size_t i;
+    uint32_t v;
+
+    for (i = 0; i < count; ++i)
+    {
+        v = (uint32_t)(first + (int32_t)i);
+        raw[3 * i] = (uint8_t)(v >> 16);
+        raw[3 * i + 1] = (uint8_t)(v >> 8);
+        raw[3 * i + 2] = (uint8_t)v;
+    }
+    return;
+}
+
+/**
+ * test_open - Open a replay of @count ramp samples and set it up like the CLI
+ * @flags: ADS125x_REPLAY_* flags.
+ *
+ * @return: 0 success, 1 is the replay could not be set up.
+ */
+static inline int test_open(ads125x_dev *dev, uint8_t *raw, size_t count, int flags)
+{
+    memset(dev, 0x00, sizeof(*dev));
+    dev->name = (char *)"ADS1256";
+    test_ramp(raw, count, 0);
+    if (ads125xReplayOpenBuffer(dev, raw, count, flags))
+        return 1;
+    if (ads125xRESET(dev) < 0 || ads125xSetDRATE(dev, ADS125x_DR_30000) < 0 ||
+        ads125xSetMUX(dev, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1) < 0 || ads125xSELFCAL(dev) < 0)
+    {
+        ads125xReplayClose(dev);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * test_done - Report the result of the test program
+ *
+ * @return: The exit code, EXIT_FAILURE if a check failed.
+ */
+static inline int test_done(const char *name)
+{
+    fprintf(stderr, "%-10s %s\n", name, test_failures ? "FAILED" : "ok");
+    return test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,189 @@
+/**
+ * test_align.c - Test of the clock estimate and the merger on simulated clocks
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <math.h>
+#include "ads1256test.h"
+#include "libads1256align.h"
+
+#define ALIGN_SAMPLES   20000
+#define ALIGN_BLOCK     50
+#define ALIGN_SPS       1000.0
+#define ALIGN_JITTER    20000       // Late by 0 ~ 20 us
+#define ALIGN_OUTLIER   97          // Every 97th timestamp is late by 400 us
+#define ALIGN_DROP      499         // Every 499th conversion is missed
+#define ALIGN_FRAMES    (ALIGN_SAMPLES + 64)
+
+static const double ppm[2] = {40, -60};
+static const uint64_t start_ns[2] = {1000000000000ULL, 1000000333333ULL};
+
+static int32_t codes[2][ALIGN_SAMPLES];
+static uint64_t ts[2][ALIGN_SAMPLES];
+static uint64_t frame_ns[ALIGN_FRAMES];
+static double frames[ALIGN_FRAMES * 2];
+
+/**
+ * align_input - The true input of device @d at @t_ns, a 2 Hz sine
+ */
+static double align_input(int d, double t_ns)
+{
+    return 1e6 * sin(2 * M_PI * 2 * t_ns * 1e-9 + d);
+}
+
+/**
+ * align_simulate - Fill codes and ts of device @d
+ * @outliers: Used to store the number of very late timestamps.
+ *
+ * The chip converts every 1e9 / ALIGN_SPS / (1 + ppm) ns, the reader
+ * stamps each sample late, sometimes much later, and misses some.
+ *
+ * @return: The number of missed conversions.
+ */
+static uint64_t align_simulate(int d, uint32_t seed, uint64_t *outliers)
+{
+    double period = 1e9 / ALIGN_SPS / (1 + ppm[d] * 1e-6), t;
+    uint64_t missed = 0;
+    size_t k, n = 0;
+
+    *outliers = 0;
+    for (k = 0; n < ALIGN_SAMPLES; ++k)
+    {
+        if (k % ALIGN_DROP == ALIGN_DROP - 1)
+        {
+            ++missed;
+            continue;
+        }
+        seed = seed * 1664525 + 1013904223;
+        t = k * period;
+        codes[d][n] = (int32_t)lround(align_input(d, t));
+        ts[d][n] = start_ns[d] + (uint64_t)llround(t) + (seed >> 8) % ALIGN_JITTER;
+        if (k % ALIGN_OUTLIER == ALIGN_OUTLIER - 1)
+        {
+            ts[d][n] += 400000;
+            ++*outliers;
+        }
+        ++n;
+    }
+    return missed;
+}
+
+/**
+ * align_error - Worst error of device @d in the frames, against the input
+ * @gap: Used to store the worst error next to a missed conversion.
+ *
+ * The estimate follows the mean lateness of the timestamps, half the
+ * jitter. Frames before the clocks lock are skipped.
+ */
+static double align_error(int d, size_t n, double *gap)
+{
+    double period = 1e9 / ALIGN_SPS / (1 + ppm[d] * 1e-6), t, k, e, worst = 0;
+    size_t i;
+
+    *gap = 0;
+    for (i = ADS125x_CLOCK_LOCK_SAMPLES; i < n; ++i)
+    {
+        t = (double)(int64_t)(frame_ns[i] - start_ns[d]) - ALIGN_JITTER / 2;
+        e = fabs(frames[2 * i + d] - align_input(d, t));
+        // Samples from k - 2 to k + 2 take part
+        k = fmod(t / period + 1, ALIGN_DROP);
+        if (k < 3 || k > ALIGN_DROP - 3)
+            *gap = e > *gap ? e : *gap;
+        else
+            worst = e > worst ? e : worst;
+    }
+    return worst;
+}
+
+int main(void)
+{
+    const double sps[2] = {ALIGN_SPS, ALIGN_SPS};
+    const ads125x_clock *c;
+    ads125x_merge *m;
+    ads125x_clock one;
+    uint64_t missed[2], outliers[2];
+    double e, gap;
+    size_t n = 0, i, at;
+    int d;
+
+    TEST_CHECK(ads125xMergeOpen(0, sps, ALIGN_SPS) == NULL);
+    TEST_CHECK(ads125xMergeOpen(2, sps, 0) == NULL);
+    TEST_CHECK((m = ads125xMergeOpen(2, sps, ALIGN_SPS)) != NULL);
+    if (m == NULL)
+        return test_done("align");
+    TEST_CHECK(ads125xMergeClock(m, 2) == NULL);
+    TEST_CHECK(ads125xMergePush(m, 2, codes[0], ts[0], 1) == 1);
+    for (d = 0; d < 2; ++d)
+        missed[d] = align_simulate(d, 12345 + d, &outliers[d]);
+
+    // A single clock on exact timestamps takes the nominal period
+    ads125xClockInit(&one, ALIGN_SPS);
+    for (i = 0; i < 8; ++i)
+        TEST_CHECK(ads125xClockUpdate(&one, start_ns[0] + i * 1000000) == i);
+    TEST_CHECK(ads125xClockUpdate(&one, start_ns[0] + 10 * 1000000) == 10);
+    TEST_CHECK(one.missed == 2 && one.clipped == 0 && !ads125xClockLocked(&one));
+    TEST_CHECK(fabs(ads125xClockPPM(&one)) < 1e-6);
+    TEST_CHECK(fabs(ads125xClockTime(&one, 12) - 12e6) < 1e-3);
+
+    // Push the devices in turn and pull what is ready
+    TEST_CHECK(ads125xMergePull(m, frame_ns, frames, ALIGN_FRAMES) == 0);
+    for (at = 0; at < ALIGN_SAMPLES; at += ALIGN_BLOCK)
+    {
+        for (d = 0; d < 2; ++d)
+            TEST_OK(ads125xMergePush(m, d, codes[d] + at, ts[d] + at, ALIGN_BLOCK));
+        n += ads125xMergePull(m, frame_ns + n, frames + 2 * n, ALIGN_FRAMES - n);
+    }
+
+    for (d = 0; d < 2; ++d)
+    {
+        c = ads125xMergeClock(m, d);
+        TEST_CHECK(ads125xClockLocked(c));
+        TEST_CHECK(fabs(ads125xClockPPM(c) - ppm[d]) < 1);
+        TEST_CHECK(c->samples == ALIGN_SAMPLES);
+        TEST_CHECK(c->missed == missed[d]);
+        TEST_CHECK(c->index == ALIGN_SAMPLES - 1 + missed[d]);
+        // Every outlier and only a few more while the estimate settles
+        TEST_CHECK(c->clipped >= outliers[d] && c->clipped < outliers[d] + 32);
+        TEST_CHECK(c->jitter_ns > 0 && c->jitter_ns < ALIGN_JITTER);
+        e = align_error(d, n, &gap);
+        TEST_CHECK(e < 50);
+        // A missed conversion holds the previous value
+        TEST_CHECK(gap < 1e6 * 2 * M_PI * 2 / ALIGN_SPS);
+    }
+
+    // A frame every ms from the later start up to the last common sample
+    TEST_CHECK(n > ALIGN_SAMPLES + missed[0] - 2 * ALIGN_BLOCK && n <= ALIGN_SAMPLES + missed[0]);
+    TEST_CHECK(frame_ns[0] >= start_ns[1] + 1000000 && frame_ns[0] < start_ns[1] + 1100000);
+    for (i = 1; i < n; ++i)
+        TEST_CHECK(frame_ns[i] - frame_ns[i - 1] >= 999999 && frame_ns[i] - frame_ns[i - 1] <= 1000001);
+    ads125xMergeClose(m);
+    return test_done("align");
+}
@@ -0,0 +1,172 @@
+/**
+ * test_burst.c - Test of the burst one-shot read on replay devices
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <math.h>
+#include "ads1256test.h"
+
+#define BURST_PERIOD    16          // The input repeats, any burst of a multiple sees the same codes
+#define BURST_LEVEL     1000
+#define BURST_SPIKE     100000
+#define BURST_COUNT     (4 * BURST_PERIOD)
+
+static uint8_t raw[TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+static int32_t sorted[BURST_COUNT];
+
+/**
+ * burst_input - The replayed input at @i
+ *
+ * Noise of -7 ~ 7 codes around BURST_LEVEL and one spike per period.
+ */
+static int32_t burst_input(size_t i)
+{
+    int j = (int)(i % BURST_PERIOD);
+
+    return j == BURST_PERIOD - 1 ? BURST_LEVEL + BURST_SPIKE : BURST_LEVEL + j * 7 % 15 - 7;
+}
+
+static int burst_cmp(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * burst_median - Median of @n codes by sorting, the mean of the middle two for even @n
+ */
+static double burst_median(int32_t *codes, int n)
+{
+    qsort(codes, n, sizeof(*codes), burst_cmp);
+    return n % 2 ? codes[n / 2] : ((double)codes[n / 2 - 1] + codes[n / 2]) / 2;
+}
+
+/**
+ * burst_open - Open a replay of the burst input at DR_30000
+ */
+static int burst_open(ads125x_dev *dev)
+{
+    size_t i;
+
+    memset(dev, 0x00, sizeof(*dev));
+    dev->name = (char *)"ADS1256";
+    for (i = 0; i < TEST_SAMPLES; ++i)
+    {
+        raw[3 * i] = (uint8_t)((uint32_t)burst_input(i) >> 16);
+        raw[3 * i + 1] = (uint8_t)((uint32_t)burst_input(i) >> 8);
+        raw[3 * i + 2] = (uint8_t)burst_input(i);
+    }
+    if (ads125xReplayOpenBuffer(dev, raw, TEST_SAMPLES, ADS125x_REPLAY_FAST | ADS125x_REPLAY_LOOP))
+        return 1;
+    if (ads125xRESET(dev) < 0 || ads125xSetDRATE(dev, ADS125x_DR_30000) < 0 ||
+        ads125xSetMUX(dev, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1) < 0)
+    {
+        ads125xReplayClose(dev);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * burst_check_drate - The DRATE of the chip and of the cache is @dr
+ */
+static void burst_check_drate(ads125x_dev *dev, uint8_t dr)
+{
+    uint8_t reg = 0;
+
+    TEST_CHECK(dev->regs[ADS125x_REG_ADDR_DRATE] == dr);
+    TEST_OK(ads125xRREG(dev, ADS125x_REG_ADDR_DRATE, &reg, 1));
+    TEST_CHECK(reg == dr);
+    return;
+}
+
+int main(void)
+{
+    ads125x_burst mean, median, one;
+    ads125x_dev dev;
+    double sum = 0, sq = 0, med;
+    int i;
+
+    if (burst_open(&dev))
+    {
+        TEST_CHECK(0);
+        return test_done("burst");
+    }
+    TEST_CHECK(ads125xBurstRead(&dev, ADS125x_DR_1000, 0, ADS125x_BURST_MEAN, &mean) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xBurstRead(&dev, ADS125x_DR_1000, ADS125x_BURST_MAX + 1, ADS125x_BURST_MEAN, &mean) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xBurstRead(&dev, 0x42, BURST_COUNT, ADS125x_BURST_MEAN, &mean) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xBurstRead(&dev, ADS125x_DR_1000, BURST_COUNT, 2, &mean) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xBurstLatencyUs(0x42, BURST_COUNT) == 0);
+    TEST_CHECK(ads125xBurstLatencyUs(ADS125x_DR_1000, BURST_COUNT) == 1180 + (BURST_COUNT + 1) * 1000);
+
+    // Mean and standard deviation over the codes, spikes included
+    for (i = 0; i < BURST_COUNT; ++i)
+    {
+        sorted[i] = burst_input(i);
+        sum += sorted[i];
+    }
+    for (i = 0; i < BURST_COUNT; ++i)
+        sq += (sorted[i] - sum / BURST_COUNT) * (sorted[i] - sum / BURST_COUNT);
+    TEST_OK(ads125xBurstRead(&dev, ADS125x_DR_1000, BURST_COUNT, ADS125x_BURST_MEAN, &mean));
+    TEST_CHECK(mean.count == BURST_COUNT);
+    TEST_CHECK(fabs(mean.value - sum / BURST_COUNT) < 1e-9);
+    TEST_CHECK(fabs(mean.noise_rms - sqrt(sq / (BURST_COUNT - 1))) < 1e-6);
+    TEST_CHECK(fabs(mean.noise - mean.noise_rms / sqrt(BURST_COUNT)) < 1e-9);
+    TEST_CHECK(mean.latency_ns > 0);
+    burst_check_drate(&dev, ADS125x_DR_30000);
+
+    // The median and the median absolute deviation reject the spikes
+    med = burst_median(sorted, BURST_COUNT);
+    for (i = 0; i < BURST_COUNT; ++i)
+        sorted[i] = abs(sorted[i] - (int32_t)med);
+    TEST_OK(ads125xBurstRead(&dev, ADS125x_DR_1000, BURST_COUNT, ADS125x_BURST_MEDIAN, &median));
+    TEST_CHECK(median.count == BURST_COUNT);
+    TEST_CHECK(median.value == med);
+    TEST_CHECK(fabs(median.value - BURST_LEVEL) <= 1);
+    TEST_CHECK(fabs(median.noise_rms - 1.4826 * burst_median(sorted, BURST_COUNT)) < 1e-9);
+    TEST_CHECK(median.noise_rms < 15 && mean.noise_rms > 1000 * median.noise_rms);
+    TEST_CHECK(fabs(median.noise - median.noise_rms / sqrt(BURST_COUNT) * sqrt(M_PI / 2)) < 1e-9);
+    burst_check_drate(&dev, ADS125x_DR_30000);
+
+    // An odd count, at the DRATE already set
+    TEST_OK(ads125xBurstRead(&dev, ADS125x_DR_30000, 1, ADS125x_BURST_MEDIAN, &one));
+    TEST_CHECK(one.count == 1 && one.noise_rms == 0);
+    burst_check_drate(&dev, ADS125x_DR_30000);
+
+    // A read failing in the middle of the burst
+    TEST_OK(ads125xReplayInjectFault(&dev, ADS125x_FAULT_XFER, 10, 1));
+    TEST_CHECK(ads125xBurstRead(&dev, ADS125x_DR_1000, BURST_COUNT, ADS125x_BURST_MEAN, &mean) < 0);
+    TEST_CHECK(!dev.rdatac);
+    burst_check_drate(&dev, ADS125x_DR_30000);
+    ads125xReplayClose(&dev);
+    return test_done("burst");
+}
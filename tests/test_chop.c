@@ -0,0 +1,159 @@
+/**
+ * test_chop.c - Test of the input-swap chopping mode on replay devices
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <math.h>
+#include "ads1256test.h"
+
+#define CHOP_INPUT      100000      // Input in codes
+#define CHOP_OFFSET     -20000      // Emulated offset of the chip
+#define CHOP_DRIFT      5000.0      // Its drift, codes per second
+#define CHOP_PAIRS      200
+
+static uint8_t raw[TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+static int32_t data[CHOP_PAIRS];
+static uint64_t ts[CHOP_PAIRS];
+
+/**
+ * chop_open - Open a replay of a constant input at @dr
+ * @flags: ADS125x_REPLAY_* flags.
+ *
+ * @return: 0 success, 1 is the replay could not be set up.
+ */
+static int chop_open(ads125x_dev *dev, uint8_t dr, int flags)
+{
+    size_t i;
+
+    memset(dev, 0x00, sizeof(*dev));
+    dev->name = (char *)"ADS1256";
+    for (i = 0; i < TEST_SAMPLES; ++i)
+    {
+        raw[3 * i] = (uint8_t)(CHOP_INPUT >> 16);
+        raw[3 * i + 1] = (uint8_t)(CHOP_INPUT >> 8);
+        raw[3 * i + 2] = (uint8_t)CHOP_INPUT;
+    }
+    if (ads125xReplayOpenBuffer(dev, raw, TEST_SAMPLES, flags | ADS125x_REPLAY_LOOP))
+        return 1;
+    if (ads125xRESET(dev) < 0 || ads125xSetDRATE(dev, dr) < 0 ||
+        ads125xSetMUX(dev, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1) < 0 ||
+        ads125xReplaySetOffset(dev, CHOP_OFFSET, CHOP_DRIFT))
+    {
+        ads125xReplayClose(dev);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * chop_run - Chop @pairs results at @dr and check them
+ * @flags: ADS125x_REPLAY_* flags.
+ *
+ * The offset and its drift over a pair cancel in the results, the
+ * offset shows up in the statistics.
+ *
+ * @return: The chopped rate from ads125xChopGetStats().
+ */
+static double chop_run(uint8_t dr, int flags, int pairs)
+{
+    ads125x_chop_stats stats;
+    ads125x_chop chop;
+    ads125x_dev dev;
+    uint64_t start;
+    double sum = 0, drift;
+    uint8_t mux = 0;
+    int i;
+
+    if (chop_open(&dev, dr, flags))
+    {
+        TEST_CHECK(0);
+        return 0;
+    }
+    start = ads125xNowNs();
+    TEST_OK(ads125xChopStart(&dev, &chop, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1));
+    TEST_CHECK(chop.mux[0] == (ADS125x_MUX_PSEL_CH0 | ADS125x_MUX_NSEL_CH1));
+    TEST_CHECK(chop.mux[1] == (ADS125x_MUX_PSEL_CH1 | ADS125x_MUX_NSEL_CH0));
+    TEST_CHECK(ads125xChopRead(&dev, &chop, data, ts, pairs) == ADS125x_OK);
+    ads125xChopGetStats(&chop, &stats);
+    // Offset change over the run and over the two conversions of a pair
+    drift = CHOP_DRIFT * (ads125xNowNs() - start) * 1e-9;
+    for (i = 0; i < pairs; ++i)
+    {
+        sum += data[i];
+        if (i)
+            TEST_CHECK(ts[i] > ts[i - 1]);
+    }
+    TEST_CHECK(fabs(sum / pairs - CHOP_INPUT) <= 1 + CHOP_DRIFT * 2 * ads125xDRATEToSettleUs(dr) * 1e-6);
+    TEST_CHECK(stats.pairs == (uint64_t)pairs);
+    TEST_CHECK(stats.offset >= CHOP_OFFSET - 1 && stats.offset <= CHOP_OFFSET + drift + 1);
+    TEST_CHECK(stats.noise_rms <= 1 + CHOP_DRIFT * 2 * ads125xDRATEToSettleUs(dr) * 1e-6);
+    TEST_CHECK(stats.rate_sps > 0);
+
+    // Back to (P,N) on the chip and in the cache
+    TEST_OK(ads125xChopStop(&dev, &chop));
+    TEST_CHECK(dev.regs[ADS125x_REG_ADDR_MUX] == (ADS125x_MUX_PSEL_CH0 | ADS125x_MUX_NSEL_CH1));
+    TEST_OK(ads125xRREG(&dev, ADS125x_REG_ADDR_MUX, &mux, 1));
+    TEST_CHECK(mux == (ADS125x_MUX_PSEL_CH0 | ADS125x_MUX_NSEL_CH1));
+    ads125xReplayClose(&dev);
+    return stats.rate_sps;
+}
+
+/**
+ * chop_check_rate - Check the chopped rate on a paced replay against 1 / (2 * settling time)
+ */
+static void chop_check_rate(uint8_t dr, int pairs)
+{
+    double rate = chop_run(dr, ADS125x_REPLAY_PACED, pairs), max = 1e6 / (2 * ads125xDRATEToSettleUs(dr));
+
+    TEST_CHECK(rate <= max * 1.01 && rate > max * 0.8);
+    return;
+}
+
+int main(void)
+{
+    ads125x_chop chop;
+    ads125x_dev dev;
+
+    chop_run(ADS125x_DR_30000, ADS125x_REPLAY_FAST, CHOP_PAIRS);
+
+    // At most 424 SPS at 1 kSPS, 1.61 kSPS at 7.5 kSPS, 2.38 kSPS at 30 kSPS
+    chop_check_rate(ADS125x_DR_1000, 50);
+    chop_check_rate(ADS125x_DR_7500, CHOP_PAIRS);
+    chop_check_rate(ADS125x_DR_30000, CHOP_PAIRS);
+
+    // Not in RDATAC mode
+    TEST_CHECK(chop_open(&dev, ADS125x_DR_30000, ADS125x_REPLAY_FAST) == 0);
+    TEST_OK(ads125xRDATACStart(&dev));
+    TEST_CHECK(ads125xChopStart(&dev, &chop, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1) == ADS125x_ERR_INVAL);
+    TEST_OK(ads125xRDATACStop(&dev));
+    ads125xReplayClose(&dev);
+    return test_done("chop");
+}
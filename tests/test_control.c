@@ -0,0 +1,208 @@
+/**
+ * test_control.c - Test of the closed-loop control mode on a replay device
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <time.h>
+#include "ads1256test.h"
+
+#define CONTROL_CALLS   200
+#define CONTROL_PERIOD  1000000     // DR_1000
+#define CONTROL_SLOW    50          // This call sleeps 4.5 periods, losing 3 or more conversions
+#define CONTROL_LATE    20          // Every this call sleeps past the deadline
+
+static uint8_t raw[TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+
+/**
+ * control_arg - What the callback saw
+ * @calls: Calls so far.
+ * @stop: Return this on call @stop_at.
+ * @slow: Sleep 4.5 periods on this call, 0 is never.
+ * @late_ns: Sleep this long on every CONTROL_LATE call, 0 is never.
+ * @slept: Calls that slept @late_ns.
+ * @lat_ns: Entry time less DRDY, the run measures it a bit earlier.
+ */
+typedef struct control_arg_struct
+{
+    uint64_t calls;
+    uint64_t stop_at;
+    int stop;
+    uint64_t slow;
+    uint64_t late_ns;
+    uint64_t slept;
+    int32_t codes[CONTROL_CALLS];
+    uint64_t ts[CONTROL_CALLS];
+    uint64_t lat_ns[CONTROL_CALLS];
+} control_arg;
+
+static control_arg arg;
+
+static void control_sleep(uint64_t ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = ns / 1000000000ULL;
+    ts.tv_nsec = ns % 1000000000ULL;
+    nanosleep(&ts, NULL);
+    return;
+}
+
+static int control_fn(void *p, int32_t code, uint64_t ts)
+{
+    control_arg *a = (control_arg *)p;
+    uint64_t i = a->calls++;
+
+    if (i < CONTROL_CALLS)
+    {
+        a->lat_ns[i] = ads125xNowNs() - ts;
+        a->codes[i] = code;
+        a->ts[i] = ts;
+    }
+    if (a->slow && i + 1 == a->slow)
+        control_sleep(CONTROL_PERIOD * 9 / 2);
+    if (a->late_ns && (i + 1) % CONTROL_LATE == 0)
+    {
+        control_sleep(a->late_ns);
+        a->slept++;
+    }
+    return a->calls == a->stop_at ? a->stop : 0;
+}
+
+/**
+ * control_run - Run @count calls with a fresh @arg
+ */
+static int control_run(ads125x_dev *dev, ads125x_control *c, uint64_t deadline_ns, uint64_t count)
+{
+    arg.calls = arg.slept = 0;
+    return ads125xControlRun(dev, c, control_fn, &arg, deadline_ns, count);
+}
+
+/**
+ * control_overruns - Conversions lost, from the DRDY gaps seen by the callback
+ */
+static uint64_t control_overruns(uint64_t n)
+{
+    uint64_t i, gap, lost = 0;
+
+    for (i = 1; i < n; ++i)
+        if ((gap = arg.ts[i] - arg.ts[i - 1]) > CONTROL_PERIOD + CONTROL_PERIOD / 2)
+            lost += (gap + CONTROL_PERIOD / 2) / CONTROL_PERIOD - 1;
+    return lost;
+}
+
+/**
+ * control_check_stats - The accounting adds up the calls of the run
+ */
+static void control_check_stats(const ads125x_control *c)
+{
+    ads125x_control_stats st;
+    uint64_t i, seen = 0, lat_sum = 0, lat_max = 0;
+
+    for (i = 0; i < ADS125x_CONTROL_BUCKETS; ++i)
+        seen += c->hist[i];
+    TEST_CHECK(seen == c->calls && c->calls == arg.calls);
+    // The run takes its time before the call, the callback a bit later
+    for (i = 0; i < c->calls; ++i)
+    {
+        lat_sum += arg.lat_ns[i];
+        lat_max = arg.lat_ns[i] > lat_max ? arg.lat_ns[i] : lat_max;
+    }
+    TEST_CHECK(c->lat_sum_ns <= lat_sum && c->lat_max_ns <= lat_max && c->lat_max_ns <= c->done_max_ns);
+    // The largest latency is in its bucket, none above it
+    i = c->lat_max_ns / ADS125x_CONTROL_BUCKET_NS;
+    i = i < ADS125x_CONTROL_BUCKETS ? i : ADS125x_CONTROL_BUCKETS - 1;
+    TEST_CHECK(c->hist[i] > 0);
+    for (++i; i < ADS125x_CONTROL_BUCKETS; ++i)
+        TEST_CHECK(c->hist[i] == 0);
+
+    ads125xControlGetStats(c, &st);
+    TEST_CHECK(st.calls == c->calls && st.misses == c->misses && st.overruns == c->overruns);
+    TEST_CHECK(st.lat_p50_us <= st.lat_p99_us && st.lat_p99_us <= st.lat_max_us);
+    TEST_CHECK(st.lat_mean_us <= st.lat_max_us && st.lat_max_us <= st.done_max_us);
+    return;
+}
+
+int main(void)
+{
+    ads125x_control c;
+    ads125x_dev dev;
+    uint64_t i, lost;
+
+    if (test_open(&dev, raw, TEST_SAMPLES, ADS125x_REPLAY_PACED))
+    {
+        TEST_CHECK(!"open the replay");
+        return test_done("control");
+    }
+    TEST_OK(ads125xSetDRATE(&dev, ADS125x_DR_1000));
+    TEST_CHECK(ads125xControlRun(&dev, &c, NULL, &arg, 0, 1) == ADS125x_ERR_INVAL);
+
+    // Every conversion once, in order, the lost ones counted as overruns
+    arg.slow = CONTROL_SLOW;
+    TEST_OK(control_run(&dev, &c, 0, CONTROL_CALLS));
+    TEST_CHECK(!dev.rdatac && c.calls == CONTROL_CALLS && c.misses == 0);
+    lost = control_overruns(CONTROL_CALLS);
+    TEST_CHECK(c.overruns == lost && lost >= 3);
+    // The codes skip the lost conversions, a DRDY read just before a newer one may be one off
+    TEST_CHECK(arg.codes[CONTROL_SLOW] - arg.codes[CONTROL_SLOW - 1] >= 3);
+    for (i = 1; i < CONTROL_CALLS; ++i)
+        TEST_CHECK(arg.codes[i] > arg.codes[i - 1]);
+    TEST_CHECK((uint64_t)(arg.codes[CONTROL_CALLS - 1] - arg.codes[0]) - (CONTROL_CALLS - 1) + 1 >= lost);
+    control_check_stats(&c);
+    arg.slow = 0;
+
+    // Sleeping past the deadline misses it
+    arg.late_ns = CONTROL_PERIOD / 2;
+    TEST_OK(control_run(&dev, &c, CONTROL_PERIOD / 4, CONTROL_CALLS));
+    TEST_CHECK(c.deadline_ns == CONTROL_PERIOD / 4 && arg.slept == CONTROL_CALLS / CONTROL_LATE);
+    TEST_CHECK(c.misses >= arg.slept && c.misses <= c.calls);
+    TEST_CHECK(c.done_max_ns >= CONTROL_PERIOD / 2);
+    control_check_stats(&c);
+    arg.late_ns = 0;
+
+    // Stop when the callback asks, with its error
+    arg.stop_at = 30;
+    arg.stop = 1;
+    TEST_OK(control_run(&dev, &c, 0, 0));
+    TEST_CHECK(!dev.rdatac && c.calls == 30 && arg.calls == 30);
+    arg.stop = ADS125x_ERR_IO;
+    TEST_CHECK(control_run(&dev, &c, 0, CONTROL_CALLS) == ADS125x_ERR_IO);
+    TEST_CHECK(!dev.rdatac && c.calls == 30);
+    control_check_stats(&c);
+    arg.stop_at = 0;
+
+    // With the DRATE not cached the lost conversions are not counted
+    dev.regs_valid &= ~(1 << ADS125x_REG_ADDR_DRATE);
+    arg.slow = 10;
+    TEST_OK(control_run(&dev, &c, 0, 20));
+    TEST_CHECK(c.calls == 20 && c.overruns == 0 && control_overruns(20) >= 3);
+    ads125xReplayClose(&dev);
+    return test_done("control");
+}
@@ -0,0 +1,146 @@
+/**
+ * test_coro.cpp - Test of the coroutine interface on emulated devices
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include "ads1256test.h"
+#include "libads1256coro.hpp"
+
+using Dev = ads125x::Device<>;
+using AsyncDev = ads125x::AsyncDevice<>;
+
+static uint8_t raw[2][TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+
+// Counts the frames freed, done or destroyed, as a parameter it lives in the frame
+struct Guard
+{
+    int *freed;
+
+    explicit Guard(int *f) : freed(f) {}
+    Guard(Guard &&other) noexcept : freed(std::exchange(other.freed, nullptr)) {}
+    ~Guard()
+    {
+        if (freed)
+            ++*freed;
+    }
+};
+
+// A fast replay serves every sample in order, a paced one keeps the data rate
+static Dev emulate(uint8_t *buf, int32_t first, ads125x::DataRate rate, int flags)
+{
+    Dev dev = Dev::emulate((test_ramp(buf, TEST_SAMPLES, first), buf), TEST_SAMPLES, flags);
+
+    dev.reset();
+    dev.set_rate(rate);
+    dev.set_mux(ads125x::Input::AIN0, ads125x::Input::AIN1);
+    return dev;
+}
+
+// The n-th sample of a device is first + n
+static ads125x::Task<void> consume(AsyncDev &adc, int32_t first, int *done)
+{
+    int32_t one = co_await adc.read_one();
+    std::vector<int32_t> block = co_await adc.next_block(200);
+    std::size_t i, bad = 0;
+
+    TEST_CHECK(one == first);
+    for (i = 0; i < block.size(); ++i)
+        bad += block[i] != first + 1 + (int32_t)i;
+    TEST_CHECK(bad == 0);
+    ++*done;
+}
+
+static ads125x::Task<void> fail(AsyncDev &adc)
+{
+    co_await adc.read_one();
+    throw ads125x::Error("injected", ADS125x_ERR_IO);
+}
+
+// Waits far longer than the test runs
+static ads125x::Task<void> park(AsyncDev &adc, Guard guard)
+{
+    co_await adc.next_block(TEST_SAMPLES);
+}
+
+int main()
+{
+    int done = 0, freed = 0, thrown = 0;
+
+    try
+    {
+        ads125x::EventLoop loop;
+        Dev fast = emulate(raw[0], 0, ads125x::DataRate::SPS_30000, ADS125x_REPLAY_FAST);
+        Dev slow = emulate(raw[1], 100000, ads125x::DataRate::SPS_2_5, ADS125x_REPLAY_PACED);
+
+        // Two devices driven by one thread
+        {
+            Dev other = emulate(raw[1], -5000, ads125x::DataRate::SPS_7500, ADS125x_REPLAY_FAST);
+            AsyncDev a(loop, fast), b(loop, other);
+
+            loop.spawn(consume(a, 0, &done));
+            loop.spawn(consume(b, -5000, &done));
+            loop.run();
+            TEST_CHECK(done == 2);
+        }
+
+        // A failed task stops run(), the one still waiting is destroyed
+        {
+            AsyncDev a(loop, fast), b(loop, slow);
+
+            loop.spawn(park(b, Guard(&freed)));
+            loop.spawn(fail(a));
+            try
+            {
+                loop.run();
+            }
+            catch (const ads125x::Error &e)
+            {
+                thrown = e.code() == ADS125x_ERR_IO;
+            }
+            TEST_CHECK(thrown && freed == 1);
+
+            // and the loop runs again, after the 201 + 1 samples read
+            loop.spawn(consume(a, 202, &done));
+            loop.run();
+            TEST_CHECK(done == 3);
+
+            // Tasks never run are destroyed with the loop
+            loop.spawn(park(b, Guard(&freed)));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        TEST_CHECK(!"no exception");
+    }
+    TEST_CHECK(freed == 2);
+    return test_done("coro");
+}
@@ -0,0 +1,200 @@
+/**
+ * test_detect.c - Test of the event detector on a replayed stream
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include "ads1256test.h"
+#include "libads1256detect.h"
+
+#define DETECT_SAMPLES  8192
+#define DETECT_CHUNK    1000
+#define DETECT_SPIKE    1500
+#define DETECT_STEP_UP  3000
+#define DETECT_STEP_DN  4500
+#define DETECT_LEVEL    5500
+#define DETECT_FLAT     7700
+#define DETECT_EVENTS   16
+
+static uint8_t raw[DETECT_SAMPLES * ADS125x_DATA_LEN_BYTE];
+static int32_t codes[DETECT_SAMPLES];
+static uint64_t ts[DETECT_SAMPLES];
+
+/**
+ * detect_input - The replayed input at @i
+ *
+ * A triangle of 0 ~ 1000 codes that is never flat, with one event of
+ * each kind: a spike, a step up and back down, a slow rise over the
+ * HIGH level and back, and a flat tail.
+ */
+static int32_t detect_input(int i)
+{
+    int32_t x = i % 200 < 100 ? i % 200 * 10 : (200 - i % 200) * 10;
+
+    if (i >= DETECT_FLAT)
+        return 500;
+    if (i == DETECT_SPIKE)
+        x += 5000;
+    if (i >= DETECT_STEP_UP && i < DETECT_STEP_DN)
+        x += 20000;
+    // 40 codes a sample, the means of a step window move by 2560 only
+    if (i >= DETECT_LEVEL && i < DETECT_LEVEL + 1000)
+        x += (i - DETECT_LEVEL) * 40;
+    else if (i >= DETECT_LEVEL + 1000 && i < DETECT_LEVEL + 2000)
+        x += (DETECT_LEVEL + 2000 - i) * 40;
+    return x;
+}
+
+static void config(ads125x_detect_config *cfg, int mask)
+{
+    ads125xDetectConfigInit(cfg);
+    cfg->mask = mask;
+    cfg->high = 25000;
+    cfg->low = -1000;
+    cfg->hysteresis = 1000;
+    cfg->spike = 2000;
+    cfg->step = 10000;
+    cfg->flat_delta = 5;
+    cfg->flat_samples = 300;
+    return;
+}
+
+int main(void)
+{
+    ads125x_detect_config cfg;
+    ads125x_detect_stats stats;
+    ads125x_detect *all, *quiet;
+    ads125x_event events[DETECT_EVENTS], other[DETECT_EVENTS];
+    ads125x_dev dev;
+    int i, n = 0, m = 0, k, seen[ADS125x_EVENT_TYPES] = {0};
+    uint64_t at;
+
+    config(&cfg, ADS125x_DETECT_LEVEL | ADS125x_DETECT_SPIKE | ADS125x_DETECT_STEP | ADS125x_DETECT_FLATLINE);
+    cfg.step_window = 0;
+    TEST_CHECK(ads125xDetectOpen(&cfg) == NULL);
+    cfg.step_window = 64;
+    cfg.context = ADS125x_DETECT_CONTEXT_MAX + 1;
+    TEST_CHECK(ads125xDetectOpen(&cfg) == NULL);
+    cfg.context = 8;
+    all = ads125xDetectOpen(&cfg);
+    config(&cfg, ADS125x_DETECT_LEVEL | ADS125x_DETECT_SPIKE | ADS125x_DETECT_STEP);
+    quiet = ads125xDetectOpen(&cfg);
+    TEST_CHECK(all && quiet);
+    TEST_CHECK(strcmp(ads125xEventName(ADS125x_EVENT_FLATLINE), "flatline") == 0);
+    TEST_CHECK(strcmp(ads125xEventName(ADS125x_EVENT_TYPES), "unknown") == 0);
+
+    for (i = 0; i < DETECT_SAMPLES; ++i)
+    {
+        raw[3 * i] = (uint8_t)((uint32_t)detect_input(i) >> 16);
+        raw[3 * i + 1] = (uint8_t)((uint32_t)detect_input(i) >> 8);
+        raw[3 * i + 2] = (uint8_t)detect_input(i);
+    }
+    memset(&dev, 0x00, sizeof(dev));
+    dev.name = "ADS1256";
+    if (!all || !quiet || ads125xReplayOpenBuffer(&dev, raw, DETECT_SAMPLES, ADS125x_REPLAY_FAST))
+    {
+        TEST_CHECK(!"open the replay");
+        ads125xDetectClose(all);
+        ads125xDetectClose(quiet);
+        return test_done("detect");
+    }
+    TEST_OK(ads125xSetDRATE(&dev, ADS125x_DR_30000));
+    TEST_OK(ads125xSetMUX(&dev, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1));
+
+    // Raw samples as read, in chunks that are not a multiple of a block
+    TEST_OK(ads125xRDATACStart(&dev));
+    for (i = 0; i < DETECT_SAMPLES; i += k)
+    {
+        k = DETECT_SAMPLES - i < DETECT_CHUNK ? DETECT_SAMPLES - i : DETECT_CHUNK;
+        TEST_OK(ads125xRDATACReadTs(&dev, raw + 3 * i, ts + i, k));
+        n += ads125xDetectPushRaw(all, raw + 3 * i, ts + i, k, events + n, DETECT_EVENTS - n);
+    }
+    TEST_OK(ads125xRDATACStop(&dev));
+    n += ads125xDetectFlush(all, events + n, DETECT_EVENTS - n);
+    TEST_CHECK(n == 6);
+
+    for (i = 0; i < n; ++i)
+    {
+        seen[events[i].type]++;
+        TEST_CHECK(events[i].ts == ts[events[i].index]);
+        TEST_CHECK(events[i].context_n == 2 * 8 + 1 && events[i].context_index + 8 == events[i].index);
+        if (events[i].type != ADS125x_EVENT_STEP)
+            TEST_CHECK(events[i].context[8] == events[i].code && events[i].code == detect_input((int)events[i].index));
+        switch (events[i].type)
+        {
+        case ADS125x_EVENT_SPIKE:
+            TEST_CHECK(events[i].index == DETECT_SPIKE && events[i].ref == 990);
+            break;
+        case ADS125x_EVENT_STEP:
+            at = events[i].index;
+            TEST_CHECK(at == DETECT_STEP_UP || at == DETECT_STEP_DN);
+            TEST_CHECK(llabs((int64_t)events[i].code - events[i].ref) > 19000);
+            break;
+        case ADS125x_EVENT_HIGH:
+            TEST_CHECK(events[i].index > DETECT_LEVEL && events[i].index < DETECT_LEVEL + 1000);
+            TEST_CHECK(events[i].code > 25000 && events[i].ref == 25000);
+            break;
+        case ADS125x_EVENT_NORMAL:
+            TEST_CHECK(events[i].index > DETECT_LEVEL + 1000 && events[i].index < DETECT_LEVEL + 2000);
+            TEST_CHECK(events[i].code < 24000 && events[i].ref == 24000);
+            break;
+        case ADS125x_EVENT_FLATLINE:
+            TEST_CHECK(events[i].index == DETECT_FLAT + 300 - 1 && events[i].ref == 500);
+            break;
+        }
+    }
+    TEST_CHECK(seen[ADS125x_EVENT_SPIKE] == 1 && seen[ADS125x_EVENT_STEP] == 2 && seen[ADS125x_EVENT_HIGH] == 1 &&
+               seen[ADS125x_EVENT_NORMAL] == 1 && seen[ADS125x_EVENT_FLATLINE] == 1 && seen[ADS125x_EVENT_LOW] == 0);
+    ads125xDetectGetStats(all, &stats);
+    TEST_CHECK(stats.samples == DETECT_SAMPLES && stats.dropped == 0 && stats.events[ADS125x_EVENT_STEP] == 2);
+
+    // The same stream as codes in one call, without timestamps and the
+    // flatline detector, skips the quiet blocks
+    for (i = 0; i < DETECT_SAMPLES; ++i)
+        codes[i] = (int32_t)((uint32_t)raw[3 * i] << 24 | (uint32_t)raw[3 * i + 1] << 16 | (uint32_t)raw[3 * i + 2] << 8) >> 8;
+    m = ads125xDetectPush(quiet, codes, NULL, DETECT_SAMPLES, other, DETECT_EVENTS);
+    m += ads125xDetectFlush(quiet, other + m, DETECT_EVENTS - m);
+    TEST_CHECK(m == n - 1);
+    for (i = 0, k = 0; i < n && k < m; ++i)
+    {
+        if (events[i].type == ADS125x_EVENT_FLATLINE)
+            continue;
+        TEST_CHECK(other[k].type == events[i].type && other[k].index == events[i].index &&
+                   other[k].code == events[i].code && other[k].ts == 0);
+        k++;
+    }
+    ads125xDetectGetStats(quiet, &stats);
+    TEST_CHECK(stats.blocks == DETECT_SAMPLES / ADS125x_DETECT_BLOCK && stats.scanned < stats.blocks);
+
+    ads125xDetectClose(all);
+    ads125xDetectClose(quiet);
+    ads125xReplayClose(&dev);
+    return test_done("detect");
+}
@@ -0,0 +1,238 @@
+/**
+ * test_duty.c - Test of the power states and the duty cycle on replay devices
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <errno.h>
+#include <time.h>
+#include "ads1256test.h"
+#include "libads1256duty.h"
+
+#define DUTY_READINGS   20
+
+static uint8_t raw[TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+static ads125x_duty_sample out[DUTY_READINGS];
+
+/**
+ * duty_regs - Read all the registers from the chip
+ */
+static int duty_regs(ads125x_dev *dev, uint8_t *regs)
+{
+    return ads125xRREG(dev, ADS125x_REG_ADDR_STATUS, regs, ADS125x_REG_NUM);
+}
+
+/**
+ * duty_check_power - Power down and up, the registers come back
+ */
+static void duty_check_power(ads125x_dev *dev)
+{
+    uint8_t before[ADS125x_REG_NUM], after[ADS125x_REG_NUM];
+    uint8_t adcon = ADS125x_ADCON_CLK_FEQIN | ADS125x_ADCON_PGA_8, dr = ADS125x_DR_100;
+
+    TEST_OK(ads125xSetMUX(dev, ADS125x_MUX_PSEL_CH2, ADS125x_MUX_NSEL_CH3));
+    TEST_OK(ads125xWREG(dev, ADS125x_REG_ADDR_ADCON, &adcon, 1));
+    TEST_OK(ads125xWREG(dev, ADS125x_REG_ADDR_DRATE, &dr, 1));
+    TEST_OK(duty_regs(dev, before));
+    TEST_CHECK(dev->regs_valid == (1 << ADS125x_REG_NUM) - 1);
+
+    TEST_OK(ads125xPowerDown(dev));
+    TEST_CHECK(dev->power == ADS125x_POWER_DOWN && !dev->rdatac);
+    TEST_CHECK(ads125xGetDRDY(dev) == 1);
+    // The cache outlives the chip, which lost its registers
+    TEST_CHECK(memcmp(dev->regs, before, ADS125x_REG_NUM) == 0);
+    TEST_OK(ads125xPowerUp(dev));
+    TEST_CHECK(dev->power == ADS125x_POWER_ON);
+    TEST_OK(duty_regs(dev, after));
+    TEST_CHECK(memcmp(after, before, ADS125x_REG_NUM) == 0);
+    TEST_CHECK(after[ADS125x_REG_ADDR_MUX] == (ADS125x_MUX_PSEL_CH2 | ADS125x_MUX_NSEL_CH3));
+    TEST_CHECK(after[ADS125x_REG_ADDR_DRATE] == ADS125x_DR_100);
+    return;
+}
+
+/**
+ * duty_check_plan - Pick the states at DR_1000
+ */
+static void duty_check_plan(ads125x_dev *dev)
+{
+    uint8_t dr = ADS125x_DR_1000;
+    ads125x_duty d;
+    uint16_t valid;
+
+    TEST_OK(ads125xWREG(dev, ADS125x_REG_ADDR_DRATE, &dr, 1));
+    TEST_CHECK(ads125xDutyPlan(dev, &d, 0, ADS125x_DUTY_AUTO) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xDutyPlan(dev, &d, 10, ADS125x_DUTY_STATES) == ADS125x_ERR_INVAL);
+    valid = dev->regs_valid;
+    dev->regs_valid &= ~(1 << ADS125x_REG_ADDR_DRATE);
+    TEST_CHECK(ads125xDutyPlan(dev, &d, 10, ADS125x_DUTY_AUTO) == ADS125x_ERR_INVAL);
+    dev->regs_valid = valid;
+
+    // Faster than the DRATE
+    TEST_CHECK(ads125xDutyPlan(dev, &d, 2000, ADS125x_DUTY_AUTO) == ADS125x_ERR_INVAL);
+    // Too short for the settling time
+    TEST_OK(ads125xDutyPlan(dev, &d, 900, ADS125x_DUTY_AUTO));
+    TEST_CHECK(d.state == ADS125x_DUTY_AWAKE && d.energy_uj[ADS125x_DUTY_STANDBY] == 0);
+    // Too short for the oscillator, STANDBY is cheaper than staying awake
+    TEST_OK(ads125xDutyPlan(dev, &d, 100, ADS125x_DUTY_AUTO));
+    TEST_CHECK(d.state == ADS125x_DUTY_STANDBY && d.period_ns == 10000000);
+    TEST_CHECK(d.wake_us == ADS125x_DUTY_XFER_US + ads125xDRATEToSettleUs(ADS125x_DR_1000));
+    TEST_CHECK(d.energy_uj[ADS125x_DUTY_PDWN] == 0);
+    TEST_CHECK(d.energy_uj[ADS125x_DUTY_STANDBY] < d.energy_uj[ADS125x_DUTY_AWAKE]);
+    TEST_CHECK(ads125xDutyPlan(dev, &d, 100, ADS125x_DUTY_PDWN) == ADS125x_ERR_INVAL);
+    // PDWN pays off for periods of a few seconds
+    TEST_OK(ads125xDutyPlan(dev, &d, 20, ADS125x_DUTY_AUTO));
+    TEST_CHECK(d.state == ADS125x_DUTY_STANDBY && d.energy_uj[ADS125x_DUTY_PDWN] > d.energy_uj[ADS125x_DUTY_STANDBY]);
+    TEST_OK(ads125xDutyPlan(dev, &d, 0.2, ADS125x_DUTY_AUTO));
+    TEST_CHECK(d.state == ADS125x_DUTY_PDWN && d.energy_uj[ADS125x_DUTY_PDWN] < d.energy_uj[ADS125x_DUTY_STANDBY]);
+    return;
+}
+
+/**
+ * duty_check_stats - The statistics add up the @n readings of the run
+ * @early_ns: How early before its deadline a reading may be ready, with
+ *            no late reading to grow the lead.
+ * @late_ns: How late a reading may be, a few may be later when the
+ *           test is preempted, their missed deadlines are skipped.
+ */
+static void duty_check_stats(const ads125x_duty *d, int n, int64_t early_ns, int64_t late_ns)
+{
+    ads125x_duty_stats st;
+    uint64_t late = 0, late_max = 0, early_max = 0, awake = 0, awake_max = 0, skipped = 0, gap;
+    int64_t grown = 0;
+    int i, slow = 0;
+
+    ads125xDutyGetStats(d, &st);
+    for (i = 0; i < n; ++i)
+    {
+        // Early by the lead grown after the late readings at most
+        TEST_CHECK(-out[i].late_ns < early_ns + grown);
+        if (out[i].late_ns > 0)
+        {
+            grown += out[i].late_ns + ADS125x_DUTY_MARGIN_US * 1000;
+            late++;
+            late_max = (uint64_t)out[i].late_ns > late_max ? (uint64_t)out[i].late_ns : late_max;
+        }
+        else
+            early_max = (uint64_t)-out[i].late_ns > early_max ? (uint64_t)-out[i].late_ns : early_max;
+        awake += out[i].awake_ns;
+        awake_max = out[i].awake_ns > awake_max ? out[i].awake_ns : awake_max;
+        // Deadlines a whole number of periods apart, more than one for skips
+        if (i)
+        {
+            gap = out[i].ts - out[i].late_ns - (out[i - 1].ts - out[i - 1].late_ns);
+            TEST_CHECK(gap % d->period_ns == 0 && gap >= d->period_ns);
+            skipped += gap / d->period_ns - 1;
+        }
+        slow += out[i].late_ns >= late_ns;
+    }
+    TEST_CHECK(slow <= n / 4);
+    TEST_CHECK(st.readings == (uint64_t)n && st.skipped == skipped);
+    TEST_CHECK(st.late == late && st.late_max_ns == late_max && st.early_max_ns == early_max);
+    TEST_CHECK(st.awake_ns == awake && st.awake_max_ns == awake_max);
+    TEST_CHECK(st.energy_uj > 0);
+    return;
+}
+
+int main(void)
+{
+    uint8_t before[ADS125x_REG_NUM], after[ADS125x_REG_NUM];
+    uint64_t next, wake, skipped;
+    struct timespec ts;
+    ads125x_duty d;
+    ads125x_dev dev;
+    int i, slow;
+
+    if (test_open(&dev, raw, TEST_SAMPLES, ADS125x_REPLAY_PACED))
+    {
+        TEST_CHECK(!"open the replay");
+        return test_done("duty");
+    }
+    duty_check_power(&dev);
+    duty_check_plan(&dev);
+
+    // STANDBY at 100 Hz, one conversion of the capture per reading
+    TEST_OK(ads125xDutyPlan(&dev, &d, 100, ADS125x_DUTY_AUTO));
+    TEST_OK(ads125xDutyStart(&dev, &d));
+    TEST_CHECK(dev.power == ADS125x_POWER_STANDBY);
+    TEST_OK(ads125xDutyRead(&dev, &d, out, DUTY_READINGS));
+    TEST_CHECK(dev.power == ADS125x_POWER_STANDBY);
+    for (i = 1; i < DUTY_READINGS; ++i)
+        TEST_CHECK(out[i].code == out[0].code + i);
+    for (i = 0, slow = 0; i < DUTY_READINGS; ++i)
+    {
+        TEST_CHECK(out[i].awake_ns >= ads125xDRATEToSettleUs(ADS125x_DR_1000) * 1000);
+        slow += out[i].awake_ns >= d.period_ns / 2;
+    }
+    TEST_CHECK(slow <= DUTY_READINGS / 4);
+    // Ready about at the deadline, woken up early enough
+    duty_check_stats(&d, DUTY_READINGS, 1000000, 1000000);
+
+    // A caller back 3.5 periods after the wakeup skips 3 deadlines, and reads at once
+    next = d.next_ns;
+    skipped = d.stats.skipped;
+    wake = d.next_ns - d.lead_ns + 3 * d.period_ns + d.period_ns / 2;
+    ts.tv_sec = wake / 1000000000ULL;
+    ts.tv_nsec = wake % 1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+    TEST_OK(ads125xDutyRead(&dev, &d, out, 2));
+    TEST_CHECK(d.stats.readings == DUTY_READINGS + 2 && d.stats.skipped == skipped + 3);
+    TEST_CHECK(out[0].ts - out[0].late_ns == next + 3 * d.period_ns && out[0].ts > wake);
+    TEST_OK(ads125xDutyStop(&dev));
+    TEST_CHECK(dev.power == ADS125x_POWER_ON);
+
+    // PDWN at 20 Hz, the registers are written back for every reading
+    TEST_OK(duty_regs(&dev, before));
+    TEST_OK(ads125xDutyPlan(&dev, &d, 20, ADS125x_DUTY_PDWN));
+    TEST_OK(ads125xDutyStart(&dev, &d));
+    TEST_CHECK(dev.power == ADS125x_POWER_DOWN);
+    TEST_OK(ads125xDutyRead(&dev, &d, out, 4));
+    TEST_CHECK(dev.power == ADS125x_POWER_DOWN);
+    for (i = 0; i < 4; ++i)
+        TEST_CHECK(out[i].awake_ns >= ADS125x_PDWN_WAKE_US * 1000ULL);
+    duty_check_stats(&d, 4, 1000000, 1000000);
+    TEST_OK(ads125xDutyStop(&dev));
+    TEST_CHECK(dev.power == ADS125x_POWER_ON);
+    TEST_OK(duty_regs(&dev, after));
+    TEST_CHECK(memcmp(after, before, ADS125x_REG_NUM) == 0);
+
+    // Awake, converting all the time
+    TEST_OK(ads125xDutyPlan(&dev, &d, 900, ADS125x_DUTY_AUTO));
+    TEST_CHECK(d.state == ADS125x_DUTY_AWAKE);
+    TEST_OK(ads125xDutyStart(&dev, &d));
+    TEST_OK(ads125xDutyRead(&dev, &d, out, DUTY_READINGS));
+    for (i = 0; i < DUTY_READINGS; ++i)
+        TEST_CHECK(out[i].awake_ns == d.period_ns);
+    // The latest conversion at the wakeup, up to a conversion before it
+    duty_check_stats(&d, DUTY_READINGS, (int64_t)d.lead_ns + 1000000 + 500000, 1000000);
+    TEST_OK(ads125xDutyStop(&dev));
+    ads125xReplayClose(&dev);
+    return test_done("duty");
+}
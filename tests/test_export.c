@@ -0,0 +1,182 @@
+/**
+ * test_export.c - Test of the CSV export against printf
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "ads1256test.h"
+#include "libads1256export.h"
+
+#define EXPORT_BATCH    4096
+// Whole chunks and a partial one
+#define EXPORT_SAMPLES  (10 * ADS125x_EXPORT_CHUNK + 123)
+#define EXPORT_CHUNKS   11
+
+static uint8_t raw[EXPORT_SAMPLES * ADS125x_DATA_LEN_BYTE];
+static char line[EXPORT_BATCH * ADS125x_EXPORT_LINE_MAX];
+static char csv[EXPORT_SAMPLES * ADS125x_EXPORT_LINE_MAX];
+static char file[EXPORT_SAMPLES * ADS125x_EXPORT_LINE_MAX];
+
+static void export_raw(uint8_t *p, int32_t code)
+{
+    p[0] = (uint8_t)(code >> 16);
+    p[1] = (uint8_t)(code >> 8);
+    p[2] = (uint8_t)code;
+    return;
+}
+
+/**
+ * export_printf - The lines of the continuous mode, as continu_read() prints them
+ *
+ * @return: Bytes written to @out.
+ */
+static size_t export_printf(char *out, const uint8_t *p, size_t count, uint64_t first)
+{
+    size_t i, len = 0;
+
+    for (i = 0; i < count; ++i, p += 3)
+        len += sprintf(out + len, "%5llu,%02x%02x%02x,%.12lf\n", (unsigned long long)(first + i), p[0], p[1], p[2],
+                       (double)convert_to_signed_24bit((uint8_t *)p) * ADS125x_EXPORT_FULL_SCALE / (1 << 23));
+    return len;
+}
+
+/**
+ * export_check_codes - Format @count codes from @code every @step and compare with printf
+ *
+ * @return: Number of batches that differ.
+ */
+static int export_check_codes(int64_t code, int64_t step, size_t count, uint64_t first)
+{
+    static char want[EXPORT_BATCH * ADS125x_EXPORT_LINE_MAX];
+    static uint8_t batch[EXPORT_BATCH * ADS125x_DATA_LEN_BYTE];
+    size_t i, n, len;
+    int bad = 0;
+
+    for (; count; count -= n, first += n)
+    {
+        n = count < EXPORT_BATCH ? count : EXPORT_BATCH;
+        for (i = 0; i < n; ++i, code += step)
+            export_raw(batch + 3 * i, (int32_t)code);
+        len = export_printf(want, batch, n, first);
+        bad += ads125xExportFormat(line, batch, n, first) != len || memcmp(line, want, len) != 0;
+    }
+    return bad;
+}
+
+/**
+ * export_check_write - Write the samples with @threads and compare with one ads125xExportFormat()
+ */
+static void export_check_write(int threads, size_t len)
+{
+    char path[] = "/tmp/ads1256test-XXXXXX";
+    ads125x_export_stats stats;
+    ssize_t got;
+    int fd;
+
+    if ((fd = mkstemp(path)) < 0)
+    {
+        TEST_CHECK(!"create the csv");
+        return;
+    }
+    unlink(path);
+    memset(&stats, 0x00, sizeof(stats));
+    TEST_OK(ads125xExportWrite(fd, raw, EXPORT_SAMPLES, 1, threads, &stats));
+    TEST_CHECK(stats.samples == EXPORT_SAMPLES && stats.bytes == len);
+    // No more threads than chunks
+    TEST_CHECK(threads <= 0 ? stats.threads >= 1 : stats.threads == (threads < EXPORT_CHUNKS ? threads : EXPORT_CHUNKS));
+    got = pread(fd, file, sizeof(file), 0);
+    TEST_CHECK(got == (ssize_t)len && memcmp(file, csv, len) == 0);
+    close(fd);
+    return;
+}
+
+int main(void)
+{
+    char path[] = "/tmp/ads1256test-XXXXXX", out[64];
+    ads125x_export_stats stats;
+    size_t i, len;
+    uint32_t seed = 1;
+    ssize_t got;
+    int fd;
+
+    // Both ends of the range, around zero, and a code of every 97 elsewhere
+    TEST_CHECK(export_check_codes(-0x800000, 1, 65536, 1) == 0);
+    TEST_CHECK(export_check_codes(-32768, 1, 65536, 1) == 0);
+    TEST_CHECK(export_check_codes(0x7FFFFF - 65535, 1, 65536, 1) == 0);
+    TEST_CHECK(export_check_codes(-0x800000, 97, (1 << 24) / 97, 1) == 0);
+    // Odd multiples of 1024 are exact ties at 12 decimals, printf rounds them to even
+    TEST_CHECK(export_check_codes(-0x800000, 1024, 1 << 14, 1) == 0);
+    // Indexes wider than 5 columns
+    TEST_CHECK(export_check_codes(-5, 1, 200, 9950) == 0);
+    TEST_CHECK(export_check_codes(-5, 1, 200, 99950) == 0);
+    TEST_CHECK(export_check_codes(-5, 1, 200, 4294967200ULL) == 0);
+    TEST_CHECK(export_check_codes(-5, 1, 200, 999999999999999900ULL) == 0);
+    TEST_CHECK(ads125xExportFormat(line, raw, 0, 1) == 0);
+    // The longest line fits
+    export_raw((uint8_t *)out, -0x800000);
+    TEST_CHECK(ads125xExportFormat(line, (uint8_t *)out, 1, 18446744073709551615ULL) <= ADS125x_EXPORT_LINE_MAX);
+
+    // The chunks formatted by a pool of threads are written in order
+    for (i = 0; i < EXPORT_SAMPLES; ++i)
+    {
+        seed = seed * 1664525 + 1013904223;
+        export_raw(raw + 3 * i, (int32_t)(seed >> 8) - 0x800000);
+    }
+    len = ads125xExportFormat(csv, raw, EXPORT_SAMPLES, 1);
+    export_check_write(1, len);
+    export_check_write(2, len);
+    export_check_write(4, len);
+    export_check_write(ADS125x_EXPORT_MAX_THREADS, len);
+    export_check_write(0, len);
+
+    // A binary capture to a file, the trailing partial sample ignored
+    if ((fd = mkstemp(path)) < 0 || write(fd, raw, sizeof(raw) - 1) != sizeof(raw) - 1)
+        TEST_CHECK(!"create the capture");
+    else
+    {
+        snprintf(out, sizeof(out), "%s.csv", path);
+        TEST_OK(ads125xExportFile(path, out, 3, &stats));
+        TEST_CHECK(stats.samples == EXPORT_SAMPLES - 1);
+        got = -1;
+        close(fd);
+        if ((fd = open(out, O_RDONLY)) >= 0)
+            got = read(fd, file, sizeof(file));
+        TEST_CHECK(got == (ssize_t)stats.bytes && got < (ssize_t)len && memcmp(file, csv, got) == 0);
+        TEST_CHECK(got > 0 && file[got - 1] == '\n');
+        unlink(out);
+    }
+    if (fd >= 0)
+        close(fd);
+    unlink(path);
+    return test_done("export");
+}
@@ -0,0 +1,242 @@
+/**
+ * test_graph.c - Test of the processing graph on replay devices
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "ads1256test.h"
+#include "libads1256graph.h"
+
+#define GRAPH_BLOCK     256
+#define GRAPH_BLOCKS    64
+#define GRAPH_DECIMATE  8
+#define GRAPH_BOXCAR    4
+
+static uint8_t raw[TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+
+/**
+ * graph_sink - What a sink saw
+ * @expect: Code of sample i of block seq, INT32_MIN for any.
+ * @blocks: Blocks received, read by the main thread while running.
+ * @bad: Samples that were not @expect.
+ */
+typedef struct graph_sink_struct
+{
+    int32_t (*expect)(uint64_t seq, size_t i);
+    uint64_t blocks;
+    uint64_t samples;
+    uint64_t bad;
+    uint64_t last_ts;
+} graph_sink;
+
+// The source reads the ramp in blocks, which do not cross its end
+static int32_t expect_source(uint64_t seq, size_t i)
+{
+    return (int32_t)((seq * GRAPH_BLOCK + i) % TEST_SAMPLES);
+}
+
+// Mean of 8 ramp samples, a block holds whole groups
+static int32_t expect_decimate(uint64_t seq, size_t i)
+{
+    return expect_source(seq, i * GRAPH_DECIMATE) + 3;
+}
+
+// Mean of the last 4, known once the block holds them
+static int32_t expect_boxcar(uint64_t seq, size_t i)
+{
+    return i + 1 < GRAPH_BOXCAR ? INT32_MIN : expect_source(seq, i) - 2;
+}
+
+static int sink_fn(void *arg, const ads125x_gblock *in, ads125x_gblock *out)
+{
+    graph_sink *s = (graph_sink *)arg;
+    size_t i;
+
+    (void)out;
+    for (i = 0; i < in->n; ++i)
+    {
+        if (s->expect && s->expect(in->seq, i) != INT32_MIN && in->codes[i] != s->expect(in->seq, i))
+            s->bad++;
+        if (in->ts[i] < s->last_ts)
+            s->bad++;
+        s->last_ts = in->ts[i];
+    }
+    s->samples += in->n;
+    __atomic_add_fetch(&s->blocks, 1, __ATOMIC_RELEASE);
+    return ADS125x_OK;
+}
+
+// Negates, and fails on the first block it is given
+static int negate_fn(void *arg, const ads125x_gblock *in, ads125x_gblock *out)
+{
+    size_t i;
+
+    if ((*(int *)arg)++ == 0)
+        return ADS125x_ERR_IO;
+    for (i = 0; i < in->n; ++i)
+    {
+        out->codes[i] = -in->codes[i];
+        out->ts[i] = in->ts[i];
+    }
+    out->n = in->n;
+    return ADS125x_OK;
+}
+
+static int32_t expect_negate(uint64_t seq, size_t i)
+{
+    return -expect_source(seq, i);
+}
+
+int main(void)
+{
+    graph_sink dec_sink = {expect_decimate}, box_sink = {expect_boxcar}, neg_sink = {expect_negate}, end_sink = {expect_source};
+    ads125x_graph_node_stats ns, src_stats;
+    ads125x_graph_stats gs;
+    ads125x_graph *g;
+    ads125x_dev dev;
+    char path[] = "/tmp/ads1256test-XXXXXX";
+    uint8_t *file;
+    uint64_t got = 0, deadline;
+    struct stat st;
+    int src, dec, box, fsink, neg, sink, fd, i, bad = 0, calls = 0;
+
+    if (test_open(&dev, raw, TEST_SAMPLES, ADS125x_REPLAY_FAST | ADS125x_REPLAY_LOOP))
+    {
+        TEST_CHECK(!"open the replay");
+        return test_done("graph");
+    }
+    // A source to a decimate, a boxcar and a file
+    TEST_CHECK(ads125xGraphOpen(0) == NULL);
+    if ((g = ads125xGraphOpen(GRAPH_BLOCK)) == NULL || (fd = mkstemp(path)) < 0)
+    {
+        TEST_CHECK(!"open the graph");
+        ads125xGraphClose(g);
+        ads125xReplayClose(&dev);
+        return test_done("graph");
+    }
+    unlink(path);
+    src = ads125xGraphAddSource(g, &dev, GRAPH_BLOCKS * GRAPH_BLOCK);
+    dec = ads125xGraphAddDecimate(g, GRAPH_DECIMATE);
+    box = ads125xGraphAddBoxcar(g, GRAPH_BOXCAR);
+    fsink = ads125xGraphAddFileSink(g, fd);
+    TEST_CHECK(ads125xGraphAddDecimate(g, 0) == ADS125x_ERR_INVAL && ads125xGraphAddFileSink(g, -1) == ADS125x_ERR_INVAL);
+    TEST_CHECK(src >= 0 && dec >= 0 && box >= 0 && fsink >= 0);
+    TEST_OK(ads125xGraphConnect(g, src, dec));
+    TEST_OK(ads125xGraphConnect(g, src, box));
+    TEST_OK(ads125xGraphConnect(g, src, fsink));
+    // A node has one input, a sink no output
+    TEST_CHECK(ads125xGraphConnect(g, src, dec) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xGraphConnect(g, fsink, src) == ADS125x_ERR_INVAL);
+    sink = ads125xGraphAddSink(g, sink_fn, &dec_sink);
+    // Every node but the sources needs an input to start
+    TEST_CHECK(ads125xGraphStart(g, 2) == ADS125x_ERR_INVAL);
+    TEST_OK(ads125xGraphConnect(g, dec, sink));
+    TEST_OK(ads125xGraphConnect(g, box, ads125xGraphAddSink(g, sink_fn, &box_sink)));
+    TEST_OK(ads125xGraphStart(g, 2));
+    TEST_CHECK(ads125xGraphStart(g, 2) == ADS125x_ERR_INVAL);
+    TEST_OK(ads125xGraphWait(g));
+
+    // A source drops a block on a full queue, a sink sees whole blocks or none
+    TEST_OK(ads125xGraphGetNodeStats(g, src, &src_stats));
+    TEST_CHECK(src_stats.type == ADS125x_GRAPH_SOURCE && src_stats.blocks == GRAPH_BLOCKS &&
+               src_stats.samples == GRAPH_BLOCKS * GRAPH_BLOCK && src_stats.errors == 0);
+    TEST_CHECK(dec_sink.bad == 0 && box_sink.bad == 0);
+    TEST_CHECK(dec_sink.samples == dec_sink.blocks * GRAPH_BLOCK / GRAPH_DECIMATE);
+    TEST_CHECK(box_sink.samples == box_sink.blocks * GRAPH_BLOCK);
+    TEST_OK(ads125xGraphGetNodeStats(g, dec, &ns));
+    TEST_CHECK(ns.type == ADS125x_GRAPH_TRANSFORM && ns.blocks == dec_sink.blocks);
+    got += ns.blocks;
+    TEST_OK(ads125xGraphGetNodeStats(g, box, &ns));
+    TEST_CHECK(ns.blocks == box_sink.blocks);
+    got += ns.blocks;
+    TEST_OK(ads125xGraphGetNodeStats(g, fsink, &ns));
+    TEST_CHECK(ns.type == ADS125x_GRAPH_SINK && ns.errors == 0);
+    got += ns.blocks;
+    // A dropped block is missed by one of the outputs at least
+    TEST_CHECK(got <= 3 * GRAPH_BLOCKS && got + 3 * src_stats.dropped >= 3 * GRAPH_BLOCKS);
+    TEST_CHECK((got == 3 * GRAPH_BLOCKS) == (src_stats.dropped == 0));
+    TEST_CHECK(ads125xGraphGetNodeStats(g, 64, &ns) == ADS125x_ERR_INVAL);
+
+    // The file holds the blocks not dropped, each a piece of the ramp
+    TEST_CHECK(fstat(fd, &st) == 0 && (uint64_t)st.st_size == ns.samples * ADS125x_DATA_LEN_BYTE);
+    if ((file = (uint8_t *)malloc(st.st_size + 1)) != NULL && pread(fd, file, st.st_size, 0) == st.st_size)
+    {
+        for (i = 0; i < st.st_size / ADS125x_DATA_LEN_BYTE; ++i)
+            if (((int32_t)file[3 * i] << 16 | file[3 * i + 1] << 8 | file[3 * i + 2]) % GRAPH_BLOCK != i % GRAPH_BLOCK)
+                bad++;
+        TEST_CHECK(bad == 0);
+    }
+    else
+        TEST_CHECK(!"read the file back");
+    free(file);
+    close(fd);
+    ads125xGraphGetStats(g, &gs);
+    TEST_CHECK(gs.threads == 2 && gs.runs > 0 && gs.elapsed > 0);
+    ads125xGraphClose(g);
+
+    // A failed transform is reported by the wait, and the graph goes on.
+    // The replay is back at its start, each graph read whole passes of it
+    if ((g = ads125xGraphOpen(GRAPH_BLOCK)) != NULL)
+    {
+        src = ads125xGraphAddSource(g, &dev, 16 * GRAPH_BLOCK);
+        neg = ads125xGraphAddTransform(g, negate_fn, &calls);
+        TEST_OK(ads125xGraphConnect(g, src, neg));
+        TEST_OK(ads125xGraphConnect(g, neg, ads125xGraphAddSink(g, sink_fn, &neg_sink)));
+        TEST_OK(ads125xGraphStart(g, 1));
+        TEST_CHECK(ads125xGraphWait(g) == ADS125x_ERR_IO);
+        TEST_OK(ads125xGraphGetNodeStats(g, neg, &ns));
+        TEST_CHECK(ns.errors == 1 && ns.blocks == (uint64_t)calls && neg_sink.blocks + 1 == ns.blocks && neg_sink.bad == 0);
+        ads125xGraphClose(g);
+    }
+    else
+        TEST_CHECK(!"open the graph");
+
+    // An endless source runs until stopped
+    if ((g = ads125xGraphOpen(GRAPH_BLOCK)) != NULL)
+    {
+        src = ads125xGraphAddSource(g, &dev, 0);
+        TEST_OK(ads125xGraphConnect(g, src, ads125xGraphAddSink(g, sink_fn, &end_sink)));
+        TEST_OK(ads125xGraphStart(g, 0));
+        deadline = ads125xNowNs() + 2000000000ULL;
+        while (__atomic_load_n(&end_sink.blocks, __ATOMIC_ACQUIRE) < 100 && ads125xNowNs() < deadline)
+            usleep(1000);
+        TEST_OK(ads125xGraphStop(g));
+        TEST_CHECK(end_sink.blocks >= 100 && end_sink.bad == 0);
+        TEST_CHECK(!dev.rdatac);
+        ads125xGraphClose(g);
+    }
+    else
+        TEST_CHECK(!"open the graph");
+    ads125xReplayClose(&dev);
+    return test_done("graph");
+}
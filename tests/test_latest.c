@@ -0,0 +1,110 @@
+/**
+ * test_latest.c - The latest-value cache fed from a replay
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <unistd.h>
+#include "ads1256test.h"
+#include "libads1256latest.h"
+
+static uint8_t raw[TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+
+int main(void)
+{
+    const ads125x_latest_table *table;
+    ads125x_latest_value v, w;
+    ads125x_dev dev, other;
+    char name[32];
+    uint64_t deadline;
+    int i, torn = 0;
+
+    snprintf(name, sizeof(name), "/ads1256test-%d", (int)getpid());
+    if (test_open(&dev, raw, TEST_SAMPLES, ADS125x_REPLAY_FAST | ADS125x_REPLAY_LOOP))
+    {
+        TEST_CHECK(!"open the replay");
+        return test_done("latest");
+    }
+    TEST_CHECK(ads125xGetLatest(&dev, 0, &v) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xLatestOpen(&dev, name) != NULL);
+    // One cache per device and one publisher per name
+    TEST_CHECK(ads125xLatestOpen(&dev, NULL) == NULL);
+    memset(&other, 0x00, sizeof(other));
+    TEST_CHECK(ads125xLatestOpen(&other, name) == NULL);
+
+    TEST_OK(ads125xGetLatest(&dev, 0, &v));
+    TEST_CHECK(v.seq == 0);
+    TEST_CHECK(ads125xGetLatest(&dev, ADS125x_LATEST_CHANNELS, &v) == ADS125x_ERR_INVAL);
+    ads125xLatestPut(&dev, ADS125x_MUX_PSEL_CH2 | ADS125x_MUX_NSEL_CH3, -12345, 42);
+    TEST_OK(ads125xGetLatest(&dev, 2, &v));
+    TEST_CHECK(v.seq == 1 && v.code == -12345 && v.ts == 42 && v.mux == (ADS125x_MUX_PSEL_CH2 | ADS125x_MUX_NSEL_CH3));
+
+    // Another process maps the table read-only
+    if ((table = ads125xLatestMap(name)) == NULL)
+    {
+        TEST_CHECK(!"map the table");
+        ads125xLatestClose(&dev);
+        ads125xReplayClose(&dev);
+        return test_done("latest");
+    }
+    TEST_OK(ads125xLatestRead(table, 2, &w));
+    TEST_CHECK(w.seq == 1 && w.code == -12345);
+
+    // The background RDATAC keeps AIN0 current, the n-th conversion is the n-th ramp sample
+    TEST_OK(ads125xLatestStart(&dev, NULL));
+    TEST_CHECK(ads125xLatestStart(&dev, NULL) == ADS125x_ERR_INVAL);
+    deadline = ads125xNowNs() + 2000000000ULL;
+    do
+        TEST_OK(ads125xLatestRead(table, 0, &v));
+    while (v.seq < 10000 && ads125xNowNs() < deadline);
+    TEST_CHECK(v.seq >= 10000);
+    for (i = 0; i < 100000; ++i)
+    {
+        TEST_OK(ads125xLatestRead(table, 0, &w));
+        if (w.seq < v.seq || w.code != (int32_t)((w.seq - 1) % TEST_SAMPLES))
+            torn++;
+        v = w;
+    }
+    TEST_CHECK(torn == 0);
+    TEST_CHECK(v.mux == (ADS125x_MUX_PSEL_CH0 | ADS125x_MUX_NSEL_CH1) && v.ts != 0);
+    TEST_OK(ads125xLatestStop(&dev));
+    TEST_CHECK(ads125xLatestStop(&dev) == ADS125x_ERR_INVAL);
+    TEST_OK(ads125xGetLatest(&dev, 0, &w));
+    TEST_CHECK(w.seq >= v.seq);
+
+    // Closing unlinks the name, a mapping stays readable
+    ads125xLatestClose(&dev);
+    TEST_CHECK(ads125xLatestMap(name) == NULL);
+    TEST_OK(ads125xLatestRead(table, 0, &v));
+    TEST_CHECK(v.seq == w.seq);
+    ads125xLatestUnmap(table);
+    ads125xReplayClose(&dev);
+    return test_done("latest");
+}
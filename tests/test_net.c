@@ -0,0 +1,149 @@
+/**
+ * test_net.c - Loopback round trip of the sample stream
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <unistd.h>
+#include "ads1256test.h"
+#include "libads1256net.h"
+
+#define SAMPLES 5000
+
+static int32_t codes[ADS125x_NET_MAX_COUNT];
+static uint64_t ts[ADS125x_NET_MAX_COUNT];
+
+/**
+ * round_trip - Publish SAMPLES samples and receive them over @proto
+ * @port: Loopback port of the stream.
+ */
+static void round_trip(int proto, int port)
+{
+    ads125x_net_client_stats cstats;
+    ads125x_net_stats stats;
+    ads125x_net_frame frame;
+    ads125x_net_client *cli = NULL;
+    ads125x_net_cfg cfg;
+    ads125x_net *net;
+    ads125x_pub *pub;
+    int32_t pcodes[SAMPLES];
+    uint64_t pts[SAMPLES], seq = 0;
+    char addr[32];
+    size_t i, got = 0;
+    int n, bad = 0;
+
+    if ((pub = ads125xPubOpen(8192)) == NULL)
+    {
+        TEST_CHECK(!"open the publisher");
+        return;
+    }
+    memset(&cfg, 0x00, sizeof(cfg));
+    cfg.proto = proto;
+    cfg.addr = addr;
+    cfg.batch = 256;
+    cfg.latency_us = 1000;
+    cfg.policy = ADS125x_SUB_BLOCK;
+    snprintf(addr, sizeof(addr), "127.0.0.1:%d", port);
+    // The UDP receiver is there before the first datagram
+    if (proto == ADS125x_NET_UDP)
+        cli = ads125xNetConnect(proto, addr);
+    net = ads125xNetServe(pub, &cfg);
+    if (proto == ADS125x_NET_TCP)
+        cli = ads125xNetConnect(proto, addr);
+    TEST_CHECK(net != NULL && cli != NULL);
+    if (net == NULL || cli == NULL)
+        goto out;
+    TEST_OK(ads125xNetWaitClients(net, 1, 1000000));
+
+    // Negative codes and 64-bit timestamps catch a wrong byte order or width
+    for (i = 0; i < SAMPLES; ++i)
+    {
+        pcodes[i] = (int32_t)(i * 2654435761u) >> 8;
+        pts[i] = 0x123456789ULL + i * 1000003ULL;
+    }
+    for (i = 0; i < SAMPLES; i += 500)
+        TEST_OK(ads125xPubPublish(pub, pcodes + i, pts + i, 500));
+
+    while (got < SAMPLES && (n = ads125xNetRecv(cli, &frame, codes, ts, 1000000)) > 0)
+    {
+        TEST_CHECK((size_t)n == frame.count);
+        if (got == 0)
+            seq = frame.seq;
+        TEST_CHECK(frame.seq == seq + got);
+        TEST_CHECK(frame.lost == 0);
+        for (i = 0; i < (size_t)n && got + i < SAMPLES; ++i)
+            if (codes[i] != pcodes[got + i] || ts[i] != pts[got + i])
+                bad++;
+        got += n;
+    }
+    TEST_CHECK(got == SAMPLES);
+    TEST_CHECK(bad == 0);
+
+    ads125xPubClose(pub);
+    pub = NULL;
+    ads125xNetClose(net, &stats);
+    net = NULL;
+    TEST_CHECK(stats.samples == SAMPLES);
+    TEST_CHECK(stats.dropped == 0);
+    TEST_CHECK(stats.frames >= SAMPLES / 256);
+    // A closed TCP stream ends, UDP only ever times out
+    if (proto == ADS125x_NET_TCP)
+    {
+        TEST_CHECK(stats.clients == 1);
+        TEST_CHECK(ads125xNetRecv(cli, &frame, codes, ts, 1000000) == 0);
+    }
+    else
+        TEST_CHECK(ads125xNetRecv(cli, &frame, codes, ts, 10000) == ADS125x_ERR_TIMEOUT);
+    ads125xNetClientGetStats(cli, &cstats);
+    TEST_CHECK(cstats.samples == SAMPLES);
+    TEST_CHECK(cstats.gaps == 0);
+    TEST_CHECK(cstats.lost == 0);
+
+out:
+    if (pub)
+        ads125xPubClose(pub);
+    if (net)
+        ads125xNetClose(net, NULL);
+    if (cli)
+        ads125xNetDisconnect(cli);
+    return;
+}
+
+int main(void)
+{
+    // Away from the well-known ports, and from a test running in parallel
+    int port = 40000 + getpid() % 10000 * 2;
+
+    round_trip(ADS125x_NET_TCP, port);
+    round_trip(ADS125x_NET_UDP, port + 1);
+    TEST_CHECK(ads125xNetConnect(ADS125x_NET_TCP + 7, "127.0.0.1:1") == NULL);
+
+    return test_done("net");
+}
@@ -0,0 +1,139 @@
+/**
+ * test_pubsub.c - Subscriber policies on a replayed stream
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include "ads1256test.h"
+#include "libads1256pubsub.h"
+
+#define RING 256
+
+static uint8_t raw[TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+
+/**
+ * drain - Read all that @sub has without waiting
+ * @first: Returns the first code read.
+ * @last: Returns the last code read.
+ * @step: Returns 1 if each code is the one before plus the stride it was
+ *        read with, the ramp decimated without a gap.
+ *
+ * @return: Samples read, or the error of ads125xSubPeek().
+ */
+static int drain(ads125x_sub *sub, int32_t *first, int32_t *last, int *step)
+{
+    ads125x_slice s;
+    size_t stride = 0;
+    int n, i, total = 0;
+
+    *step = 1;
+    while ((n = ads125xSubPeek(sub, &s, 0)) > 0)
+    {
+        for (i = 0; i < n; ++i)
+        {
+            if (total == 0)
+                *first = s.codes[0];
+            else if (s.codes[i * s.stride] - *last != (int32_t)stride)
+                *step = 0;
+            *last = s.codes[i * s.stride];
+            stride = s.stride;
+            ++total;
+        }
+        TEST_OK(ads125xSubRelease(sub, n));
+    }
+    return n < 0 && n != ADS125x_ERR_TIMEOUT ? n : total;
+}
+
+int main(void)
+{
+    ads125x_sub *block, *drop, *dec;
+    ads125x_sub_stats stats;
+    ads125x_slice slice;
+    ads125x_dev dev;
+    ads125x_pub *pub;
+    int32_t first = -1, last = -1;
+    int step;
+
+    TEST_CHECK(ads125xPubOpen(100) == NULL);
+    TEST_CHECK(ads125xPubOpen(32) == NULL);
+    if (test_open(&dev, raw, TEST_SAMPLES, ADS125x_REPLAY_FAST) || (pub = ads125xPubOpen(RING)) == NULL)
+    {
+        TEST_CHECK(!"open the replay and the publisher");
+        return test_done("pubsub");
+    }
+    block = ads125xSubscribe(pub, ADS125x_SUB_BLOCK, 0);
+    drop = ads125xSubscribe(pub, ADS125x_SUB_DROP_OLDEST, 0);
+    dec = ads125xSubscribe(pub, ADS125x_SUB_DECIMATE, 8);
+    TEST_CHECK(block && drop && dec);
+    TEST_CHECK(ads125xSubscribe(pub, ADS125x_SUB_DECIMATE, 3) == NULL);
+    TEST_OK(ads125xRDATACStart(&dev));
+
+    // Every subscriber sees the ramp in place while it keeps up
+    TEST_OK(ads125xPubRDATAC(&dev, pub, 100));
+    TEST_CHECK(ads125xPubCount(pub) == 100);
+    TEST_CHECK(drain(block, &first, &last, &step) == 100 && first == 0 && last == 99 && step);
+    TEST_CHECK(drain(drop, &first, &last, &step) == 100 && first == 0 && last == 99 && step);
+    TEST_CHECK(drain(dec, &first, &last, &step) == 100 && first == 0 && last == 99 && step);
+    TEST_CHECK(ads125xSubPeek(block, &slice, 0) == ADS125x_ERR_TIMEOUT);
+    TEST_CHECK(ads125xSubRelease(block, 1) == ADS125x_ERR_INVAL);
+
+    // Three quarters of a ring behind, only the decimating subscriber skips
+    TEST_OK(ads125xPubRDATAC(&dev, pub, RING * 3 / 4));
+    TEST_CHECK(ads125xSubPeek(dec, &slice, 0) > 0 && slice.stride > 1 && slice.stride <= 8);
+    // Up to a stride of the newest samples waits for the next ones
+    TEST_CHECK(drain(dec, &first, &last, &step) < RING * 3 / 4 && last > 100 + RING * 3 / 4 - 1 - 8 && step);
+    ads125xSubGetStats(dec, &stats);
+    TEST_CHECK(stats.dropped > 0);
+    TEST_CHECK(drain(block, &first, &last, &step) == RING * 3 / 4 && first == 100 && step);
+    TEST_CHECK(drain(drop, &first, &last, &step) == RING * 3 / 4 && first == 100 && step);
+
+    // Four rings behind, a lossless subscriber is told, the others skip
+    TEST_OK(ads125xPubRDATAC(&dev, pub, 4 * RING));
+    TEST_CHECK(ads125xSubPeek(block, &slice, 0) == ADS125x_ERR_OVERRUN);
+    ads125xSubGetStats(block, &stats);
+    TEST_CHECK(stats.overruns == 1);
+    TEST_CHECK(drain(drop, &first, &last, &step) == RING / 2 && last == 100 + RING * 19 / 4 - 1 && step);
+    ads125xSubGetStats(drop, &stats);
+    TEST_CHECK(stats.overruns == 1);
+    TEST_CHECK(stats.delivered + stats.dropped == 100 + RING * 19 / 4);
+
+    // Closed, what is left is read and then the stream ends
+    TEST_OK(ads125xPubRDATAC(&dev, pub, 10));
+    ads125xRDATACStop(&dev);
+    ads125xPubClose(pub);
+    TEST_CHECK(drain(drop, &first, &last, &step) == 10 && last == 100 + RING * 19 / 4 + 9 && step);
+    TEST_CHECK(ads125xSubPeek(drop, &slice, 0) == 0);
+
+    ads125xUnsubscribe(block);
+    ads125xUnsubscribe(drop);
+    ads125xUnsubscribe(dec);
+    ads125xReplayClose(&dev);
+    return test_done("pubsub");
+}
@@ -0,0 +1,220 @@
+/**
+ * test_pyramid.c - Test of the min/max/mean pyramid against brute force
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <unistd.h>
+#include "ads1256test.h"
+#include "libads1256pyramid.h"
+
+#define PYR_SAMPLES     200003      // Not a multiple of the 64 samples of an entry
+#define PYR_PIXELS      333
+
+static uint8_t capture[PYR_SAMPLES * ADS125x_DATA_LEN_BYTE];
+static int32_t codes[PYR_SAMPLES];
+static ads125x_pyr_point out[PYR_PIXELS], want[PYR_PIXELS];
+
+// Chunks pushed in turn, most not multiples of 64
+static const size_t chunks[] = {1, 7, 63, 64, 65, 1000, 4097, 127, 3};
+
+/**
+ * pyr_brute - Summarize samples first .. first + count into pixels the plain way
+ */
+static void pyr_brute(uint64_t first, uint64_t count, ads125x_pyr_point *pts, int pixels)
+{
+    ads125x_pyr_point *pt;
+    uint64_t i;
+    int p;
+
+    for (p = 0; p < pixels; ++p)
+    {
+        pts[p].min = INT32_MAX;
+        pts[p].max = INT32_MIN;
+        pts[p].mean = 0;
+        pts[p].count = 0;
+    }
+    for (i = 0; i < count; ++i)
+    {
+        pt = pts + i * pixels / count;
+        pt->min = codes[first + i] < pt->min ? codes[first + i] : pt->min;
+        pt->max = codes[first + i] > pt->max ? codes[first + i] : pt->max;
+        pt->mean += codes[first + i];
+        pt->count++;
+    }
+    for (p = 0; p < pixels; ++p)
+        pts[p].mean /= pts[p].count;
+    return;
+}
+
+/**
+ * pyr_exact - Query and compare every pixel with brute force
+ *
+ * Exact when the pixel borders fall on entry borders, or the query
+ * reads the samples.
+ */
+static void pyr_exact(ads125x_pyr_view *v, uint64_t first, uint64_t count, int pixels)
+{
+    int p, bad = 0;
+
+    TEST_OK(ads125xPyrQuery(v, first, count, out, pixels));
+    pyr_brute(first, count, want, pixels);
+    for (p = 0; p < pixels; ++p)
+        bad += out[p].min != want[p].min || out[p].max != want[p].max || out[p].count != want[p].count ||
+               out[p].mean != want[p].mean;
+    TEST_CHECK(bad == 0);
+    return;
+}
+
+/**
+ * pyr_near - Query and compare with brute force over pixels widened by an entry
+ *
+ * An entry crossing a pixel border goes to the pixel it starts in, the
+ * entries read are at most a quarter of a pixel.
+ */
+static void pyr_near(ads125x_pyr_view *v, uint64_t first, uint64_t count, int pixels)
+{
+    uint64_t lo, hi, i, total = 0, w = count / pixels / 4;
+    int32_t mn, mx;
+    int p, bad = 0;
+
+    TEST_OK(ads125xPyrQuery(v, first, count, out, pixels));
+    for (p = 0; p < pixels; ++p)
+    {
+        lo = first + p * count / pixels;
+        hi = first + (p + 1) * count / pixels;
+        lo = lo > first + w ? lo - w : (first > w ? first - w : 0);
+        hi = hi + w < PYR_SAMPLES ? hi + w : PYR_SAMPLES;
+        for (mn = INT32_MAX, mx = INT32_MIN, i = lo; i < hi; ++i)
+        {
+            mn = codes[i] < mn ? codes[i] : mn;
+            mx = codes[i] > mx ? codes[i] : mx;
+        }
+        bad += out[p].count == 0 || out[p].min < mn || out[p].max > mx || out[p].mean < out[p].min || out[p].mean > out[p].max;
+        bad += out[p].count + 2 * w < count / pixels || out[p].count > count / pixels + 1 + 2 * w;
+        total += out[p].count;
+    }
+    TEST_CHECK(bad == 0);
+    TEST_CHECK(total >= count && total <= count + 2 * w);
+    return;
+}
+
+/**
+ * pyr_remove - Remove the capture and its pyramid
+ */
+static void pyr_remove(const char *path)
+{
+    char level[64];
+    int k;
+
+    for (k = 0; k < ADS125x_PYR_MAX_LEVELS; ++k)
+    {
+        snprintf(level, sizeof(level), "%s%s/level%02d", path, ADS125x_PYR_SUFFIX, k);
+        unlink(level);
+    }
+    snprintf(level, sizeof(level), "%s%s", path, ADS125x_PYR_SUFFIX);
+    rmdir(level);
+    unlink(path);
+    return;
+}
+
+int main(void)
+{
+    char path[] = "/tmp/ads1256test-XXXXXX";
+    ads125x_pyr_view *v;
+    ads125x_pyr *p;
+    uint32_t seed = 1;
+    size_t i, n, c;
+    int fd;
+
+    // Random codes over the whole 24 bit range
+    for (i = 0; i < PYR_SAMPLES; ++i)
+    {
+        seed = seed * 1664525 + 1013904223;
+        codes[i] = (int32_t)(seed & 0xFFFFFF) - 0x800000;
+        capture[3 * i] = (uint8_t)(codes[i] >> 16);
+        capture[3 * i + 1] = (uint8_t)(codes[i] >> 8);
+        capture[3 * i + 2] = (uint8_t)codes[i];
+    }
+    if ((fd = mkstemp(path)) < 0 || write(fd, capture, sizeof(capture)) != sizeof(capture) || (p = ads125xPyrCreate(path)) == NULL)
+    {
+        TEST_CHECK(!"create the capture");
+        if (fd >= 0)
+            close(fd);
+        pyr_remove(path);
+        return test_done("pyramid");
+    }
+    close(fd);
+    // Both push calls, in odd chunks
+    for (i = c = 0; i < PYR_SAMPLES; i += n, ++c)
+    {
+        n = chunks[c % (sizeof(chunks) / sizeof(chunks[0]))];
+        n = n < PYR_SAMPLES - i ? n : PYR_SAMPLES - i;
+        TEST_OK(c % 2 ? ads125xPyrPushRaw(p, capture + 3 * i, n) : ads125xPyrPush(p, codes + i, n));
+    }
+    // Still being built, it covers the entries written so far
+    TEST_CHECK((v = ads125xPyrOpen(path)) != NULL);
+    if (v)
+    {
+        TEST_CHECK(ads125xPyrSamples(v) % 64 == 0 && ads125xPyrSamples(v) < PYR_SAMPLES);
+        ads125xPyrViewClose(v);
+    }
+    TEST_OK(ads125xPyrClose(p));
+
+    if ((v = ads125xPyrOpen(path)) == NULL)
+    {
+        TEST_CHECK(!"open the pyramid");
+        pyr_remove(path);
+        return test_done("pyramid");
+    }
+    TEST_CHECK(ads125xPyrSamples(v) == PYR_SAMPLES);
+    TEST_CHECK(ads125xPyrQuery(v, 0, 10, out, 0) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xPyrQuery(v, 0, 10, out, 11) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xPyrQuery(v, PYR_SAMPLES - 10, 11, out, 1) == ADS125x_ERR_INVAL);
+
+    // The whole capture, partial last entries of every level included
+    pyr_exact(v, 0, PYR_SAMPLES, 1);
+    // Pixel borders on entry borders, 1 ~ 32 pixels
+    for (i = 1; i <= 32; i *= 2)
+        pyr_exact(v, 65536, 131072, (int)i);
+    // Finer than level 0, from the samples, up to the end
+    pyr_exact(v, 12345, 1000, 7);
+    pyr_exact(v, PYR_SAMPLES - 999, 999, 10);
+    pyr_exact(v, 0, 1, 1);
+    // Anywhere
+    pyr_near(v, 0, PYR_SAMPLES, 3);
+    pyr_near(v, 777, 150001, 10);
+    pyr_near(v, 777, 150001, 100);
+    pyr_near(v, 4099, PYR_SAMPLES - 4099, PYR_PIXELS);
+    pyr_near(v, 100, 70000, 17);
+    ads125xPyrViewClose(v);
+    pyr_remove(path);
+    return test_done("pyramid");
+}
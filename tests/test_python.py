@@ -0,0 +1,141 @@
+#
+# test_python.py - Test of the Python module on a replayed capture
+#
+#	Driver for the ADS1256 SPI 24-Bit ADC
+#	Copyright (c) 2025, Guo Ruijing (rokkiea)
+#
+# This program has been tested solely on the Orange Pi 5 Pro with the
+# ADS1256. It should theoretically work with the ADS1255 as well.
+# However, its functionality on any other board is not guaranteed.
+#
+#**********************************************************************
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+#**********************************************************************
+# For details of ADS125x, see:
+#  TI ADS125x: https://www.ti.com/product/ADS1256
+#              https://www.ti.com/product/ADS1255
+#  Datasheet: https://www.ti.com/lit/gpn/ads1256
+#             https://www.ti.com/lit/gpn/ads1255
+#
+
+import array
+import os
+import struct
+import tempfile
+import time
+import unittest
+
+import ads1256
+
+# A ramp of 24 bit codes crossing zero, replayed in a loop
+FIRST = -100
+COUNT = 2048
+
+
+def expect(n):
+    """Code of the n-th conversion of the replay."""
+    return n % COUNT + FIRST
+
+
+def wait_for(cond, timeout=2.0):
+    """Poll cond until it holds or timeout s passed."""
+    end = time.monotonic() + timeout
+    while not cond():
+        if time.monotonic() > end:
+            return False
+        time.sleep(0.001)
+    return True
+
+
+class DeviceTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        fd, cls.path = tempfile.mkstemp(prefix="ads1256test-")
+        os.write(fd, b"".join(struct.pack(">i", FIRST + i)[1:] for i in range(COUNT)))
+        os.close(fd)
+
+    @classmethod
+    def tearDownClass(cls):
+        os.unlink(cls.path)
+
+    def setUp(self):
+        self.dev = ads1256.Device(replay=self.path, fast=True, loop=True)
+        self.dev.configure(drate=ads1256.DR_30000)
+
+    def tearDown(self):
+        self.dev.close()
+
+    def test_read(self):
+        self.assertEqual(self.dev.sps, 30000.0)
+        blk = self.dev.read(COUNT + 10)
+        codes, ts, volts = memoryview(blk.codes), memoryview(blk.ts), memoryview(blk.volts)
+        self.assertEqual((codes.format, ts.format, volts.format), ("i", "Q", "d"))
+        self.assertEqual(len(blk), COUNT + 10)
+        self.assertEqual(list(codes), [expect(n) for n in range(COUNT + 10)])
+        self.assertTrue(all(a <= b for a, b in zip(ts, ts[1:])))
+        # 2 * vref / 2^23 a code at gain 1
+        self.assertAlmostEqual(volts[0], FIRST * 5.0 / 8388608)
+        # The next read goes on where this one stopped
+        self.assertEqual(self.dev.read(1).codes[0], expect(COUNT + 10))
+        self.assertEqual(self.dev.dropped, 0)
+
+    def test_read_into(self):
+        codes, ts = array.array("i", bytes(4 * 100)), array.array("Q", bytes(8 * 100))
+        self.assertEqual(self.dev.read_into(codes, ts), 100)
+        self.assertEqual(list(codes), [expect(n) for n in range(100)])
+        self.assertTrue(ts[0] > 0 and ts[99] >= ts[0])
+        self.assertEqual(self.dev.read_into(codes), 100)
+        self.assertEqual(list(codes), [expect(n) for n in range(100, 200)])
+        with self.assertRaises(ValueError):
+            self.dev.read_into(codes, array.array("Q", bytes(8)))
+
+    def test_stream(self):
+        seen = 0
+        with self.dev.stream(block=256, blocks=4) as st:
+            # A device has one reader at a time
+            with self.assertRaises(RuntimeError):
+                self.dev.read(1)
+            # The fast replay outruns Python, seq counts the lost samples too
+            for blk in st:
+                self.assertEqual(list(blk.codes), [expect(n) for n in range(blk.seq, blk.seq + 256)])
+                seen += 1
+                if seen == 20:
+                    break
+        self.dev.read(1)
+
+    def test_stream_held(self):
+        # Python holding every block makes the thread count what it reads as lost
+        with self.dev.stream(block=64, blocks=2) as st:
+            held = [next(st), next(st)]
+            self.assertTrue(wait_for(lambda: st.lost > 0), "nothing lost")
+            held.clear()
+            blk = next(st)
+            self.assertEqual(blk.codes[0], expect(blk.seq))
+
+    def test_errors(self):
+        with self.assertRaises(ValueError):
+            self.dev.configure(psel=9)
+        with self.assertRaises(ValueError):
+            self.dev.read(0)
+        with self.assertRaises(ads1256.Error):
+            ads1256.Device(replay="/nonexistent/capture.bin")
+        self.dev.close()
+        with self.assertRaises(ValueError):
+            self.dev.read(1)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,98 @@
+/**
+ * test_recover.c - Fault injection and in-place recovery of RDATAC
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include "ads1256test.h"
+
+static uint8_t raw[TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+static uint8_t data[64 * ADS125x_DATA_LEN_BYTE];
+
+/**
+ * read_faulted - Stream 64 samples with @fault injected after 16 of them
+ * @recover: Set ADS125x_FLAG_RECOVER.
+ * @count: Failed transfers of ADS125x_FAULT_XFER.
+ *
+ * @return: The return of ads125xRDATACRead().
+ */
+static int read_faulted(ads125x_dev *dev, int fault, int recover, int count)
+{
+    int ret;
+
+    if (test_open(dev, raw, TEST_SAMPLES, ADS125x_REPLAY_FAST | ADS125x_REPLAY_LOOP))
+        return ADS125x_ERR_IO;
+    // A stuck DRDY times out at once instead of after 4 conversions
+    dev->drdy_timeout_us = 2000;
+    if (recover)
+        dev->flags |= ADS125x_FLAG_RECOVER;
+    TEST_OK(ads125xRDATACStart(dev));
+    TEST_OK(ads125xReplayInjectFault(dev, fault, 16, count));
+    ret = ads125xRDATACRead(dev, data, 64);
+    ads125xRDATACStop(dev);
+    return ret;
+}
+
+int main(void)
+{
+    ads125x_dev dev;
+
+    memset(&dev, 0x00, sizeof(dev));
+    TEST_CHECK(ads125xReplayInjectFault(&dev, ADS125x_FAULT_XFER, 0, 1) == 1);
+
+    // Without the flag the first error ends the read
+    TEST_CHECK(read_faulted(&dev, ADS125x_FAULT_XFER, 0, 1) == ADS125x_ERR_IO);
+    TEST_CHECK(dev.recovery.count == 0);
+    ads125xReplayClose(&dev);
+    TEST_CHECK(read_faulted(&dev, ADS125x_FAULT_DRDY_STUCK, 0, 0) == ADS125x_ERR_TIMEOUT);
+    TEST_CHECK(dev.recovery.count == 0);
+    ads125xReplayClose(&dev);
+
+    // With it the read goes on after one recovery
+    TEST_CHECK(read_faulted(&dev, ADS125x_FAULT_XFER, 1, 1) == ADS125x_OK);
+    TEST_CHECK(dev.recovery.count == 1);
+    TEST_CHECK(dev.recovery.failures == 0);
+    TEST_CHECK(dev.recovery.last_index == 16);
+    TEST_CHECK(dev.rdatac_count == 64);
+    ads125xReplayClose(&dev);
+    TEST_CHECK(read_faulted(&dev, ADS125x_FAULT_DRDY_STUCK, 1, 0) == ADS125x_OK);
+    TEST_CHECK(dev.recovery.count == 1);
+    TEST_CHECK(dev.recovery.failures == 0);
+    TEST_CHECK(dev.rdatac_count == 64);
+    ads125xReplayClose(&dev);
+
+    // A bus that keeps failing gives up after ADS125x_RECOVER_TRIES recoveries
+    TEST_CHECK(read_faulted(&dev, ADS125x_FAULT_XFER, 1, 1000) == ADS125x_ERR_IO);
+    TEST_CHECK(dev.recovery.count == 0);
+    TEST_CHECK(dev.recovery.failures == 1);
+    ads125xReplayClose(&dev);
+
+    return test_done("recover");
+}
@@ -0,0 +1,156 @@
+/**
+ * test_replay.c - The replay backend against known captures
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <unistd.h>
+#include "ads1256test.h"
+
+static uint8_t raw[TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+static uint8_t data[TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+
+/**
+ * check_ramp - Check that @n samples at @p count up from @first
+ * @sign: -1 for swapped inputs.
+ *
+ * @return: Index of the first wrong sample, @n if all are right.
+ */
+static int check_ramp(const uint8_t *p, int n, int32_t first, int sign)
+{
+    int i;
+
+    for (i = 0; i < n; ++i)
+        if (convert_to_signed_24bit(p + 3 * i) != sign * (first + i))
+            break;
+    return i;
+}
+
+/**
+ * check_file - Replay a CSV and a binary capture of the same 5 samples
+ */
+static void check_file(void)
+{
+    static const int32_t codes[5] = {0, 1, -1, 0x7FFFFF, -0x800000};
+    char csv[] = "/tmp/ads1256test-XXXXXX.csv", bin[] = "/tmp/ads1256test-XXXXXX";
+    ads125x_dev dev;
+    FILE *fp;
+    int i, fd;
+
+    if ((fd = mkstemps(csv, 4)) < 0 || (fp = fdopen(fd, "w")) == NULL)
+    {
+        TEST_CHECK(!"create the CSV capture");
+        return;
+    }
+    // Lines which are not samples are skipped
+    fprintf(fp, "STATUS MUX ADCON DRATE REG: 30 01 20 a1\n====== Continues read ======\n");
+    for (i = 0; i < 5; ++i)
+        fprintf(fp, "%5d,%06x,%.12lf\n", i, (unsigned int)codes[i] & 0xFFFFFF, codes[i] * 5.0 / 0x7FFFFF);
+    fclose(fp);
+    for (i = 0; i < 5; ++i)
+        test_ramp(raw + 3 * i, 1, codes[i]);
+    if ((fd = mkstemp(bin)) < 0 || write(fd, raw, 5 * ADS125x_DATA_LEN_BYTE) != 5 * ADS125x_DATA_LEN_BYTE)
+        TEST_CHECK(!"create the binary capture");
+    if (fd >= 0)
+        close(fd);
+
+    memset(&dev, 0x00, sizeof(dev));
+    TEST_OK(ads125xReplayOpen(&dev, csv, ADS125x_REPLAY_FMT_AUTO, ADS125x_REPLAY_FAST));
+    TEST_CHECK(ads125xReplayCount(&dev) == 5);
+    TEST_OK(ads125xRDATAC(&dev, data, 5));
+    for (i = 0; i < 5; ++i)
+        TEST_CHECK(convert_to_signed_24bit(data + 3 * i) == codes[i]);
+    ads125xReplayClose(&dev);
+
+    memset(&dev, 0x00, sizeof(dev));
+    TEST_OK(ads125xReplayOpen(&dev, bin, ADS125x_REPLAY_FMT_AUTO, ADS125x_REPLAY_FAST));
+    TEST_CHECK(ads125xReplayCount(&dev) == 5);
+    TEST_OK(ads125xRDATAC(&dev, data, 5));
+    for (i = 0; i < 5; ++i)
+        TEST_CHECK(convert_to_signed_24bit(data + 3 * i) == codes[i]);
+    ads125xReplayClose(&dev);
+
+    TEST_CHECK(ads125xReplayOpen(&dev, "/nonexistent/capture.bin", ADS125x_REPLAY_FMT_AUTO, 0) != 0);
+    unlink(csv);
+    unlink(bin);
+    return;
+}
+
+int main(void)
+{
+    ads125x_dev dev;
+    uint64_t start;
+    uint8_t mux;
+
+    check_file();
+
+    // RDATAC serves the capture in order
+    TEST_OK(test_open(&dev, raw, 64, ADS125x_REPLAY_FAST));
+    TEST_CHECK(ads125xReplayCount(&dev) == 64);
+    TEST_OK(ads125xRDATAC(&dev, data, 32));
+    TEST_CHECK(check_ramp(data, 32, 0, 1) == 32);
+    TEST_OK(ads125xRDATAC(&dev, data, 32));
+    TEST_CHECK(check_ramp(data, 32, 32, 1) == 32);
+    // Exhausted without ADS125x_REPLAY_LOOP, the last sample repeats, in a new RDATAC as well
+    TEST_OK(ads125xRDATAC(&dev, data, 2));
+    TEST_CHECK(convert_to_signed_24bit(data) == 63 && convert_to_signed_24bit(data + 3) == 63);
+    TEST_CHECK(ads125xReplayDropped(&dev) == 0);
+    ads125xReplayClose(&dev);
+
+    // The capture is the input seen with PSEL below NSEL, swapped inputs see it negated
+    TEST_OK(test_open(&dev, raw, 64, ADS125x_REPLAY_FAST | ADS125x_REPLAY_LOOP));
+    TEST_OK(ads125xSetMUX(&dev, ADS125x_MUX_PSEL_CH1, ADS125x_MUX_NSEL_CH0));
+    TEST_OK(ads125xRREG(&dev, ADS125x_REG_ADDR_MUX, &mux, 1));
+    TEST_CHECK(mux == (ADS125x_MUX_PSEL_CH1 | ADS125x_MUX_NSEL_CH0));
+    TEST_OK(ads125xRDATAC(&dev, data, 48));
+    TEST_CHECK(check_ramp(data, 48, 0, -1) == 48);
+    // And ADS125x_REPLAY_LOOP starts over
+    TEST_OK(ads125xSetMUX(&dev, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1));
+    TEST_OK(ads125xRDATAC(&dev, data, 32));
+    TEST_CHECK(check_ramp(data, 16, 48, 1) == 16);
+    TEST_CHECK(check_ramp(data + 3 * 16, 16, 0, 1) == 16);
+    // A one-shot read is a conversion of the capture as well
+    TEST_OK(ads125xRDATA(&dev, data));
+    TEST_CHECK(convert_to_signed_24bit(data) >= 0 && convert_to_signed_24bit(data) < 64);
+    ads125xReplayClose(&dev);
+
+    // Paced, DRDY follows the programmed DRATE
+    TEST_OK(test_open(&dev, raw, TEST_SAMPLES, ADS125x_REPLAY_PACED | ADS125x_REPLAY_LOOP));
+    TEST_OK(ads125xSetDRATE(&dev, ADS125x_DR_1000));
+    TEST_OK(ads125xRDATACStart(&dev));
+    start = ads125xNowNs();
+    TEST_OK(ads125xRDATACRead(&dev, data, 50));
+    TEST_CHECK(ads125xNowNs() - start >= 45 * 1000000ULL);
+    TEST_CHECK(dev.drdy_ns != 0);
+    TEST_OK(ads125xRDATACStop(&dev));
+    ads125xReplayClose(&dev);
+
+    return test_done("replay");
+}
@@ -0,0 +1,170 @@
+/**
+ * test_scan.c - Test of the scan planner and reader on replay devices
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include "ads1256test.h"
+#include "libads1256scan.h"
+
+#define SCAN_FRAMES     20
+#define SCAN_SAMPLES    1024
+
+static uint8_t raw[TEST_SAMPLES * ADS125x_DATA_LEN_BYTE];
+static ads125x_scan_sample out[SCAN_SAMPLES];
+
+/**
+ * scan_check_plan - Check the rates and the frame of a plan
+ *
+ * @return: Conversions per frame.
+ */
+static int scan_check_plan(const ads125x_scan *s)
+{
+    int i, n = 0, seen = 0;
+
+    for (i = 0; i < s->nch; ++i)
+    {
+        TEST_CHECK(s->ch[i].burst >= 0);
+        TEST_CHECK(s->ch[i].achieved_sps == s->ch[i].burst * 1e6 / s->frame_us);
+        n += s->ch[i].burst;
+        seen += s->ch[i].burst > 0;
+    }
+    TEST_CHECK(seen == s->slots);
+    TEST_CHECK(s->frame_us > 0 && s->frame_us <= ADS125x_SCAN_MAX_FRAME_US);
+    // Slots sorted by DRATE, then PGA
+    for (i = 1; i < s->slots; ++i)
+        TEST_CHECK(s->ch[s->order[i - 1]].drate < s->ch[s->order[i]].drate ||
+                   (s->ch[s->order[i - 1]].drate == s->ch[s->order[i]].drate &&
+                    s->ch[s->order[i - 1]].pga <= s->ch[s->order[i]].pga));
+    return n;
+}
+
+/**
+ * scan_shed - Plans of a chip too slow for all the wanted rates
+ */
+static void scan_shed(void)
+{
+    ads125x_scan s;
+    int i;
+
+    // The lowest priority slows down, the others keep their rates
+    ads125xScanInit(&s);
+    for (i = 0; i < 4; ++i)
+        TEST_CHECK(ads125xScanAdd(&s, i << 4, ADS125x_MUX_NSEL_CH7, ADS125x_ADCON_PGA_1, ADS125x_DR_30000, 8000, i < 2 ? 2 - i : 0) == i);
+    TEST_OK(ads125xScanPlan(&s));
+    scan_check_plan(&s);
+    TEST_CHECK(s.slots == 4);
+    TEST_CHECK(s.ch[0].achieved_sps >= 8000 && s.ch[1].achieved_sps >= 8000);
+    TEST_CHECK(s.ch[2].achieved_sps < 8000 && s.ch[2].achieved_sps > 0);
+    TEST_CHECK(s.ch[2].achieved_sps == s.ch[3].achieved_sps);
+    // Same DRATE and PGA, each switch writes MUX only
+    TEST_CHECK(s.writes == 4);
+
+    // Nothing is left for the lower priority
+    ads125xScanInit(&s);
+    TEST_CHECK(ads125xScanAdd(&s, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1, ADS125x_ADCON_PGA_1, ADS125x_DR_30000, 30000, 1) == 0);
+    TEST_CHECK(ads125xScanAdd(&s, ADS125x_MUX_PSEL_CH2, ADS125x_MUX_NSEL_CH3, ADS125x_ADCON_PGA_1, ADS125x_DR_30000, 10, 0) == 1);
+    TEST_OK(ads125xScanPlan(&s));
+    scan_check_plan(&s);
+    TEST_CHECK(s.slots == 1 && s.order[0] == 0 && s.writes == 0);
+    TEST_CHECK(s.ch[0].achieved_sps >= 30000 - 1e-6);
+    TEST_CHECK(s.ch[1].burst == 0 && s.ch[1].achieved_sps == 0);
+
+    // Faster than its DRATE, slowed down to it
+    ads125xScanInit(&s);
+    TEST_CHECK(ads125xScanAdd(&s, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1, ADS125x_ADCON_PGA_1, ADS125x_DR_1000, 2000, 0) == 0);
+    TEST_OK(ads125xScanPlan(&s));
+    scan_check_plan(&s);
+    TEST_CHECK(s.ch[0].achieved_sps <= 1000 && s.ch[0].achieved_sps > 990);
+    return;
+}
+
+int main(void)
+{
+    ads125x_scan s;
+    ads125x_dev dev;
+    int i, j, k, n, count[3] = {0};
+    uint64_t first, last;
+    double elapsed;
+    int32_t base;
+
+    ads125xScanInit(&s);
+    TEST_CHECK(ads125xScanPlan(&s) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xScanAdd(&s, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1, ADS125x_ADCON_PGA_1, 0x42, 10, 0) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xScanAdd(&s, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1, ADS125x_ADCON_PGA_1, 0, 0, 0) == ADS125x_ERR_INVAL);
+    scan_shed();
+
+    // A swapped input reads the ramp negated, which tells the channel of a conversion
+    TEST_CHECK(ads125xScanAdd(&s, ADS125x_MUX_PSEL_CH0, ADS125x_MUX_NSEL_CH1, ADS125x_ADCON_PGA_1, ADS125x_DR_2000, 500, 1) == 0);
+    TEST_CHECK(ads125xScanAdd(&s, ADS125x_MUX_PSEL_CH3, ADS125x_MUX_NSEL_CH2, ADS125x_ADCON_PGA_2, ADS125x_DR_2000, 50, 1) == 1);
+    TEST_CHECK(ads125xScanAdd(&s, ADS125x_MUX_PSEL_CH4, ADS125x_MUX_NSEL_CH5, ADS125x_ADCON_PGA_1, 0, 100, 0) == 2);
+
+    TEST_CHECK(test_open(&dev, raw, TEST_SAMPLES, ADS125x_REPLAY_PACED) == 0);
+    // Not planned yet
+    TEST_CHECK(ads125xScanStart(&dev, &s) == ADS125x_ERR_INVAL);
+    TEST_CHECK(ads125xScanRead(&dev, &s, out, 1) == ADS125x_ERR_INVAL);
+
+    TEST_OK(ads125xScanPlan(&s));
+    n = scan_check_plan(&s);
+    // The slowest DRATE at least 2 * channels * rate
+    TEST_CHECK(s.ch[2].drate == ADS125x_DR_1000);
+    for (i = 0; i < s.nch; ++i)
+        TEST_CHECK(s.ch[i].achieved_sps >= s.ch[i].rate_sps);
+    TEST_CHECK(s.slots == 3 && s.order[0] == 2 && s.order[1] == 0 && s.order[2] == 1);
+    // MUX and DRATE, MUX and ADCON, then all three
+    TEST_CHECK(s.writes == 8);
+
+    TEST_OK(ads125xScanStart(&dev, &s));
+    TEST_OK(ads125xScanRead(&dev, &s, out, n * SCAN_FRAMES));
+    base = out[0].code;
+    for (i = k = 0; k < SCAN_FRAMES; ++k)
+        for (j = 0; j < s.slots; ++j)
+        {
+            for (n = 0; n < s.ch[s.order[j]].burst; ++n, ++i)
+            {
+                TEST_CHECK(out[i].channel == s.order[j]);
+                TEST_CHECK(out[i].code == (out[i].channel == 1 ? -(base + i) : base + i));
+                TEST_CHECK(i == 0 || out[i].ts > out[i - 1].ts);
+                // The whole frames after the first
+                if (k)
+                    count[out[i].channel]++;
+            }
+        }
+
+    // Faster than planned by the SPI message time the emulated chip does not take
+    first = out[s.ch[s.order[0]].burst + s.ch[s.order[1]].burst + s.ch[s.order[2]].burst].ts;
+    TEST_OK(ads125xScanRead(&dev, &s, out, 1));
+    last = out[0].ts;
+    elapsed = (last - first) * 1e-9;
+    for (i = 0; i < s.nch; ++i)
+        TEST_CHECK(count[i] / elapsed >= s.ch[i].achieved_sps * 0.9 && count[i] / elapsed <= s.ch[i].achieved_sps * 1.15);
+    ads125xReplayClose(&dev);
+    return test_done("scan");
+}
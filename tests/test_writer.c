@@ -0,0 +1,223 @@
+/**
+ * test_writer.c - The background writer with both engines
+ *
+ *	Driver for the ADS1256 SPI 24-Bit ADC
+ *	Copyright (c) 2025, Guo Ruijing (rokkiea)
+ *
+ * This program has been tested solely on the Orange Pi 5 Pro with the
+ * ADS1256. It should theoretically work with the ADS1255 as well.
+ * However, its functionality on any other board is not guaranteed.
+ *
+ ***********************************************************************
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***********************************************************************
+ * For details of ADS125x, see:
+ *  TI ADS125x: https://www.ti.com/product/ADS1256
+ *              https://www.ti.com/product/ADS1255
+ *  Datasheet: https://www.ti.com/lit/gpn/ads1256
+ *             https://www.ti.com/lit/gpn/ads1255
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include "ads1256test.h"
+#include "libads1256writer.h"
+
+#define BLOCK 8192
+#define BLOCKS 64
+#define LAST 1000   // Bytes of the short last block
+
+static uint8_t back[BLOCK * BLOCKS];
+
+/**
+ * pattern - Byte @i of the file written by write_file()
+ */
+static uint8_t pattern(size_t i)
+{
+    return (uint8_t)(i * 7 + i / BLOCK);
+}
+
+/**
+ * write_file - Write BLOCKS blocks and a short one, waiting for free buffers
+ *
+ * @return: The result of ads125xWriterClose(), -1 is the writer failed.
+ */
+static int write_file(const char *path, int flags, ads125x_writer_stats *stats)
+{
+    ads125x_writer *w;
+    uint8_t *buf;
+    size_t i, len;
+    int b;
+
+    if ((w = ads125xWriterOpen(path, BLOCK, 8, 4, flags)) == NULL)
+        return -1;
+    // A buffer not from the writer is refused
+    TEST_CHECK(ads125xWriterSubmit(w, back, BLOCK) == -1);
+    for (b = 0; b <= BLOCKS; ++b)
+    {
+        while ((buf = ads125xWriterGetBuffer(w)) == NULL)
+            usleep(100);
+        len = b < BLOCKS ? BLOCK : LAST;
+        for (i = 0; i < len; ++i)
+            buf[i] = pattern((size_t)b * BLOCK + i);
+        TEST_OK(ads125xWriterSubmit(w, buf, len));
+    }
+    return ads125xWriterClose(w, stats);
+}
+
+/**
+ * check_engine - Write a file with @flags and read it back
+ */
+static void check_engine(const char *path, int flags)
+{
+    ads125x_writer_stats stats;
+    size_t i, size = (size_t)BLOCK * BLOCKS + LAST;
+    FILE *fp;
+
+    memset(&stats, 0x00, sizeof(stats));
+    TEST_OK(write_file(path, flags, &stats));
+    TEST_CHECK(stats.engine != NULL);
+    if (flags & ADS125x_WRITER_POOL)
+        TEST_CHECK(stats.engine && strcmp(stats.engine, "pwrite") == 0);
+    TEST_CHECK(stats.blocks == BLOCKS + 1);
+    TEST_CHECK(stats.bytes == size);
+    TEST_CHECK(stats.errors == 0);
+    TEST_CHECK(stats.lat_min_ns <= stats.lat_avg_ns && stats.lat_avg_ns <= stats.lat_max_ns);
+
+    if ((fp = fopen(path, "rb")) == NULL)
+    {
+        TEST_CHECK(!"open the written file");
+        return;
+    }
+    TEST_CHECK(fread(back, 1, sizeof(back), fp) == sizeof(back));
+    for (i = 0; i < sizeof(back) && back[i] == pattern(i); ++i)
+        ;
+    TEST_CHECK(i == sizeof(back));
+    for (i = 0; i < LAST && fgetc(fp) == pattern(sizeof(back) + i); ++i)
+        ;
+    TEST_CHECK(i == LAST);
+    TEST_CHECK(fgetc(fp) == EOF);
+    fclose(fp);
+    return;
+}
+
+/**
+ * submit_refused - Submit a block from a thread where io_uring_enter() fails
+ *
+ * The seccomp filter only holds for this thread, the reaper of the
+ * writer keeps waiting for completions.
+ */
+static void *submit_refused(void *arg)
+{
+    struct sock_filter filter[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_io_uring_enter, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | EAGAIN),
+        BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
+    };
+    struct sock_fprog prog = {sizeof(filter) / sizeof(filter[0]), filter};
+    ads125x_writer *w = (ads125x_writer *)arg;
+    uint8_t *buf;
+
+    if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) || prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &prog))
+        return arg;
+    if ((buf = ads125xWriterGetBuffer(w)) == NULL)
+    {
+        TEST_CHECK(!"get a buffer");
+        return NULL;
+    }
+    memset(buf, 0x55, BLOCK);
+    TEST_CHECK(ads125xWriterSubmit(w, buf, BLOCK) == -1);
+    return NULL;
+}
+
+/**
+ * check_refused - A write io_uring refuses fails at once, and close still returns
+ */
+static void check_refused(const char *path)
+{
+    ads125x_writer_stats stats;
+    ads125x_writer *w;
+    pthread_t thread;
+    uint8_t *buf;
+    void *skipped = NULL;
+    int b;
+
+    if ((w = ads125xWriterOpen(path, BLOCK, 8, 4, 0)) == NULL)
+    {
+        TEST_CHECK(!"open the writer");
+        return;
+    }
+    ads125xWriterGetStats(w, &stats);
+    if (strcmp(stats.engine, "io_uring") == 0 && pthread_create(&thread, NULL, submit_refused, w) == 0)
+    {
+        pthread_join(thread, &skipped);
+        // The refused buffer is free again, 8 more blocks need it
+        for (b = 0; b < 8; ++b)
+        {
+            while ((buf = ads125xWriterGetBuffer(w)) == NULL)
+                usleep(100);
+            memset(buf, b, BLOCK);
+            TEST_OK(ads125xWriterSubmit(w, buf, BLOCK));
+        }
+        memset(&stats, 0x00, sizeof(stats));
+        TEST_CHECK(ads125xWriterClose(w, &stats) == (skipped ? 0 : 1));
+        TEST_CHECK(stats.blocks == 8 && stats.errors == (skipped ? 0 : 1));
+        if (skipped)
+            fprintf(stderr, "writer: seccomp not allowed, refused submit not tested\n");
+        return;
+    }
+    ads125xWriterClose(w, NULL);
+    return;
+}
+
+int main(void)
+{
+    char path[] = "/tmp/ads1256test-XXXXXX";
+    ads125x_writer_stats stats;
+    int fd;
+
+    if ((fd = mkstemp(path)) < 0)
+    {
+        TEST_CHECK(!"create the output file");
+        return test_done("writer");
+    }
+    close(fd);
+    // io_uring if the kernel allows it, the thread pool otherwise
+    check_engine(path, 0);
+    check_engine(path, ADS125x_WRITER_POOL);
+    check_refused(path);
+    unlink(path);
+
+    TEST_CHECK(ads125xWriterOpen("/nonexistent/capture.bin", BLOCK, 8, 4, 0) == NULL);
+    TEST_CHECK(ads125xWriterOpen(path, BLOCK, 2, 4, 0) == NULL);
+    // A full device fails every write, the errors are counted and reported
+    if (access("/dev/full", W_OK) == 0)
+    {
+        memset(&stats, 0x00, sizeof(stats));
+        TEST_CHECK(write_file("/dev/full", ADS125x_WRITER_POOL, &stats) == 1);
+        TEST_CHECK(stats.errors == BLOCKS + 1);
+        TEST_CHECK(stats.bytes == 0);
+    }
+
+    return test_done("writer");
+}